@@ -0,0 +1,379 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <chrono>
+#include <cstdio>
+#include <log.h>
+#include <Greenpak4.h>
+
+using namespace std;
+
+void ShowUsage();
+void ShowVersion();
+
+typedef map<string, string> settings;
+
+bool LoadDevice(string fname, Greenpak4Device* device, Greenpak4Bitstream& bitstream);
+string GetNetName(Greenpak4EntityOutput src);
+settings GetSettings(Greenpak4BitstreamEntity* entity);
+unsigned int DiffEntities(Greenpak4Device* a, Greenpak4Device* b);
+unsigned int DiffChipFields(Greenpak4Device* device, const Greenpak4Bitstream& a, const Greenpak4Bitstream& b);
+void PrintBits(Greenpak4Device* device, const Greenpak4Bitstream& a, const Greenpak4Bitstream& b);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Entry point
+
+int main(int argc, char* argv[])
+{
+	Severity console_verbosity = Severity::NOTICE;
+
+	//Bitstream files
+	string fnames[2];
+
+	//List every bit that differs, not just the settings
+	bool bits = false;
+
+	Greenpak4Device::GREENPAK4_PART part = Greenpak4Device::GREENPAK4_SLG46620;
+
+	//Parse command-line arguments
+	for(int i=1; i<argc; i++)
+	{
+		string s(argv[i]);
+
+		//Let the logger eat its args first
+		if(ParseLoggerArguments(i, argc, argv, console_verbosity))
+			continue;
+
+		else if(s == "--help")
+		{
+			ShowUsage();
+			return 0;
+		}
+		else if(s == "--version")
+		{
+			ShowVersion();
+			return 0;
+		}
+		else if(s == "--part")
+		{
+			if(i+1 < argc)
+			{
+				string p = argv[++i];
+				if(p == "SLG46620")
+					part = Greenpak4Device::GREENPAK4_SLG46620;
+				else if(p == "SLG46621")
+					part = Greenpak4Device::GREENPAK4_SLG46621;
+				else if(p == "SLG46140")
+					part = Greenpak4Device::GREENPAK4_SLG46140;
+				else
+				{
+					printf("--part must be one of SLG46620, SLG46621, SLG46140\n");
+					return 2;
+				}
+			}
+			else
+			{
+				printf("--part requires an argument\n");
+				return 2;
+			}
+		}
+		else if(s == "--bits")
+			bits = true;
+
+		//assume it's a bitstream file if it's a non-switch argument
+		else if( (s[0] != '-') && (fnames[0] == "") )
+			fnames[0] = s;
+		else if( (s[0] != '-') && (fnames[1] == "") )
+			fnames[1] = s;
+
+		else
+		{
+			printf("Unrecognized command-line argument \"%s\", use --help\n", s.c_str());
+			return 2;
+		}
+	}
+
+	//Need two things to compare
+	if( (fnames[0] == "") || (fnames[1] == "") )
+	{
+		ShowUsage();
+		return 2;
+	}
+
+	//Set up logging
+	g_log_sinks.emplace(g_log_sinks.begin(), new STDLogSink(console_verbosity));
+
+	//Print header
+	if(console_verbosity >= Severity::NOTICE)
+		ShowVersion();
+
+	//Reconstruct both configurations
+	Greenpak4Device a(part);
+	Greenpak4Device b(part);
+	Greenpak4Bitstream abits;
+	Greenpak4Bitstream bbits;
+	LogNotice("\nLoading bitstream files \"%s\" and \"%s\".\n", fnames[0].c_str(), fnames[1].c_str());
+	{
+		LogIndenter li;
+
+		auto start = chrono::steady_clock::now();
+		if(!LoadDevice(fnames[0], &a, abits) || !LoadDevice(fnames[1], &b, bbits))
+			return 2;
+		auto usec = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+		LogNotice("Loaded in %ld us\n", (long)usec);
+	}
+
+	unsigned int nbits = abits.CountDifferences(bbits);
+	if(nbits == 0)
+	{
+		LogNotice("\nBitstreams are identical\n");
+		return 0;
+	}
+	LogNotice("\n%u bits differ\n", nbits);
+
+	unsigned int nchanges = DiffEntities(&a, &b);
+	nchanges += DiffChipFields(&a, abits, bbits);
+	if(nchanges == 0)
+		LogNotice("\nNo differences in the configuration (only don't-care bits changed)\n");
+
+	if(bits)
+		PrintBits(&a, abits, bbits);
+
+	return 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Loading
+
+/**
+	@brief Reads a bitstream file and configures a device from it, keeping the raw bits for comparison
+ */
+bool LoadDevice(string fname, Greenpak4Device* device, Greenpak4Bitstream& bitstream)
+{
+	uint16_t part;
+	if(!bitstream.ReadFile(fname, &part))
+		return false;
+
+	//Text files don't say what part they're for
+	if( (part != 0) && (part != device->GetPartCode()) )
+	{
+		LogError("%s is for part %x, not %x\n", fname.c_str(), part, device->GetPartCode());
+		return false;
+	}
+
+	uint8_t userid;
+	bool readProtect;
+	if(!device->Load(bitstream, userid, readProtect))
+	{
+		LogError("Couldn't reconstruct the configuration from %s\n", fname.c_str());
+		return false;
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Comparison
+
+/**
+	@brief Gets the name of a signal (named after its driver, or a constant)
+ */
+string GetNetName(Greenpak4EntityOutput src)
+{
+	if(src.m_src == NULL)
+		return "1'bx";
+	if(src.IsPowerRail())
+		return src.GetPowerRailValue() ? "1'b1" : "1'b0";
+	return src.GetRealEntity()->GetDescription() + "." + src.GetPort();
+}
+
+/**
+	@brief Gets everything that describes how an entity is configured: its primitive, parameters and inputs
+ */
+settings GetSettings(Greenpak4BitstreamEntity* entity)
+{
+	settings ret;
+
+	string prim = entity->GetPrimitiveName();
+	ret["primitive"] = prim;
+	for(auto it : entity->GetParameters())
+		ret[it.first] = it.second;
+
+	auto p = Greenpak4LookupPrimitive(prim);
+	if(p == NULL)
+		return ret;
+	for(unsigned int i=0; i<p->m_portCount; i++)
+	{
+		auto& port = p->m_ports[i];
+		if(port.m_direction != Greenpak4NetlistPort::DIR_INPUT)
+			continue;
+
+		if(port.m_width == 1)
+			ret[port.m_name] = GetNetName(entity->GetInput(port.m_name));
+		else
+		{
+			for(unsigned int j=0; j<port.m_width; j++)
+			{
+				string name = string(port.m_name) + "[" + to_string(j) + "]";
+				ret[name] = GetNetName(entity->GetInput(name));
+			}
+		}
+	}
+
+	return ret;
+}
+
+/**
+	@brief Prints every setting of every entity that differs between two configurations
+
+	@return Number of settings that differ
+ */
+unsigned int DiffEntities(Greenpak4Device* a, Greenpak4Device* b)
+{
+	unsigned int nchanges = 0;
+
+	for(unsigned int i=0; i<a->GetEntityCount(); i++)
+	{
+		auto ea = a->GetEntity(i);
+		auto eb = b->GetEntity(i);
+		auto sa = GetSettings(ea);
+		auto sb = GetSettings(eb);
+		if(sa == sb)
+			continue;
+
+		//Paired entities are named after whichever half is active
+		string name = ea->GetDescription();
+		if(name != eb->GetDescription())
+			name += " / " + eb->GetDescription();
+		LogNotice("\n%s:\n", name.c_str());
+		LogIndenter li;
+
+		//Settings only one side has (a different primitive) show up as missing on the other
+		settings all = sa;
+		all.insert(sb.begin(), sb.end());
+		for(auto it : all)
+		{
+			string va = sa.count(it.first) ? sa[it.first] : "-";
+			string vb = sb.count(it.first) ? sb[it.first] : "-";
+			if(va == vb)
+				continue;
+			LogNotice("%-16s %s -> %s\n", it.first.c_str(), va.c_str(), vb.c_str());
+			nchanges ++;
+		}
+	}
+
+	return nchanges;
+}
+
+/**
+	@brief Prints every chip-wide field (trim values, ID codes...) and unused bit that differs
+
+	@return Number of fields that differ
+ */
+unsigned int DiffChipFields(Greenpak4Device* device, const Greenpak4Bitstream& a, const Greenpak4Bitstream& b)
+{
+	auto& fields = device->GetBitFields();
+	unsigned int nchanges = 0;
+	bool first = true;
+
+	//Bits below this belong to a field that was already reported
+	unsigned int next = 0;
+
+	for(auto i : a.GetDifferences(b))
+	{
+		if(i < next)
+			continue;
+
+		//Entity settings were already covered
+		auto field = fields.Lookup(i);
+		if( (field != NULL) && (field->m_entity != NULL) )
+			continue;
+
+		if(first)
+		{
+			LogNotice("\nChip-wide:\n");
+			first = false;
+		}
+		LogIndenter li;
+
+		if(field == NULL)
+			LogNotice("bit %-12u %d -> %d\n", i, (int)a[i], (int)b[i]);
+
+		//Report the whole field once, at its first differing bit
+		else
+		{
+			LogNotice("%-16s %x -> %x\n",
+				field->m_name.c_str(),
+				(unsigned int)a.GetField(field->m_start, field->m_width),
+				(unsigned int)b.GetField(field->m_start, field->m_width));
+			next = field->m_start + field->m_width;
+		}
+		nchanges ++;
+	}
+
+	return nchanges;
+}
+
+/**
+	@brief Prints every bit that differs, and what it does
+ */
+void PrintBits(Greenpak4Device* device, const Greenpak4Bitstream& a, const Greenpak4Bitstream& b)
+{
+	auto& fields = device->GetBitFields();
+
+	LogNotice("\nChanged bits:\n");
+	LogIndenter li;
+	for(auto i : a.GetDifferences(b))
+		LogNotice("%4u  %d -> %d  %s\n", i, (int)a[i], (int)b[i], fields.DescribeBit(i).c_str());
+}
+
+void ShowUsage()
+{
+	printf(//                                                                               v 80th column
+		"Usage: gp4diff [--bits] old.txt new.txt\n"
+		"    -q, --quiet\n"
+		"        Causes only warnings and errors to be written to the console.\n"
+		"        Specify twice to also silence warnings.\n"
+		"    --verbose\n"
+		"        Prints additional information about the design.\n"
+		"    --debug\n"
+		"        Prints lots of internal debugging information.\n"
+		"    --bits\n"
+		"        Also lists every bit that differs, and the field it belongs to.\n"
+		"    --part               [SLG46620|SLG46621|SLG46140]\n"
+		"        Selects the device the bitstreams are for (default SLG46620). Binary\n"
+		"        bitstreams are checked against it.\n"
+		"    -l, --logfile        <file>\n"
+		"        Causes verbose log messages to be written to <file>.\n"
+		"    -L, --logfile-lines  <file>\n"
+		"        Causes verbose log messages to be written to <file>, flushing after\n"
+		"        each line.\n"
+		"\n"
+		"Prints the blocks whose configuration differs between two bitstreams. Exits with\n"
+		"0 if the bitstreams are identical, 1 if they differ, or 2 on error.\n");
+}
+
+void ShowVersion()
+{
+	printf(
+		"GreenPAK 4 bitstream comparator by Andrew D. Zonenberg.\n"
+		"\n"
+		"License: LGPL v2.1+\n"
+		"This is free software: you are free to change and redistribute it.\n"
+		"There is NO WARRANTY, to the extent permitted by law.\n");
+}
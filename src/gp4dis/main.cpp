@@ -0,0 +1,549 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include <chrono>
+#include <cstdio>
+#include <set>
+#include <log.h>
+#include <Greenpak4.h>
+
+using namespace std;
+
+void ShowUsage();
+void ShowVersion();
+
+Greenpak4EntityOutput ResolveCrossConnections(Greenpak4EntityOutput src);
+string GetNetName(Greenpak4EntityOutput src);
+string GetFabricPort(Greenpak4BitstreamEntity* entity, string port);
+string GetPadPort(const string& prim);
+vector<string> GetInputPins(const Greenpak4Primitive* prim);
+vector<Greenpak4BitstreamEntity*> FindLiveEntities(Greenpak4Device* device);
+bool WriteNetlist(string fname, string bitfile, Greenpak4Device* device, uint8_t userid, bool readProtect);
+void PrintReport(Greenpak4Device* device);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Entry point
+
+int main(int argc, char* argv[])
+{
+	Severity console_verbosity = Severity::NOTICE;
+
+	//Bitstream file
+	string fname = "";
+
+	//Output netlist
+	string ofname = "";
+
+	//Print a block-by-block report to the console
+	bool report = false;
+
+	Greenpak4Device::GREENPAK4_PART part = Greenpak4Device::GREENPAK4_SLG46620;
+
+	//Parse command-line arguments
+	for(int i=1; i<argc; i++)
+	{
+		string s(argv[i]);
+
+		//Let the logger eat its args first
+		if(ParseLoggerArguments(i, argc, argv, console_verbosity))
+			continue;
+
+		else if(s == "--help")
+		{
+			ShowUsage();
+			return 0;
+		}
+		else if(s == "--version")
+		{
+			ShowVersion();
+			return 0;
+		}
+		else if(s == "--part")
+		{
+			if(i+1 < argc)
+			{
+				string p = argv[++i];
+				if(p == "SLG46620")
+					part = Greenpak4Device::GREENPAK4_SLG46620;
+				else if(p == "SLG46621")
+					part = Greenpak4Device::GREENPAK4_SLG46621;
+				else if(p == "SLG46140")
+					part = Greenpak4Device::GREENPAK4_SLG46140;
+				else
+				{
+					printf("--part must be one of SLG46620, SLG46621, SLG46140\n");
+					return 1;
+				}
+			}
+			else
+			{
+				printf("--part requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--report")
+			report = true;
+		else if(s == "-o" || s == "--output")
+		{
+			if(i+1 < argc)
+				ofname = argv[++i];
+			else
+			{
+				printf("--output requires an argument\n");
+				return 1;
+			}
+		}
+
+		//assume it's the bitstream file if it's the first non-switch argument
+		else if( (s[0] != '-') && (fname == "") )
+			fname = s;
+
+		else
+		{
+			printf("Unrecognized command-line argument \"%s\", use --help\n", s.c_str());
+			return 1;
+		}
+	}
+
+	//Need something to read, and something to do with it
+	if( (fname == "") || ( (ofname == "") && !report) )
+	{
+		ShowUsage();
+		return 1;
+	}
+
+	//Set up logging
+	g_log_sinks.emplace(g_log_sinks.begin(), new STDLogSink(console_verbosity));
+
+	//Print header
+	if(console_verbosity >= Severity::NOTICE)
+		ShowVersion();
+
+	//Reconstruct the device configuration
+	LogNotice("\nLoading bitstream file \"%s\".\n", fname.c_str());
+	Greenpak4Device device(part);
+	uint8_t userid = 0;
+	bool readProtect = false;
+	{
+		LogIndenter li;
+
+		auto start = chrono::steady_clock::now();
+		if(!device.LoadFromFile(fname, userid, readProtect))
+			return 1;
+		auto usec = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+
+		LogNotice("Loaded in %ld us\n", (long)usec);
+		LogNotice("User ID code:    %02x\n", userid);
+		LogNotice("Read protection: %s\n", readProtect ? "enabled" : "disabled");
+	}
+
+	if(report)
+		PrintReport(&device);
+
+	if(ofname != "")
+	{
+		LogNotice("\nWriting netlist to output file \"%s\".\n", ofname.c_str());
+		if(!WriteNetlist(ofname, fname, &device, userid, readProtect))
+			return 1;
+	}
+
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Net tracing
+
+/**
+	@brief Follows a signal back through cross connections to the block that actually drives it
+ */
+Greenpak4EntityOutput ResolveCrossConnections(Greenpak4EntityOutput src)
+{
+	//A signal can only cross between matrices once, but don't hang on a bogus bitstream
+	for(int i=0; i<4; i++)
+	{
+		if(src.m_src == NULL)
+			break;
+		auto real = src.GetRealEntity();
+		if(real->GetKind() != Greenpak4BitstreamEntity::KIND_CROSS_CONNECTION)
+			break;
+		auto xc = static_cast<Greenpak4CrossConnection*>(real);
+		src = xc->GetInput("I");
+	}
+	return src;
+}
+
+/**
+	@brief Gets the HDL name of a signal (a wire named after its driver, or a constant)
+ */
+string GetNetName(Greenpak4EntityOutput src)
+{
+	src = ResolveCrossConnections(src);
+	if(src.m_src == NULL)
+		return "1'bx";
+	if(src.IsPowerRail())
+		return src.GetPowerRailValue() ? "1'b1" : "1'b0";
+	return src.GetRealEntity()->GetDescription() + "_" + src.GetPort();
+}
+
+/**
+	@brief Gets the name the routing fabric knows an output by.
+
+	Some outputs have several names for the same net (a DFF's Q and nQ); the device net table uses the first.
+ */
+string GetFabricPort(Greenpak4BitstreamEntity* entity, string port)
+{
+	unsigned int net = entity->GetOutputNetNumber(port);
+	if(net == (unsigned int)-1)
+		return port;
+
+	for(auto p : entity->GetOutputPorts())
+	{
+		if(entity->GetOutputNetNumber(p) == net)
+			return p;
+	}
+	return port;
+}
+
+/**
+	@brief Gets the name of the port connecting an I/O buffer primitive to its pad
+ */
+string GetPadPort(const string& prim)
+{
+	if(prim == "GP_IBUF")
+		return "IN";
+	else if(prim == "GP_IOBUF")
+		return "IO";
+	else
+		return "OUT";
+}
+
+/**
+	@brief Gets the names of every input pin of a primitive, with buses split into bits (DIN[0], DIN[1] ...)
+ */
+vector<string> GetInputPins(const Greenpak4Primitive* prim)
+{
+	vector<string> pins;
+	for(unsigned int i=0; i<prim->m_portCount; i++)
+	{
+		auto& port = prim->m_ports[i];
+		if(port.m_direction != Greenpak4NetlistPort::DIR_INPUT)
+			continue;
+
+		if(port.m_width == 1)
+			pins.push_back(port.m_name);
+		else
+		{
+			for(unsigned int j=0; j<port.m_width; j++)
+				pins.push_back(string(port.m_name) + "[" + to_string(j) + "]");
+		}
+	}
+	return pins;
+}
+
+/**
+	@brief Finds every block that contributes to the design, in device order.
+
+	A bitstream configures every block whether the design uses it or not, so we walk back from the things that
+	are observable from outside the chip (pins driven by the device, and the system reset) and keep whatever they
+	depend on.
+ */
+vector<Greenpak4BitstreamEntity*> FindLiveEntities(Greenpak4Device* device)
+{
+	set<Greenpak4BitstreamEntity*> live;
+	vector<Greenpak4BitstreamEntity*> pending;
+
+	for(unsigned int i=0; i<device->GetEntityCount(); i++)
+	{
+		auto entity = device->GetEntity(i);
+		string prim = entity->GetPrimitiveName();
+
+		bool sink = false;
+		if( (prim == "GP_OBUF") || (prim == "GP_IOBUF") )
+			sink = true;
+		else if(prim == "GP_SYSRESET")
+			sink = !ResolveCrossConnections(entity->GetInput("RST")).IsPowerRail();
+
+		if(sink)
+		{
+			live.insert(entity);
+			pending.push_back(entity);
+		}
+	}
+
+	while(!pending.empty())
+	{
+		auto entity = pending.back();
+		pending.pop_back();
+
+		string prim = entity->GetPrimitiveName();
+		auto p = Greenpak4LookupPrimitive(prim);
+		if(p == NULL)
+			continue;
+
+		bool iob = entity->HasCapability(Greenpak4BitstreamEntity::CAP_IOB);
+		for(auto pin : GetInputPins(p))
+		{
+			//Pads aren't driven by anything on the chip
+			if(iob && (pin == GetPadPort(prim)) )
+				continue;
+
+			auto src = ResolveCrossConnections(entity->GetInput(pin));
+			if( (src.m_src == NULL) || src.IsPowerRail() )
+				continue;
+
+			auto driver = src.GetRealEntity();
+			if(live.find(driver) != live.end())
+				continue;
+			live.insert(driver);
+			pending.push_back(driver);
+		}
+	}
+
+	vector<Greenpak4BitstreamEntity*> ret;
+	for(unsigned int i=0; i<device->GetEntityCount(); i++)
+	{
+		auto entity = device->GetEntity(i);
+		if(live.find(entity) != live.end())
+			ret.push_back(entity);
+	}
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Output
+
+/**
+	@brief Writes the live part of the device configuration as a structural Verilog netlist of GreenPAK primitives
+ */
+bool WriteNetlist(string fname, string bitfile, Greenpak4Device* device, uint8_t userid, bool readProtect)
+{
+	auto entities = FindLiveEntities(device);
+
+	vector<string> ports;
+	set<string> wires;
+	string body;
+
+	for(auto entity : entities)
+	{
+		string prim = entity->GetPrimitiveName();
+		auto p = Greenpak4LookupPrimitive(prim);
+		if(p == NULL)
+		{
+			LogError("%s has no HDL primitive (%s)\n", entity->GetDescription().c_str(), prim.c_str());
+			return false;
+		}
+		auto params = entity->GetParameters();
+
+		//I/O buffers become top-level ports, with the pad configuration as attributes
+		auto iob = entity->HasCapability(Greenpak4BitstreamEntity::CAP_IOB) ? static_cast<Greenpak4IOB*>(entity) : NULL;
+		string pad;
+		string inst = entity->GetDescription();
+		if(iob)
+		{
+			pad = iob->GetDescription();
+			inst = pad + "_BUF";
+
+			string dir = "inout";
+			if(prim == "GP_IBUF")
+				dir = "input";
+			else if(prim == "GP_OBUF")
+				dir = "output";
+
+			string decl = "\t(* LOC = \"" + pad + "\" *)\n";
+			for(auto it : params)
+				decl += "\t(* " + it.first + " = " + it.second + " *)\n";
+			decl += "\t" + dir + " wire " + pad + ";\n";
+			ports.push_back(decl);
+			params.clear();
+		}
+
+		//Instance header and parameters
+		body += "\t" + prim;
+		if(!params.empty())
+		{
+			body += " #(\n";
+			bool first = true;
+			for(auto it : params)
+			{
+				if(!first)
+					body += ",\n";
+				body += "\t\t." + it.first + "(" + it.second + ")";
+				first = false;
+			}
+			body += "\n\t)";
+		}
+		body += " " + inst + " (\n";
+
+		//Connections
+		for(unsigned int i=0; i<p->m_portCount; i++)
+		{
+			auto& port = p->m_ports[i];
+			string name = port.m_name;
+			string net;
+
+			if(iob && (name == GetPadPort(prim)) )
+				net = pad;
+
+			//Buses are concatenated MSB first
+			else if(port.m_direction == Greenpak4NetlistPort::DIR_INPUT)
+			{
+				vector<string> bits;
+				if(port.m_width == 1)
+					bits.push_back(GetNetName(entity->GetInput(name)));
+				else
+				{
+					for(unsigned int j=port.m_width; j>0; j--)
+						bits.push_back(GetNetName(entity->GetInput(name + "[" + to_string(j-1) + "]")));
+				}
+
+				for(size_t j=0; j<bits.size(); j++)
+				{
+					if(j > 0)
+						net += ", ";
+					net += bits[j];
+
+					//Constants aren't wires
+					if(bits[j].find('\'') == string::npos)
+						wires.insert(bits[j]);
+				}
+				if(bits.size() > 1)
+					net = "{" + net + "}";
+			}
+
+			//Outputs are named after the port the rest of the device sees (GP_DFFI nQ is our Q)
+			else
+			{
+				net = entity->GetDescription() + "_" + GetFabricPort(entity, name);
+				wires.insert(net);
+			}
+
+			body += "\t\t." + name + "(" + net + ")";
+			if(i+1 < p->m_portCount)
+				body += ",";
+			body += "\n";
+		}
+		body += "\t);\n\n";
+	}
+
+	FILE* fp = fopen(fname.c_str(), "w");
+	if(!fp)
+	{
+		LogError("Couldn't open %s for writing\n", fname.c_str());
+		return false;
+	}
+
+	fprintf(fp, "//Disassembled from %s by gp4dis\n", bitfile.c_str());
+	fprintf(fp, "//User ID code 0x%02x, read protection %s\n\n", userid, readProtect ? "enabled" : "disabled");
+
+	fprintf(fp, "module top(");
+	bool first = true;
+	for(auto entity : entities)
+	{
+		if(!entity->HasCapability(Greenpak4BitstreamEntity::CAP_IOB))
+			continue;
+		auto iob = static_cast<Greenpak4IOB*>(entity);
+		fprintf(fp, "%s%s", first ? "" : ", ", iob->GetDescription().c_str());
+		first = false;
+	}
+	fprintf(fp, ");\n\n");
+
+	for(auto decl : ports)
+		fprintf(fp, "%s\n", decl.c_str());
+
+	for(auto w : wires)
+		fprintf(fp, "\twire %s;\n", w.c_str());
+	if(!wires.empty())
+		fprintf(fp, "\n");
+
+	fprintf(fp, "%sendmodule\n", body.c_str());
+	fclose(fp);
+
+	LogNotice("%zu blocks used\n", entities.size());
+	return true;
+}
+
+/**
+	@brief Prints the configuration of every block the design uses
+ */
+void PrintReport(Greenpak4Device* device)
+{
+	auto entities = FindLiveEntities(device);
+
+	LogNotice("\nDevice configuration (%zu blocks used):\n", entities.size());
+	LogIndenter li;
+
+	for(auto entity : entities)
+	{
+		string prim = entity->GetPrimitiveName();
+		LogNotice("%-12s %s\n", entity->GetDescription().c_str(), prim.c_str());
+		LogIndenter li2;
+
+		for(auto it : entity->GetParameters())
+			LogNotice("%-16s = %s\n", it.first.c_str(), it.second.c_str());
+
+		auto p = Greenpak4LookupPrimitive(prim);
+		if(p == NULL)
+			continue;
+		bool iob = entity->HasCapability(Greenpak4BitstreamEntity::CAP_IOB);
+		for(auto pin : GetInputPins(p))
+		{
+			if(iob && (pin == GetPadPort(prim)) )
+				continue;
+			LogNotice("%-16s <- %s\n", pin.c_str(), GetNetName(entity->GetInput(pin)).c_str());
+		}
+	}
+}
+
+void ShowUsage()
+{
+	printf(//                                                                               v 80th column
+		"Usage: gp4dis [--report] [-o netlist.v] bitstream.txt\n"
+		"    -q, --quiet\n"
+		"        Causes only warnings and errors to be written to the console.\n"
+		"        Specify twice to also silence warnings.\n"
+		"    --verbose\n"
+		"        Prints additional information about the design.\n"
+		"    --debug\n"
+		"        Prints lots of internal debugging information.\n"
+		"    -o, --output         <netlist.v>\n"
+		"        Writes the design as a Verilog netlist of GreenPAK primitives.\n"
+		"    --report\n"
+		"        Prints the configuration and inputs of every block the design uses.\n"
+		"    --part               [SLG46620|SLG46621|SLG46140]\n"
+		"        Selects the device the bitstream is for (default SLG46620). Binary\n"
+		"        bitstreams are checked against it.\n"
+		"    -l, --logfile        <file>\n"
+		"        Causes verbose log messages to be written to <file>.\n"
+		"    -L, --logfile-lines  <file>\n"
+		"        Causes verbose log messages to be written to <file>, flushing after\n"
+		"        each line.\n"
+		"\n"
+		"The bitstream may be in the Silego text format or the binary container written\n"
+		"by gp4par --output-format binary.\n");
+}
+
+void ShowVersion()
+{
+	printf(
+		"GreenPAK 4 bitstream disassembler by Andrew D. Zonenberg.\n"
+		"\n"
+		"License: LGPL v2.1+\n"
+		"This is free software: you are free to change and redistribute it.\n"
+		"There is NO WARRANTY, to the extent permitted by law.\n");
+}
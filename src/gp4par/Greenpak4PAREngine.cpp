@@ -16,7 +16,6 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
  **********************************************************************************************************************/
 
-#include <cmath>
 #include "gp4par.h"
 
 using namespace std;
@@ -24,9 +23,17 @@ using namespace std;
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
-Greenpak4PAREngine::Greenpak4PAREngine(PARGraph* netlist, PARGraph* device, labelmap& lmap)
+Greenpak4PAREngine::Greenpak4PAREngine(
+	PARGraph* netlist,
+	PARGraph* device,
+	Greenpak4Device* pdev,
+	labelmap& lmap,
+	bool checkIncremental)
 	: PAREngine(netlist, device)
+	, m_pdev(pdev)
+	, m_nextReplicaID(1)
 	, m_lmap(lmap)
+	, m_checkIncremental(checkIncremental)
 {
 
 }
@@ -55,7 +62,7 @@ bool Greenpak4PAREngine::InitialPlacement_core()
 	{
 		auto node = m_netlist->GetNodeByIndex(i);
 		auto entity = static_cast<Greenpak4NetlistEntity*>(node->GetData());
-		auto cell = dynamic_cast<Greenpak4NetlistCell*>(entity);
+		auto cell = entity->AsCell();
 		if(cell == NULL)
 		{
 			LogError("Cell in netlist is not a Greenpak4NetlistCell\n");
@@ -157,50 +164,87 @@ bool Greenpak4PAREngine::InitialPlacement_core()
 		}
 	}
 
+	IndexEdges();
 	return true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Congestion metrics
 
-uint32_t Greenpak4PAREngine::ComputeCongestionCost()
+/**
+	@brief Rebuilds the input edge index and recounts the cross connection demand (after the netlist graph changes)
+ */
+void Greenpak4PAREngine::IndexEdges()
 {
-	uint32_t costs[2] = {0};
+	m_inputEdges.clear();
+	for(uint32_t i=0; i<m_netlist->GetNumNodes(); i++)
+	{
+		auto node = m_netlist->GetNodeByIndex(i);
+		for(uint32_t j=0; j<node->GetEdgeCount(); j++)
+		{
+			auto edge = node->GetEdgeByIndex(j);
+			m_inputEdges[edge->m_destnode].push_back(edge);
+		}
+	}
 
-	for(uint32_t i=0; i<m_device->GetNumNodes(); i++)
+	m_crossDemand.Rebuild(m_netlist);
+}
+
+/**
+	@brief Moves a node, keeping the cross connection demand up to date
+
+	Only edges touching the node, and whatever it displaces, can change their crossing, so those are taken out of the
+	demand before the move and put back after.
+ */
+void Greenpak4PAREngine::MoveNode(PARGraphNode* node, PARGraphNode* newpos, map<uint32_t, string>& label_names)
+{
+	set<PARGraphEdge*> edges;
+	PARGraphNode* moving[2] = { node, newpos->GetMate() };
+	for(auto n : moving)
 	{
-		//If no node in the netlist is assigned to us, nothing to do
-		PARGraphNode* node = m_device->GetNodeByIndex(i);
-		PARGraphNode* netnode = node->GetMate();
-		if(netnode == NULL)
+		if(n == NULL)
 			continue;
+		for(uint32_t i=0; i<n->GetEdgeCount(); i++)
+			edges.insert(n->GetEdgeByIndex(i));
+		auto it = m_inputEdges.find(n);
+		if(it != m_inputEdges.end())
+			edges.insert(it->second.begin(), it->second.end());
+	}
 
-		//Find all edges crossing the central routing matrix
-		for(uint32_t i=0; i<netnode->GetEdgeCount(); i++)
-		{
-			auto edge = netnode->GetEdgeByIndex(i);
-			auto src = static_cast<Greenpak4BitstreamEntity*>(edge->m_sourcenode->GetMate()->GetData());
-			auto dst = static_cast<Greenpak4BitstreamEntity*>(edge->m_destnode->GetMate()->GetData());
-			uint32_t sm = src->GetMatrix();
-			uint32_t dm = dst->GetMatrix();
-
-			//If we're driving a port that isn't general fabric routing, then it doesn't compete for cross connections
-			if(!dst->IsGeneralFabricInput(edge->m_destport))
-				continue;
+	for(auto edge : edges)
+		m_crossDemand.RemoveEdge(edge);
+	PAREngine::MoveNode(node, newpos, label_names);
+	for(auto edge : edges)
+		m_crossDemand.AddEdge(edge);
 
-			//If the source has a dual, don't count this in the cost since it can route anywhere
-			if(src->GetDual() != NULL)
-				continue;
+	if(m_checkIncremental)
+		CheckCrossDemand();
+}
 
-			//If matrices don't match, bump cost
-			if(sm != dm)
-				costs[sm] ++;
-		}
+/**
+	@brief Compares the incrementally maintained cross connection demand against a recount of the whole placement
+ */
+void Greenpak4PAREngine::CheckCrossDemand()
+{
+	CrossConnectionPlan plan;
+	PlanCrossConnections(m_device, plan);
+	if(!m_crossDemand.Matches(plan))
+	{
+		LogFatal("Cross connection demand is out of sync with the placement (%u/%u counted, %zu/%zu planned)\n",
+			m_crossDemand.GetCount(0), m_crossDemand.GetCount(1), plan.m_nets[0].size(), plan.m_nets[1].size());
 	}
+}
+
+/**
+	@brief Congestion cost of the current placement: the number of cross connections it needs
 
-	//Squaring each half makes minimizing the larger one more important
-	//vs if we just summed
-	return sqrt(costs[0]*costs[0] + costs[1]*costs[1]);
+	This is the same count CommitRouting() checks. Needing more than the device has in either direction is penalized
+	as heavily as unroutable edges, since CommitRouting() would fail.
+ */
+uint32_t Greenpak4PAREngine::ComputeCongestionCost()
+{
+	uint32_t overflow = m_crossDemand.GetOverflow(m_pdev->GetCrossConnectionCount());
+	return m_crossDemand.GetCount(0) + m_crossDemand.GetCount(1) + overflow*10;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -213,11 +257,11 @@ void Greenpak4PAREngine::PrintUnroutes(vector<PARGraphEdge*>& unroutes)
 	for(auto edge : unroutes)
 	{
 		auto source = static_cast<Greenpak4NetlistEntity*>(edge->m_sourcenode->GetData());
-		auto sport = dynamic_cast<Greenpak4NetlistPort*>(source);
-		auto scell = dynamic_cast<Greenpak4NetlistCell*>(source);
+		auto sport = source->AsPort();
+		auto scell = source->AsCell();
 		auto dest = static_cast<Greenpak4NetlistEntity*>(edge->m_destnode->GetData());
-		auto dport = dynamic_cast<Greenpak4NetlistPort*>(dest);
-		auto dcell = dynamic_cast<Greenpak4NetlistCell*>(dest);
+		auto dport = dest->AsPort();
+		auto dcell = dest->AsCell();
 
 		if(scell != NULL)
 		{
@@ -268,7 +312,13 @@ void Greenpak4PAREngine::PrintUnroutes(vector<PARGraphEdge*>& unroutes)
  */
 void Greenpak4PAREngine::FindSubOptimalPlacements(std::vector<PARGraphNode*>& bad_nodes)
 {
+	//Output in the order the nodes are found (not sorted by address) so the pivot choice only depends on the seed
 	std::set<PARGraphNode*> nodes;
+	auto add = [&](PARGraphNode* node)
+	{
+		if(nodes.insert(node).second)
+			bad_nodes.push_back(node);
+	};
 
 	//Find all nodes that have at least one cross-spine route
 	for(uint32_t i=0; i<m_device->GetNumNodes(); i++)
@@ -302,7 +352,7 @@ void Greenpak4PAREngine::FindSubOptimalPlacements(std::vector<PARGraphNode*>& ba
 					continue;
 
 				//Add the node
-				nodes.insert(edge->m_sourcenode);
+				add(edge->m_sourcenode);
 			}
 		}
 	}
@@ -316,19 +366,15 @@ void Greenpak4PAREngine::FindSubOptimalPlacements(std::vector<PARGraphNode*>& ba
 		if(!CantMoveSrc(static_cast<Greenpak4BitstreamEntity*>(edge->m_sourcenode->GetMate()->GetData())))
 		{
 			m_unroutableNodes.insert(edge->m_sourcenode);
-			nodes.insert(edge->m_sourcenode);
+			add(edge->m_sourcenode);
 		}
 		if(!CantMoveDst(static_cast<Greenpak4BitstreamEntity*>(edge->m_destnode->GetMate()->GetData())))
 		{
 			m_unroutableNodes.insert(edge->m_destnode);
-			nodes.insert(edge->m_destnode);
+			add(edge->m_destnode);
 		}
 	}
 
-	//Push into the final output list
-	for(auto x : nodes)
-		bad_nodes.push_back(x);
-
 	//DEBUG
 	/*
 	LogVerbose("Optimizing (%d bad nodes, %d unroutes)\n", bad_nodes.size(), unroutes.size());
@@ -353,7 +399,7 @@ bool Greenpak4PAREngine::CantMoveSrc(Greenpak4BitstreamEntity* src)
 
 	//If it has a LOC constraint, don't move it
 	auto se = static_cast<Greenpak4NetlistEntity*>(pn->GetMate()->GetData());
-	auto netnode = dynamic_cast<Greenpak4NetlistCell*>(se);
+	auto netnode = se->AsCell();
 	if( (netnode != NULL) && netnode->HasLOC() )
 		return true;
 
@@ -373,7 +419,7 @@ bool Greenpak4PAREngine::CanMoveNode(PARGraphNode* node, PARGraphNode* old_mate,
 		return true;
 
 	//If the displaced node has a LOC constraint, don't use that site
-	auto netnode = dynamic_cast<Greenpak4NetlistCell*>(static_cast<Greenpak4NetlistEntity*>(displaced->GetData()));
+	auto netnode = static_cast<Greenpak4NetlistEntity*>(displaced->GetData())->AsCell();
 	if( (netnode != NULL) && netnode->HasLOC() )
 	{
 		//LogDebug("Tried to move cell %s\n", netnode->m_name.c_str());
@@ -397,7 +443,7 @@ bool Greenpak4PAREngine::CantMoveDst(Greenpak4BitstreamEntity* dst)
 
 	//If it has a LOC constraint, don't move it
 	auto se = static_cast<Greenpak4NetlistEntity*>(pn->GetMate()->GetData());
-	auto netnode = dynamic_cast<Greenpak4NetlistCell*>(se);
+	auto netnode = se->AsCell();
 	if( (netnode != NULL) && netnode->HasLOC() )
 		return true;
 
@@ -428,8 +474,9 @@ PARGraphNode* Greenpak4PAREngine::GetNewPlacementForNode(PARGraphNode* pivot)
 	//Default to trying the opposite matrix
 	uint32_t target_matrix = 1 - current_matrix;
 
-	//Make the list of candidate placements
-	std::set<PARGraphNode*> temp_candidates;
+	//Make the list of candidate placements.
+	//Keep them in device graph order (not a std::set of pointers) so the pick below only depends on the seed.
+	std::vector<PARGraphNode*> candidates;
 	for(uint32_t i=0; i<m_device->GetNumNodesWithLabel(label); i++)
 	{
 		PARGraphNode* node = m_device->GetNodeByLabelAndIndex(label, i);
@@ -440,11 +487,11 @@ PARGraphNode* Greenpak4PAREngine::GetNewPlacementForNode(PARGraphNode* pivot)
 			continue;
 
 		if(entity->GetMatrix() == target_matrix)
-			temp_candidates.insert(node);
+			candidates.push_back(node);
 	}
 
 	//If no routable candidates found in the opposite matrix, check all matrices
-	if(temp_candidates.empty())
+	if(candidates.empty())
 	{
 		for(uint32_t i=0; i<m_device->GetNumNodesWithLabel(label); i++)
 		{
@@ -453,29 +500,283 @@ PARGraphNode* Greenpak4PAREngine::GetNewPlacementForNode(PARGraphNode* pivot)
 			if(0 != ComputeNodeUnroutableCost(pivot, node))
 				continue;
 
-			temp_candidates.insert(node);
+			candidates.push_back(node);
 		}
 	}
 
 	//If no routable candidates found anywhere, consider the entire chip and hope we can patch things up later
-	if(temp_candidates.empty())
+	if(candidates.empty())
 	{
 		LogDebug("No routable candidates found\n");
 		for(uint32_t i=0; i<m_device->GetNumNodesWithLabel(label); i++)
-			temp_candidates.insert(m_device->GetNodeByLabelAndIndex(label, i));
+			candidates.push_back(m_device->GetNodeByLabelAndIndex(label, i));
 	}
 
-	//Move to a vector for random access
-	std::vector<PARGraphNode*> candidates;
-	for(auto x : temp_candidates)
-		candidates.push_back(x);
 	uint32_t ncandidates = candidates.size();
 	if(ncandidates == 0)
 		return NULL;
 
 	//Pick one at random
-	auto c = candidates[rand() % ncandidates];
+	auto c = candidates[Random() % ncandidates];
 	LogDebug("Selected %s\n",
 		static_cast<Greenpak4BitstreamEntity*>(c->GetData())->GetDescription().c_str());
 	return c;
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Logic replication
+
+/**
+	@brief Copies cheap logic into the other matrix while the placement needs more cross connections than there are
+
+	Only ever done for a direction that's over capacity, since cross connections are free up to that point and copies
+	use up sites.
+ */
+bool Greenpak4PAREngine::ReplicateNodes(bool& changed)
+{
+	changed = false;
+	unsigned int capacity = m_pdev->GetCrossConnectionCount();
+	if(m_crossDemand.GetOverflow(capacity) == 0)
+		return true;
+
+	PlanCrossConnections(m_device, m_crossPlan);
+	for(unsigned int matrix=0; matrix<2; matrix++)
+	{
+		while(m_crossPlan.m_nets[matrix].size() > capacity)
+		{
+			bool replicated;
+			if(!ReplicateOneNode(matrix, replicated))
+				return false;
+			if(!replicated)
+				break;
+			changed = true;
+			PlanCrossConnections(m_device, m_crossPlan);
+		}
+	}
+
+	if(changed)
+	{
+		m_netlist->IndexNodesByLabel();
+		IndexEdges();
+	}
+	return true;
+}
+
+/**
+	@brief Finds the best LUT or inverter crossing out of one matrix and replicates it on the other side
+
+	A copy in the other matrix takes over all of the driver's general fabric loads there, which frees the cross
+	connection its output used. The copy needs the driver's inputs on its own side, though, so it's only a win if every
+	one of them is already crossing, or is available in both matrices. Of the candidates that qualify, the one with the
+	most loads on the far side is copied.
+
+	@param replicated	Set to true if a node was replicated
+
+	@return false if the netlist couldn't be updated
+ */
+bool Greenpak4PAREngine::ReplicateOneNode(unsigned int matrix, bool& replicated)
+{
+	replicated = false;
+	unordered_set<Greenpak4EntityOutput> crossing(m_crossPlan.m_nets[matrix].begin(), m_crossPlan.m_nets[matrix].end());
+
+	PARGraphNode* best = NULL;
+	PARGraphNode* best_site = NULL;
+	vector<PARGraphEdge*> best_inputs;
+	vector<PARGraphEdge*> best_moved;
+	for(auto& srcnet : m_crossPlan.m_nets[matrix])
+	{
+		//Only cheap combinatorial cells are worth copying
+		auto node = srcnet.m_src->GetPARNode()->GetMate();
+		auto cell = static_cast<Greenpak4NetlistEntity*>(node->GetData())->AsCell();
+		if( (cell == NULL) || cell->HasAttribute("keep") )
+			continue;
+		if(!cell->IsType(GP_PRIM_2LUT) && !cell->IsType(GP_PRIM_3LUT) && !cell->IsType(GP_PRIM_4LUT) &&
+			!cell->IsType(GP_PRIM_INV) )
+		{
+			continue;
+		}
+
+		//Sort the loads into the ones that move to the copy and the ones that stay here.
+		//A load that has any dedicated route from us stays here, with all of its edges.
+		set<PARGraphNode*> far_loads;
+		set<PARGraphNode*> pinned_loads;
+		bool stays_used = false;
+		for(uint32_t i=0; i<node->GetEdgeCount(); i++)
+		{
+			auto edge = node->GetEdgeByIndex(i);
+			auto dst = static_cast<Greenpak4BitstreamEntity*>(edge->m_destnode->GetMate()->GetData());
+			if(dst->GetMatrix() == matrix)
+				stays_used = true;
+			else if(dst->IsGeneralFabricInput(edge->m_destport))
+				far_loads.insert(edge->m_destnode);
+			else
+				pinned_loads.insert(edge->m_destnode);
+		}
+		for(auto load : pinned_loads)
+		{
+			far_loads.erase(load);
+			stays_used = true;
+		}
+
+		//If nothing is left on this side, the placer should move the driver instead
+		if(!stays_used || far_loads.empty())
+			continue;
+		if( (best != NULL) && (far_loads.size() <= best_moved.size()) )
+			continue;
+
+		//Every input has to be available on the far side already
+		vector<PARGraphEdge*> inputs;
+		bool free = true;
+		for(uint32_t i=0; i<m_netlist->GetNumNodes() && free; i++)
+		{
+			auto src = m_netlist->GetNodeByIndex(i);
+			for(uint32_t j=0; j<src->GetEdgeCount(); j++)
+			{
+				auto edge = src->GetEdgeByIndex(j);
+				if(edge->m_destnode != node)
+					continue;
+				if(src == node)
+				{
+					free = false;
+					break;
+				}
+				inputs.push_back(edge);
+
+				auto entity = static_cast<Greenpak4BitstreamEntity*>(src->GetMate()->GetData());
+				if( (entity->GetMatrix() != matrix) || (entity->GetDual() != NULL) )
+					continue;
+				if(crossing.find(entity->GetOutput(edge->m_sourceport)) == crossing.end())
+				{
+					free = false;
+					break;
+				}
+			}
+		}
+		if(!free)
+			continue;
+
+		//Need a spare site on the far side
+		PARGraphNode* site = NULL;
+		uint32_t label = node->GetLabel();
+		for(uint32_t i=0; i<m_device->GetNumNodesWithLabel(label); i++)
+		{
+			auto candidate = m_device->GetNodeByLabelAndIndex(label, i);
+			auto entity = static_cast<Greenpak4BitstreamEntity*>(candidate->GetData());
+			if( (candidate->GetMate() == NULL) && (entity->GetMatrix() != matrix) )
+			{
+				site = candidate;
+				break;
+			}
+		}
+		if(site == NULL)
+			continue;
+
+		best = node;
+		best_site = site;
+		best_inputs = inputs;
+		best_moved.clear();
+		for(uint32_t i=0; i<node->GetEdgeCount(); i++)
+		{
+			auto edge = node->GetEdgeByIndex(i);
+			if(far_loads.find(edge->m_destnode) != far_loads.end())
+				best_moved.push_back(edge);
+		}
+	}
+
+	if(best == NULL)
+		return true;
+
+	auto copy = ReplicateNode(best, best_site, best_inputs, best_moved);
+	if(copy == NULL)
+		return false;
+	replicated = true;
+	LogVerbose("Replicated %s to %s to save a cross connection (%zu loads moved)\n",
+		static_cast<Greenpak4NetlistEntity*>(best->GetData())->m_name.c_str(),
+		static_cast<Greenpak4BitstreamEntity*>(copy->GetMate()->GetData())->GetDescription().c_str(),
+		best_moved.size());
+	return true;
+}
+
+/**
+	@brief Makes a copy of a netlist node, in both the netlist and the PAR graph, and places it at a given site
+
+	@param node		The node to copy
+	@param site		Where to put the copy
+	@param inputs	Edges into the node, which are duplicated to feed the copy
+	@param moved	Edges out of the node, which are moved over to the copy
+
+	@return The PAR node of the copy, or NULL if the netlist couldn't be re-indexed afterwards
+ */
+PARGraphNode* Greenpak4PAREngine::ReplicateNode(
+	PARGraphNode* node,
+	PARGraphNode* site,
+	const vector<PARGraphEdge*>& inputs,
+	const vector<PARGraphEdge*>& moved)
+{
+	auto cell = static_cast<Greenpak4NetlistEntity*>(node->GetData())->AsCell();
+	auto module = cell->m_parent;
+	auto arena = module->GetNetlist()->GetArena();
+	auto net = cell->m_connections["OUT"][0];
+
+	//Copy the cell, minus its LOC constraint (which only applies to the original)
+	Greenpak4NetlistCell* copy = arena->New<Greenpak4NetlistCell>(module);
+	copy->SetType(cell->m_type);
+	copy->m_parameters = cell->m_parameters;
+	copy->m_attributes = cell->m_attributes;
+	auto loc = copy->m_attributes.find(GP_SYM_LOC);
+	if(loc != copy->m_attributes.end())
+		copy->m_attributes.erase(loc);
+	copy->m_connections = cell->m_connections;
+
+	char tmp[128];
+	snprintf(tmp, sizeof(tmp), "$auto$Greenpak4PAREngine.cpp:%d:replica$%u", __LINE__, m_nextReplicaID ++);
+	copy->m_name = tmp;
+	module->AddCell(copy);
+
+	//Create a net for the output
+	snprintf(tmp, sizeof(tmp), "$auto$Greenpak4PAREngine.cpp:%d:replica$%u", __LINE__, m_nextReplicaID ++);
+	Greenpak4NetlistNode* out = arena->New<Greenpak4NetlistNode>(module->GetNetlist()->GetStringTable());
+	out->m_name = tmp;
+	out->m_src_locations = net->m_src_locations;
+	module->AddNet(out);
+	copy->m_connections["OUT"][0] = out;
+
+	//Point the loads that move over at the new net
+	set<PARGraphNode*> loads;
+	for(auto edge : moved)
+		loads.insert(edge->m_destnode);
+	for(auto load : loads)
+	{
+		auto lcell = static_cast<Greenpak4NetlistEntity*>(load->GetData())->AsCell();
+		for(auto& x : lcell->m_connections)
+		{
+			for(auto& bit : x.second)
+			{
+				if(bit == net)
+					bit = out;
+			}
+		}
+	}
+
+	//Create the PAR node and place it
+	PARGraphNode* nnode = new PARGraphNode(node->GetLabel(), copy);
+	copy->m_parnode = nnode;
+	m_netlist->AddNode(nnode);
+	nnode->MateWith(site);
+
+	//Copy the netlist edges to the PAR graph
+	for(auto edge : inputs)
+		edge->m_sourcenode->AddEdge(edge->m_sourceport, nnode, edge->m_destport);
+	vector<PARGraphEdge> old;
+	for(auto edge : moved)
+		old.push_back(*edge);
+	for(auto& edge : old)
+	{
+		nnode->AddEdge(edge.m_sourceport, edge.m_destnode, edge.m_destport);
+		node->RemoveEdge(edge.m_sourceport, edge.m_destnode, edge.m_destport);
+	}
+
+	if(!module->GetNetlist()->Reindex(false))
+		return NULL;
+	return nnode;
+}
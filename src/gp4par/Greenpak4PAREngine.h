@@ -25,7 +25,12 @@
 class Greenpak4PAREngine : public PAREngine
 {
 public:
-	Greenpak4PAREngine(PARGraph* netlist, PARGraph* device, labelmap& lmap);
+	Greenpak4PAREngine(
+		PARGraph* netlist,
+		PARGraph* device,
+		Greenpak4Device* pdev,
+		labelmap& lmap,
+		bool checkIncremental = false);
 	virtual ~Greenpak4PAREngine();
 
 protected:
@@ -38,15 +43,45 @@ protected:
 	virtual bool InitialPlacement_core();
 
 	virtual bool CanMoveNode(PARGraphNode* node, PARGraphNode* old_mate, PARGraphNode* new_mate);
+	virtual void MoveNode(PARGraphNode* node, PARGraphNode* newpos, std::map<uint32_t, std::string>& label_names);
+
+	void IndexEdges();
+	void CheckCrossDemand();
+
+	virtual bool ReplicateNodes(bool& changed);
+	bool ReplicateOneNode(unsigned int matrix, bool& replicated);
+	PARGraphNode* ReplicateNode(
+		PARGraphNode* node,
+		PARGraphNode* site,
+		const std::vector<PARGraphEdge*>& inputs,
+		const std::vector<PARGraphEdge*>& moved);
 
 	bool CantMoveSrc(Greenpak4BitstreamEntity* src);
 	bool CantMoveDst(Greenpak4BitstreamEntity* dst);
 
+	//The device we're placing into (for resource counts)
+	Greenpak4Device* m_pdev;
+
 	//Cached list of unroutable nodes for the current iteration
 	std::set<PARGraphNode*> m_unroutableNodes;
 
+	//Cross connection demand of the current placement, updated as nodes move
+	CrossConnectionDemand m_crossDemand;
+
+	//Edges into each netlist node, so a move can find every edge it affects
+	std::map<PARGraphNode*, std::vector<PARGraphEdge*> > m_inputEdges;
+
+	//Nets needing cross connections, in order, for replication (reused to avoid reallocating)
+	CrossConnectionPlan m_crossPlan;
+
+	//Counter used to give replicated cells and nets unique names. Per engine, so the names only depend on this run.
+	unsigned int m_nextReplicaID;
+
 	//used for error messages only
 	labelmap m_lmap;
+
+	//Recompute the incrementally maintained state from scratch after every move and check it (slow, for --debug)
+	bool m_checkIncremental;
 };
 
 #endif
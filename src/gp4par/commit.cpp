@@ -53,6 +53,7 @@ bool CommitChanges(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_ro
 	if(!CommitRouting(device, pdev, num_routes_used))
 		return false;
 
+	CommitSharedComparatorMux(pdev);
 	return true;
 }
 
@@ -61,13 +62,34 @@ bool CommitChanges(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_ro
  */
 bool CommitRouting(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_routes_used)
 {
-	num_routes_used[0] = 0;
-	num_routes_used[1] = 0;
-
-	//Map of source net to cross-connection output
-	map<Greenpak4EntityOutput, Greenpak4EntityOutput> nodemap;
+	//Find every net that has to cross between the matrices before touching anything.
+	//This is the exact number of cross connections needed, so we can report it even if it's more than we have.
+	CrossConnectionPlan plan;
+	PlanCrossConnections(device, plan);
+	unsigned int capacity = pdev->GetCrossConnectionCount();
+	num_routes_used[0] = plan.m_nets[0].size();
+	num_routes_used[1] = plan.m_nets[1].size();
+	if(GetCrossConnectionOverflow(plan, capacity) != 0)
+	{
+		LogError(
+			"More than 100%% of device resources are used "
+			"(cross connections: %u east and %u west needed, %u available each way)\n",
+			num_routes_used[0], num_routes_used[1], capacity);
+		return false;
+	}
 
-	bool ran_out = false;
+	//Insert a cross connection into the path of each of those nets.
+	//Map of source net to cross-connection output.
+	unordered_map<Greenpak4EntityOutput, Greenpak4EntityOutput> nodemap;
+	for(unsigned int matrix=0; matrix<2; matrix++)
+	{
+		for(unsigned int i=0; i<plan.m_nets[matrix].size(); i++)
+		{
+			auto xconn = pdev->GetCrossConnection(matrix, i);
+			xconn->SetInput("I", plan.m_nets[matrix][i]);
+			nodemap[plan.m_nets[matrix][i]] = xconn->GetOutput("O");
+		}
+	}
 
 	for(uint32_t i=0; i<device->GetNumNodes(); i++)
 	{
@@ -82,71 +104,53 @@ bool CommitRouting(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_ro
 		for(uint32_t i=0; i<netnode->GetEdgeCount(); i++)
 		{
 			auto edge = netnode->GetEdgeByIndex(i);
-			auto src = static_cast<Greenpak4BitstreamEntity*>(edge->m_sourcenode->GetMate()->GetData());
 			auto dst = static_cast<Greenpak4BitstreamEntity*>(edge->m_destnode->GetMate()->GetData());
 
-			//If the source node has a dual, use the secondary output if needed
-			//so we don't waste cross connections
-			if(src->GetDual())
-			{
-				if(dst->GetMatrix() != src->GetMatrix())
-					src = src->GetDual();
-			}
-
-			//Look up the actual NET (not just the entity) for the source.
-			//If we don't do this we risk merging cross-connections that should not be (see github issue #13)
-			Greenpak4EntityOutput srcnet = src->GetOutput(edge->m_sourceport);
-
-			//Cross connections
-			//Only use these if destination node is general fabric routing; dedicated routing can cross between
-			//the matrices freely
-			unsigned int srcmatrix = src->GetMatrix();
-			if( (srcmatrix != dst->GetMatrix()) && dst->IsGeneralFabricInput(edge->m_destport) )
-			{
-				//Reuse existing connections, if any
-				if(nodemap.find(srcnet) != nodemap.end())
-					srcnet = nodemap[srcnet];
-
-				//Allocate a new cross-connection
-				else
-				{
-					//We need to jump from one matrix to another!
-					//Make sure we have a free cross-connection to use
-					if(num_routes_used[srcmatrix] >= 10)
-						ran_out = true;
-
-					else
-					{
-						//Save our cross-connection and mark it as used
-						auto xconn = pdev->GetCrossConnection(srcmatrix, num_routes_used[srcmatrix]);
-
-
-						//Insert the cross-connection into the path
-						xconn->SetInput("I", srcnet);
-						Greenpak4EntityOutput newsrc = xconn->GetOutput("O");
-						nodemap[srcnet] = newsrc;
-						srcnet = newsrc;
-					}
-
-					num_routes_used[srcmatrix] ++;
-				}
-			}
+			//Go through the net's cross connection if it needs one
+			Greenpak4EntityOutput srcnet;
+			if(GetEdgeSourceNet(edge, srcnet))
+				srcnet = nodemap[srcnet];
 
 			//Yay virtual functions - we can set the input without caring about the node type
-			if(!ran_out)
-				dst->SetInput(edge->m_destport, srcnet);
+			dst->SetInput(edge->m_destport, srcnet);
 		}
 	}
 
-	//Don't fail until we attempt full routing.
-	//This lets us see how much over the limit we went
-	if(ran_out)
+	return true;
+}
+
+/**
+	@brief If ACMP0 is not used, but other comparators use the output of its input mux, configure it
+
+	Comparators asking for different settings of the mux are left for the DRC to report; the first one wins here.
+	TODO: for better power efficiency, turn on only when a downstream comparator is on?
+ */
+void CommitSharedComparatorMux(Greenpak4Device* pdev)
+{
+	if(pdev->GetPart() != Greenpak4Device::GREENPAK4_SLG46620)
+		return;
+
+	auto acmp0 = pdev->GetAcmp(0);
+	if(acmp0->GetInput() != pdev->GetGround())
+		return;
+
+	auto pin6 = pdev->GetIOB(6)->GetOutput("");
+	auto vdd = pdev->GetPower();
+	for(unsigned int i=1; i<pdev->GetAcmpCount(); i++)
 	{
-		LogError(
-			"More than 100%% of device resources are used "
-			"(cross connections)\n");
-		return false;
-	}
+		//TODO: buffered pin 6 is a candidate too
+		auto acmp = pdev->GetAcmp(i);
+		auto input = acmp->GetInput();
+		if( (input != pin6) && (input != vdd) )
+			continue;
+		if(!acmp->IsUsed())
+			continue;
 
-	return true;
+		LogNotice(
+			"Enabling ACMP0 and configuring input mux, since output of mux "
+			"is used but ACMP0 is not instantiated\n");
+		acmp0->SetInput(input);
+		acmp0->SetPowerEn(pdev->GetPowerOnReset()->GetOutput("RST_DONE"));
+		return;
+	}
 }
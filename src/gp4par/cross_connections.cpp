@@ -0,0 +1,186 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include "gp4par.h"
+
+using namespace std;
+
+/*
+	Cross connections as a routing resource
+
+	Every cross connection leaving a matrix can carry any signal in that matrix to the other one, so as a flow problem
+	each direction is a bipartite graph from source nets to identical slots. Its maximum flow is min(nets, capacity),
+	and the minimum number of cross connections a placement needs is exactly the number of distinct source nets that
+	have at least one general fabric load in the other matrix. Loads of the same net share one cross connection,
+	sources with a dual use the output on the far side instead, and dedicated routing never needs one.
+ */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Planning
+
+/**
+	@brief Finds the net driving a netlist edge in the current placement
+
+	If the source has a dual in the destination's matrix, the dual's output is used.
+
+	@return true if the edge needs a cross connection
+ */
+bool GetEdgeSourceNet(PARGraphEdge* edge, Greenpak4EntityOutput& srcnet)
+{
+	auto src = static_cast<Greenpak4BitstreamEntity*>(edge->m_sourcenode->GetMate()->GetData());
+	auto dst = static_cast<Greenpak4BitstreamEntity*>(edge->m_destnode->GetMate()->GetData());
+
+	//If the source node has a dual, use the secondary output if needed
+	//so we don't waste cross connections
+	if(src->GetDual())
+	{
+		if(dst->GetMatrix() != src->GetMatrix())
+			src = src->GetDual();
+	}
+
+	//Look up the actual NET (not just the entity) for the source.
+	//If we don't do this we risk merging cross-connections that should not be (see github issue #13)
+	srcnet = src->GetOutput(edge->m_sourceport);
+
+	//Cross connections are only needed if the destination node is general fabric routing; dedicated routing can
+	//cross between the matrices freely
+	return (src->GetMatrix() != dst->GetMatrix()) && dst->IsGeneralFabricInput(edge->m_destport);
+}
+
+/**
+	@brief Finds every net that needs a cross connection in the current placement
+
+	Nets are listed in the order they're first seen, walking the device graph the same way CommitRouting() does.
+ */
+void PlanCrossConnections(PARGraph* device, CrossConnectionPlan& plan)
+{
+	plan.m_nets[0].clear();
+	plan.m_nets[1].clear();
+
+	unordered_set<Greenpak4EntityOutput> seen;
+	for(uint32_t i=0; i<device->GetNumNodes(); i++)
+	{
+		//If no node in the netlist is assigned to us, nothing to do
+		PARGraphNode* netnode = device->GetNodeByIndex(i)->GetMate();
+		if(netnode == NULL)
+			continue;
+
+		for(uint32_t j=0; j<netnode->GetEdgeCount(); j++)
+		{
+			Greenpak4EntityOutput srcnet;
+			if(!GetEdgeSourceNet(netnode->GetEdgeByIndex(j), srcnet))
+				continue;
+			if(seen.insert(srcnet).second)
+				plan.m_nets[srcnet.m_src->GetMatrix()].push_back(srcnet);
+		}
+	}
+}
+
+/**
+	@brief Number of cross connections the plan needs beyond what the device has (zero if it fits)
+ */
+unsigned int GetCrossConnectionOverflow(const CrossConnectionPlan& plan, unsigned int capacity)
+{
+	unsigned int overflow = 0;
+	for(unsigned int matrix=0; matrix<2; matrix++)
+	{
+		if(plan.m_nets[matrix].size() > capacity)
+			overflow += plan.m_nets[matrix].size() - capacity;
+	}
+	return overflow;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Incremental demand
+
+/**
+	@brief Recounts the demand from scratch. Every node in the netlist must be placed.
+ */
+void CrossConnectionDemand::Rebuild(PARGraph* netlist)
+{
+	m_nets[0].clear();
+	m_nets[1].clear();
+
+	for(uint32_t i=0; i<netlist->GetNumNodes(); i++)
+	{
+		auto node = netlist->GetNodeByIndex(i);
+		for(uint32_t j=0; j<node->GetEdgeCount(); j++)
+			AddEdge(node->GetEdgeByIndex(j));
+	}
+}
+
+/**
+	@brief Adds an edge, as it's currently placed, to the demand
+ */
+void CrossConnectionDemand::AddEdge(PARGraphEdge* edge)
+{
+	Greenpak4EntityOutput srcnet;
+	if(GetEdgeSourceNet(edge, srcnet))
+		m_nets[srcnet.m_src->GetMatrix()][srcnet] ++;
+}
+
+/**
+	@brief Removes an edge from the demand. It must be placed the same way it was when it was added.
+ */
+void CrossConnectionDemand::RemoveEdge(PARGraphEdge* edge)
+{
+	Greenpak4EntityOutput srcnet;
+	if(!GetEdgeSourceNet(edge, srcnet))
+		return;
+
+	auto& nets = m_nets[srcnet.m_src->GetMatrix()];
+	auto it = nets.find(srcnet);
+	if(it == nets.end())
+		LogFatal("Removed a cross connection edge that was never added\n");
+	if(--it->second == 0)
+		nets.erase(it);
+}
+
+/**
+	@brief Number of cross connections needed beyond what the device has (zero if it fits)
+ */
+unsigned int CrossConnectionDemand::GetOverflow(unsigned int capacity) const
+{
+	unsigned int overflow = 0;
+	for(unsigned int matrix=0; matrix<2; matrix++)
+	{
+		if(m_nets[matrix].size() > capacity)
+			overflow += m_nets[matrix].size() - capacity;
+	}
+	return overflow;
+}
+
+/**
+	@brief Checks that the demand counts exactly the nets a fresh PlanCrossConnections() finds
+ */
+bool CrossConnectionDemand::Matches(const CrossConnectionPlan& plan) const
+{
+	for(unsigned int matrix=0; matrix<2; matrix++)
+	{
+		//The plan lists each net once, so equal sizes and no missing nets means the same nets
+		if(plan.m_nets[matrix].size() != m_nets[matrix].size())
+			return false;
+		for(auto& net : plan.m_nets[matrix])
+		{
+			if(m_nets[matrix].find(net) == m_nets[matrix].end())
+				return false;
+		}
+	}
+	return true;
+}
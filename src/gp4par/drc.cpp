@@ -0,0 +1,644 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include "gp4par.h"
+
+#include <stdarg.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Rule framework
+
+/**
+	@brief A design rule.
+
+	A rule asks to see netlist nodes, device entities of some kinds, or both, and gets one call per item during the
+	single pass over the design. Rules comparing several entities collect them and decide in Finish().
+
+	Rules only read the design and keep their findings to themselves, so they don't depend on each other or on the
+	order in which they are run.
+ */
+class DRCRule
+{
+public:
+	DRCRule(Greenpak4Device* device, uint32_t kinds, bool nodes = false)
+		: m_device(device)
+		, m_kinds(kinds)
+		, m_nodes(nodes)
+		, m_name("")
+		, m_severity(Severity::ERROR)
+	{}
+
+	virtual ~DRCRule()
+	{}
+
+	///Called for every node in the netlist graph, if the rule asked for nodes
+	virtual void CheckNode(PARGraphNode* /*node*/)
+	{}
+
+	///Called for every device entity of a kind the rule asked for
+	virtual void CheckEntity(Greenpak4BitstreamEntity* /*entity*/)
+	{}
+
+	///Called once everything has been seen
+	virtual void Finish()
+	{}
+
+	///Bitmask of the entity kinds CheckEntity() wants to see
+	uint32_t GetKinds() const
+	{ return m_kinds; }
+
+	bool WantsNodes() const
+	{ return m_nodes; }
+
+	void SetName(const char* name, Severity severity)
+	{
+		m_name = name;
+		m_severity = severity;
+	}
+
+	const vector<DRCDiagnostic>& GetDiagnostics() const
+	{ return m_diagnostics; }
+
+	static uint32_t KindMask(Greenpak4BitstreamEntity::Kind kind)
+	{ return 1 << kind; }
+
+protected:
+	DRCDiagnostic& Report(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+	Greenpak4Device* m_device;
+	uint32_t m_kinds;
+	bool m_nodes;
+
+	const char* m_name;
+	Severity m_severity;
+	vector<DRCDiagnostic> m_diagnostics;
+};
+
+/**
+	@brief Adds a finding for this rule, and returns it so the caller can attach details
+ */
+DRCDiagnostic& DRCRule::Report(const char* format, ...)
+{
+	va_list list;
+	va_start(list, format);
+	va_list copy;
+	va_copy(copy, list);
+	int len = vsnprintf(NULL, 0, format, copy);
+	va_end(copy);
+
+	vector<char> text(max(len, 0) + 1);
+	vsnprintf(&text[0], text.size(), format, list);
+	va_end(list);
+
+	DRCDiagnostic diag;
+	diag.m_rule = m_name;
+	diag.m_severity = m_severity;
+	diag.m_message = &text[0];
+	diag.m_waived = false;
+	m_diagnostics.push_back(diag);
+	return m_diagnostics.back();
+}
+
+/**
+	@brief Returns the netlist cell placed at a site, or NULL if the site is unused or holds something else
+ */
+static Greenpak4NetlistCell* GetPlacedCell(Greenpak4BitstreamEntity* entity)
+{
+	auto node = entity->GetPARNode();
+	if( (node == NULL) || (node->GetMate() == NULL) )
+		return NULL;
+	return static_cast<Greenpak4NetlistEntity*>(node->GetMate()->GetData())->AsCell();
+}
+
+/**
+	@brief Returns the entity driving a signal, looking through cross connections (NULL if nothing drives it)
+ */
+static Greenpak4BitstreamEntity* GetDriver(Greenpak4EntityOutput signal)
+{
+	if(signal.m_src == NULL)
+		return NULL;
+	auto src = signal.GetRealEntity();
+	if(src->GetKind() == Greenpak4BitstreamEntity::KIND_CROSS_CONNECTION)
+		return GetDriver(src->GetInput("I"));
+	return src;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Netlist rules
+
+class UnplacedRule : public DRCRule
+{
+public:
+	UnplacedRule(Greenpak4Device* device)
+		: DRCRule(device, 0, true)
+	{}
+
+	virtual void CheckNode(PARGraphNode* node)
+	{
+		if(node->GetMate() == NULL)
+			Report("Node \"%s\" is not mapped to any site in the device", GetName(node));
+	}
+
+	static const char* GetName(PARGraphNode* node)
+	{ return static_cast<Greenpak4NetlistEntity*>(node->GetData())->m_name.c_str(); }
+};
+
+class NoLoadRule : public DRCRule
+{
+public:
+	NoLoadRule(Greenpak4Device* device)
+		: DRCRule(device, 0, true)
+	{}
+
+	virtual void CheckNode(PARGraphNode* node)
+	{
+		if( (node->GetMate() == NULL) || (node->GetEdgeCount() != 0) )
+			return;
+		auto dst = static_cast<Greenpak4BitstreamEntity*>(node->GetMate()->GetData());
+
+		//Do not warn if power rails have no load, that's perfectly normal
+		if(dst->GetKind() == Greenpak4BitstreamEntity::KIND_POWER_RAIL)
+			return;
+
+		//If the node has no output ports, of course it won't have any loads
+		if(dst->GetOutputPorts().size() == 0)
+			return;
+
+		//If the node is an IOB configured as an output, there's no internal load for its output.
+		//This is perfectly normal, obviously.
+		auto cell = static_cast<Greenpak4NetlistEntity*>(node->GetData())->AsCell();
+		if( (cell != NULL) &&  ( cell->IsType(GP_PRIM_IOBUF) || cell->IsType(GP_PRIM_OBUF) ) )
+			return;
+
+		//If we have a magic attribute set, it's OK
+		//(for example, inferred ACMP for a VREF we used for another purpose)
+		if( (cell != NULL) && cell->m_attributes.contains(GP_SYM_IGNORE_NOLOAD))
+			return;
+
+		Report("Node \"%s\" has no load", UnplacedRule::GetName(node));
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// I/O rules
+
+static const uint32_t IOB_KINDS =
+	(1 << Greenpak4BitstreamEntity::KIND_IOB_TYPE_A) | (1 << Greenpak4BitstreamEntity::KIND_IOB_TYPE_B);
+
+class UnlockedIOBRule : public DRCRule
+{
+public:
+	UnlockedIOBRule(Greenpak4Device* device)
+		: DRCRule(device, IOB_KINDS)
+	{}
+
+	//This is not an error because sometimes a user may want to let PAR find a placement for a complex
+	//netlist before laying out the board, to improve routability. We warn because it's easy to forget
+	//to add LOC constraints afterwards, causing a future ECO to break the pinout.
+	virtual void CheckEntity(Greenpak4BitstreamEntity* entity)
+	{
+		auto cell = GetPlacedCell(entity);
+		if( (cell == NULL) || cell->HasLOC() )
+			return;
+
+		Report(
+			"IOB cell %s was placed at location %s, but was not locked with a LOC constraint.\n"
+			"This can lead to unexpected pinout changes if the netlist is modified.",
+			cell->m_name.c_str(), entity->GetDescription().c_str()
+			);
+	}
+};
+
+class AnalogOutputPinRule : public DRCRule
+{
+public:
+	AnalogOutputPinRule(Greenpak4Device* device)
+		: DRCRule(device, IOB_KINDS)
+	{}
+
+	//TODO: driving an input-only pin etc - is this possible?
+	virtual void CheckEntity(Greenpak4BitstreamEntity* entity)
+	{
+		auto iob = static_cast<Greenpak4IOB*>(entity);
+		if(iob->IsAnalogIbuf())
+			return;
+
+		auto src = GetDriver(iob->GetOutputSignal());
+		if( (src != NULL) && src->HasCapability(Greenpak4BitstreamEntity::CAP_ANALOG_OUTPUT) )
+		{
+			Report("Pin %d is driven by an analog source (%s) but does not have IBUF_TYPE = ANALOG",
+				iob->GetPinNumber(),
+				iob->GetOutputSignal().GetOutputName().c_str()
+				);
+		}
+	}
+};
+
+/**
+	@brief Analog blocks reading a pin need the pin's input buffer in analog mode
+ */
+class AnalogInputPinRule : public DRCRule
+{
+public:
+	AnalogInputPinRule(Greenpak4Device* device)
+		: DRCRule(device,
+			KindMask(Greenpak4BitstreamEntity::KIND_COMPARATOR) |
+			KindMask(Greenpak4BitstreamEntity::KIND_ABUF) |
+			KindMask(Greenpak4BitstreamEntity::KIND_PGA))
+	{}
+
+	virtual void CheckEntity(Greenpak4BitstreamEntity* entity)
+	{ Greenpak4VisitEntity(entity, *this); }
+
+	void Visit(Greenpak4Comparator* acmp)
+	{ Check(acmp, acmp->GetInput()); }
+
+	void Visit(Greenpak4Abuf* abuf)
+	{ Check(abuf, abuf->GetInput()); }
+
+	void Visit(Greenpak4PGA* pga)
+	{
+		Check(pga, pga->GetInputP());
+		Check(pga, pga->GetInputN());
+	}
+
+	void Visit(Greenpak4BitstreamEntity* /*entity*/)
+	{}
+
+	//TODO: Check for VREF with inputs driven from non-analog IOs
+
+protected:
+	void Check(Greenpak4BitstreamEntity* load, Greenpak4EntityOutput signal)
+	{
+		//Only signals coming from IOBs need checking
+		auto src = GetDriver(signal);
+		if( (src == NULL) || !src->HasCapability(Greenpak4BitstreamEntity::CAP_IOB) )
+			return;
+		auto iob = static_cast<Greenpak4IOB*>(src);
+		if(iob->IsAnalogIbuf())
+			return;
+
+		Report("%s is driven by IOB %s, which does not have IBUF_TYPE = ANALOG",
+			load->GetDescription().c_str(),
+			iob->GetDescription().c_str()
+			);
+	}
+};
+
+/**
+	@brief If POR is driven to an IOB, it should be pin 8 using dedicated routing. If not, warn about timing
+ */
+class PowerOnResetPinRule : public DRCRule
+{
+public:
+	PowerOnResetPinRule(Greenpak4Device* device)
+		: DRCRule(device, IOB_KINDS)
+	{}
+
+	virtual void CheckEntity(Greenpak4BitstreamEntity* entity)
+	{
+		if(m_device->GetPart() != Greenpak4Device::GREENPAK4_SLG46620)
+			return;
+		if(entity == m_device->GetIOB(8))
+			return;
+
+		Greenpak4BitstreamEntity* por = m_device->GetPowerOnReset();
+		if( (GetDriver(entity->GetInput("IN")) != por) && (GetDriver(entity->GetInput("OE")) != por) )
+			return;
+
+		Report(
+			"Pin %s is driven by the power-on reset, but is does not have dedicated reset routing.\n"
+			"This may lead to synchronization issues or glitches if this pin is used to drive resets on "
+			"external logic.",
+			entity->GetDescription().c_str());
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Shared resources
+
+typedef pair<string, Greenpak4EntityOutput> spair;
+
+/**
+	@brief Comparators using ACMP0's input mux must all want the same setting of it
+ */
+class SharedComparatorMuxRule : public DRCRule
+{
+public:
+	SharedComparatorMuxRule(Greenpak4Device* device)
+		: DRCRule(device, KindMask(Greenpak4BitstreamEntity::KIND_COMPARATOR))
+	{}
+
+	virtual void CheckEntity(Greenpak4BitstreamEntity* entity)
+	{
+		if(m_device->GetPart() != Greenpak4Device::GREENPAK4_SLG46620)
+			return;
+
+		//If this comparator is not using one of ACMP0's inputs, we don't care
+		//TODO: buffered pin 6 is a candidate too
+		auto input = static_cast<Greenpak4Comparator*>(entity)->GetInput();
+		if( (input != m_device->GetIOB(6)->GetOutput("")) && (input != m_device->GetPower()) )
+			return;
+
+		//Look up the instance name of the comparator. Sanity check that it's used.
+		auto mate = entity->GetPARNode()->GetMate();
+		if(mate == NULL)
+			return;
+		m_inputs.push_back(spair(static_cast<Greenpak4NetlistEntity*>(mate->GetData())->m_name, input));
+	}
+
+	virtual void Finish()
+	{
+		for(auto s : m_inputs)
+		{
+			//The first comparator sets the mux, the sharing did its job if the rest agree
+			if(s.second == m_inputs[0].second)
+				continue;
+
+			//Problem! Incompatible mux settings
+			auto& diag = Report(
+				"Multiple comparators tried to simultaneously use different outputs from the ACMP0 input mux");
+			for(auto p : m_inputs)
+			{
+				char line[256];
+				snprintf(line, sizeof(line), "Comparator %10s requested %s",
+					p.first.c_str(), p.second.GetOutputName().c_str());
+				diag.m_details.push_back(line);
+			}
+			break;
+		}
+	}
+
+protected:
+	vector<spair> m_inputs;
+};
+
+/**
+	@brief Oscillators with power-down enabled must share the power-down signal
+ */
+class OscillatorPowerDownRule : public DRCRule
+{
+public:
+	OscillatorPowerDownRule(Greenpak4Device* device)
+		: DRCRule(device,
+			KindMask(Greenpak4BitstreamEntity::KIND_LFOSC) |
+			KindMask(Greenpak4BitstreamEntity::KIND_RINGOSC) |
+			KindMask(Greenpak4BitstreamEntity::KIND_RCOSC))
+	{}
+
+	virtual void CheckEntity(Greenpak4BitstreamEntity* entity)
+	{ Greenpak4VisitEntity(entity, *this); }
+
+	void Visit(Greenpak4LFOscillator* osc)
+	{ Add(osc); }
+
+	void Visit(Greenpak4RingOscillator* osc)
+	{ Add(osc); }
+
+	void Visit(Greenpak4RCOscillator* osc)
+	{ Add(osc); }
+
+	void Visit(Greenpak4BitstreamEntity* /*entity*/)
+	{}
+
+	virtual void Finish()
+	{
+		bool ok = true;
+		for(auto p : m_powerdowns)
+		{
+			if(p.second != m_powerdowns[0].second)
+				ok = false;
+		}
+		if(ok)
+			return;
+
+		auto& diag = Report(
+			"Multiple oscillators have power-down enabled, but do not share the same power-down signal");
+		for(auto p : m_powerdowns)
+		{
+			char line[256];
+			snprintf(line, sizeof(line), "Oscillator %10s powerdown is %s",
+				p.first.c_str(), p.second.GetOutputName().c_str());
+			diag.m_details.push_back(line);
+		}
+	}
+
+protected:
+	template<class T> void Add(T* osc)
+	{
+		if(osc->IsUsed() && osc->GetPowerDownEn() && !osc->IsConstantPowerDown())
+			m_powerdowns.push_back(spair(osc->GetDescription(), osc->GetPowerDown()));
+	}
+
+	vector<spair> m_powerdowns;
+};
+
+/**
+	@brief Enabling the PGA turns on the SAR ADC, which takes over DAC1
+ */
+class PGAvsDAC1Rule : public DRCRule
+{
+public:
+	PGAvsDAC1Rule(Greenpak4Device* device)
+		: DRCRule(device, 0)
+	{}
+
+	virtual void Finish()
+	{
+		if(m_device->GetPart() != Greenpak4Device::GREENPAK4_SLG46620)
+			return;
+
+		//null check on pga is unnecessary for the 46620v, but necessary to avoid false positive from static analysis
+		auto pga = m_device->GetPGA();
+		if(pga && pga->IsUsed() && m_device->GetDAC(1)->IsUsed())
+		{
+			Report(
+				"Both DAC1 and the PGA are used. This is illegal due to a poorly documented control hazard.\n"
+				"Enabling the PGA turns on the SAR ADC, forcing DAC1 to emit a sawtooth waveform instead of the "
+				"desired signal.");
+		}
+
+		//TODO: Cannot use DAC1 when ADC is used
+		//TODO: Check for PGA driving an IOB when ADC is enabled (we do not yet implement the ADC)
+	}
+};
+
+/**
+	@brief The PGA uses DAC0 for its offset voltage in pseudo-differential mode
+ */
+class PGAvsDAC0Rule : public DRCRule
+{
+public:
+	PGAvsDAC0Rule(Greenpak4Device* device)
+		: DRCRule(device, 0)
+	{}
+
+	virtual void Finish()
+	{
+		if(m_device->GetPart() != Greenpak4Device::GREENPAK4_SLG46620)
+			return;
+
+		auto pga = m_device->GetPGA();
+		if(pga && pga->IsUsed() && m_device->GetDAC(0)->IsUsed() && (pga->GetInputMode() == Greenpak4PGA::MODE_PDIFF) )
+		{
+			Report(
+				"DAC0 is used while the PGA is in pseudo-differential mode. This is illegal since the "
+				"PGA uses DAC0 to provide the pseudo-differential offset voltage.");
+		}
+	}
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Rule table
+
+template<class T> static DRCRule* CreateRule(Greenpak4Device* device)
+{ return new T(device); }
+
+struct DRCRuleInfo
+{
+	const char* m_name;
+	Severity m_severity;
+	DRCRule* (*m_create)(Greenpak4Device* device);
+};
+
+//Every rule we know about, in the order findings are printed
+static const DRCRuleInfo g_drcRules[] =
+{
+	{ "UNPLACED",			Severity::ERROR,	CreateRule<UnplacedRule> },
+	{ "NO_LOAD",			Severity::WARNING,	CreateRule<NoLoadRule> },
+	{ "IOB_NO_LOC",			Severity::WARNING,	CreateRule<UnlockedIOBRule> },
+	{ "ANALOG_OUT_PIN",		Severity::ERROR,	CreateRule<AnalogOutputPinRule> },
+	{ "ANALOG_IN_PIN",		Severity::ERROR,	CreateRule<AnalogInputPinRule> },
+	{ "ACMP0_MUX",			Severity::ERROR,	CreateRule<SharedComparatorMuxRule> },
+	{ "OSC_POWERDOWN",		Severity::ERROR,	CreateRule<OscillatorPowerDownRule> },
+	{ "PGA_DAC1",			Severity::ERROR,	CreateRule<PGAvsDAC1Rule> },
+	{ "PGA_DAC0",			Severity::ERROR,	CreateRule<PGAvsDAC0Rule> },
+	{ "POR_PIN",			Severity::WARNING,	CreateRule<PowerOnResetPinRule> },
+};
+
+/**
+	@brief Returns true if there is a design rule by this name
+ */
+bool IsDRCRule(const string& name)
+{
+	for(auto& info : g_drcRules)
+	{
+		if(name == info.m_name)
+			return true;
+	}
+	return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Checking
+
+/**
+	@brief Check the routed design against every design rule
+
+	The netlist and the device are each walked once; every node and entity is handed to the rules that asked for it.
+	Findings of waived rules are still collected (and logged at verbose level) but don't fail the check.
+
+	@param netlist		The placed netlist graph
+	@param device		The device, with the design committed to it
+	@param waivers		Names of the rules to waive
+	@param diagnostics	Every finding, in rule table order
+ */
+bool PostPARDRC(
+	PARGraph* netlist,
+	Greenpak4Device* device,
+	const drcwaivers& waivers,
+	vector<DRCDiagnostic>& diagnostics)
+{
+	LogNotice("\nChecking post-route design rules...\n");
+	LogIndenter li;
+
+	//Instantiate the rules, and index them by what they look at
+	vector<DRCRule*> rules;
+	vector<DRCRule*> node_rules;
+	vector<DRCRule*> kind_rules[Greenpak4BitstreamEntity::KIND_COUNT];
+	for(auto& info : g_drcRules)
+	{
+		auto rule = info.m_create(device);
+		rule->SetName(info.m_name, info.m_severity);
+		rules.push_back(rule);
+
+		if(rule->WantsNodes())
+			node_rules.push_back(rule);
+		for(unsigned int kind=0; kind<Greenpak4BitstreamEntity::KIND_COUNT; kind++)
+		{
+			if( (rule->GetKinds() >> kind) & 1 )
+				kind_rules[kind].push_back(rule);
+		}
+	}
+
+	//One pass over the netlist, one over the device
+	for(uint32_t i=0; i<netlist->GetNumNodes(); i++)
+	{
+		auto node = netlist->GetNodeByIndex(i);
+		for(auto rule : node_rules)
+			rule->CheckNode(node);
+	}
+	for(unsigned int i=0; i<device->GetEntityCount(); i++)
+	{
+		auto entity = device->GetEntity(i);
+		if(entity == NULL)
+			continue;
+		for(auto rule : kind_rules[entity->GetKind()])
+			rule->CheckEntity(entity);
+	}
+
+	//Collect the findings
+	unsigned int errors = 0;
+	unsigned int warnings = 0;
+	unsigned int waived = 0;
+	for(auto rule : rules)
+	{
+		rule->Finish();
+		for(auto diag : rule->GetDiagnostics())
+		{
+			diag.m_waived = (waivers.find(diag.m_rule) != waivers.end());
+			diagnostics.push_back(diag);
+		}
+		delete rule;
+	}
+
+	for(auto& diag : diagnostics)
+	{
+		Severity severity = diag.m_severity;
+		if(diag.m_waived)
+		{
+			severity = Severity::VERBOSE;
+			waived ++;
+		}
+		else if(severity == Severity::ERROR)
+			errors ++;
+		else
+			warnings ++;
+
+		Log(severity, "%s%s: %s\n", diag.m_waived ? "(waived) " : "", diag.m_rule.c_str(), diag.m_message.c_str());
+		LogIndenter li;
+		for(auto& line : diag.m_details)
+			Log(diag.m_waived ? Severity::VERBOSE : Severity::NOTICE, "%s\n", line.c_str());
+	}
+
+	LogVerbose("%u errors, %u warnings, %u waived\n", errors, warnings, waived);
+	return (errors == 0);
+}
@@ -22,12 +22,49 @@
 #include <cstdio>
 #include <string>
 #include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <log.h>
 #include <xbpar.h>
 #include <Greenpak4.h>
+#include "libgp4par.h"
 
 typedef std::map<uint32_t, std::string> labelmap;
 typedef std::map<std::string, uint32_t> ilabelmap;
+typedef std::map<Greenpak4NetlistCell*, Greenpak4BitstreamEntity*> placementmap;
+
+//The nets that need cross connections for one placement, per source matrix
+struct CrossConnectionPlan
+{
+	std::vector<Greenpak4EntityOutput> m_nets[2];
+};
+
+/**
+	@brief The number of cross connections a placement needs, kept up to date edge by edge as nodes move
+
+	Counts the same nets as PlanCrossConnections(), without walking the whole graph for every move.
+ */
+class CrossConnectionDemand
+{
+public:
+	void Rebuild(PARGraph* netlist);
+
+	void AddEdge(PARGraphEdge* edge);
+	void RemoveEdge(PARGraphEdge* edge);
+
+	unsigned int GetCount(unsigned int matrix) const
+	{ return m_nets[matrix].size(); }
+
+	unsigned int GetOverflow(unsigned int capacity) const;
+
+	bool Matches(const CrossConnectionPlan& plan) const;
+
+protected:
+	//Number of crossing edges on each net that needs a cross connection, per source matrix
+	std::unordered_map<Greenpak4EntityOutput, unsigned int> m_nets[2];
+};
 
 #include "Greenpak4PAREngine.h"
 
@@ -35,6 +72,10 @@ typedef std::map<std::string, uint32_t> ilabelmap;
 void ShowUsage();
 void ShowVersion();
 
+//Netlist optimization
+bool IsOptimizationPass(const std::string& name);
+bool OptimizeNetlist(Greenpak4Netlist* netlist, const optpasses& disabled);
+
 //Setup
 uint32_t AllocateLabel(
 	PARGraph*& ngraph,
@@ -50,15 +91,45 @@ bool BuildGraphs(
 void ApplyLocConstraints(Greenpak4Netlist* netlist, PARGraph* ngraph, PARGraph* dgraph);
 
 //PAR core
-bool DoPAR(Greenpak4Netlist* netlist, Greenpak4Device* device);
+bool DoPAR(
+	Greenpak4Netlist* netlist,
+	Greenpak4Device* device,
+	placementmap* placement = NULL,
+	const drcwaivers& waivers = drcwaivers(),
+	PARReport* report = NULL,
+	uint32_t seed = 1,
+	bool checkIncremental = false);
 
 //DRC
-bool PostPARDRC(PARGraph* netlist, Greenpak4Device* device);
+bool IsDRCRule(const std::string& name);
+bool PostPARDRC(
+	PARGraph* netlist,
+	Greenpak4Device* device,
+	const drcwaivers& waivers,
+	std::vector<DRCDiagnostic>& diagnostics);
+
+//Cross connections
+bool GetEdgeSourceNet(PARGraphEdge* edge, Greenpak4EntityOutput& srcnet);
+void PlanCrossConnections(PARGraph* device, CrossConnectionPlan& plan);
+unsigned int GetCrossConnectionOverflow(const CrossConnectionPlan& plan, unsigned int capacity);
 
 //Committing
 bool CommitChanges(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_routes_used);
 bool CommitRouting(PARGraph* device, Greenpak4Device* pdev, unsigned int* num_routes_used);
-void PrintUtilizationReport(PARGraph* netlist, Greenpak4Device* device, unsigned int* num_routes_used);
+void CommitSharedComparatorMux(Greenpak4Device* pdev);
+void GetUtilization(
+	PARGraph* netlist,
+	Greenpak4Device* device,
+	unsigned int* num_routes_used,
+	std::vector<UtilizationRow>& rows);
+void PrintUtilizationReport(const std::vector<UtilizationRow>& rows);
 void PrintPlacementReport(PARGraph* netlist, Greenpak4Device* device);
 
+//Verification
+bool VerifyBitstream(
+	Greenpak4Netlist* netlist,
+	Greenpak4Device::GREENPAK4_PART part,
+	std::string fname,
+	const placementmap& placement);
+
 #endif
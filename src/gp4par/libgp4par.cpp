@@ -0,0 +1,299 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4par.h"
+#include <cstdarg>
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Log capture
+
+/**
+	@brief Log sink that keeps messages in a Greenpak4PARResults instead of writing them out
+ */
+class CaptureLogSink : public LogSink
+{
+public:
+	CaptureLogSink(Severity level, vector<Greenpak4PARLogMessage>& log)
+		: m_level(level)
+		, m_log(log)
+	{}
+
+	virtual void Log(Severity severity, const string& msg)
+	{
+		if(severity > m_level)
+			return;
+
+		Greenpak4PARLogMessage message;
+		message.m_severity = severity;
+		message.m_text = msg;
+		m_log.push_back(message);
+	}
+
+	virtual void Log(Severity severity, const char* format, va_list va)
+	{
+		if(severity > m_level)
+			return;
+
+		va_list va2;
+		va_copy(va2, va);
+		int len = vsnprintf(NULL, 0, format, va2);
+		va_end(va2);
+		if(len < 0)
+			return;
+
+		vector<char> buf(len + 1);
+		vsnprintf(&buf[0], buf.size(), format, va);
+		Log(severity, string(&buf[0], len));
+	}
+
+protected:
+	Severity m_level;
+	vector<Greenpak4PARLogMessage>& m_log;
+};
+
+//Capture sink of the run in progress on this thread (if any), and whether the application's sinks see its messages too
+static thread_local CaptureLogSink* g_captureSink = NULL;
+static thread_local bool g_captureForward = false;
+
+//Guards the changes LogCapture makes to g_log_sinks, and the count of runs that need them
+static mutex g_captureMutex;
+static unsigned int g_activeCaptures = 0;
+
+/**
+	@brief Hands each message to the CaptureLogSink of the run in progress on the logging thread, if there is one
+ */
+class CaptureRouterLogSink : public LogSink
+{
+public:
+	virtual void Log(Severity severity, const string& msg)
+	{
+		if(g_captureSink != NULL)
+			g_captureSink->Log(severity, msg);
+	}
+
+	virtual void Log(Severity severity, const char* format, va_list va)
+	{
+		if(g_captureSink != NULL)
+			g_captureSink->Log(severity, format, va);
+	}
+};
+
+/**
+	@brief Wraps one of the application's sinks while runs are in progress, hiding the messages of runs that don't
+	forward their log
+ */
+class CaptureFilterLogSink : public LogSink
+{
+public:
+	CaptureFilterLogSink(LogSink* sink)
+		: m_sink(sink)
+	{}
+
+	virtual void Log(Severity severity, const string& msg)
+	{
+		if( (g_captureSink == NULL) || g_captureForward )
+			m_sink->Log(severity, msg);
+	}
+
+	virtual void Log(Severity severity, const char* format, va_list va)
+	{
+		if( (g_captureSink == NULL) || g_captureForward )
+			m_sink->Log(severity, format, va);
+	}
+
+	unique_ptr<LogSink> m_sink;
+};
+
+/**
+	@brief Routes everything this thread logs while it is in scope to a CaptureLogSink
+
+	g_log_sinks is only changed while at least one run is in progress. Every run starts by wrapping whatever sinks the
+	application has installed (including ones added since the last run) and making sure there is a router in the list,
+	and the last run to finish puts the application's sinks back as they were, so nothing is left behind between runs.
+ */
+class LogCapture
+{
+public:
+	LogCapture(const Greenpak4PAROptions& options, vector<Greenpak4PARLogMessage>& log)
+		: m_sink(options.m_logLevel, log)
+		, m_prevSink(g_captureSink)
+		, m_prevForward(g_captureForward)
+	{
+		{
+			lock_guard<mutex> lock(g_captureMutex);
+			g_activeCaptures ++;
+
+			bool routed = false;
+			for(auto& sink : g_log_sinks)
+			{
+				if(dynamic_cast<CaptureRouterLogSink*>(sink.get()) != NULL)
+					routed = true;
+				else if(dynamic_cast<CaptureFilterLogSink*>(sink.get()) == NULL)
+					sink.reset(new CaptureFilterLogSink(sink.release()));
+			}
+			if(!routed)
+				g_log_sinks.emplace_back(new CaptureRouterLogSink);
+		}
+
+		g_captureSink = &m_sink;
+		g_captureForward = options.m_forwardLog;
+	}
+
+	~LogCapture()
+	{
+		g_captureSink = m_prevSink;
+		g_captureForward = m_prevForward;
+
+		lock_guard<mutex> lock(g_captureMutex);
+		if(--g_activeCaptures != 0)
+			return;
+
+		for(auto it = g_log_sinks.begin(); it != g_log_sinks.end(); )
+		{
+			if(dynamic_cast<CaptureRouterLogSink*>(it->get()) != NULL)
+			{
+				it = g_log_sinks.erase(it);
+				continue;
+			}
+
+			auto filter = dynamic_cast<CaptureFilterLogSink*>(it->get());
+			if(filter != NULL)
+				it->reset(filter->m_sink.release());
+			it ++;
+		}
+	}
+
+protected:
+	CaptureLogSink m_sink;
+
+	//Capture in effect before this one (runs don't nest today, but it costs nothing to allow it)
+	CaptureLogSink* m_prevSink;
+	bool m_prevForward;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The flow
+
+/**
+	@brief Runs the same flow as the gp4par executable, minus the file I/O
+
+	@param netlist		The netlist to implement. Optimized in place, so don't reuse it for anything that expects the
+						original cells (such as VerifyBitstream()).
+	@param options		Run settings
+	@param results		Bitstream, reports and log. Anything already in there is thrown away.
+
+	@return true if the design was placed, routed and passed DRC
+ */
+bool Greenpak4PlaceAndRoute(
+	Greenpak4Netlist* netlist,
+	const Greenpak4PAROptions& options,
+	Greenpak4PARResults& results)
+{
+	results = Greenpak4PARResults();
+	LogCapture capture(options, results.m_log);
+
+	if( (options.m_vccMax < options.m_vccMin) ||
+		!Greenpak4TimingAnalyzer::IsSupportedVoltage(options.m_vccMin) ||
+		!Greenpak4TimingAnalyzer::IsSupportedVoltage(options.m_vccMax) )
+	{
+		LogError("VCC range %.2f - %.2f V is not supported\n", options.m_vccMin, options.m_vccMax);
+		return false;
+	}
+	for(auto& rule : options.m_waivers)
+	{
+		if(!IsDRCRule(rule))
+		{
+			LogError("\"%s\" is not a design rule\n", rule.c_str());
+			return false;
+		}
+	}
+	for(auto& pass : options.m_disabledPasses)
+	{
+		if(!IsOptimizationPass(pass))
+		{
+			LogError("\"%s\" is not an optimization pass\n", pass.c_str());
+			return false;
+		}
+	}
+
+	if(!netlist->Validate() || (netlist->GetTopModule() == NULL) )
+	{
+		LogError("Netlist didn't load, or has no top-level module\n");
+		return false;
+	}
+
+	//Clean up the netlist before placing it
+	LogNotice("\nOptimizing netlist:\n");
+	{
+		LogIndenter li;
+		if(!OptimizeNetlist(netlist, options.m_disabledPasses))
+			return false;
+	}
+
+	//Do the actual P&R
+	Greenpak4Device device(options.m_part, options.m_unusedPull, options.m_unusedDrive);
+	LogNotice("\nSynthesizing top-level module \"%s\".\n", netlist->GetTopModule()->GetName().c_str());
+	bool debug = (options.m_logLevel >= Severity::DEBUG);
+	if(!DoPAR(netlist, &device, NULL, options.m_waivers, &results.m_report, options.m_seed, debug))
+		return false;
+
+	//Static timing analysis of the committed design
+	LogNotice("\nStatic timing analysis:\n");
+	{
+		LogIndenter li;
+		Greenpak4TimingAnalyzer sta(&device, options.m_vccMin, options.m_vccMax);
+		sta.Analyze();
+		sta.PrintSummary();
+		results.m_worstSetupSlack = sta.GetWorstSetupSlack();
+		results.m_worstHoldSlack = sta.GetWorstHoldSlack();
+	}
+
+	return device.Save(results.m_bitstream, options.m_userid, options.m_readProtect);
+}
+
+/**
+	@brief Loads a netlist from memory and runs the flow on it
+
+	@param buf			Yosys JSON, or a binary netlist image
+	@param len			Length of buf in bytes
+	@param options		Run settings
+	@param results		Bitstream, reports and log (including any netlist parse errors)
+ */
+bool Greenpak4PlaceAndRoute(
+	const char* buf,
+	size_t len,
+	const Greenpak4PAROptions& options,
+	Greenpak4PARResults& results)
+{
+	//Capture the parse messages too. The inner call starts its own capture, so collect these separately.
+	vector<Greenpak4PARLogMessage> load_log;
+	unique_ptr<Greenpak4Netlist> netlist;
+	{
+		LogCapture capture(options, load_log);
+		LogNotice("\nLoading netlist from memory (%zu bytes).\n", len);
+		netlist.reset(new Greenpak4Netlist(buf, len));
+	}
+
+	bool ok = Greenpak4PlaceAndRoute(netlist.get(), options, results);
+	results.m_log.insert(results.m_log.begin(), load_log.begin(), load_log.end());
+	return ok;
+}
@@ -0,0 +1,168 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef libgp4par_h
+#define libgp4par_h
+
+/**
+	@file
+	@brief In-process interface to gp4par, for tools that embed the flow instead of running the executable
+
+	Everything gp4par writes to files (bitstream, reports, log) comes back in memory instead. Nothing here touches the
+	filesystem, and log messages go to the caller's Greenpak4PARResults, not to the globally installed log sinks.
+
+	Runs on different threads can go ahead at the same time. While any run is in progress, the application's log sinks
+	are wrapped so that they don't see the messages of runs that aren't forwarding them, and once the last run finishes
+	g_log_sinks is put back exactly as the application left it. Don't change g_log_sinks from another thread while a
+	run is starting or finishing.
+
+	A thin C wrapper around this lives in libgp4par_c.h.
+ */
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <log.h>
+#include <Greenpak4.h>
+
+typedef std::set<std::string> drcwaivers;
+typedef std::set<std::string> optpasses;
+
+//One finding of the post-route design rule check
+struct DRCDiagnostic
+{
+	std::string m_rule;
+	Severity m_severity;
+	std::string m_message;
+	std::vector<std::string> m_details;
+	bool m_waived;
+};
+
+//How much of one kind of site a design uses
+struct UtilizationRow
+{
+	std::string m_name;
+	unsigned int m_used;
+	unsigned int m_total;
+
+	//True for rows that break down the row above them (COUNT8 under COUNT etc)
+	bool m_detail;
+};
+
+//Everything DoPAR() reports about a run, other than the log
+struct PARReport
+{
+	std::vector<DRCDiagnostic> m_diagnostics;
+	std::vector<UtilizationRow> m_utilization;
+
+	//Description of the site each netlist cell and port went to, by name
+	std::map<std::string, std::string> m_placement;
+};
+
+//One message the flow logged
+struct Greenpak4PARLogMessage
+{
+	Severity m_severity;
+	std::string m_text;
+};
+
+/**
+	@brief Settings for one run. The defaults are the same as gp4par's command line defaults.
+ */
+struct Greenpak4PAROptions
+{
+	Greenpak4PAROptions()
+		: m_part(Greenpak4Device::GREENPAK4_SLG46620)
+		, m_unusedPull(Greenpak4IOB::PULL_NONE)
+		, m_unusedDrive(Greenpak4IOB::PULL_1M)
+		, m_userid(0)
+		, m_readProtect(false)
+		, m_vccMin(1.8)
+		, m_vccMax(5.0)
+		, m_seed(1)
+		, m_logLevel(Severity::NOTICE)
+		, m_forwardLog(false)
+	{}
+
+	Greenpak4Device::GREENPAK4_PART m_part;
+
+	//Action to take with unused pins
+	Greenpak4IOB::PullDirection m_unusedPull;
+	Greenpak4IOB::PullStrength m_unusedDrive;
+
+	//Bitstream metadata
+	uint8_t m_userid;
+	bool m_readProtect;
+
+	//Supply voltage range to analyze timing over
+	double m_vccMin;
+	double m_vccMax;
+
+	//Design rules not to fail on, and netlist optimizations not to run (same names as --waive and --no-opt)
+	drcwaivers m_waivers;
+	optpasses m_disabledPasses;
+
+	//Seed for the placer's random number generator
+	uint32_t m_seed;
+
+	//Most verbose messages to keep in Greenpak4PARResults::m_log
+	Severity m_logLevel;
+
+	//Also pass messages on to the application's log sinks
+	bool m_forwardLog;
+};
+
+/**
+	@brief What came out of one run
+
+	The report and log are filled in as far as the run got, so they are worth looking at on failure too.
+ */
+struct Greenpak4PARResults
+{
+	Greenpak4PARResults()
+		: m_worstSetupSlack(0)
+		, m_worstHoldSlack(0)
+	{}
+
+	//The final configuration (empty if the run failed). See Greenpak4Bitstream::FormatText() / FormatBinary().
+	Greenpak4Bitstream m_bitstream;
+
+	PARReport m_report;
+
+	//Worst slack over all corners in ns, infinite if there were no paths to check
+	double m_worstSetupSlack;
+	double m_worstHoldSlack;
+
+	std::vector<Greenpak4PARLogMessage> m_log;
+};
+
+//Optimizes the netlist in place, places and routes it, and checks timing
+bool Greenpak4PlaceAndRoute(
+	Greenpak4Netlist* netlist,
+	const Greenpak4PAROptions& options,
+	Greenpak4PARResults& results);
+
+//Same, but loads the netlist (Yosys JSON or a netlist image) from memory first
+bool Greenpak4PlaceAndRoute(
+	const char* buf,
+	size_t len,
+	const Greenpak4PAROptions& options,
+	Greenpak4PARResults& results);
+
+#endif
@@ -0,0 +1,269 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4par.h"
+#include "libgp4par_c.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+
+/**
+	@brief Copies a buffer into memory the C caller can free()
+ */
+static void* CopyOut(const void* data, size_t len, size_t padding = 0)
+{
+	uint8_t* ret = static_cast<uint8_t*>(malloc(len + padding));
+	if(ret == NULL)
+		return NULL;
+	memcpy(ret, data, len);
+	memset(ret + len, 0, padding);
+	return ret;
+}
+
+static char* CopyOut(const string& str)
+{ return static_cast<char*>(CopyOut(str.c_str(), str.length(), 1)); }
+
+/**
+	@brief Splits a comma separated list of names into a set. NULL or empty is an empty set.
+ */
+static set<string> SplitNames(const char* list)
+{
+	set<string> ret;
+	if( (list == NULL) || (*list == '\0') )
+		return ret;
+
+	string names = list;
+	size_t start = 0;
+	while(start <= names.size())
+	{
+		size_t end = names.find(',', start);
+		if(end == string::npos)
+			end = names.size();
+		ret.insert(names.substr(start, end - start));
+		start = end + 1;
+	}
+	return ret;
+}
+
+/**
+	@brief Converts C options to C++ ones. Returns false (with a message in log) if something doesn't map.
+ */
+static bool ConvertOptions(const gp4par_options* in, Greenpak4PAROptions& out, string& log)
+{
+	switch(in->part)
+	{
+		case 0x140:
+			out.m_part = Greenpak4Device::GREENPAK4_SLG46140;
+			break;
+
+		case 0x620:
+			out.m_part = Greenpak4Device::GREENPAK4_SLG46620;
+			break;
+
+		case 0x621:
+			out.m_part = Greenpak4Device::GREENPAK4_SLG46621;
+			break;
+
+		default:
+			log += "Unknown part number\n";
+			return false;
+	}
+
+	switch(in->unused_pull)
+	{
+		case GP4PAR_PULL_NONE:
+			out.m_unusedPull = Greenpak4IOB::PULL_NONE;
+			break;
+
+		case GP4PAR_PULL_DOWN:
+			out.m_unusedPull = Greenpak4IOB::PULL_DOWN;
+			break;
+
+		case GP4PAR_PULL_UP:
+			out.m_unusedPull = Greenpak4IOB::PULL_UP;
+			break;
+
+		default:
+			log += "Invalid pull direction\n";
+			return false;
+	}
+
+	switch(in->unused_drive)
+	{
+		case GP4PAR_DRIVE_10K:
+			out.m_unusedDrive = Greenpak4IOB::PULL_10K;
+			break;
+
+		case GP4PAR_DRIVE_100K:
+			out.m_unusedDrive = Greenpak4IOB::PULL_100K;
+			break;
+
+		case GP4PAR_DRIVE_1M:
+			out.m_unusedDrive = Greenpak4IOB::PULL_1M;
+			break;
+
+		default:
+			log += "Invalid pull strength\n";
+			return false;
+	}
+
+	if( (in->log_level < static_cast<int>(Severity::FATAL)) || (in->log_level > static_cast<int>(Severity::DEBUG)) )
+	{
+		log += "Invalid log level\n";
+		return false;
+	}
+
+	out.m_userid = in->userid;
+	out.m_readProtect = (in->read_protect != 0);
+	out.m_vccMin = in->vcc_min;
+	out.m_vccMax = in->vcc_max;
+	out.m_waivers = SplitNames(in->waivers);
+	out.m_disabledPasses = SplitNames(in->no_opt);
+	out.m_seed = in->seed;
+	out.m_logLevel = static_cast<Severity>(in->log_level);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// C API
+
+void gp4par_default_options(gp4par_options* options)
+{
+	Greenpak4PAROptions defaults;
+
+	options->part = 0x620;
+	options->unused_pull = GP4PAR_PULL_NONE;
+	options->unused_drive = GP4PAR_DRIVE_1M;
+	options->userid = defaults.m_userid;
+	options->read_protect = defaults.m_readProtect;
+	options->vcc_min = defaults.m_vccMin;
+	options->vcc_max = defaults.m_vccMax;
+	options->waivers = NULL;
+	options->no_opt = NULL;
+	options->seed = defaults.m_seed;
+	options->log_level = static_cast<int>(defaults.m_logLevel);
+}
+
+/**
+	@brief gp4par_run() minus the exception handling
+ */
+static int Run(const char* netlist, size_t len, const gp4par_options* options, gp4par_result* result)
+{
+	gp4par_options defaults;
+	if(options == NULL)
+	{
+		gp4par_default_options(&defaults);
+		options = &defaults;
+	}
+
+	Greenpak4PAROptions cppoptions;
+	string log;
+	if(!ConvertOptions(options, cppoptions, log))
+	{
+		result->log = CopyOut(log);
+		return 0;
+	}
+
+	Greenpak4PARResults results;
+	bool ok = Greenpak4PlaceAndRoute(netlist, len, cppoptions, results);
+
+	for(auto& message : results.m_log)
+		log += message.m_text;
+	result->log = CopyOut(log);
+
+	string placement;
+	for(auto& it : results.m_report.m_placement)
+		placement += it.first + "\t" + it.second + "\n";
+	result->placement = CopyOut(placement);
+
+	string utilization;
+	for(auto& row : results.m_report.m_utilization)
+	{
+		utilization += string(row.m_detail ? "  " : "") + row.m_name + "\t" +
+			to_string(row.m_used) + "\t" + to_string(row.m_total) + "\n";
+	}
+	result->utilization = CopyOut(utilization);
+
+	string drc;
+	for(auto& diag : results.m_report.m_diagnostics)
+	{
+		//Some messages run over several lines, keep one record per line
+		string message = diag.m_message;
+		replace(message.begin(), message.end(), '\n', ' ');
+
+		drc += diag.m_rule + "\t" + to_string(static_cast<int>(diag.m_severity)) + "\t" +
+			(diag.m_waived ? "1" : "0") + "\t" + message + "\n";
+	}
+	result->drc = CopyOut(drc);
+
+	result->worst_setup_slack = results.m_worstSetupSlack;
+	result->worst_hold_slack = results.m_worstHoldSlack;
+
+	if(!ok)
+		return 0;
+
+	vector<uint8_t> binary = results.m_bitstream.FormatBinary(options->part, cppoptions.m_userid, cppoptions.m_readProtect);
+	result->bitstream = static_cast<uint8_t*>(CopyOut(&binary[0], binary.size()));
+	result->bitstream_len = binary.size();
+	result->bitstream_text = CopyOut(results.m_bitstream.FormatText());
+	return 1;
+}
+
+int gp4par_run(const char* netlist, size_t len, const gp4par_options* options, gp4par_result* result)
+{
+	memset(result, 0, sizeof(*result));
+
+	//Nothing may propagate into C code, so turn exceptions (out of memory, mostly) into a failed run
+	const char* what = "unknown exception";
+	try
+	{
+		return Run(netlist, len, options, result);
+	}
+	catch(const exception& e)
+	{
+		what = e.what();
+	}
+	catch(...)
+	{
+	}
+
+	//Throw away whatever was filled in and report the exception, without allocating anything that can throw
+	gp4par_free_result(result);
+	const char* prefix = "Run aborted by an exception: ";
+	size_t loglen = strlen(prefix) + strlen(what) + 2;
+	result->log = static_cast<char*>(malloc(loglen));
+	if(result->log != NULL)
+		snprintf(result->log, loglen, "%s%s\n", prefix, what);
+	return 0;
+}
+
+void gp4par_free_result(gp4par_result* result)
+{
+	free(result->bitstream);
+	free(result->bitstream_text);
+	free(result->log);
+	free(result->placement);
+	free(result->utilization);
+	free(result->drc);
+	memset(result, 0, sizeof(*result));
+}
@@ -0,0 +1,119 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef libgp4par_c_h
+#define libgp4par_c_h
+
+/**
+	@file
+	@brief C interface to gp4par, for callers that can't use the C++ one in libgp4par.h
+
+	Everything is plain data: reports come back as tab separated text, one record per line, and every pointer in a
+	gp4par_result is allocated by the library and released by gp4par_free_result().
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum gp4par_pull
+{
+	GP4PAR_PULL_NONE,
+	GP4PAR_PULL_DOWN,
+	GP4PAR_PULL_UP
+};
+
+enum gp4par_drive
+{
+	GP4PAR_DRIVE_10K,
+	GP4PAR_DRIVE_100K,
+	GP4PAR_DRIVE_1M
+};
+
+//Settings for gp4par_run(). Start from gp4par_default_options(), which matches the gp4par command line defaults.
+typedef struct gp4par_options
+{
+	//Part number, coded as in bitstream container headers (0x620 for SLG46620 etc)
+	uint16_t part;
+
+	//Action to take with unused pins
+	enum gp4par_pull unused_pull;
+	enum gp4par_drive unused_drive;
+
+	//Bitstream metadata
+	uint8_t userid;
+	int read_protect;
+
+	//Supply voltage range to analyze timing over
+	double vcc_min;
+	double vcc_max;
+
+	//Comma separated design rules to waive and optimization passes to skip, as for --waive and --no-opt (or NULL)
+	const char* waivers;
+	const char* no_opt;
+
+	//Seed for the placer's random number generator
+	uint32_t seed;
+
+	//Most verbose log messages to keep: 0 = fatal, 1 = error, 2 = warning, 3 = notice, 4 = verbose, 5 = debug
+	int log_level;
+} gp4par_options;
+
+//What came out of gp4par_run(). Filled in as far as the run got, so worth looking at on failure too.
+typedef struct gp4par_result
+{
+	//Final bitstream in the binary container format (see Greenpak4Bitstream.h) and the legacy text format.
+	//NULL if the run failed.
+	uint8_t* bitstream;
+	size_t bitstream_len;
+	char* bitstream_text;
+
+	//Everything the flow logged
+	char* log;
+
+	//"cell<TAB>site" lines
+	char* placement;
+
+	//"resource<TAB>used<TAB>total" lines. Rows that break down the row above them are indented by two spaces.
+	char* utilization;
+
+	//"rule<TAB>severity<TAB>waived<TAB>message" lines, severity as for log_level and waived 0 or 1.
+	//Line breaks within a message are replaced by spaces.
+	char* drc;
+
+	//Worst slack over all corners in ns, infinite if there were no paths to check
+	double worst_setup_slack;
+	double worst_hold_slack;
+} gp4par_result;
+
+void gp4par_default_options(gp4par_options* options);
+
+//Places and routes a Yosys JSON netlist (or netlist image) held in memory. Returns 1 on success, 0 on failure.
+//Internal errors (such as running out of memory) are failures too, with the reason in the log.
+int gp4par_run(const char* netlist, size_t len, const gp4par_options* options, gp4par_result* result);
+
+void gp4par_free_result(gp4par_result* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,6 +29,10 @@ int main(int argc, char* argv[])
 
 	//Output file
 	string ofname = "";
+	Greenpak4Bitstream::FileFormat oformat = Greenpak4Bitstream::FORMAT_TEXT;
+
+	//Binary netlist image to use as a cache
+	string cachefname = "";
 
 	//Action to take with unused pins;
 	Greenpak4IOB::PullDirection unused_pull = Greenpak4IOB::PULL_NONE;
@@ -41,6 +45,22 @@ int main(int argc, char* argv[])
 	unsigned int userid = 0;
 	bool readProtect = false;
 
+	//Supply voltage range to analyze timing over
+	double vcc_min = 1.8;
+	double vcc_max = 5.0;
+
+	//Detailed timing report
+	string timing_report = "";
+
+	//Check the bitstream against the netlist
+	bool verify = false;
+
+	//Design rules not to fail on
+	drcwaivers waivers;
+
+	//Netlist optimizations not to run
+	optpasses no_opt;
+
 	//Parse command-line arguments
 	for(int i=1; i<argc; i++)
 	{
@@ -118,6 +138,127 @@ int main(int argc, char* argv[])
 		}
 		else if(s == "--read-protect")
 			readProtect = true;
+		else if(s == "--netlist-cache")
+		{
+			if(i+1 < argc)
+				cachefname = argv[++i];
+			else
+			{
+				printf("--netlist-cache requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--output-format")
+		{
+			if(i+1 < argc)
+			{
+				string format = argv[++i];
+				if(format == "text")
+					oformat = Greenpak4Bitstream::FORMAT_TEXT;
+				else if(format == "binary")
+					oformat = Greenpak4Bitstream::FORMAT_BINARY;
+				else
+				{
+					printf("--output-format must be one of text, binary\n");
+					return 1;
+				}
+			}
+			else
+			{
+				printf("--output-format requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--vcc")
+		{
+			if(i+1 < argc)
+			{
+				//Either a single voltage or a range
+				int n = sscanf(argv[++i], "%lf-%lf", &vcc_min, &vcc_max);
+				if(n == 1)
+					vcc_max = vcc_min;
+				if( (n < 1) || (vcc_max < vcc_min) ||
+					!Greenpak4TimingAnalyzer::IsSupportedVoltage(vcc_min) ||
+					!Greenpak4TimingAnalyzer::IsSupportedVoltage(vcc_max) )
+				{
+					printf("--vcc must be a voltage or range of voltages between 1.71 and 5.5, like 3.3 or 3.0-3.6\n");
+					return 1;
+				}
+			}
+			else
+			{
+				printf("--vcc requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--timing-report")
+		{
+			if(i+1 < argc)
+				timing_report = argv[++i];
+			else
+			{
+				printf("--timing-report requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--verify")
+			verify = true;
+		else if(s == "--waive")
+		{
+			if(i+1 < argc)
+			{
+				//Comma separated list of rule names
+				string rules = argv[++i];
+				size_t start = 0;
+				while(start <= rules.size())
+				{
+					size_t end = rules.find(',', start);
+					if(end == string::npos)
+						end = rules.size();
+					string rule = rules.substr(start, end - start);
+					if(!IsDRCRule(rule))
+					{
+						printf("--waive: \"%s\" is not a design rule\n", rule.c_str());
+						return 1;
+					}
+					waivers.insert(rule);
+					start = end + 1;
+				}
+			}
+			else
+			{
+				printf("--waive requires an argument\n");
+				return 1;
+			}
+		}
+		else if(s == "--no-opt")
+		{
+			if(i+1 < argc)
+			{
+				//Comma separated list of pass names
+				string passes = argv[++i];
+				size_t start = 0;
+				while(start <= passes.size())
+				{
+					size_t end = passes.find(',', start);
+					if(end == string::npos)
+						end = passes.size();
+					string pass = passes.substr(start, end - start);
+					if(!IsOptimizationPass(pass))
+					{
+						printf("--no-opt: \"%s\" is not an optimization pass\n", pass.c_str());
+						return 1;
+					}
+					no_opt.insert(pass);
+					start = end + 1;
+				}
+			}
+			else
+			{
+				printf("--no-opt requires an argument\n");
+				return 1;
+			}
+		}
 		else if(s == "-o" || s == "--output")
 		{
 			if(i+1 < argc)
@@ -159,7 +300,10 @@ int main(int argc, char* argv[])
 	{
 		LogIndenter li;
 		LogNotice("Target device:   SLG46620V\n");
-		LogNotice("VCC range:       not yet implemented\n");
+		if(vcc_min == vcc_max)
+			LogNotice("VCC:             %.2f V\n", vcc_min);
+		else
+			LogNotice("VCC range:       %.2f - %.2f V\n", vcc_min, vcc_max);
 
 		string pull;
 		string drive;
@@ -212,17 +356,27 @@ int main(int argc, char* argv[])
 	}
 
 	//Parse the unplaced netlist
-	LogNotice("\nLoading Yosys JSON file \"%s\".\n", fname.c_str());
-	Greenpak4Netlist netlist(fname);
+	LogNotice("\nLoading netlist file \"%s\".\n", fname.c_str());
+	Greenpak4Netlist netlist(fname, cachefname);
 	if(!netlist.Validate())
 		return 1;
 
+	//Clean up the netlist before placing it
+	LogNotice("\nOptimizing netlist:\n");
+	{
+		LogIndenter li;
+		if(!OptimizeNetlist(&netlist, no_opt))
+			return 1;
+	}
+
 	//Create the device and initialize all IO pins
 	Greenpak4Device device(part, unused_pull, unused_drive);
 
 	//Do the actual P&R
 	LogNotice("\nSynthesizing top-level module \"%s\".\n", netlist.GetTopModule()->GetName().c_str());
-	if(!DoPAR(&netlist, &device))
+	placementmap placement;
+	bool debug = (console_verbosity >= Severity::DEBUG);
+	if(!DoPAR(&netlist, &device, &placement, waivers, NULL, 1, debug))
 		return 1;
 
 	//Write the final bitstream
@@ -230,11 +384,47 @@ int main(int argc, char* argv[])
 		ofname.c_str(), (int)userid);
 	{
 		LogIndenter li;
-		device.WriteToFile(ofname, userid, readProtect);
+		if(!device.WriteToFile(ofname, userid, readProtect, oformat))
+			return 1;
+	}
+
+	//Static timing analysis of the committed design
+	LogNotice("\nStatic timing analysis:\n");
+	{
+		LogIndenter li;
+		Greenpak4TimingAnalyzer sta(&device, vcc_min, vcc_max);
+		sta.Analyze();
+		sta.PrintSummary();
+
+		if(timing_report != "")
+		{
+			LogNotice("Writing timing report to \"%s\"\n", timing_report.c_str());
+			if(!sta.WriteReport(timing_report))
+				return 1;
+		}
 	}
 
-	//TODO: Static timing analysis
-	LogNotice("\nStatic timing analysis: not yet implemented\n");
+	//Read back what we wrote and simulate it against the netlist
+	if(verify)
+	{
+		LogNotice("\nVerifying bitstream against the netlist:\n");
+		LogIndenter li;
+
+		//Check against the netlist as it was written, not as we optimized it.
+		//Cells that survived optimization keep their names, so placements carry over by name.
+		Greenpak4Netlist original(fname, cachefname);
+		auto module = original.GetTopModule();
+		placementmap original_placement;
+		for(auto it : placement)
+		{
+			auto cell = module->GetCell(it.first->m_name);
+			if(cell != NULL)
+				original_placement[cell] = it.second;
+		}
+
+		if(!VerifyBitstream(&original, part, ofname, original_placement))
+			return 1;
+	}
 
 	return 0;
 }
@@ -243,6 +433,7 @@ void ShowUsage()
 {
 	printf(//                                                                               v 80th column
 		"Usage: gp4par -o bitstream.txt netlist.json\n"
+		"       gp4par -o bitstream.txt netlist.gp4nl\n"
 		"    -q, --quiet\n"
 		"        Causes only warnings and errors to be written to the console.\n"
 		"        Specify twice to also silence warnings.\n"
@@ -252,6 +443,17 @@ void ShowUsage()
 		"        Prints lots of internal debugging information.\n"
 		"    -o, --output         <bitstream>\n"
 		"        Writes bitstream into the specified file.\n"
+		"    --output-format      [text|binary]\n"
+		"        Selects the bitstream file format. text (the default) is the format used\n"
+		"        by the Silego tools; binary is a compact container with a header, which\n"
+		"        gp4prog also accepts and can convert back to text.\n"
+		"    --no-opt             <pass>[,<pass>...]\n"
+		"        Skips the named netlist optimization passes (constprop, absorb-inv,\n"
+		"        strash, sweep), or all of them.\n"
+		"    --netlist-cache      <netlist.gp4nl>\n"
+		"        Loads the netlist from a pre-indexed binary image instead of the JSON if\n"
+		"        the image was built from the same JSON file, (re)writes it otherwise.\n"
+		"        Images can also be passed to gp4par in place of the JSON netlist.\n"
 		"    -l, --logfile        <file>\n"
 		"        Causes verbose log messages to be written to <file>.\n"
 		"    -L, --logfile-lines  <file>\n"
@@ -260,7 +462,18 @@ void ShowUsage()
 		"    --unused-pull        [down|up|float]\n"
 		"        Specifies direction to pull unused pins.\n"
 		"    --unused-drive       [10k|100k|1m]\n"
-		"        Specifies strength of pullup/down resistor on unused pins.\n");
+		"        Specifies strength of pullup/down resistor on unused pins.\n"
+		"    --vcc                <volts>[-<volts>]\n"
+		"        Supply voltage, or range of voltages, to analyze timing at (default\n"
+		"        1.8-5.0). Both ends of a range are analyzed.\n"
+		"    --timing-report      <file>\n"
+		"        Writes every timing path checked, worst first, to <file>.\n"
+		"    --verify\n"
+		"        Reads back the bitstream and simulates it side by side with the netlist\n"
+		"        on random stimulus. Fails with a counterexample if they disagree.\n"
+		"    --waive              <rule>[,<rule>...]\n"
+		"        Reports violations of the named design rules without failing on them.\n"
+		"        Each DRC message starts with the name of the rule that raised it.\n");
 }
 
 void ShowVersion()
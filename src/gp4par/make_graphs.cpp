@@ -46,7 +46,7 @@ PARGraphNode* MakeNode(
 	Greenpak4BitstreamEntity* entity,
 	PARGraph* dgraph);
 
-void InferExtraNodes(
+bool InferExtraNodes(
 	Greenpak4Netlist* netlist,
 	Greenpak4Device* device,
 	PARGraph*& ngraph,
@@ -92,7 +92,8 @@ bool BuildGraphs(
 		return false;
 
 	//Infer extra support nodes for things that use hidden functions of others
-	InferExtraNodes(netlist, device, ngraph, ilmap);
+	if(!InferExtraNodes(netlist, device, ngraph, ilmap))
+		return false;
 
 	return true;
 }
@@ -110,12 +111,13 @@ void ReplicateVREF(
 {
 
 
-	//Monotonically increasing counter used to ensure unique node IDs
-	static unsigned int vref_id = 1;
+	//Monotonically increasing counter used to ensure unique node IDs (thread local for concurrent runs)
+	static thread_local unsigned int vref_id = 1;
 
 	//Create a new VREF and copy the input config
-	Greenpak4NetlistCell* vref = new Greenpak4NetlistCell(module);
-	vref->m_type = "GP_VREF";
+	auto arena = module->GetNetlist()->GetArena();
+	Greenpak4NetlistCell* vref = arena->New<Greenpak4NetlistCell>(module);
+	vref->SetType("GP_VREF");
 	vref->m_connections["VIN"].push_back(cell->m_connections["VIN"][0]);
 	vref->m_parameters = cell->m_parameters;
 	vref->m_attributes = cell->m_attributes;
@@ -134,7 +136,7 @@ void ReplicateVREF(
 	snprintf(tmp, sizeof(tmp), "$auto$make_graphs.cpp:%d:vref$%u",
 		__LINE__,
 		vref_id ++);
-	Greenpak4NetlistNode* vout = new Greenpak4NetlistNode;
+	Greenpak4NetlistNode* vout = arena->New<Greenpak4NetlistNode>(module->GetNetlist()->GetStringTable());
 	vout->m_name = tmp;
 	vout->m_src_locations = net->m_src_locations;
 
@@ -175,8 +177,10 @@ void ReplicateVREF(
 
 /**
 	@brief Add extra nodes to handle dependencies between nodes that share hard IP under the hood
+
+	@return false if the netlist couldn't be re-indexed after adding them
  */
-void InferExtraNodes(
+bool InferExtraNodes(
 	Greenpak4Netlist* netlist,
 	Greenpak4Device* device,
 	PARGraph*& ngraph,
@@ -192,12 +196,16 @@ void InferExtraNodes(
 	auto vdd = top->GetNet("GP_VDD");
 	auto vddn = device->GetPowerRail(true)->GetPARNode();
 
-	//Look for IOBs driven by GP_VREF cells
+	//Both passes add cells to the module as they go, so walk a copy of the cell list
 	Greenpak4NetlistModule* module = netlist->GetTopModule();
+	vector<Greenpak4NetlistCell*> cells;
 	for(auto it = module->cell_begin(); it != module->cell_end(); it ++)
+		cells.push_back(it->second);
+
+	//Look for IOBs driven by GP_VREF cells
+	for(auto cell : cells)
 	{
 		//See if we're an IOB
-		Greenpak4NetlistCell* cell = it->second;
 		if(!cell->IsIOB())
 			continue;
 
@@ -206,7 +214,7 @@ void InferExtraNodes(
 		auto driver = net->m_driver;
 		if(driver.IsNull())
 			continue;
-		if( (driver.m_cell->m_type != "GP_VREF") || (driver.m_portname != "VOUT") )
+		if(!driver.m_cell->IsType(GP_PRIM_VREF) || (driver.m_portname != "VOUT") )
 			continue;
 		Greenpak4NetlistCell* vref = driver.m_cell;
 
@@ -220,7 +228,7 @@ void InferExtraNodes(
 		{
 			if(jt.IsNull())
 				continue;
-			if(jt.m_cell->m_type == "GP_ACMP")
+			if(jt.m_cell->IsType(GP_PRIM_ACMP))
 				acmps.push_back(jt.m_cell);
 		}
 
@@ -231,12 +239,12 @@ void InferExtraNodes(
 			LogDebug("No comparator driven by this VREF, creating a dummy\n");
 			madeChanges = true;
 
-			//Monotonically increasing counter used to ensure unique node IDs
-			static unsigned int acmp_id = 1;
+			//Monotonically increasing counter used to ensure unique node IDs (thread local for concurrent runs)
+			static thread_local unsigned int acmp_id = 1;
 
 			//Create the cell and tie its VREF to our input
-			Greenpak4NetlistCell* acmp = new Greenpak4NetlistCell(module);
-			acmp->m_type = "GP_ACMP";
+			Greenpak4NetlistCell* acmp = netlist->GetArena()->New<Greenpak4NetlistCell>(module);
+			acmp->SetType("GP_ACMP");
 			acmp->m_connections["VREF"].push_back(net);
 
 			//TODO: Determine whether we actually *need* to power on the comparator
@@ -252,7 +260,7 @@ void InferExtraNodes(
 			acmp->m_name = tmp;
 
 			//Set a special attribute so that we don't give a "has no loads" warning
-			acmp->m_attributes["__IGNORE__NOLOAD__"] = "1";
+			acmp->m_attributes[GP_SYM_IGNORE_NOLOAD] = "1";
 
 			//Add the cell to the module
 			module->AddCell(acmp);
@@ -280,18 +288,21 @@ void InferExtraNodes(
 	if(madeChanges)
 	{
 		LogNotice("Re-indexing graph because we inferred additional nodes..\n");
-		netlist->Reindex(true);
+		if(!netlist->Reindex(true))
+			return false;
 		ngraph->IndexNodesByLabel();
 		madeChanges = false;
 	}
 
 	//If one GP_VREF drives multiple GP_ACMP/GP_DAC blocks, split it
 	//This must come after the IOB pass since that might infer GP_ACMPs we need to contend with
+	cells.clear();
 	for(auto it = module->cell_begin(); it != module->cell_end(); it ++)
+		cells.push_back(it->second);
+	for(auto cell : cells)
 	{
 		//See if we're a VREF
-		Greenpak4NetlistCell* cell = it->second;
-		if(cell->m_type != "GP_VREF")
+		if(!cell->IsType(GP_PRIM_VREF))
 			continue;
 		//LogDebug("vref %s\n", cell->m_name.c_str());
 
@@ -303,7 +314,7 @@ void InferExtraNodes(
 			//Skip anything not a comparator or DAC
 			auto load = net->m_nodeports[i].m_cell;
 			//LogDebug("    load %s type %s\n", load->m_name.c_str(), load->m_type.c_str());
-			if( (load->m_type != "GP_ACMP") && (load->m_type != "GP_DAC") )
+			if(!load->IsType(GP_PRIM_ACMP) && !load->IsType(GP_PRIM_DAC))
 				continue;
 
 			//If this is the first one, flag it but don't do anything
@@ -329,10 +340,13 @@ void InferExtraNodes(
 	if(madeChanges)
 	{
 		LogVerbose("Re-indexing graph because we inferred additional nodes..\n");
-		netlist->Reindex(true);
+		if(!netlist->Reindex(true))
+			return false;
 		ngraph->IndexNodesByLabel();
 		//madeChanges = false;
 	}
+
+	return true;
 }
 
 /**
@@ -369,6 +383,21 @@ bool MakeNetlistNodes(
 			return false;
 		}
 
+		//LUTs can go in a smaller site if some of their inputs turn out not to matter
+		if(cell->IsType(GP_PRIM_2LUT) || cell->IsType(GP_PRIM_3LUT) || cell->IsType(GP_PRIM_4LUT))
+		{
+			Greenpak4LUT::InputMap map;
+			if(!Greenpak4LUT::MapCellInputs(cell, map))
+				return false;
+			unsigned int order = max(2u, map.m_count);
+			label = ilmap["GP_" + to_string(order) + "LUT"];
+			if(cell->m_type != "GP_" + to_string(order) + "LUT")
+			{
+				LogVerbose("LUT \"%s\" (%s) only uses %u of its inputs\n",
+					cell->m_name.c_str(), cell->m_type.c_str(), map.m_count);
+			}
+		}
+
 		//Create a node for the cell
 		PARGraphNode* nnode = new PARGraphNode(label, cell);
 		cell->m_parnode = nnode;
@@ -396,7 +425,7 @@ void MakeDeviceNodes(
 		auto iob = it->second;
 
 		//Type A (and not input-only)? Can be anything
-		if( (dynamic_cast<Greenpak4IOBTypeA*>(iob) != NULL) && !iob->IsInputOnly() )
+		if( (iob->GetKind() == Greenpak4BitstreamEntity::KIND_IOB_TYPE_A) && !iob->IsInputOnly() )
 		{
 			auto node = MakeNode(iobuf_label, iob, dgraph);
 			node->AddAlternateLabel(obuf_label);
@@ -551,6 +580,24 @@ void MakeDeviceNodes(
 	//TODO: make nodes for all of the other hard IP
 }
 
+/**
+	@brief Look up the direction of the cell port a net connects to, complaining if it isn't a primitive port
+ */
+static bool GetNodePortDirection(Greenpak4NetlistNodePoint& point, Greenpak4NetlistPort::Direction& dir)
+{
+	if(point.m_port != NULL)
+	{
+		dir = point.m_port->m_direction;
+		return true;
+	}
+
+	LogError(
+		"Cell \"%s\" of type %s is not a valid GreenPak4 primitive\n",
+		point.m_cell->m_name.c_str(),
+		point.m_cell->m_type.c_str());
+	return false;
+}
+
 /**
 	@brief Make all of the edges in the netlist
  */
@@ -559,6 +606,9 @@ bool MakeNetlistEdges(Greenpak4Netlist* netlist)
 	LogDebug("Creating PAR netlist...\n");
 	LogIndenter li;
 
+	//Edges into LUTs go to the physical input each cell input was assigned to
+	unordered_map<Greenpak4NetlistCell*, Greenpak4LUT::InputMap> lutmaps;
+
 	for(auto it = netlist->nodebegin(); it != netlist->nodeend(); it ++)
 	{
 		Greenpak4NetlistNode* node = *it;
@@ -568,6 +618,7 @@ bool MakeNetlistEdges(Greenpak4Netlist* netlist)
 
 		PARGraphNode* source = NULL;
 		string sourceport = "";
+		const Greenpak4PrimitivePort* sourcepport = NULL;
 
 		//Nets sourced by port are special - no edges
 		bool sourced_by_port = false;
@@ -582,16 +633,18 @@ bool MakeNetlistEdges(Greenpak4Netlist* netlist)
 		}
 
 		//See if it was sourced by a node
-		for(auto c : node->m_nodeports)
+		for(auto& c : node->m_nodeports)
 		{
-			Greenpak4NetlistModule* module = netlist->GetModule(c.m_cell->m_type);
-			Greenpak4NetlistPort* port = module->GetPort(c.m_portname);
+			Greenpak4NetlistPort::Direction dir;
+			if(!GetNodePortDirection(c, dir))
+				return false;
 
-			if(port->m_direction == Greenpak4NetlistPort::DIR_INPUT)
+			if(dir == Greenpak4NetlistPort::DIR_INPUT)
 				continue;
 
 			source = c.m_cell->m_parnode;
 			sourceport = c.m_portname;
+			sourcepport = c.m_port;
 			LogDebug("cell %s port %s\n", c.m_cell->m_name.c_str(), c.m_portname.c_str());
 
 			node->m_driver = c;
@@ -617,17 +670,18 @@ bool MakeNetlistEdges(Greenpak4Netlist* netlist)
 				return false;
 			}
 
-			for(auto c : node->m_nodeports)
+			for(auto& c : node->m_nodeports)
 			{
 				//Don't add edges to ourself (happens with inouts etc)
-				if( (source == c.m_cell->m_parnode) && (sourceport == c.m_portname) )
+				if( (source == c.m_cell->m_parnode) && (sourcepport == c.m_port) )
 					continue;
 
 				has_loads = true;
 				LogDebug("cell %s port %s\n", c.m_cell->m_name.c_str(), c.m_portname.c_str());
 
 				//Verify the type is IBUF/IOBUF
-				if( (c.m_cell->m_type == "GP_IBUF") || (c.m_cell->m_type == "GP_IOBUF") )
+				auto prim = c.m_cell->m_primitive;
+				if( (prim != NULL) && ( (prim->m_type == GP_PRIM_IBUF) || (prim->m_type == GP_PRIM_IOBUF) ) )
 					continue;
 
 				LogError(
@@ -644,16 +698,16 @@ bool MakeNetlistEdges(Greenpak4Netlist* netlist)
 		//Create edges from this source node to all sink nodes
 		else
 		{
-			for(auto c : node->m_nodeports)
+			for(auto& c : node->m_nodeports)
 			{
-				Greenpak4NetlistModule* module = netlist->GetModule(c.m_cell->m_type);
-				Greenpak4NetlistPort* port = module->GetPort(c.m_portname);
-
 				//Don't add edges to ourself (happens with inouts etc)
-				if( (source == c.m_cell->m_parnode) && (sourceport == c.m_portname) )
+				if( (source == c.m_cell->m_parnode) && (sourcepport == c.m_port) )
 					continue;
 
-				if(port->m_direction == Greenpak4NetlistPort::DIR_OUTPUT)
+				Greenpak4NetlistPort::Direction dir;
+				if(!GetNodePortDirection(c, dir))
+					return false;
+				if(dir == Greenpak4NetlistPort::DIR_OUTPUT)
 					continue;
 
 				//Name the net
@@ -665,8 +719,30 @@ bool MakeNetlistEdges(Greenpak4Netlist* netlist)
 					nname = tmp;
 				}
 
-				//Use the new name
+				//LUT inputs may be permuted or dropped
 				has_loads = true;
+				auto cell = c.m_cell;
+				if(cell->IsType(GP_PRIM_2LUT) || cell->IsType(GP_PRIM_3LUT) || cell->IsType(GP_PRIM_4LUT))
+				{
+					auto mit = lutmaps.find(cell);
+					if(mit == lutmaps.end())
+					{
+						Greenpak4LUT::InputMap map;
+						if(!Greenpak4LUT::MapCellInputs(cell, map))
+							return false;
+						mit = lutmaps.emplace(cell, map).first;
+					}
+					int pin = mit->second.m_pins[c.m_port->m_index];
+					if(pin == Greenpak4LUT::PIN_DROPPED)
+					{
+						LogDebug("cell %s port %s (dropped, doesn't affect the output)\n",
+							cell->m_name.c_str(), nname.c_str());
+						continue;
+					}
+					nname = "IN" + to_string(pin);
+				}
+
+				//Use the new name
 				LogDebug("cell %s port %s\n", c.m_cell->m_name.c_str(), nname.c_str());
 				if(source)
 					source->AddEdge(sourceport, c.m_cell->m_parnode, nname);
@@ -734,300 +810,54 @@ void MakeDeviceEdges(Greenpak4Device* device)
 			device_nodes.push_back(pnode);
 	}
 
+	//Look up the general fabric inputs of each node once, rather than once per source port
+	vector< vector<string> > iports;
+	for(auto y : device_nodes)
+		iports.push_back(static_cast<Greenpak4BitstreamEntity*>(y->GetData())->GetInputPorts());
+
 	//Add the O(n^2) edges between the main fabric nodes
 	for(auto x : device_nodes)
 	{
 		auto oports = static_cast<Greenpak4BitstreamEntity*>(x->GetData())->GetOutputPorts();
 		for(auto srcport : oports)
 		{
-			for(auto y : device_nodes)
+			//Add paths to each cell input
+			for(size_t j=0; j<device_nodes.size(); j++)
 			{
-				//Add paths to each cell input
-				auto iports = static_cast<Greenpak4BitstreamEntity*>(y->GetData())->GetInputPorts();
-				for(auto ip : iports)
-					x->AddEdge(srcport, y, ip);
+				for(auto& ip : iports[j])
+					x->AddEdge(srcport, device_nodes[j], ip);
 			}
 		}
 	}
 
-	//Add dedicated routing between hard IP
-	if(device->GetPart() == Greenpak4Device::GREENPAK4_SLG46620)
+	//Add dedicated routing between hard IP, as listed in the device description
+	auto desc = device->GetDescription();
+	for(unsigned int i=0; i<desc->m_routeCount; i++)
 	{
-		auto lfosc = device->GetLFOscillator()->GetPARNode();
-		auto rosc = device->GetRingOscillator()->GetPARNode();
-		auto rcosc = device->GetRCOscillator()->GetPARNode();
-
-		//TODO: Disable clock outputs to dedicated routing in matrix 1 if SPI slave is enabled?
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// Cache some commonly used stuff
-
-		auto pin2 = device->GetIOB(2)->GetPARNode();
-		auto pin3 = device->GetIOB(3)->GetPARNode();
-		auto pin4 = device->GetIOB(4)->GetPARNode();
-		auto pin6 = device->GetIOB(6)->GetPARNode();
-		auto pin7 = device->GetIOB(7)->GetPARNode();
-		auto pin8 = device->GetIOB(8)->GetPARNode();
-		auto pin9 = device->GetIOB(9)->GetPARNode();
-		auto pin12 = device->GetIOB(12)->GetPARNode();
-		auto pin13 = device->GetIOB(13)->GetPARNode();
-		auto pin15 = device->GetIOB(15)->GetPARNode();
-		auto pin16 = device->GetIOB(16)->GetPARNode();
-		auto pin18 = device->GetIOB(18)->GetPARNode();
-		auto pin19 = device->GetIOB(19)->GetPARNode();
-
-		auto vdd = device->GetPowerRail(true)->GetPARNode();
-		auto gnd = device->GetPowerRail(false)->GetPARNode();
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// CLOCK INPUTS TO COUNTERS
-
-		PARGraphNode* cnodes[] =
-		{
-			device->GetCounter(0)->GetPARNode(),
-			device->GetCounter(1)->GetPARNode(),
-			device->GetCounter(2)->GetPARNode(),
-			device->GetCounter(3)->GetPARNode(),
-			device->GetCounter(4)->GetPARNode(),
-			device->GetCounter(5)->GetPARNode(),
-			device->GetCounter(6)->GetPARNode(),
-			device->GetCounter(7)->GetPARNode(),
-			device->GetCounter(8)->GetPARNode(),
-			device->GetCounter(9)->GetPARNode()
-		};
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[0], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[0], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[0], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[1], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[1], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[1], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[2], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[2], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[2], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[3], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[3], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[3], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[4], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[4], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[4], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[5], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[5], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[5], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[6], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[6], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[6], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[7], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[7], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[7], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[8], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[8], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[8], "CLK");
-
-		//TODO: other clock sources
-		lfosc->AddEdge("CLKOUT", cnodes[9], "CLK");
-		rosc->AddEdge("CLKOUT_HARDIP", cnodes[9], "CLK");
-		rcosc->AddEdge("CLKOUT_HARDIP", cnodes[9], "CLK");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// SYSTEM RESET
-
-		//Can drive reset with ground or pin 2 only
-		auto sysrst = device->GetSystemReset()->GetPARNode();
-		pin2->AddEdge("OUT", sysrst, "RST");
-		gnd->AddEdge("OUT", sysrst, "RST");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// REFERENCE OUT
-
-		PARGraphNode* vrefs[] =
-		{
-			device->GetVref(0)->GetPARNode(),
-			device->GetVref(1)->GetPARNode(),
-			device->GetVref(2)->GetPARNode(),
-			device->GetVref(3)->GetPARNode(),
-			device->GetVref(4)->GetPARNode(),
-			device->GetVref(5)->GetPARNode(),
-
-			//DAC references
-			device->GetVref(6)->GetPARNode(),
-			device->GetVref(7)->GetPARNode()
-		};
-
-		//VREF0/1 can drive pin 19
-		vrefs[0]->AddEdge("VOUT", pin19, "IN");
-		vrefs[1]->AddEdge("VOUT", pin19, "IN");
-
-		//VREF2/3 can drive pin 18
-		vrefs[2]->AddEdge("VOUT", pin18, "IN");
-		vrefs[3]->AddEdge("VOUT", pin18, "IN");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// REFERENCE TO COMPARATORS
-
-		PARGraphNode* acmps[] =
-		{
-			device->GetAcmp(0)->GetPARNode(),
-			device->GetAcmp(1)->GetPARNode(),
-			device->GetAcmp(2)->GetPARNode(),
-			device->GetAcmp(3)->GetPARNode(),
-			device->GetAcmp(4)->GetPARNode(),
-			device->GetAcmp(5)->GetPARNode()
-		};
-
-		/*
-		//Any vref can drive any comparator, we hide the complexity of the actual routing structure
-		//TODO: add a 6th vref for the DACs?
-		for(auto acmp : acmps)
-		{
-			for(auto vref : vrefs)
-				vref->AddEdge("VOUT", acmp, "VREF");
-		}
-		*/
-
-		//Only allow one VREF to drive its attached comparator.
-		//TODO: Add a 6th vref for DAC reference
-		for(unsigned int i=0; i<6; i++)
-			vrefs[i]->AddEdge("VOUT", acmps[i], "VREF");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// INPUTS TO COMPARATORS
-
-		auto pga = device->GetPGA()->GetPARNode();
-		auto abuf = device->GetAbuf()->GetPARNode();
-
-		//Input to buffer
-		pin6->AddEdge("OUT", abuf, "IN");
-
-		//Dedicated inputs for ACMP0 (none)
-
-		//Dedicated inputs for acmps[1]
-		pin12->AddEdge("OUT", acmps[1], "VIN");
-		pga->AddEdge("VOUT", acmps[1], "VIN");
-
-		//Dedicated inputs for acmps[2]
-		pin13->AddEdge("OUT", acmps[2], "VIN");
-
-		//Dedicated inputs for acmps[3]
-		pin15->AddEdge("OUT", acmps[3], "VIN");
-		pin13->AddEdge("OUT", acmps[3], "VIN");
-
-		//Dedicated inputs for acmps[4]
-		pin3->AddEdge("OUT", acmps[4], "VIN");
-		pin15->AddEdge("OUT", acmps[4], "VIN");
-
-		//Dedicated inputs for acmps[5]
-		pin4->AddEdge("OUT", acmps[5], "VIN");
-
-		//acmps[0] input before gain stage is fed to everything but acmps[5]
-		pin6->AddEdge("OUT", acmps[0], "VIN");
-		vdd->AddEdge("OUT", acmps[0], "VIN");
-		abuf->AddEdge("OUT", acmps[0], "VIN");
-
-		pin6->AddEdge("OUT", acmps[1], "VIN");
-		vdd->AddEdge("OUT", acmps[1], "VIN");
-		abuf->AddEdge("OUT", acmps[1], "VIN");
-
-		pin6->AddEdge("OUT", acmps[2], "VIN");
-		vdd->AddEdge("OUT", acmps[2], "VIN");
-		abuf->AddEdge("OUT", acmps[2], "VIN");
-
-		pin6->AddEdge("OUT", acmps[3], "VIN");
-		vdd->AddEdge("OUT", acmps[3], "VIN");
-		abuf->AddEdge("OUT", acmps[3], "VIN");
-
-		pin6->AddEdge("OUT", acmps[4], "VIN");
-		vdd->AddEdge("OUT", acmps[4], "VIN");
-		abuf->AddEdge("OUT", acmps[4], "VIN");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// INPUTS TO PGA
-
-		vdd->AddEdge("OUT", pga, "VIN_P");
-		pin8->AddEdge("OUT", pga, "VIN_P");
-
-		pin9->AddEdge("OUT", pga, "VIN_N");
-		gnd->AddEdge("OUT", pga, "VIN_N");
-		//TODO: DAC output
-
-		pin16->AddEdge("OUT", pga, "VIN_SEL");
-		vdd->AddEdge("OUT", pga, "VIN_SEL");
-
-		//TODO: Output to ADC
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// PGA to IOB
-
-		pga->AddEdge("VOUT", pin7, "IN");
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// INPUTS TO DAC
-
-		PARGraphNode* dacs[] =
-		{
-			device->GetDAC(0)->GetPARNode(),
-			device->GetDAC(1)->GetPARNode()
-		};
-
-		//DAC voltage references driving DAC inputs
-		vrefs[6]->AddEdge("VOUT", dacs[0], "VREF");
-		vrefs[7]->AddEdge("VOUT", dacs[1], "VREF");
+		auto& route = desc->m_routes[i];
+		if(!device->HasPart(route.m_parts))
+			continue;
 
-		//Static 1/0 for register configuration
-		for(size_t i=0; i<device->GetDACCount(); i++)
+		for(auto src : device->GetSites(route.m_srcKind, route.m_srcNum))
 		{
-			auto dac = device->GetDAC(i)->GetPARNode();
-
-			vdd->AddEdge("OUT", dac, "DIN[0]");
-			vdd->AddEdge("OUT", dac, "DIN[1]");
-			vdd->AddEdge("OUT", dac, "DIN[2]");
-			vdd->AddEdge("OUT", dac, "DIN[3]");
-			vdd->AddEdge("OUT", dac, "DIN[4]");
-			vdd->AddEdge("OUT", dac, "DIN[5]");
-			vdd->AddEdge("OUT", dac, "DIN[6]");
-			vdd->AddEdge("OUT", dac, "DIN[7]");
-
-			gnd->AddEdge("OUT", dac, "DIN[0]");
-			gnd->AddEdge("OUT", dac, "DIN[1]");
-			gnd->AddEdge("OUT", dac, "DIN[2]");
-			gnd->AddEdge("OUT", dac, "DIN[3]");
-			gnd->AddEdge("OUT", dac, "DIN[4]");
-			gnd->AddEdge("OUT", dac, "DIN[5]");
-			gnd->AddEdge("OUT", dac, "DIN[6]");
-			gnd->AddEdge("OUT", dac, "DIN[7]");
-		}
-
-		//TODO: Direct inputs from counters
-
-		////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-		// OUTPUTS FROM DAC
+			auto snode = src->GetPARNode();
+			for(auto dst : device->GetSites(route.m_dstKind, route.m_dstNum))
+			{
+				auto dnode = dst->GetPARNode();
 
-		// Both DACs can drive to every comparator vref
-		for(int i=0; i<2; i++)
-		{
-			for(int j=0; j<6; j++)
-				dacs[i]->AddEdge("VOUT", vrefs[j], "VIN");
+				//Buses get one edge per bit
+				if(route.m_width > 1)
+				{
+					for(unsigned int b=0; b<route.m_width; b++)
+					{
+						char port[64];
+						snprintf(port, sizeof(port), "%s[%u]", route.m_dstPort, b);
+						snode->AddEdge(route.m_srcPort, dnode, port);
+					}
+				}
+				else
+					snode->AddEdge(route.m_srcPort, dnode, route.m_dstPort);
+			}
 		}
-
-		//DACs can drive I/O pins directly without going through a GP_VREF
-		dacs[0]->AddEdge("VOUT", pin19, "IN");
-		dacs[1]->AddEdge("VOUT", pin18, "IN");
 	}
 }
@@ -0,0 +1,531 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include "gp4par.h"
+#include <algorithm>
+
+using namespace std;
+
+/**
+	@brief Cleans up the netlist before it's placed
+
+	Every pass works on a freshly indexed netlist and reports whether it changed anything; the passes are run over and
+	over until none of them does.
+ */
+class NetlistOptimizer
+{
+public:
+	NetlistOptimizer(Greenpak4Netlist* netlist);
+
+	bool Reindex()
+	{ return m_netlist->Reindex(false); }
+
+	bool PropagateConstants();
+	bool AbsorbInverters();
+	bool MergeDuplicates();
+	bool SweepDeadCells();
+
+	void PrintReport();
+
+protected:
+	static unsigned int GetLUTOrder(Greenpak4NetlistCell* cell);
+	static uint32_t GetLUTTable(Greenpak4NetlistCell* cell);
+	static void SetLUTTable(Greenpak4NetlistCell* cell, uint32_t table);
+	static Greenpak4NetlistNode* GetNet(Greenpak4NetlistCell* cell, const string& port);
+	static bool IsPinned(Greenpak4NetlistCell* cell);
+
+	bool IsConstant(Greenpak4NetlistNode* net)
+	{ return (net != NULL) && ( (net == m_vdd) || (net == m_vss) ); }
+
+	bool HasLoads(Greenpak4NetlistNode* net);
+	bool ReplaceNet(Greenpak4NetlistNode* from, Greenpak4NetlistNode* to);
+
+	Greenpak4Netlist* m_netlist;
+	Greenpak4NetlistModule* m_module;
+	Greenpak4NetlistNode* m_vdd;
+	Greenpak4NetlistNode* m_vss;
+
+	//Statistics
+	unsigned int m_tiedInputs;
+	unsigned int m_constantCells;
+	unsigned int m_absorbedInverters;
+	unsigned int m_mergedCells;
+	unsigned int m_sweptCells;
+};
+
+NetlistOptimizer::NetlistOptimizer(Greenpak4Netlist* netlist)
+	: m_netlist(netlist)
+	, m_module(netlist->GetTopModule())
+	, m_vdd(m_module->GetNet("GP_VDD"))
+	, m_vss(m_module->GetNet("GP_VSS"))
+	, m_tiedInputs(0)
+	, m_constantCells(0)
+	, m_absorbedInverters(0)
+	, m_mergedCells(0)
+	, m_sweptCells(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+
+/**
+	@brief Number of inputs of a LUT cell, or 0 if it's not a LUT
+ */
+unsigned int NetlistOptimizer::GetLUTOrder(Greenpak4NetlistCell* cell)
+{
+	if(cell->IsType(GP_PRIM_2LUT))
+		return 2;
+	else if(cell->IsType(GP_PRIM_3LUT))
+		return 3;
+	else if(cell->IsType(GP_PRIM_4LUT))
+		return 4;
+	return 0;
+}
+
+uint32_t NetlistOptimizer::GetLUTTable(Greenpak4NetlistCell* cell)
+{
+	auto it = cell->m_parameters.find("INIT");
+	if(it == cell->m_parameters.end())
+		return 0;
+	return atoi(it->second.c_str()) & ( (1u << (1 << GetLUTOrder(cell))) - 1 );
+}
+
+//INIT is stored as decimal, same as the netlist parser does
+void NetlistOptimizer::SetLUTTable(Greenpak4NetlistCell* cell, uint32_t table)
+{
+	cell->m_parameters["INIT"] = to_string(table);
+}
+
+/**
+	@brief The net on a single-bit port of a cell, or NULL if it's unconnected
+ */
+Greenpak4NetlistNode* NetlistOptimizer::GetNet(Greenpak4NetlistCell* cell, const string& port)
+{
+	auto it = cell->m_connections.find(port);
+	if( (it == cell->m_connections.end()) || (it->second.size() != 1) )
+		return NULL;
+	return it->second[0];
+}
+
+/**
+	@brief Returns true if the user asked for this cell to be left alone
+ */
+bool NetlistOptimizer::IsPinned(Greenpak4NetlistCell* cell)
+{
+	return cell->HasLOC() || cell->HasAttribute("keep");
+}
+
+/**
+	@brief Returns true if anything reads the net (a cell input, or a top-level port)
+ */
+bool NetlistOptimizer::HasLoads(Greenpak4NetlistNode* net)
+{
+	if(!net->m_ports.empty())
+		return true;
+	for(auto& c : net->m_nodeports)
+	{
+		if( (c.m_port == NULL) || (c.m_port->m_direction != Greenpak4NetlistPort::DIR_OUTPUT) )
+			return true;
+	}
+	return false;
+}
+
+/**
+	@brief Moves every cell input reading one net over to another net
+
+	Nets that go to top-level ports are left alone, since the port needs the net. Returns true if anything moved.
+ */
+bool NetlistOptimizer::ReplaceNet(Greenpak4NetlistNode* from, Greenpak4NetlistNode* to)
+{
+	if( (from == to) || !from->m_ports.empty() )
+		return false;
+
+	bool changed = false;
+	for(auto& c : from->m_nodeports)
+	{
+		if( (c.m_port == NULL) || (c.m_port->m_direction != Greenpak4NetlistPort::DIR_INPUT) )
+			continue;
+		c.m_cell->m_connections[c.m_portname][c.m_nbit] = to;
+		changed = true;
+	}
+	return changed;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Passes
+
+/**
+	@brief Folds constant inputs of LUTs and inverters into their truth tables
+
+	A LUT input tied to a constant is left connected, but the truth table no longer depends on it, so it's dropped when
+	the LUT is placed. A LUT or inverter whose output ends up constant has its loads moved to the power rails.
+ */
+bool NetlistOptimizer::PropagateConstants()
+{
+	bool changed = false;
+	for(auto it = m_module->cell_begin(); it != m_module->cell_end(); it ++)
+	{
+		auto cell = it->second;
+		if(IsPinned(cell))
+			continue;
+
+		auto out = GetNet(cell, "OUT");
+		if(out == NULL)
+			continue;
+
+		if(cell->IsType(GP_PRIM_INV))
+		{
+			auto in = GetNet(cell, "IN");
+			if(IsConstant(in) && ReplaceNet(out, (in == m_vdd) ? m_vss : m_vdd) )
+			{
+				m_constantCells ++;
+				changed = true;
+			}
+			continue;
+		}
+
+		unsigned int order = GetLUTOrder(cell);
+		if(order == 0)
+			continue;
+		unsigned int nbits = 1 << order;
+		uint32_t table = GetLUTTable(cell);
+
+		//Replace each constant input with its value
+		for(unsigned int i=0; i<order; i++)
+		{
+			auto in = GetNet(cell, "IN" + to_string(i));
+			if(!IsConstant(in))
+				continue;
+
+			uint32_t folded = 0;
+			for(unsigned int j=0; j<nbits; j++)
+			{
+				unsigned int k = (in == m_vdd) ? (j | (1 << i)) : (j & ~(1 << i));
+				if( (table >> k) & 1 )
+					folded |= (1 << j);
+			}
+			if(folded != table)
+			{
+				table = folded;
+				m_tiedInputs ++;
+				changed = true;
+			}
+		}
+		SetLUTTable(cell, table);
+
+		//If nothing is left, the output is constant
+		uint32_t mask = (1u << nbits) - 1;
+		if( (table == 0) || (table == mask) )
+		{
+			if(ReplaceNet(out, table ? m_vdd : m_vss))
+			{
+				m_constantCells ++;
+				changed = true;
+			}
+		}
+	}
+
+	return changed;
+}
+
+/**
+	@brief Pushes GP_INV cells that only drive LUTs into the truth tables of those LUTs
+ */
+bool NetlistOptimizer::AbsorbInverters()
+{
+	//Nets that picked up new loads during this pass, so their index entries are out of date until the next one
+	set<Greenpak4NetlistNode*> dirty;
+
+	bool changed = false;
+	for(auto it = m_module->cell_begin(); it != m_module->cell_end(); it ++)
+	{
+		auto inv = it->second;
+		if(!inv->IsType(GP_PRIM_INV) || IsPinned(inv))
+			continue;
+		auto in = GetNet(inv, "IN");
+		auto out = GetNet(inv, "OUT");
+		if( (in == NULL) || (out == NULL) || !out->m_ports.empty() || (dirty.find(out) != dirty.end()) )
+			continue;
+
+		//Every load has to be a LUT input we can invert
+		bool ok = true;
+		unsigned int loads = 0;
+		for(auto& c : out->m_nodeports)
+		{
+			if(c.m_cell == inv)
+				continue;
+			loads ++;
+			if( (GetLUTOrder(c.m_cell) == 0) || IsPinned(c.m_cell) || (c.m_portname.compare(0, 2, "IN") != 0) )
+				ok = false;
+		}
+		if(!ok || (loads == 0) )
+			continue;
+
+		for(auto& c : out->m_nodeports)
+		{
+			if(c.m_cell == inv)
+				continue;
+
+			//Swap the halves of the truth table selected by this input
+			auto lut = c.m_cell;
+			unsigned int pin = atoi(c.m_portname.c_str() + 2);
+			unsigned int nbits = 1 << GetLUTOrder(lut);
+			uint32_t table = GetLUTTable(lut);
+			uint32_t inverted = 0;
+			for(unsigned int j=0; j<nbits; j++)
+			{
+				if( (table >> (j ^ (1 << pin))) & 1 )
+					inverted |= (1 << j);
+			}
+			SetLUTTable(lut, inverted);
+			lut->m_connections[c.m_portname][c.m_nbit] = in;
+		}
+		dirty.insert(in);
+
+		//The inverter has no loads now, the sweep takes care of it
+		m_absorbedInverters ++;
+		changed = true;
+	}
+
+	return changed;
+}
+
+/**
+	@brief Structural hashing: LUTs computing the same function of the same nets are merged, as are inverters of the
+	same net
+ */
+bool NetlistOptimizer::MergeDuplicates()
+{
+	bool changed = false;
+	map<vector<uintptr_t>, Greenpak4NetlistCell*> seen;
+	for(auto it = m_module->cell_begin(); it != m_module->cell_end(); it ++)
+	{
+		auto cell = it->second;
+		if(IsPinned(cell))
+			continue;
+		auto out = GetNet(cell, "OUT");
+		if( (out == NULL) || !out->m_ports.empty() )
+			continue;
+
+		//Key is the function plus the nets it reads, with unused inputs dropped and the rest in a fixed order
+		vector<uintptr_t> key;
+		if(cell->IsType(GP_PRIM_INV))
+		{
+			key.push_back(GP_PRIM_INV);
+			key.push_back(reinterpret_cast<uintptr_t>(GetNet(cell, "IN")));
+		}
+		else if(GetLUTOrder(cell) != 0)
+		{
+			Greenpak4LUT::InputMap map;
+			if(!Greenpak4LUT::MapCellInputs(cell, map))
+				continue;
+
+			//Sort the inputs by net so the same function of the same nets always looks the same
+			vector<pair<Greenpak4NetlistNode*, unsigned int> > inputs;
+			for(unsigned int i=0; i<4; i++)
+			{
+				if(map.m_pins[i] != Greenpak4LUT::PIN_DROPPED)
+					inputs.push_back(make_pair(GetNet(cell, "IN" + to_string(i)), map.m_pins[i]));
+			}
+			sort(inputs.begin(), inputs.end());
+
+			uint32_t table = 0;
+			for(unsigned int j=0; j < (1u << map.m_count); j++)
+			{
+				unsigned int k = 0;
+				for(unsigned int i=0; i<map.m_count; i++)
+				{
+					if( (j >> i) & 1 )
+						k |= (1 << inputs[i].second);
+				}
+				if( (map.m_table >> k) & 1 )
+					table |= (1 << j);
+			}
+
+			key.push_back(GP_PRIM_4LUT);
+			key.push_back(table);
+			for(auto& x : inputs)
+				key.push_back(reinterpret_cast<uintptr_t>(x.first));
+		}
+		else
+			continue;
+
+		auto sit = seen.find(key);
+		if(sit == seen.end())
+		{
+			seen[key] = cell;
+			continue;
+		}
+
+		if(ReplaceNet(out, GetNet(sit->second, "OUT")))
+		{
+			LogDebug("%s is a copy of %s\n", cell->m_name.c_str(), sit->second->m_name.c_str());
+			m_mergedCells ++;
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+/**
+	@brief Removes logic whose outputs aren't used
+ */
+bool NetlistOptimizer::SweepDeadCells()
+{
+	vector<Greenpak4NetlistCell*> dead;
+	for(auto it = m_module->cell_begin(); it != m_module->cell_end(); it ++)
+	{
+		auto cell = it->second;
+		if( (cell->m_primitive == NULL) || IsPinned(cell) )
+			continue;
+
+		//Only digital logic, whose only effect is its outputs.
+		//I/O, analog blocks, oscillators and the like are kept even if nothing in the netlist reads them.
+		switch(cell->m_primitive->m_type)
+		{
+			case GP_PRIM_2LUT:
+			case GP_PRIM_3LUT:
+			case GP_PRIM_4LUT:
+			case GP_PRIM_COUNT14:
+			case GP_PRIM_COUNT14_ADV:
+			case GP_PRIM_COUNT8:
+			case GP_PRIM_COUNT8_ADV:
+			case GP_PRIM_DELAY:
+			case GP_PRIM_DFF:
+			case GP_PRIM_DFFI:
+			case GP_PRIM_DFFR:
+			case GP_PRIM_DFFRI:
+			case GP_PRIM_DFFS:
+			case GP_PRIM_DFFSI:
+			case GP_PRIM_DFFSR:
+			case GP_PRIM_DFFSRI:
+			case GP_PRIM_EDGEDET:
+			case GP_PRIM_INV:
+			case GP_PRIM_PGEN:
+			case GP_PRIM_SHREG:
+				break;
+
+			default:
+				continue;
+		}
+
+		bool used = false;
+		for(auto& x : cell->m_connections)
+		{
+			auto port = cell->m_primitive->GetPort(cell->m_connections.GetName(x.first));
+			if( (port == NULL) || (port->m_direction == Greenpak4NetlistPort::DIR_INPUT) )
+				continue;
+			for(auto net : x.second)
+			{
+				if( (net != NULL) && HasLoads(net) )
+					used = true;
+			}
+		}
+		if(!used)
+			dead.push_back(cell);
+	}
+
+	for(auto cell : dead)
+	{
+		LogDebug("Removing %s (%s), nothing reads its outputs\n", cell->m_name.c_str(), cell->m_type.c_str());
+		m_module->RemoveCell(cell);
+	}
+	m_sweptCells += dead.size();
+	return !dead.empty();
+}
+
+void NetlistOptimizer::PrintReport()
+{
+	LogNotice("Constant propagation: %u LUT inputs folded, %u cells replaced by constants\n",
+		m_tiedInputs, m_constantCells);
+	LogNotice("Inverter absorption:  %u inverters absorbed into LUTs\n", m_absorbedInverters);
+	LogNotice("Structural hashing:   %u duplicate cells merged\n", m_mergedCells);
+	LogNotice("Dead cell sweep:      %u cells removed\n", m_sweptCells);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Pass table
+
+struct OptimizationPass
+{
+	const char* m_name;
+	bool (NetlistOptimizer::*m_run)();
+};
+
+//Every pass, in the order they're run
+static const OptimizationPass g_optimizationPasses[] =
+{
+	{ "constprop",	&NetlistOptimizer::PropagateConstants },
+	{ "absorb-inv",	&NetlistOptimizer::AbsorbInverters },
+	{ "strash",		&NetlistOptimizer::MergeDuplicates },
+	{ "sweep",		&NetlistOptimizer::SweepDeadCells },
+};
+
+/**
+	@brief Returns true if there is an optimization pass by this name ("all" stands for every pass)
+ */
+bool IsOptimizationPass(const string& name)
+{
+	if(name == "all")
+		return true;
+	for(auto& pass : g_optimizationPasses)
+	{
+		if(name == pass.m_name)
+			return true;
+	}
+	return false;
+}
+
+/**
+	@brief Optimize the netlist before placement
+
+	@param netlist		The netlist to optimize in place
+	@param disabled		Names of passes not to run ("all" turns off every pass)
+ */
+bool OptimizeNetlist(Greenpak4Netlist* netlist, const optpasses& disabled)
+{
+	if(disabled.find("all") != disabled.end())
+	{
+		LogNotice("All optimizations disabled\n");
+		return true;
+	}
+
+	NetlistOptimizer opt(netlist);
+
+	//Each pass can open up work for the others, so keep going until nothing changes
+	//(every change removes a cell, an input or a load, so this terminates)
+	bool changed = true;
+	while(changed)
+	{
+		changed = false;
+		for(auto& pass : g_optimizationPasses)
+		{
+			if(disabled.find(pass.m_name) != disabled.end())
+				continue;
+			if(!opt.Reindex())
+				return false;
+			if((opt.*pass.m_run)())
+				changed = true;
+		}
+	}
+
+	opt.PrintReport();
+	return opt.Reindex();
+}
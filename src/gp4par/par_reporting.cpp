@@ -20,33 +20,88 @@
 
 using namespace std;
 
-static void PrintRow(string kind, int used, int total)
+/**
+	@brief Adds one row to a utilization report
+ */
+static void AddRow(vector<UtilizationRow>& rows, string name, unsigned int used, unsigned int total, bool detail = false)
 {
-	if(total == 0)
-		return;
-
-	Severity severity = (used > 0) ? Severity::NOTICE : Severity::VERBOSE;
-	string padded_kind = kind + std::string(14 - kind.size(), ' ');
-	Log(severity, "%s%2d/%2d (%d %%)\n", padded_kind.c_str(), used, total, used*100/total);
+	UtilizationRow row;
+	row.m_name = name;
+	row.m_used = used;
+	row.m_total = total;
+	row.m_detail = detail;
+	rows.push_back(row);
 }
 
 /**
-	@brief Print the report showing how many resources were used
+	@brief Counts how many sites of each type are used, one Visit() per placed netlist node
  */
-void PrintUtilizationReport(PARGraph* netlist, Greenpak4Device* device, unsigned int* num_routes_used)
+class UtilizationCounter
 {
-	//Get resource counts from the whole device
-	unsigned int lut_counts[5] =
+public:
+	void Visit(Greenpak4LUT* lut)
+	{ luts_used[lut->GetOrder()] ++; }
+
+	void Visit(Greenpak4IOB* /*iob*/)
+	{ iobs_used ++; }
+
+	void Visit(Greenpak4Flipflop* ff)
 	{
-		0,	//no LUT0
-		0,	//no LUT1
-		device->GetLUT2Count(),
-		device->GetLUT3Count(),
-		device->GetLUT4Count()
-	};
+		if(ff->HasSetReset())
+			dffsr_used ++;
+		else
+			dff_used ++;
+	}
+
+	void Visit(Greenpak4Counter* count)
+	{
+		if(count->HasFSM())
+		{
+			if(count->GetDepth() == 8)
+				counters_8_adv_used ++;
+			else
+				counters_14_adv_used ++;
+		}
+		else
+		{
+			if(count->GetDepth() == 8)
+				counters_8_used ++;
+			else
+				counters_14_used ++;
+		}
+	}
+
+	void Visit(Greenpak4Inverter* /*inv*/)
+	{ inv_used ++; }
+
+	void Visit(Greenpak4Bandgap* /*bandgap*/)
+	{ bandgap_used ++; }
+
+	void Visit(Greenpak4PowerOnReset* /*por*/)
+	{ por_used ++; }
+
+	void Visit(Greenpak4ShiftRegister* /*shreg*/)
+	{ shreg_used ++; }
+
+	void Visit(Greenpak4VoltageReference* /*vref*/)
+	{ vref_used ++; }
+
+	void Visit(Greenpak4Comparator* /*acmp*/)
+	{ acmp_used ++; }
+
+	void Visit(Greenpak4PGA* /*pga*/)
+	{ pga_used ++; }
+
+	void Visit(Greenpak4Abuf* /*abuf*/)
+	{ abuf_used ++; }
+
+	void Visit(Greenpak4Delay* /*delay*/)
+	{ delay_used ++; }
+
+	//Everything else isn't counted here (oscillators and SYSRST are checked directly below)
+	void Visit(Greenpak4BitstreamEntity* /*entity*/)
+	{}
 
-	//Loop over nodes, find how many of each type were used
-	//TODO: use PAR labels for this?
 	unsigned int luts_used[5] = {0};
 	unsigned int iobs_used = 0;
 	unsigned int dff_used = 0;
@@ -55,10 +110,6 @@ void PrintUtilizationReport(PARGraph* netlist, Greenpak4Device* device, unsigned
 	unsigned int counters_8_adv_used = 0;
 	unsigned int counters_14_used = 0;
 	unsigned int counters_14_adv_used = 0;
-	unsigned int lfosc_used = 0;
-	unsigned int ringosc_used = 0;
-	unsigned int rcosc_used = 0;
-	unsigned int sysrst_used = 0;
 	unsigned int inv_used = 0;
 	unsigned int bandgap_used = 0;
 	unsigned int por_used = 0;
@@ -68,59 +119,39 @@ void PrintUtilizationReport(PARGraph* netlist, Greenpak4Device* device, unsigned
 	unsigned int pga_used = 0;
 	unsigned int abuf_used = 0;
 	unsigned int delay_used = 0;
+};
+
+/**
+	@brief Find how many resources of each type were used, in the order the utilization report lists them
+ */
+void GetUtilization(
+	PARGraph* netlist,
+	Greenpak4Device* device,
+	unsigned int* num_routes_used,
+	vector<UtilizationRow>& rows)
+{
+	//Get resource counts from the whole device
+	unsigned int lut_counts[5] =
+	{
+		0,	//no LUT0
+		0,	//no LUT1
+		device->GetLUT2Count(),
+		device->GetLUT3Count(),
+		device->GetLUT4Count()
+	};
+
+	//Loop over nodes, find how many of each type were used
+	//TODO: use PAR labels for this?
+	UtilizationCounter used;
 	for(uint32_t i=0; i<netlist->GetNumNodes(); i++)
 	{
 		auto entity = static_cast<Greenpak4BitstreamEntity*>(netlist->GetNodeByIndex(i)->GetMate()->GetData());
-		auto lut = dynamic_cast<Greenpak4LUT*>(entity);
-		auto ff = dynamic_cast<Greenpak4Flipflop*>(entity);
-		auto count = dynamic_cast<Greenpak4Counter*>(entity);
-		if(lut)
-			luts_used[lut->GetOrder()] ++;
-		else if(dynamic_cast<Greenpak4IOB*>(entity) != NULL)
-			iobs_used ++;
-		else if(ff)
-		{
-			if(ff->HasSetReset())
-				dffsr_used ++;
-			else
-				dff_used ++;
-		}
-		else if(count)
-		{
-			if(count->HasFSM())
-			{
-				if(count->GetDepth() == 8)
-					counters_8_adv_used ++;
-				else
-					counters_14_adv_used ++;
-			}
-			else
-			{
-				if(count->GetDepth() == 8)
-					counters_8_used ++;
-				else
-					counters_14_used ++;
-			}
-		}
-		else if(dynamic_cast<Greenpak4Inverter*>(entity))
-			inv_used ++;
-		else if(dynamic_cast<Greenpak4Bandgap*>(entity))
-			bandgap_used ++;
-		else if(dynamic_cast<Greenpak4PowerOnReset*>(entity))
-			por_used ++;
-		else if(dynamic_cast<Greenpak4ShiftRegister*>(entity))
-			shreg_used ++;
-		else if(dynamic_cast<Greenpak4VoltageReference*>(entity))
-			vref_used ++;
-		else if(dynamic_cast<Greenpak4Comparator*>(entity))
-			acmp_used ++;
-		else if(dynamic_cast<Greenpak4PGA*>(entity))
-			pga_used ++;
-		else if(dynamic_cast<Greenpak4Abuf*>(entity))
-			abuf_used ++;
-		else if(dynamic_cast<Greenpak4Delay*>(entity))
-			delay_used ++;
+		Greenpak4VisitEntity(entity, used);
 	}
+	unsigned int lfosc_used = 0;
+	unsigned int ringosc_used = 0;
+	unsigned int rcosc_used = 0;
+	unsigned int sysrst_used = 0;
 	if(device->GetLFOscillator()->GetPARNode()->GetMate() != NULL)
 		lfosc_used = 1;
 	if(device->GetRingOscillator()->GetPARNode()->GetMate() != NULL)
@@ -130,48 +161,63 @@ void PrintUtilizationReport(PARGraph* netlist, Greenpak4Device* device, unsigned
 	if(device->GetSystemReset()->GetPARNode()->GetMate() != NULL)
 		sysrst_used = 1;
 
-	//Print the actual report
+	unsigned int total_dff_used = used.dff_used + used.dffsr_used;
+	unsigned int total_luts_used = used.luts_used[2] + used.luts_used[3] + used.luts_used[4];
+	unsigned int total_counters_used = used.counters_8_used + used.counters_8_adv_used +
+									    used.counters_14_used + used.counters_14_adv_used;
+	unsigned int total_luts_count = lut_counts[2] + lut_counts[3] + lut_counts[4];
+	unsigned int total_routes_used = num_routes_used[0] + num_routes_used[1];
+	AddRow(rows, "ABUF",		used.abuf_used,				1);
+	AddRow(rows, "ACMP",		used.acmp_used,				device->GetAcmpCount());
+	AddRow(rows, "BANDGAP",		used.bandgap_used,			1);
+	AddRow(rows, "COUNT",		total_counters_used,		device->GetCounterCount());
+	AddRow(rows, "COUNT8",		used.counters_8_used,		device->Get8BitCounterCount(false), true);
+	AddRow(rows, "COUNT8_ADV",	used.counters_8_adv_used,	device->Get8BitCounterCount(true), true);
+	AddRow(rows, "COUNT14",		used.counters_14_used,		device->Get14BitCounterCount(false), true);
+	AddRow(rows, "COUNT14_ADV",	used.counters_14_adv_used,	device->Get14BitCounterCount(true), true);
+	AddRow(rows, "DELAY",		used.delay_used,			device->GetDelayCount());
+	//TODO: print {as DELAY / as EDGEDET}
+	AddRow(rows, "FF",			total_dff_used,				device->GetTotalFFCount());
+	AddRow(rows, "DFF",			used.dff_used,				device->GetDFFCount(), true);
+	AddRow(rows, "DFFSR",		used.dffsr_used,			device->GetDFFSRCount(), true);
+	AddRow(rows, "IOB",			used.iobs_used,				device->GetIOBCount());
+	AddRow(rows, "INV",			used.inv_used,				device->GetInverterCount());
+	AddRow(rows, "LFOSC",		lfosc_used,					1);
+	AddRow(rows, "LUT",			total_luts_used,			total_luts_count);
+	for(unsigned int i=2; i<=4; i++)
+		AddRow(rows, string("LUT") + std::to_string(i), used.luts_used[i], lut_counts[i], true);
+	AddRow(rows, "PGA",			used.pga_used,				1);
+	AddRow(rows, "POR",			used.por_used,				1);
+	AddRow(rows, "RCOSC",		rcosc_used,					1);
+	AddRow(rows, "RINGOSC",		ringosc_used,				1);
+	AddRow(rows, "SHREG",		used.shreg_used,			device->GetShiftRegisterCount());
+	AddRow(rows, "SYSRST",		sysrst_used,				1);
+	AddRow(rows, "VREF",		used.vref_used,				device->GetVrefCount());
+	AddRow(rows, "X-conn",		total_routes_used,			device->GetCrossConnectionCount() * 2);
+	AddRow(rows, "East",		num_routes_used[0],			device->GetCrossConnectionCount(), true);
+	AddRow(rows, "West",		num_routes_used[1],			device->GetCrossConnectionCount(), true);
+}
+
+/**
+	@brief Print the report showing how many resources were used
+ */
+void PrintUtilizationReport(const vector<UtilizationRow>& rows)
+{
 	//TODO: Figure out how to use indentation framework here for better columnar indents?
 
 	LogNotice("\nDevice utilization:\n");
 	LogIndenter li;
 
-	unsigned int total_dff_used = dff_used + dffsr_used;
-	unsigned int total_luts_used = luts_used[2] + luts_used[3] + luts_used[4];
-	unsigned int total_counters_used = counters_8_used + counters_8_adv_used +
-									    counters_14_used + counters_14_adv_used;
-	unsigned int total_luts_count = lut_counts[2] + lut_counts[3] + lut_counts[4];
-	unsigned int total_routes_used = num_routes_used[0] + num_routes_used[1];
-	PrintRow("ABUF:",			abuf_used,				1);
-	PrintRow("ACMP:",			acmp_used,				device->GetAcmpCount());
-	PrintRow("BANDGAP:",		bandgap_used,			1);
-	PrintRow("COUNT:",			total_counters_used,	device->GetCounterCount());
-	PrintRow("  COUNT8:",		counters_8_used,		device->Get8BitCounterCount(false));
-	PrintRow("  COUNT8_ADV:",	counters_8_adv_used,	device->Get8BitCounterCount(true));
-	PrintRow("  COUNT14:",		counters_14_used,		device->Get14BitCounterCount(false));
-	PrintRow("  COUNT14_ADV:",	counters_14_adv_used,	device->Get14BitCounterCount(true));
-	PrintRow("DELAY:",			delay_used,				device->GetDelayCount());
-	//TODO: print {as DELAY / as EDGEDET}
-	PrintRow("FF:",				total_dff_used,			device->GetTotalFFCount());
-	PrintRow("  DFF:",			dff_used,				device->GetDFFCount());
-	PrintRow("  DFFSR:",		dffsr_used,				device->GetDFFSRCount());
-	PrintRow("IOB:",			iobs_used,				device->GetIOBCount());
-	PrintRow("INV:",			inv_used,				device->GetInverterCount());
-	PrintRow("LFOSC:",			lfosc_used,				1);
-	PrintRow("LUT:",			total_luts_used,		total_luts_count);
-	for(unsigned int i=2; i<=4; i++)
-		PrintRow(string("  LUT") + std::to_string(i),
-		         				luts_used[i],			lut_counts[i]);
-	PrintRow("PGA:",			pga_used,				1);
-	PrintRow("POR:",			por_used,				1);
-	PrintRow("RCOSC:",			rcosc_used,				1);
-	PrintRow("RINGOSC:",		ringosc_used,			1);
-	PrintRow("SHREG:",			shreg_used,				device->GetShiftRegisterCount());
-	PrintRow("SYSRST:",			sysrst_used,			1);
-	PrintRow("VREF:",			vref_used,				device->GetVrefCount());
-	PrintRow("X-conn:",			total_routes_used,		20);
-	PrintRow("  East:",			num_routes_used[0],		10);
-	PrintRow("  West:",			num_routes_used[1],		10);
+	for(auto& row : rows)
+	{
+		if(row.m_total == 0)
+			continue;
+
+		Severity severity = (row.m_used > 0) ? Severity::NOTICE : Severity::VERBOSE;
+		string kind = (row.m_detail ? "  " : "") + row.m_name + ":";
+		string padded_kind = kind + std::string(14 - kind.size(), ' ');
+		Log(severity, "%s%2u/%2u (%u %%)\n", padded_kind.c_str(), row.m_used, row.m_total, row.m_used*100/row.m_total);
+	}
 }
 
 /**
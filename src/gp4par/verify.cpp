@@ -0,0 +1,522 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include "gp4par.h"
+
+using namespace std;
+
+//Random stimulus: this many lanes for this many oscillator ticks
+static const unsigned int VERIFY_LANES = 256;
+static const unsigned int VERIFY_CYCLES = 1024;
+
+//Upper bound on simulation passes spent shrinking a counterexample
+static const unsigned int MAX_SHRINK_PASSES = 4096;
+
+/**
+	@brief Checks a bitstream against the netlist it was made from, by simulating both on the same random stimulus
+ */
+class EquivalenceChecker
+{
+public:
+	EquivalenceChecker()
+		: m_golden(VERIFY_LANES)
+		, m_dut(VERIFY_LANES)
+		, m_rng(0x5eed5eed5eed5eedULL)
+	{}
+
+	bool BuildNetlistModel(Greenpak4NetlistModule* module, const placementmap& placement);
+	bool BuildBitstreamModel(Greenpak4Device* device);
+	bool MatchPorts();
+
+	bool Run();
+
+protected:
+
+	///Input values of one lane, [cycle][input of the bitstream model]
+	typedef vector< vector<bool> > Stimulus;
+
+	struct Failure
+	{
+		unsigned int m_cycle;
+		unsigned int m_output;
+	};
+
+	uint64_t Random();
+	unsigned int GetSignal(Greenpak4NetlistNode* node);
+
+	void Pack(const vector<Stimulus>& lanes, vector<uint64_t>& packed, unsigned int& cycles);
+	void Simulate(const vector<uint64_t>& packed, unsigned int cycles, vector<Failure>& failures);
+	void Shrink(Stimulus& cex, Failure& failure);
+	void Report(const Stimulus& cex, const Failure& failure);
+
+	///The netlist (reference) and bitstream (device under test) models
+	Greenpak4Simulator m_golden;
+	Greenpak4Simulator m_dut;
+
+	///Netlist model input for each bitstream model input (NONE if the netlist doesn't use that pin)
+	vector<unsigned int> m_inputs;
+
+	///(netlist model output, bitstream model output) pairs
+	vector< pair<unsigned int, unsigned int> > m_outputs;
+
+	unordered_map<Greenpak4NetlistNode*, unsigned int> m_signals;
+
+	uint64_t m_rng;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Model construction
+
+/**
+	@brief Random stimulus (xorshift64*, so runs are repeatable)
+ */
+uint64_t EquivalenceChecker::Random()
+{
+	m_rng ^= m_rng >> 12;
+	m_rng ^= m_rng << 25;
+	m_rng ^= m_rng >> 27;
+	return m_rng * 0x2545f4914f6cdd1dULL;
+}
+
+unsigned int EquivalenceChecker::GetSignal(Greenpak4NetlistNode* node)
+{
+	auto it = m_signals.find(node);
+	if(it != m_signals.end())
+		return it->second;
+
+	unsigned int signal = m_golden.AddSignal();
+	m_signals[node] = signal;
+	return signal;
+}
+
+/**
+	@brief Builds the reference model straight from the primitives in the netlist
+
+	Cells are named after the sites they were placed at, and pins after the pin numbers, so both models have the same
+	inputs and outputs.
+ */
+bool EquivalenceChecker::BuildNetlistModel(Greenpak4NetlistModule* module, const placementmap& placement)
+{
+	for(auto it = module->cell_begin(); it != module->cell_end(); it ++)
+	{
+		auto cell = it->second;
+		if(cell->m_primitive == NULL)
+		{
+			LogError("Cell \"%s\" is of type %s, which is not a GreenPAK primitive\n",
+				cell->m_name.c_str(), cell->m_type.c_str());
+			return false;
+		}
+
+		string name = cell->m_name;
+		auto pit = placement.find(cell);
+		Greenpak4BitstreamEntity* site = (pit != placement.end()) ? pit->second : NULL;
+		if(site != NULL)
+			name = site->GetDescription();
+
+		map<string, string> params;
+		for(auto& x : cell->m_parameters)
+			params[cell->m_parameters.GetName(x.first)] = x.second;
+
+		map<string, unsigned int> pins;
+		for(auto& x : cell->m_connections)
+		{
+			//Multi-bit ports only go to analog blocks
+			if(x.second.size() != 1)
+				continue;
+			pins[cell->m_connections.GetName(x.first)] = GetSignal(x.second[0]);
+		}
+
+		auto type = cell->m_primitive->m_type;
+		if(!m_golden.AddCell(type, name, params, pins))
+			return false;
+
+		//Pads
+		const char* padpin = Greenpak4Simulator::GetPadPin(type);
+		if(padpin == NULL)
+			continue;
+		if( (site == NULL) || !site->HasCapability(Greenpak4BitstreamEntity::CAP_IOB) )
+		{
+			LogError("IO buffer \"%s\" was not placed at a pin\n", cell->m_name.c_str());
+			return false;
+		}
+		string pad = Greenpak4Simulator::GetPadName(static_cast<Greenpak4IOB*>(site)->GetPinNumber());
+
+		switch(type)
+		{
+			case GP_PRIM_IBUF:
+				m_golden.AddInput(pad, pins[padpin]);
+				break;
+
+			case GP_PRIM_OBUF:
+				m_golden.AddOutput(pad, pins["IN"]);
+				break;
+
+			case GP_PRIM_OBUFT:
+				m_golden.AddOutput(pad, pins["IN"], pins["OE"]);
+				break;
+
+			case GP_PRIM_IOBUF:
+				m_golden.AddInput(pad, pins[padpin]);
+				m_golden.AddOutput(pad, pins["IN"], pins["OE"]);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	m_golden.Finalize();
+	return true;
+}
+
+bool EquivalenceChecker::BuildBitstreamModel(Greenpak4Device* device)
+{
+	return m_dut.LoadDevice(device);
+}
+
+/**
+	@brief Lines up the inputs and outputs of the two models by name
+ */
+bool EquivalenceChecker::MatchPorts()
+{
+	bool ok = true;
+
+	for(unsigned int i=0; i<m_dut.GetInputCount(); i++)
+		m_inputs.push_back(m_golden.FindInput(m_dut.GetInputName(i)));
+	for(unsigned int i=0; i<m_golden.GetInputCount(); i++)
+	{
+		if(m_dut.FindInput(m_golden.GetInputName(i)) == Greenpak4Simulator::NONE)
+		{
+			LogError("Netlist reads %s, which is not an input in the bitstream\n", m_golden.GetInputName(i).c_str());
+			ok = false;
+		}
+	}
+
+	for(unsigned int i=0; i<m_golden.GetOutputCount(); i++)
+	{
+		unsigned int out = m_dut.FindOutput(m_golden.GetOutputName(i));
+		if(out == Greenpak4Simulator::NONE)
+		{
+			LogError("Netlist drives %s, which is not an output in the bitstream\n", m_golden.GetOutputName(i).c_str());
+			ok = false;
+		}
+		else
+			m_outputs.push_back(pair<unsigned int, unsigned int>(i, out));
+	}
+	for(unsigned int i=0; i<m_dut.GetOutputCount(); i++)
+	{
+		if(m_golden.FindOutput(m_dut.GetOutputName(i)) == Greenpak4Simulator::NONE)
+		{
+			LogError("Bitstream drives %s, which is not an output in the netlist\n", m_dut.GetOutputName(i).c_str());
+			ok = false;
+		}
+	}
+
+	return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Simulation
+
+/**
+	@brief Packs one stimulus per lane into words, [cycle][input][word]
+
+	Lanes past the end of their stimulus hold their last values, unused lanes are all low.
+ */
+void EquivalenceChecker::Pack(const vector<Stimulus>& lanes, vector<uint64_t>& packed, unsigned int& cycles)
+{
+	unsigned int words = m_dut.GetWordCount();
+	cycles = 0;
+	for(auto& s : lanes)
+		cycles = max(cycles, (unsigned int)s.size());
+
+	packed.assign(cycles * m_inputs.size() * words, 0);
+	for(size_t lane=0; lane<lanes.size(); lane++)
+	{
+		auto& s = lanes[lane];
+		for(unsigned int c=0; (c < cycles) && !s.empty(); c++)
+		{
+			auto& v = s[min(c, (unsigned int)s.size() - 1)];
+			for(unsigned int i=0; i<m_inputs.size(); i++)
+			{
+				if(v[i])
+					packed[(c*m_inputs.size() + i)*words + lane/64] |= (1ULL << (lane % 64));
+			}
+		}
+	}
+}
+
+/**
+	@brief Runs both models on packed stimulus, and finds the first divergence in each lane
+
+	The first failure of lane i goes in failures[i]; m_cycle is NONE if the lane never diverged.
+ */
+void EquivalenceChecker::Simulate(const vector<uint64_t>& packed, unsigned int cycles, vector<Failure>& failures)
+{
+	Failure pass = { Greenpak4Simulator::NONE, Greenpak4Simulator::NONE };
+	failures.assign(m_dut.GetLaneCount(), pass);
+
+	m_golden.Reset();
+	m_dut.Reset();
+	unsigned int words = m_dut.GetWordCount();
+	const uint64_t* p = packed.empty() ? NULL : &packed[0];
+	for(unsigned int c=0; c<cycles; c++)
+	{
+		for(unsigned int i=0; i<m_inputs.size(); i++)
+		{
+			for(unsigned int w=0; w<words; w++)
+			{
+				m_dut.SetInput(i, w, *p);
+				if(m_inputs[i] != Greenpak4Simulator::NONE)
+					m_golden.SetInput(m_inputs[i], w, *p);
+				p++;
+			}
+		}
+
+		m_golden.Step();
+		m_dut.Step();
+
+		//An output diverges if one model drives it and the other doesn't, or they drive different values
+		for(unsigned int o=0; o<m_outputs.size(); o++)
+		{
+			unsigned int g = m_outputs[o].first;
+			unsigned int d = m_outputs[o].second;
+			for(unsigned int w=0; w<words; w++)
+			{
+				uint64_t ge = m_golden.GetOutputEnable(g, w);
+				uint64_t diff =
+					(ge ^ m_dut.GetOutputEnable(d, w)) | (ge & (m_golden.GetOutput(g, w) ^ m_dut.GetOutput(d, w)));
+				while(diff)
+				{
+					unsigned int lane = w*64 + __builtin_ctzll(diff);
+					diff &= diff - 1;
+					if(failures[lane].m_cycle == Greenpak4Simulator::NONE)
+					{
+						failures[lane].m_cycle = c;
+						failures[lane].m_output = o;
+					}
+				}
+			}
+		}
+	}
+}
+
+/**
+	@brief Random simulation of both models. Returns true if they agree
+ */
+bool EquivalenceChecker::Run()
+{
+	//Random values for every input, every cycle, in every lane
+	unsigned int lanes = m_dut.GetLaneCount();
+	unsigned int words = m_dut.GetWordCount();
+	vector<uint64_t> packed(VERIFY_CYCLES * m_inputs.size() * words);
+	for(auto& w : packed)
+		w = Random();
+
+	vector<Failure> failures;
+	Simulate(packed, VERIFY_CYCLES, failures);
+
+	//Start from the lane that went wrong first
+	unsigned int worst = Greenpak4Simulator::NONE;
+	for(unsigned int lane=0; lane<lanes; lane++)
+	{
+		if(failures[lane].m_cycle == Greenpak4Simulator::NONE)
+			continue;
+		if( (worst == Greenpak4Simulator::NONE) || (failures[lane].m_cycle < failures[worst].m_cycle) )
+			worst = lane;
+	}
+
+	if(worst == Greenpak4Simulator::NONE)
+	{
+		LogNotice("%u outputs agree over %u random stimuli of %u cycles\n",
+			(unsigned int)m_outputs.size(), lanes, VERIFY_CYCLES);
+		return true;
+	}
+
+	//Unpack that lane, up to the failure
+	Failure failure = failures[worst];
+	Stimulus cex(failure.m_cycle + 1, vector<bool>(m_inputs.size()));
+	for(unsigned int c=0; c<cex.size(); c++)
+	{
+		for(unsigned int i=0; i<m_inputs.size(); i++)
+			cex[c][i] = (packed[(c*m_inputs.size() + i)*words + worst/64] >> (worst % 64)) & 1;
+	}
+	Shrink(cex, failure);
+	Report(cex, failure);
+	return false;
+}
+
+/**
+	@brief Makes a counterexample as short and quiet as possible
+
+	Each candidate undoes one input transition (sets a bit to its value in the previous cycle). A whole lane-width of
+	candidates is tried per pass, and the one that still fails soonest is kept, until nothing can be removed.
+ */
+void EquivalenceChecker::Shrink(Stimulus& cex, Failure& failure)
+{
+	unsigned int lanes = m_dut.GetLaneCount();
+	vector<Stimulus> batch;
+	vector<uint64_t> packed;
+	vector<Failure> failures;
+
+	for(unsigned int pass=0; pass<MAX_SHRINK_PASSES; )
+	{
+		//Every transition that could be removed
+		vector< pair<unsigned int, unsigned int> > candidates;
+		for(unsigned int c=0; c<cex.size(); c++)
+		{
+			for(unsigned int i=0; i<m_inputs.size(); i++)
+			{
+				bool quiet = (c > 0) ? cex[c-1][i] : false;
+				if(cex[c][i] != quiet)
+					candidates.push_back(pair<unsigned int, unsigned int>(c, i));
+			}
+		}
+
+		bool progress = false;
+		for(size_t start=0; (start < candidates.size()) && !progress && (pass < MAX_SHRINK_PASSES); start += lanes)
+		{
+			pass ++;
+			batch.clear();
+			for(size_t k=start; (k < candidates.size()) && (batch.size() < lanes); k++)
+			{
+				auto& e = candidates[k];
+				batch.push_back(cex);
+				batch.back()[e.first][e.second] = !cex[e.first][e.second];
+			}
+
+			unsigned int cycles;
+			Pack(batch, packed, cycles);
+			Simulate(packed, cycles, failures);
+			unsigned int best = Greenpak4Simulator::NONE;
+			for(unsigned int k=0; k<batch.size(); k++)
+			{
+				if(failures[k].m_cycle == Greenpak4Simulator::NONE)
+					continue;
+				if( (best == Greenpak4Simulator::NONE) || (failures[k].m_cycle < failures[best].m_cycle) )
+					best = k;
+			}
+
+			if(best != Greenpak4Simulator::NONE)
+			{
+				cex = batch[best];
+				failure = failures[best];
+				cex.resize(failure.m_cycle + 1);
+				progress = true;
+			}
+		}
+
+		if(!progress)
+			break;
+	}
+}
+
+/**
+	@brief Prints a counterexample, listing only the inputs that are ever high
+ */
+void EquivalenceChecker::Report(const Stimulus& cex, const Failure& failure)
+{
+	vector<Stimulus> lanes(1, cex);
+	vector<uint64_t> packed;
+	unsigned int cycles;
+	vector<Failure> failures;
+	Pack(lanes, packed, cycles);
+	Simulate(packed, cycles, failures);
+
+	unsigned int g = m_outputs[failure.m_output].first;
+	unsigned int d = m_outputs[failure.m_output].second;
+	auto value = [](bool enable, bool v) { return enable ? (v ? "1" : "0") : "Z"; };
+
+	string msg;
+	Greenpak4AppendFormat(msg, "Bitstream does not match the netlist: %s is %s but should be %s after %u cycles.\n",
+		m_golden.GetOutputName(g).c_str(),
+		value(m_dut.GetOutputEnable(d, 0) & 1, m_dut.GetOutput(d, 0) & 1),
+		value(m_golden.GetOutputEnable(g, 0) & 1, m_golden.GetOutput(g, 0) & 1),
+		(unsigned int)cex.size());
+
+	vector<unsigned int> active;
+	for(unsigned int i=0; i<m_inputs.size(); i++)
+	{
+		for(auto& c : cex)
+		{
+			if(c[i])
+			{
+				active.push_back(i);
+				break;
+			}
+		}
+	}
+
+	if(active.empty())
+		Greenpak4AppendFormat(msg, "    Counterexample: all inputs low\n");
+	else
+	{
+		Greenpak4AppendFormat(msg, "    Counterexample (inputs not listed are low):\n");
+		Greenpak4AppendFormat(msg, "    %-10s", "Cycle");
+		for(auto i : active)
+			Greenpak4AppendFormat(msg, " %-10s", m_dut.GetInputName(i).c_str());
+		Greenpak4AppendFormat(msg, "\n");
+		for(unsigned int c=0; c<cex.size(); c++)
+		{
+			Greenpak4AppendFormat(msg, "    %-10u", c);
+			for(auto i : active)
+				Greenpak4AppendFormat(msg, " %-10d", cex[c][i] ? 1 : 0);
+			Greenpak4AppendFormat(msg, "\n");
+		}
+	}
+
+	LogError("%s", msg.c_str());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Entry point
+
+/**
+	@brief Reads back a bitstream and checks it against the netlist
+
+	Both are simulated side by side on the same random stimulus (see Greenpak4Simulator for what is modeled). The
+	first divergence is reduced to a short counterexample and reported.
+
+	@param netlist		The netlist the bitstream was made from
+	@param part			Device the bitstream is for
+	@param fname		The bitstream file
+	@param placement	Site each netlist cell was placed at
+ */
+bool VerifyBitstream(
+	Greenpak4Netlist* netlist,
+	Greenpak4Device::GREENPAK4_PART part,
+	string fname,
+	const placementmap& placement)
+{
+	Greenpak4Device device(part);
+	uint8_t userid;
+	bool readProtect;
+	if(!device.LoadFromFile(fname, userid, readProtect))
+		return false;
+
+	EquivalenceChecker checker;
+	if(!checker.BuildNetlistModel(netlist->GetTopModule(), placement))
+		return false;
+	if(!checker.BuildBitstreamModel(&device))
+		return false;
+	if(!checker.MatchPorts())
+		return false;
+
+	return checker.Run();
+}
@@ -19,17 +19,19 @@
 #include <cstring>
 #include <cmath>
 #include <unistd.h>
+#include <memory>
 #include <log.h>
 #include <gpdevboard.h>
+#include <Greenpak4.h>
 
 using namespace std;
 
 void ShowUsage();
 void ShowVersion();
 
-const char *BitFunction(SilegoPart part, size_t bitno);
+string BitFunction(SilegoPart part, size_t bitno);
 
-void WriteBitstream(string fname, vector<uint8_t> bitstream);
+bool WriteBitstream(string fname, const vector<uint8_t>& bitstream);
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Entry point
@@ -42,8 +44,10 @@ int main(int argc, char* argv[])
 	bool test = false;
 	unsigned rcOscFreq = 0;
 	string downloadFilename, uploadFilename;
+	string convertInput, convertOutput;
 	bool programNvram = false;
 	bool force = false;
+	bool ignorePart = false;
 	uint8_t patternId = 0;
 	bool readProtect = false;
 	double voltage = 0.0;
@@ -85,6 +89,19 @@ int main(int argc, char* argv[])
 				return 1;
 			}
 		}
+		else if(s == "--convert")
+		{
+			if(i+2 < argc)
+			{
+				convertInput = argv[++i];
+				convertOutput = argv[++i];
+			}
+			else
+			{
+				printf("--convert requires two arguments\n");
+				return 1;
+			}
+		}
 		else if(s == "-t" || s == "--test-socket")
 			test = true;
 		else if(s == "-T" || s == "--trim")
@@ -145,6 +162,8 @@ int main(int argc, char* argv[])
 		}
 		else if(s == "--force")
 			force = true;
+		else if(s == "--ignore-part")
+			ignorePart = true;
 		else if(s == "--pattern-id")
 		{
 			if(i+1 < argc)
@@ -266,6 +285,20 @@ int main(int argc, char* argv[])
 	if(console_verbosity >= Severity::NOTICE)
 		ShowVersion();
 
+	//Format conversion doesn't need the board
+	if(!convertInput.empty())
+	{
+		vector<uint8_t> bitstream;
+		SilegoPart part;
+		if(!LoadBitstream(convertInput, bitstream, part))
+			return 1;
+
+		LogNotice("Writing bitstream to %s\n", convertOutput.c_str());
+		if(!WriteBitstream(convertOutput, bitstream))
+			return 1;
+		return 0;
+	}
+
 	//Open the dev board
 	hdevice hdev = OpenBoard();
 	if(!hdev)
@@ -322,7 +355,11 @@ int main(int argc, char* argv[])
 	if(!uploadFilename.empty())
 	{
 		LogNotice("Writing programmed bitstream to %s\n", uploadFilename.c_str());
-		WriteBitstream(uploadFilename, programmedBitstream);
+		if(!WriteBitstream(uploadFilename, programmedBitstream))
+		{
+			SetStatusLED(hdev, 0);
+			return 1;
+		}
 	}
 
 	//Do a socket test before doing anything else, to catch failures early
@@ -369,7 +406,7 @@ int main(int argc, char* argv[])
 	{
 		//Read the bitstream and check that it's the right size
 		vector<uint8_t> newBitstream;
-		if(!ReadBitstream(downloadFilename, newBitstream, detectedPart))
+		if(!ReadBitstream(downloadFilename, newBitstream, detectedPart, ignorePart))
 		{
 			SetStatusLED(hdev, 0);
 			return 1;
@@ -412,13 +449,9 @@ int main(int argc, char* argv[])
 					          i, (int)expectedBit, (int)actualBit);
 					failed = true;
 
-					//Explain what undocumented bits do; most of these are also trimming values, and so
+					//Explain what the bit does; many undocumented bits are trimming values, and so
 					//it is normal for them to vary even if flashing the exact same bitstream many times.
-					const char *bitFunction = BitFunction(detectedPart, i);
-					if(bitFunction)
-						LogNotice(" (bit meaning: %s)\n", bitFunction);
-					else
-						LogNotice("\n");
+					LogNotice(" (bit meaning: %s)\n", BitFunction(detectedPart, i).c_str());
 				}
 			}
 
@@ -490,6 +523,7 @@ void ShowUsage()
 {
 	printf(//                                                                               v 80th column
 		"Usage: gp4prog bitstream.txt\n"
+		"       gp4prog bitstream.gp4b\n"
 		"    When run with no arguments, scans for the board but makes no config changes.\n"
 		"    -q, --quiet\n"
 		"        Causes only warnings and errors to be written to the console.\n"
@@ -500,6 +534,11 @@ void ShowUsage()
 		"        Prints lots of internal debugging information.\n"
 		"    --force\n"
 		"        Perform actions that may be potentially inadvisable.\n"
+		"    --ignore-part\n"
+		"        Download a binary bitstream even if it was built for a different part.\n"
+		"    --convert            <input bitstream> <output bitstream>\n"
+		"        Converts a bitstream (text, or binary from gp4par --output-format binary)\n"
+		"        to the text format and exits without touching the board.\n"
 		"\n"
 		"    The following options are instructions for the developer board. They are\n"
 		"    executed in the order listed here, regardless of their order on command line.\n"
@@ -543,85 +582,61 @@ void ShowVersion()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Part database
 
-const char *BitFunction(SilegoPart part, size_t bitno)
+string BitFunction(SilegoPart part, size_t bitno)
 {
-	//The conditionals in this function are structured to resemble the structure of the datasheet.
-	//This is because the datasheet accurately *groups* reserved bits according to function;
-	//they simply black out the parts that aren't meant to be public, but do not mash them together.
-
-	const char *bitFunction = NULL;
-
-	switch(part)
+	//The bitstream layout comes from the same device model gp4par uses.
+	//Only build it once we actually need to explain something.
+	static unique_ptr<Greenpak4Device> device;
+	if(!device)
 	{
-		case SLG46620V:
-		case SLG46621V:
-			if(bitno >= 570 && bitno <= 575)
-				bitFunction = NULL;
-			else if(bitno == 833)
-				bitFunction = "ACMP5 speed double";
-			else if(bitno == 835)
-				bitFunction = "ACMP4 speed double";
-			else if(bitno == 881)
-				bitFunction = NULL;
-			else if(bitno >= 887 && bitno <= 891)
-				bitFunction = "Vref value fine tune";
-			else if(bitno == 922)
-				bitFunction = "bandgap 1x buffer enable";
-			else if(bitno == 937)
-				bitFunction = "Vref op amp chopper frequency select";
-			else if(bitno == 938)
-				bitFunction = "bandgap op amp offset chopper enable";
-			else if(bitno == 939)
-				bitFunction = "Vref op amp offset chopper enable";
-			else if((bitno >= 1003 && bitno <= 1015) ||
-			        (bitno >= 1594 && bitno <= 1599))
-				bitFunction = NULL;
-			else if(bitno >= 1975 && bitno <= 1981)
-				bitFunction = "RC oscillator trimming value";
-			else if((bitno >= 1982 && bitno <= 1987) ||
-			        (bitno >= 1988 && bitno <= 1995) ||
-			        (bitno >= 1996 && bitno <= 2001) ||
-			        (bitno >= 2002 && bitno <= 2007) ||
-			        (bitno >= 2013 && bitno <= 2014) ||
-			        (bitno >= 2021 && bitno <= 2027) ||
-			        (bitno >= 2028 && bitno <= 2029) ||
-			        bitno == 2030)
-				bitFunction = NULL;
-			else if(bitno >= 2031 && bitno <= 2038)
-				bitFunction = "pattern ID";
-			else if(bitno == 2039)
-				bitFunction = "read protection";
-			else
-				bitFunction = "see datasheet";
-			break;
+		switch(part)
+		{
+			case SLG46620V:
+				device.reset(new Greenpak4Device(Greenpak4Device::GREENPAK4_SLG46620));
+				break;
 
-		default: LogFatal("Unknown part\n");
-	}
+			case SLG46621V:
+				device.reset(new Greenpak4Device(Greenpak4Device::GREENPAK4_SLG46621));
+				break;
 
-	if(bitFunction == NULL)
-		bitFunction = "unknown--reserved";
+			default: LogFatal("Unknown part\n");
+		}
+	}
 
-	return bitFunction;
+	auto field = device->GetBitFields().Lookup(bitno);
+	if( (field == NULL) || (field->m_name == "reserved") )
+		return "unknown--reserved";
+	return device->GetBitFields().DescribeBit(bitno);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Bitstream input/output
 
-void WriteBitstream(string fname, vector<uint8_t> bitstream)
+bool WriteBitstream(string fname, const vector<uint8_t>& bitstream)
 {
+	//Format the whole file in memory and write it in one go
+	string buf = "index\t\tvalue\t\tcomment\n";
+	buf.reserve(bitstream.size() * 8 * 16);
+	char line[32];
+	for(size_t i = 0; i < bitstream.size() * 8; i++)
+	{
+		int value = (bitstream[i / 8] >> (i % 8)) & 1;
+		buf.append(line, snprintf(line, sizeof(line), "%d\t\t%d\t\t//\n", (int)i, value));
+	}
+
 	FILE* fp = fopen(fname.c_str(), "wt");
 	if(!fp)
 	{
-		LogError("Couldn't open %s for reading\n", fname.c_str());
-		return;
+		LogError("Couldn't open %s for writing\n", fname.c_str());
+		return false;
 	}
-
-	fputs("index\t\tvalue\t\tcomment\n", fp);
-	for(size_t i = 0; i < bitstream.size() * 8; i++)
+	if(buf.length() != fwrite(buf.c_str(), 1, buf.length(), fp))
 	{
-		int value = (bitstream[i / 8] >> (i % 8)) & 1;
-		fprintf(fp, "%d\t\t%d\t\t//\n", (int)i, value);
+		LogError("Couldn't write %s\n", fname.c_str());
+		fclose(fp);
+		return false;
 	}
 
 	fclose(fp);
+	return true;
 }
@@ -274,7 +274,8 @@ bool TrimOscillator(hdevice hdev, SilegoPart part, double voltage, unsigned freq
 bool SocketTest(hdevice hdev, SilegoPart part);
 
 std::vector<uint8_t> BitstreamFromHex(std::string hex);
-bool ReadBitstream(std::string fname, std::vector<uint8_t>& bitstream, SilegoPart part);
+bool LoadBitstream(std::string fname, std::vector<uint8_t>& bitstream, SilegoPart& part);
+bool ReadBitstream(std::string fname, std::vector<uint8_t>& bitstream, SilegoPart part, bool ignorePart = false);
 
 bool TweakBitstream(
 	std::vector<uint8_t>& bitstream,
@@ -21,6 +21,7 @@
 #include <cstring>
 
 #include <log.h>
+#include <Greenpak4.h>
 #include "gpdevboard.h"
 
 using namespace std;
@@ -492,58 +493,73 @@ bool TrimOscillator(hdevice hdev, SilegoPart part, double voltage, unsigned freq
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Bitstream input/output
 
+static int HexDigit(char c)
+{
+	if(c >= '0' && c <= '9')
+		return c - '0';
+	if(c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return 0;
+}
+
 vector<uint8_t> BitstreamFromHex(string hex)
 {
 	std::vector<uint8_t> bitstream;
-	for(size_t i = 0; i < hex.size(); i += 2)
-	{
-		uint8_t octet;
-		sscanf(&hex[i], "%02hhx", &octet);
-		bitstream.push_back(octet);
-	}
+	bitstream.reserve(hex.size() / 2);
+	for(size_t i = 0; i + 1 < hex.size(); i += 2)
+		bitstream.push_back((HexDigit(hex[i]) << 4) | HexDigit(hex[i + 1]));
 	return bitstream;
 }
 
-bool ReadBitstream(string fname, vector<uint8_t>& bitstream, SilegoPart part)
+/**
+	@brief Reads a bitstream in either the text or the binary container format
+
+	@param fname		File to read
+	@param bitstream	The bitstream, one byte per 8 bits, LSB first
+	@param part			The part the bitstream was built for, or UNRECOGNIZED for text files
+ */
+bool LoadBitstream(string fname, vector<uint8_t>& bitstream, SilegoPart& part)
 {
-	FILE* fp = fopen(fname.c_str(), "rt");
-	if(!fp)
-	{
-		LogError("Couldn't open %s for reading\n", fname.c_str());
-		return false;
-	}
+	bitstream.clear();
+	part = UNRECOGNIZED;
 
-	char signature[64];
-	fgets(signature, sizeof(signature), fp);
-	if(strcmp(signature, "index\t\tvalue\t\tcomment\n") &&
-	   //GP4 on Linux still outputs a \r
-	   strcmp(signature, "index\t\tvalue\t\tcomment\r\n"))
-	{
-		LogError("%s is not a GreenPAK bitstream\n", fname.c_str());
-		fclose(fp);
+	//Same parser as gp4par and gp4diff use, so there is only one definition of the container
+	Greenpak4Bitstream file;
+	uint16_t filePart;
+	if(!file.ReadFile(fname, &filePart))
 		return false;
-	}
 
-	while(!feof(fp))
+	//Text files don't say what they are for
+	if(filePart != 0)
 	{
-		int index;
-		int value;
-		fscanf(fp, "%d\t\t%d\t\t//\n", &index, &value);
-
-		int byteindex = index / 8;
-		if(byteindex < 0 || (value != 0 && value != 1))
+		part = (SilegoPart)filePart;
+		if(part != SLG46140V && part != SLG46620V && part != SLG46621V)
 		{
-			LogError("%s contains a malformed GreenPAK bitstream\n", fname.c_str());
-			fclose(fp);
+			LogError("%s is for unknown part 0x%03x\n", fname.c_str(), filePart);
+			part = UNRECOGNIZED;
 			return false;
 		}
-
-		if(byteindex >= (int)bitstream.size())
-			bitstream.resize(byteindex + 1, 0);
-		bitstream[byteindex] |= (value << (index % 8));
 	}
 
-	fclose(fp);
+	auto& words = file.GetWords();
+	bitstream.resize((file.GetLength() + 7) / 8);
+	for(size_t i=0; i<bitstream.size(); i++)
+		bitstream[i] = words[i / 8] >> ((i % 8) * 8);
+	return true;
+}
+
+/**
+	@brief Reads a bitstream for programming into a given part
+
+	@param ignorePart	Accept a container built for a different part (text files never say what they are for)
+ */
+bool ReadBitstream(string fname, vector<uint8_t>& bitstream, SilegoPart part, bool ignorePart)
+{
+	SilegoPart filePart;
+	if(!LoadBitstream(fname, bitstream, filePart))
+		return false;
 
 	//TODO: check ID words?
 
@@ -554,6 +570,19 @@ bool ReadBitstream(string fname, vector<uint8_t>& bitstream, SilegoPart part)
 		return false;
 	}
 
+	//Containers know what they were built for. The length check can't tell the SLG46620 and SLG46621 apart,
+	//so this is what stops one's bitstream from going into the other.
+	if( (filePart != UNRECOGNIZED) && (part != SLG4662XV) && (filePart != part) )
+	{
+		if(!ignorePart)
+		{
+			LogError("%s was built for %s, but the part is %s\n", fname.c_str(), PartName(filePart), PartName(part));
+			return false;
+		}
+		LogWarning("%s was built for %s, but the part is %s (ignored as requested)\n",
+			fname.c_str(), PartName(filePart), PartName(part));
+	}
+
 	return true;
 }
 
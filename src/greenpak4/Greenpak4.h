@@ -24,6 +24,8 @@
 	@brief Master include file for all Greenpak4 related stuff
  */
 
+#include "Greenpak4Bitstream.h"
+#include "Greenpak4BitFieldMap.h"
 #include "Greenpak4BitstreamEntity.h"
 #include "Greenpak4EntityOutput.h"
 #include "Greenpak4DualEntity.h"
@@ -52,13 +54,26 @@
 #include "Greenpak4ShiftRegister.h"
 #include "Greenpak4SystemReset.h"
 #include "Greenpak4VoltageReference.h"
+#include "Greenpak4EntityVisitor.h"
+
+#include "Greenpak4Format.h"
+#include "Greenpak4MappedFile.h"
+#include "Greenpak4JSONReader.h"
+#include "Greenpak4StringTable.h"
+#include "Greenpak4SymbolMap.h"
+#include "Greenpak4NetlistArena.h"
+#include "Greenpak4NetlistImage.h"
 
 #include "Greenpak4NetlistNode.h"
 #include "Greenpak4NetlistCell.h"
 #include "Greenpak4NetlistModule.h"
 #include "Greenpak4NetlistPort.h"
+#include "Greenpak4Primitives.h"
 #include "Greenpak4Netlist.h"
 
+#include "Greenpak4DeviceDescription.h"
 #include "Greenpak4Device.h"
+#include "Greenpak4TimingAnalyzer.h"
+#include "Greenpak4Simulator.h"
 
 #endif
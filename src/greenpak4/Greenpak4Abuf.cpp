@@ -26,7 +26,7 @@ using namespace std;
 
 Greenpak4Abuf::Greenpak4Abuf(
 		Greenpak4Device* device)
-		: Greenpak4BitstreamEntity(device, 0, -1, -1, -1)
+		: Greenpak4BitstreamEntity(KIND_ABUF, device, 0, -1, -1, -1)
 		, m_input(device->GetGround())
 {
 }
@@ -44,29 +44,33 @@ string Greenpak4Abuf::GetDescription()
 	return "ABUF0";	//only one of us for now
 }
 
-vector<string> Greenpak4Abuf::GetInputPorts() const
+static const Greenpak4EntityPort g_abufPorts[] =
 {
-	vector<string> r;
-	//no general fabric inputs
-	return r;
-}
+	{ "IN",   false },
+	{ "OUT",  true },
+};
+static const Greenpak4PortTable g_abufPortTable = PORT_TABLE(g_abufPorts);
 
-void Greenpak4Abuf::SetInput(string port, Greenpak4EntityOutput src)
+const Greenpak4PortTable& Greenpak4Abuf::GetPortTable() const
 {
-	if(port == "IN")
-		m_input = src;
+	return g_abufPortTable;
+}
 
-	//ignore anything else silently (should not be possible since synthesis would error out)
+uint32_t Greenpak4Abuf::GetFabricPortMask() const
+{
+	//no general fabric ports
+	return 0;
 }
 
-vector<string> Greenpak4Abuf::GetOutputPorts() const
+void Greenpak4Abuf::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	vector<string> r;
-	//no general fabric outputs
-	return r;
+	if(port == PORT_IN)
+		m_input = src;
+
+	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-unsigned int Greenpak4Abuf::GetOutputNetNumber(string /*port*/)
+unsigned int Greenpak4Abuf::GetOutputNetNumberByID(unsigned int /*port*/)
 {
 	return -1;
 }
@@ -80,16 +84,43 @@ bool Greenpak4Abuf::CommitChanges()
 	return true;
 }
 
-bool Greenpak4Abuf::Load(bool* /*bitstream*/)
+bool Greenpak4Abuf::Load(const Greenpak4Bitstream& /*bitstream*/)
 {
-	//TODO: Do our inputs
-	LogError("Unimplemented\n");
-	return false;
+	//no configuration, our only possible input is pin 6
+	m_input = m_device->GetIOB(6)->GetOutput("OUT");
+	return true;
 }
 
-bool Greenpak4Abuf::Save(bool* /*bitstream*/)
+bool Greenpak4Abuf::Save(Greenpak4Bitstream& /*bitstream*/)
 {
 	//no configuration, we just exist to help configure the comparator input muxes
 
 	return true;
 }
+
+void Greenpak4Abuf::RegisterBitFields(Greenpak4BitFieldMap& /*map*/)
+{
+	//no configuration
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4Abuf::GetInput(string port)
+{
+	if(port == "IN")
+		return m_input;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4Abuf::GetPrimitiveName()
+{
+	return "GP_ABUF";
+}
+
+map<string, string> Greenpak4Abuf::GetParameters()
+{
+	//No configuration
+	return map<string, string>();
+}
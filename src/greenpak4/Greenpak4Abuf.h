@@ -25,25 +25,37 @@ class Greenpak4Abuf : public Greenpak4BitstreamEntity
 {
 public:
 
+	///IDs of our ports (indexes into our port table)
+	enum Port
+	{
+		PORT_IN,
+		PORT_OUT
+	};
+
 	//Construction / destruction
 	Greenpak4Abuf(Greenpak4Device* device);
 
 	//Serialization
-	virtual bool Load(bool* bitstream);
-	virtual bool Save(bool* bitstream);
+	virtual bool Load(const Greenpak4Bitstream& bitstream);
+	virtual bool Save(Greenpak4Bitstream& bitstream);
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map);
 
 	virtual ~Greenpak4Abuf();
 
 	virtual std::string GetDescription();
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
-	virtual unsigned int GetOutputNetNumber(std::string port);
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
 	Greenpak4EntityOutput GetInput()
 	{ return m_input; }
 
@@ -30,7 +30,7 @@ Greenpak4Bandgap::Greenpak4Bandgap(
 	unsigned int ibase,
 	unsigned int oword,
 	unsigned int cbase)
-	: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+	: Greenpak4BitstreamEntity(KIND_BANDGAP, device, matrix, ibase, oword, cbase)
 	, m_autoPowerDown(true)
 	, m_chopperEn(true)
 	, m_outDelay(100)
@@ -51,28 +51,30 @@ string Greenpak4Bandgap::GetDescription()
 	return "BANDGAP0";
 }
 
-vector<string> Greenpak4Bandgap::GetInputPorts() const
+static const Greenpak4EntityPort g_bandgapPorts[] =
 {
-	vector<string> r;
-	//no inputs
-	return r;
+	{ "OK",  true },
+};
+static const Greenpak4PortTable g_bandgapPortTable = PORT_TABLE(g_bandgapPorts);
+
+const Greenpak4PortTable& Greenpak4Bandgap::GetPortTable() const
+{
+	return g_bandgapPortTable;
 }
 
-void Greenpak4Bandgap::SetInput(string /*port*/, Greenpak4EntityOutput /*src*/)
+uint32_t Greenpak4Bandgap::GetFabricPortMask() const
 {
-	//no inputs
+	return (1 << PORT_OK);
 }
 
-vector<string> Greenpak4Bandgap::GetOutputPorts() const
+void Greenpak4Bandgap::SetInputByID(unsigned int /*port*/, Greenpak4EntityOutput /*src*/)
 {
-	vector<string> r;
-	r.push_back("OK");
-	return r;
+	//no inputs
 }
 
-unsigned int Greenpak4Bandgap::GetOutputNetNumber(string port)
+unsigned int Greenpak4Bandgap::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "OK")
+	if(port == PORT_OK)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -84,7 +86,7 @@ unsigned int Greenpak4Bandgap::GetOutputNetNumber(string port)
 bool Greenpak4Bandgap::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -124,13 +126,16 @@ bool Greenpak4Bandgap::CommitChanges()
 	return true;
 }
 
-bool Greenpak4Bandgap::Load(bool* /*bitstream*/)
+bool Greenpak4Bandgap::Load(const Greenpak4Bitstream& bitstream)
 {
-	LogError("Unimplemented\n");
-	return false;
+	m_outDelay = bitstream[m_configBase + 0] ? 100 : 550;
+	m_autoPowerDown = !bitstream[m_configBase + 13];
+	m_chopperEn = bitstream[m_configBase + 15];
+
+	return true;
 }
 
-bool Greenpak4Bandgap::Save(bool* bitstream)
+bool Greenpak4Bandgap::Save(Greenpak4Bitstream& bitstream)
 {
 	//Startup delay
 	if(m_outDelay == 100)
@@ -152,3 +157,33 @@ bool Greenpak4Bandgap::Save(bool* bitstream)
 
 	return true;
 }
+
+void Greenpak4Bandgap::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	map.AddField(this, "OUT_DELAY", m_configBase + 0, 1);
+	map.AddField(this, "AUTO_PWRDN", m_configBase + 13, 1);
+	map.AddField(this, "CHOPPER_EN", m_configBase + 15, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4Bandgap::GetInput(string /*port*/)
+{
+	//no inputs
+	return Greenpak4EntityOutput();
+}
+
+string Greenpak4Bandgap::GetPrimitiveName()
+{
+	return "GP_BANDGAP";
+}
+
+map<string, string> Greenpak4Bandgap::GetParameters()
+{
+	map<string, string> params;
+	params["AUTO_PWRDN"] = m_autoPowerDown ? "1" : "0";
+	params["CHOPPER_EN"] = m_chopperEn ? "1" : "0";
+	params["OUT_DELAY"] = (m_outDelay == 100) ? "100" : "550";
+	return params;
+}
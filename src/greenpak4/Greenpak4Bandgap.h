@@ -26,6 +26,12 @@ class Greenpak4Bandgap : public Greenpak4BitstreamEntity
 {
 public:
 
+	///IDs of our ports (indexes into our port table)
+	enum Port
+	{
+		PORT_OK
+	};
+
 	//Construction / destruction
 	Greenpak4Bandgap(
 		Greenpak4Device* device,
@@ -36,19 +42,24 @@ public:
 	virtual ~Greenpak4Bandgap();
 
 	//Serialization
-	virtual bool Load(bool* bitstream);
-	virtual bool Save(bool* bitstream);
+	virtual bool Load(const Greenpak4Bitstream& bitstream);
+	virtual bool Save(Greenpak4Bitstream& bitstream);
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map);
 
 	virtual std::string GetDescription();
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
-	virtual unsigned int GetOutputNetNumber(std::string port);
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
 protected:
 
 	///Auto power-down
@@ -0,0 +1,134 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <log.h>
+#include <Greenpak4.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Fields
+
+string Greenpak4BitField::GetDescription() const
+{
+	if(m_entity == NULL)
+		return m_name;
+	return m_entity->GetDescription() + "." + m_name;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+Greenpak4BitFieldMap::Greenpak4BitFieldMap()
+	: m_sharedDepth(0)
+	, m_overlaps(0)
+{
+}
+
+Greenpak4BitFieldMap::~Greenpak4BitFieldMap()
+{
+}
+
+void Greenpak4BitFieldMap::Reset(unsigned int bitlen)
+{
+	m_fields.clear();
+	m_owners.assign(bitlen, -1);
+	m_sharedDepth = 0;
+	m_overlaps = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Registration
+
+/**
+	@brief Declares that a range of bits belongs to a field of an entity
+
+	@param entity	The entity the field configures (NULL for chip-wide data)
+	@param name		Name of the field
+	@param start	First bit of the field
+	@param width	Number of bits in the field
+	@param shared	True if other entities may legitimately use the same bits
+
+	@return False if the field is out of range or collides with a field registered earlier
+ */
+bool Greenpak4BitFieldMap::AddField(
+	Greenpak4BitstreamEntity* entity,
+	string name,
+	unsigned int start,
+	unsigned int width,
+	bool shared)
+{
+	Greenpak4BitField field;
+	field.m_entity = entity;
+	field.m_name = name;
+	field.m_start = start;
+	field.m_width = width;
+	field.m_shared = shared || (m_sharedDepth > 0);
+
+	if( (width == 0) || (start + width > m_owners.size()) )
+	{
+		LogError("Bitstream field %s (bits %u-%u) is outside the %zu-bit bitstream\n",
+			field.GetDescription().c_str(), start, start + width - 1, m_owners.size());
+		m_overlaps ++;
+		return false;
+	}
+
+	//Check for collisions before claiming anything
+	for(unsigned int i=start; i<start+width; i++)
+	{
+		if(m_owners[i] < 0)
+			continue;
+
+		auto& other = m_fields[m_owners[i]];
+		if(field.m_shared && other.m_shared)
+			continue;
+
+		LogError("Bitstream field %s (bits %u-%u) overlaps %s (bits %u-%u) at bit %u\n",
+			field.GetDescription().c_str(), start, start + width - 1,
+			other.GetDescription().c_str(), other.m_start, other.m_start + other.m_width - 1,
+			i);
+		m_overlaps ++;
+		return false;
+	}
+
+	//Shared bits stay with whoever claimed them first
+	int index = m_fields.size();
+	m_fields.push_back(field);
+	for(unsigned int i=start; i<start+width; i++)
+	{
+		if(m_owners[i] < 0)
+			m_owners[i] = index;
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lookup
+
+string Greenpak4BitFieldMap::DescribeBit(unsigned int bit) const
+{
+	auto field = Lookup(bit);
+	if(field == NULL)
+		return "unused";
+
+	string ret = field->GetDescription();
+	if(field->m_width > 1)
+		ret += "[" + to_string(bit - field->m_start) + "]";
+	return ret;
+}
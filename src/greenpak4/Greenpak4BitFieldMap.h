@@ -0,0 +1,121 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4BitFieldMap_h
+#define Greenpak4BitFieldMap_h
+
+#include <string>
+#include <vector>
+
+class Greenpak4BitstreamEntity;
+
+/**
+	@brief A contiguous range of bitstream bits with a single meaning (a matrix selector, a LUT truth table...)
+ */
+struct Greenpak4BitField
+{
+	///The entity the field configures (NULL for chip-wide data like trim values and ID codes)
+	Greenpak4BitstreamEntity* m_entity;
+
+	///Name of the field within its entity, or a description of chip-wide data
+	std::string m_name;
+
+	///First bit of the field
+	unsigned int m_start;
+
+	///Number of bits in the field
+	unsigned int m_width;
+
+	///True if other entities legitimately use the same bits (shared power-down input, paired LUT/PGEN)
+	bool m_shared;
+
+	std::string GetDescription() const;
+};
+
+/**
+	@brief Reverse index of a device's bitstream: which field of which entity every bit belongs to
+
+	Entities register their fields once when the device is created. Each bit stores the index of the field
+	covering it, so looking a bit up is constant time. Fields may only overlap when every one of them is declared
+	shared; anything else is a bug in the device description. It is reported when the field is added, and
+	Greenpak4Device refuses to come up with any (see GetOverlapCount()).
+ */
+class Greenpak4BitFieldMap
+{
+public:
+	Greenpak4BitFieldMap();
+	virtual ~Greenpak4BitFieldMap();
+
+	//Clear the map and size it for a bitstream of the given length
+	void Reset(unsigned int bitlen);
+
+	bool AddField(
+		Greenpak4BitstreamEntity* entity,
+		std::string name,
+		unsigned int start,
+		unsigned int width,
+		bool shared = false);
+
+	/**
+		@brief Treats every field added until EndShared() as shared.
+
+		Used by entities that register the fields of several alter egos occupying the same bits.
+	 */
+	void BeginShared()
+	{ m_sharedDepth ++; }
+
+	void EndShared()
+	{ m_sharedDepth --; }
+
+	//Get the field a bit belongs to (the first one registered, if it's shared), or NULL if nothing uses it
+	const Greenpak4BitField* Lookup(unsigned int bit) const
+	{
+		if( (bit >= m_owners.size()) || (m_owners[bit] < 0) )
+			return NULL;
+		return &m_fields[m_owners[bit]];
+	}
+
+	//Get a human-readable name for a bit, like "LUT3_2.INIT[5]"
+	std::string DescribeBit(unsigned int bit) const;
+
+	//Number of fields rejected because they were out of range or collided with another field
+	unsigned int GetOverlapCount() const
+	{ return m_overlaps; }
+
+	size_t size() const
+	{ return m_fields.size(); }
+
+	const Greenpak4BitField& operator[](size_t i) const
+	{ return m_fields[i]; }
+
+protected:
+
+	///Every field, in the order it was added
+	std::vector<Greenpak4BitField> m_fields;
+
+	///Index of the field each bit belongs to, or -1 if it's unused
+	std::vector<int> m_owners;
+
+	///Nesting depth of BeginShared() calls
+	unsigned int m_sharedDepth;
+
+	///Number of illegal overlaps found so far
+	unsigned int m_overlaps;
+};
+
+#endif
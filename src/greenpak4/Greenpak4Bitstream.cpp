@@ -0,0 +1,402 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include <log.h>
+#include <Greenpak4.h>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+Greenpak4Bitstream::Greenpak4Bitstream(unsigned int nbits)
+{
+	Resize(nbits);
+}
+
+Greenpak4Bitstream::~Greenpak4Bitstream()
+{
+}
+
+void Greenpak4Bitstream::Resize(unsigned int nbits)
+{
+	m_length = nbits;
+	m_words.assign((nbits + 63) / 64, 0);
+}
+
+void Greenpak4Bitstream::Clear()
+{
+	for(auto& w : m_words)
+		w = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Field access
+
+uint64_t Greenpak4Bitstream::GetField(unsigned int offset, unsigned int width) const
+{
+	if(width == 0)
+		return 0;
+
+	unsigned int word = offset / 64;
+	unsigned int shift = offset % 64;
+
+	uint64_t value = m_words[word] >> shift;
+	if(shift + width > 64)
+		value |= m_words[word + 1] << (64 - shift);
+
+	return value & FieldMask(width);
+}
+
+void Greenpak4Bitstream::SetField(unsigned int offset, unsigned int width, uint64_t value)
+{
+	if(width == 0)
+		return;
+
+	unsigned int word = offset / 64;
+	unsigned int shift = offset % 64;
+	uint64_t mask = FieldMask(width);
+	value &= mask;
+
+	m_words[word] = (m_words[word] & ~(mask << shift)) | (value << shift);
+
+	//Field straddles a word boundary
+	if(shift + width > 64)
+	{
+		unsigned int nlow = 64 - shift;
+		m_words[word + 1] = (m_words[word + 1] & ~(mask >> nlow)) | (value >> nlow);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Comparison
+
+uint64_t Greenpak4Bitstream::Hash() const
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for(auto w : m_words)
+	{
+		hash ^= w;
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+unsigned int Greenpak4Bitstream::CountDifferences(const Greenpak4Bitstream& rhs) const
+{
+	if(m_length != rhs.m_length)
+	{
+		LogError("Tried to compare bitstreams of different lengths (%u, %u)\n", m_length, rhs.m_length);
+		return max(m_length, rhs.m_length);
+	}
+
+	unsigned int count = 0;
+	for(size_t i=0; i<m_words.size(); i++)
+		count += __builtin_popcountll(m_words[i] ^ rhs.m_words[i]);
+	return count;
+}
+
+vector<unsigned int> Greenpak4Bitstream::GetDifferences(const Greenpak4Bitstream& rhs) const
+{
+	vector<unsigned int> ret;
+	if(m_length != rhs.m_length)
+	{
+		LogError("Tried to compare bitstreams of different lengths (%u, %u)\n", m_length, rhs.m_length);
+		return ret;
+	}
+
+	for(size_t i=0; i<m_words.size(); i++)
+	{
+		//Walk the set bits of each differing word
+		uint64_t diff = m_words[i] ^ rhs.m_words[i];
+		while(diff)
+		{
+			ret.push_back(i*64 + __builtin_ctzll(diff));
+			diff &= diff - 1;
+		}
+	}
+	return ret;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// File I/O
+
+static bool WriteBuffer(string fname, const char* mode, const void* buf, size_t len)
+{
+	FILE* fp = fopen(fname.c_str(), mode);
+	if(!fp)
+	{
+		LogError("Couldn't open %s for writing\n", fname.c_str());
+		return false;
+	}
+	if(len != fwrite(buf, 1, len, fp))
+	{
+		LogError("Couldn't write bitstream %s\n", fname.c_str());
+		fclose(fp);
+		return false;
+	}
+	fclose(fp);
+	return true;
+}
+
+/**
+	@brief Writes the bitstream in the "index value comment" text format used by the Silego tools
+
+	The whole file is formatted in memory and written with a single call.
+ */
+bool Greenpak4Bitstream::WriteText(string fname) const
+{
+	string buf = FormatText();
+	return WriteBuffer(fname, "w", buf.c_str(), buf.length());
+}
+
+/**
+	@brief Formats the bitstream in the legacy text format, without touching the filesystem
+ */
+string Greenpak4Bitstream::FormatText() const
+{
+	static const char header[] = "index\t\tvalue\t\tcomment\n";
+
+	string buf;
+	buf.reserve(sizeof(header) + m_length * 16);
+	buf += header;
+
+	char digits[16];
+	for(unsigned int i=0; i<m_length; i++)
+	{
+		//Format the index by hand, this loop runs once per bit
+		char* p = digits + sizeof(digits);
+		unsigned int n = i;
+		do
+		{
+			*--p = '0' + (n % 10);
+			n /= 10;
+		} while(n);
+		buf.append(p, digits + sizeof(digits) - p);
+
+		buf += GetBit(i) ? "\t\t1\t\t//\n" : "\t\t0\t\t//\n";
+	}
+
+	return buf;
+}
+
+/**
+	@brief Writes the bitstream in the binary container format (see GP4B_MAGIC)
+
+	@param fname		Name of the file to write to
+	@param part			Part number to record in the header
+	@param userid		User ID code to record in the header
+	@param readProtect	Read protection flag to record in the header
+ */
+bool Greenpak4Bitstream::WriteBinary(string fname, uint16_t part, uint8_t userid, bool readProtect) const
+{
+	vector<uint8_t> buf = FormatBinary(part, userid, readProtect);
+	return WriteBuffer(fname, "wb", &buf[0], buf.size());
+}
+
+/**
+	@brief Formats the bitstream in the binary container format, without touching the filesystem
+
+	Takes the same header fields as WriteBinary().
+ */
+vector<uint8_t> Greenpak4Bitstream::FormatBinary(uint16_t part, uint8_t userid, bool readProtect) const
+{
+	size_t nbytes = (m_length + 7) / 8;
+	vector<uint8_t> buf(GP4B_HEADER_SIZE + nbytes, 0);
+
+	//Payload, LSB first in both the words and the bytes
+	uint8_t* payload = &buf[GP4B_HEADER_SIZE];
+	for(size_t i=0; i<nbytes; i++)
+		payload[i] = m_words[i / 8] >> ((i % 8) * 8);
+
+	//FNV-1a 64 of the payload
+	uint64_t hash = 14695981039346656037ull;
+	for(size_t i=0; i<nbytes; i++)
+	{
+		hash ^= payload[i];
+		hash *= 1099511628211ull;
+	}
+
+	//Header
+	memcpy(&buf[0], GP4B_MAGIC, 8);
+	buf[8] = GP4B_VERSION & 0xff;
+	buf[9] = GP4B_VERSION >> 8;
+	buf[10] = part & 0xff;
+	buf[11] = part >> 8;
+	for(int i=0; i<4; i++)
+		buf[12 + i] = m_length >> (i*8);
+	buf[16] = userid;
+	buf[17] = readProtect ? 1 : 0;
+	for(int i=0; i<8; i++)
+		buf[24 + i] = hash >> (i*8);
+
+	return buf;
+}
+
+/**
+	@brief Reads a bitstream in either the legacy text format or the binary container format
+
+	@param fname		Name of the file to read
+	@param part			If not NULL, set to the part number from the container header (0 for text files)
+ */
+bool Greenpak4Bitstream::ReadFile(string fname, uint16_t* part)
+{
+	if(part)
+		*part = 0;
+
+	Greenpak4MappedFile file;
+	if(!file.Open(fname, "bitstream"))
+		return false;
+
+	const char* data = file.GetData();
+	size_t len = file.GetLength();
+	if( (len >= 8) && !memcmp(data, GP4B_MAGIC, 8) )
+		return ParseBinary(fname, data, len, part);
+	return ParseText(fname, data, len);
+}
+
+static uint64_t GetLE(const char* p, int nbytes)
+{
+	uint64_t v = 0;
+	for(int i=nbytes-1; i>=0; i--)
+		v = (v << 8) | static_cast<uint8_t>(p[i]);
+	return v;
+}
+
+bool Greenpak4Bitstream::ParseBinary(string fname, const char* data, size_t len, uint16_t* part)
+{
+	if(len < GP4B_HEADER_SIZE)
+	{
+		LogError("%s is truncated\n", fname.c_str());
+		return false;
+	}
+
+	uint16_t version = GetLE(data + 8, 2);
+	if(version != GP4B_VERSION)
+	{
+		LogError("%s is bitstream container version %d, only version %d is supported\n",
+			fname.c_str(), version, GP4B_VERSION);
+		return false;
+	}
+
+	uint32_t nbits = GetLE(data + 12, 4);
+	size_t nbytes = ((size_t)nbits + 7) / 8;
+	if(len != GP4B_HEADER_SIZE + nbytes)
+	{
+		LogError("%s has the wrong length for a %u-bit bitstream\n", fname.c_str(), nbits);
+		return false;
+	}
+
+	const uint8_t* payload = reinterpret_cast<const uint8_t*>(data + GP4B_HEADER_SIZE);
+	uint64_t hash = 14695981039346656037ull;
+	for(size_t i=0; i<nbytes; i++)
+	{
+		hash ^= payload[i];
+		hash *= 1099511628211ull;
+	}
+	if(hash != GetLE(data + 24, 8))
+	{
+		LogError("%s is corrupt (payload hash mismatch)\n", fname.c_str());
+		return false;
+	}
+
+	Resize(nbits);
+	for(size_t i=0; i<nbytes; i++)
+		m_words[i / 8] |= static_cast<uint64_t>(payload[i]) << ((i % 8) * 8);
+
+	//Keep the "no bits past the end" invariant even if the writer left junk in the last byte
+	if(nbits % 64)
+		m_words.back() &= FieldMask(nbits % 64);
+
+	if(part)
+		*part = GetLE(data + 10, 2);
+	return true;
+}
+
+bool Greenpak4Bitstream::ParseText(string fname, const char* data, size_t len)
+{
+	const char* p = data;
+	const char* end = data + len;
+
+	//GP4 on Linux still outputs a \r
+	static const char signature[] = "index\t\tvalue\t\tcomment\n";
+	static const char signatureCR[] = "index\t\tvalue\t\tcomment\r\n";
+	if( (len >= sizeof(signature) - 1) && !memcmp(p, signature, sizeof(signature) - 1) )
+		p += sizeof(signature) - 1;
+	else if( (len >= sizeof(signatureCR) - 1) && !memcmp(p, signatureCR, sizeof(signatureCR) - 1) )
+		p += sizeof(signatureCR) - 1;
+	else
+	{
+		LogError("%s is not a GreenPAK bitstream\n", fname.c_str());
+		return false;
+	}
+
+	//One "index\t\tvalue\t\tcomment" line per bit. The length is one past the highest index seen.
+	Resize(0);
+	while(p < end)
+	{
+		//Skip blank lines
+		if(*p == '\n' || *p == '\r')
+		{
+			p++;
+			continue;
+		}
+
+		//Stop accumulating once the index is out of range, so a long run of digits can't wrap around to a small one
+		unsigned int index = 0;
+		const char* start = p;
+		while(p < end && *p >= '0' && *p <= '9')
+		{
+			if(index < 0x1000000)
+				index = index*10 + (*p - '0');
+			p++;
+		}
+		bool ok = (p != start) && (index < 0x1000000);
+
+		while(p < end && (*p == '\t' || *p == ' '))
+			p++;
+		int value = -1;
+		if(p < end && (*p == '0' || *p == '1'))
+			value = *p++ - '0';
+		if(p < end && *p >= '0' && *p <= '9')
+			ok = false;
+
+		if(!ok || value < 0)
+		{
+			LogError("%s contains a malformed GreenPAK bitstream\n", fname.c_str());
+			return false;
+		}
+
+		if(index >= m_length)
+		{
+			m_length = index + 1;
+			m_words.resize((m_length + 63) / 64, 0);
+		}
+		SetBit(index, value);
+
+		//Ignore the comment
+		while(p < end && *p != '\n')
+			p++;
+	}
+
+	return true;
+}
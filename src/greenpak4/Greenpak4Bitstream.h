@@ -0,0 +1,170 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#ifndef Greenpak4Bitstream_h
+#define Greenpak4Bitstream_h
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+	@brief Binary bitstream container (.gp4b)
+
+	All fields are little-endian.
+
+	Offset	Size	Field
+	0		8		Magic (GP4B_MAGIC)
+	8		2		Format version (GP4B_VERSION)
+	10		2		Part number, same coding as the gpdevboard SilegoPart enum (0x620 = SLG46620V etc)
+	12		4		Length of the bitstream in bits
+	16		1		User ID code
+	17		1		Flags (bit 0 = read protection)
+	18		6		Reserved, must be zero
+	24		8		FNV-1a 64 hash of the payload
+	32		...		Payload, ceil(length/8) bytes. Bit N of the bitstream is bit (N % 8) of byte (N / 8).
+ */
+#define GP4B_MAGIC			"GP4B\r\n\x1a\n"
+#define GP4B_VERSION		1
+#define GP4B_HEADER_SIZE	32
+
+/**
+	@brief A device configuration image, packed 64 bits to a word
+
+	Bit N of the bitstream is bit (N % 64) of word (N / 64). Multi-bit fields are stored LSB first, i.e. bit i of the
+	value goes to bitstream offset + i, which is the ordering used by every field in the GreenPAK4 bitstream.
+
+	Bits past the end of the bitstream in the last word are always zero, so whole-word comparison and hashing are safe.
+ */
+class Greenpak4Bitstream
+{
+public:
+	Greenpak4Bitstream(unsigned int nbits = 0);
+	virtual ~Greenpak4Bitstream();
+
+	///Proxy for a single writable bit, so entities can keep using bitstream[i] = x
+	class reference
+	{
+	public:
+		reference(uint64_t& word, uint64_t mask)
+		: m_word(word)
+		, m_mask(mask)
+		{}
+
+		operator bool() const
+		{ return (m_word & m_mask) != 0; }
+
+		reference& operator=(bool value)
+		{
+			if(value)
+				m_word |= m_mask;
+			else
+				m_word &= ~m_mask;
+			return *this;
+		}
+
+		reference& operator=(const reference& rhs)
+		{ return operator=(static_cast<bool>(rhs)); }
+
+	protected:
+		uint64_t& m_word;
+		uint64_t m_mask;
+	};
+
+	enum FileFormat
+	{
+		///Legacy text format, one line per bit (compatible with the Silego tools)
+		FORMAT_TEXT,
+
+		///Binary container with header, see GP4B_MAGIC
+		FORMAT_BINARY
+	};
+
+	//Change the length, zeroing the whole bitstream
+	void Resize(unsigned int nbits);
+
+	//Set every bit to zero
+	void Clear();
+
+	unsigned int GetLength() const
+	{ return m_length; }
+
+	bool GetBit(unsigned int offset) const
+	{ return (m_words[offset / 64] >> (offset % 64)) & 1; }
+
+	void SetBit(unsigned int offset, bool value)
+	{ reference(m_words[offset / 64], 1ULL << (offset % 64)) = value; }
+
+	bool operator[](unsigned int offset) const
+	{ return GetBit(offset); }
+
+	reference operator[](unsigned int offset)
+	{ return reference(m_words[offset / 64], 1ULL << (offset % 64)); }
+
+	//Read/write an unsigned field of up to 64 bits, LSB at offset
+	uint64_t GetField(unsigned int offset, unsigned int width) const;
+	void SetField(unsigned int offset, unsigned int width, uint64_t value);
+
+	bool operator==(const Greenpak4Bitstream& rhs) const
+	{ return (m_length == rhs.m_length) && (m_words == rhs.m_words); }
+
+	bool operator!=(const Greenpak4Bitstream& rhs) const
+	{ return !(*this == rhs); }
+
+	//FNV-1a hash of the contents, a word at a time
+	uint64_t Hash() const;
+
+	//Number of bits that differ from another bitstream of the same length
+	unsigned int CountDifferences(const Greenpak4Bitstream& rhs) const;
+
+	//Offsets of all bits that differ from another bitstream of the same length, in ascending order
+	std::vector<unsigned int> GetDifferences(const Greenpak4Bitstream& rhs) const;
+
+	//Write to a file in the legacy text format
+	bool WriteText(std::string fname) const;
+
+	//Write to a file in the binary container format
+	bool WriteBinary(std::string fname, uint16_t part, uint8_t userid, bool readProtect) const;
+
+	//Same as the above, but into memory
+	std::string FormatText() const;
+	std::vector<uint8_t> FormatBinary(uint16_t part, uint8_t userid, bool readProtect) const;
+
+	//Read from a file in either format. part is set from the container header, or to 0 for text files.
+	bool ReadFile(std::string fname, uint16_t* part = NULL);
+
+	const std::vector<uint64_t>& GetWords() const
+	{ return m_words; }
+
+protected:
+	bool ParseText(std::string fname, const char* data, size_t len);
+	bool ParseBinary(std::string fname, const char* data, size_t len, uint16_t* part);
+
+	static uint64_t FieldMask(unsigned int width)
+	{ return (width >= 64) ? ~0ULL : ((1ULL << width) - 1); }
+
+	///Length in bits
+	unsigned int m_length;
+
+	///Packed bits, LSB first
+	std::vector<uint64_t> m_words;
+};
+
+#endif
@@ -25,14 +25,50 @@ using namespace std;
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
+//Capability flags for each entity kind, in the same order as Kind
+static const uint32_t g_kindCapabilities[] =
+{
+	Greenpak4BitstreamEntity::CAP_ANALOG_OUTPUT,	//KIND_ABUF
+	0,												//KIND_BANDGAP
+	0,												//KIND_COMPARATOR
+	0,												//KIND_COUNTER
+	0,												//KIND_CROSS_CONNECTION
+	Greenpak4BitstreamEntity::CAP_ANALOG_OUTPUT,	//KIND_DAC
+	0,												//KIND_DELAY
+	0,												//KIND_DUAL
+	0,												//KIND_FLIPFLOP
+	0,												//KIND_INVERTER
+	Greenpak4BitstreamEntity::CAP_IOB,				//KIND_IOB_TYPE_A
+	Greenpak4BitstreamEntity::CAP_IOB,				//KIND_IOB_TYPE_B
+	Greenpak4BitstreamEntity::CAP_OSCILLATOR,		//KIND_LFOSC
+	0,												//KIND_LUT
+	0,												//KIND_PAIRED
+	0,												//KIND_PATTERN_GENERATOR
+	Greenpak4BitstreamEntity::CAP_ANALOG_OUTPUT,	//KIND_PGA
+	0,												//KIND_POWER_ON_RESET
+	0,												//KIND_POWER_RAIL
+	Greenpak4BitstreamEntity::CAP_OSCILLATOR,		//KIND_RCOSC
+	Greenpak4BitstreamEntity::CAP_OSCILLATOR,		//KIND_RINGOSC
+	0,												//KIND_SHIFT_REGISTER
+	0,												//KIND_SYSTEM_RESET
+	Greenpak4BitstreamEntity::CAP_ANALOG_OUTPUT		//KIND_VREF
+};
+static_assert(
+	sizeof(g_kindCapabilities) / sizeof(g_kindCapabilities[0]) == Greenpak4BitstreamEntity::KIND_COUNT,
+	"g_kindCapabilities must have one entry per entity kind");
+
 Greenpak4BitstreamEntity::Greenpak4BitstreamEntity(
+	Kind kind,
 	Greenpak4Device* device,
 	unsigned int matrix,
 	unsigned int ibase,
 	unsigned int obase,
 	unsigned int cbase
 	)
-	: m_device(device)
+	: m_kind(kind)
+	, m_capabilities(g_kindCapabilities[kind])
+	, m_device(device)
+	, m_entityIndex(device->AllocateEntityIndex())
 	, m_matrix(matrix)
 	, m_inputBaseWord(ibase)
 	, m_outputBaseWord(obase)
@@ -63,7 +99,7 @@ Greenpak4BitstreamEntity::~Greenpak4BitstreamEntity()
 bool Greenpak4BitstreamEntity::HasLoadsOnPort(string port)
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return false;
 
@@ -88,6 +124,78 @@ bool Greenpak4BitstreamEntity::HasLoadsOnPort(string port)
 	return false;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Port lookup
+
+/**
+	@brief Gets the ID of the port with the given name, or PORT_NONE if we don't have one
+ */
+unsigned int Greenpak4BitstreamEntity::LookupPort(const string& name) const
+{
+	auto& table = GetPortTable();
+	for(unsigned int i=0; i<table.m_count; i++)
+	{
+		if(name == table.m_ports[i].m_name)
+			return i;
+	}
+	return PORT_NONE;
+}
+
+/**
+	@brief Gets the ID of the port that an output is taken from, complaining if there is no such port
+
+	An unknown name would get PORT_NONE, the same as the unnamed output of an IOB or any other unknown name, so the
+	outputs would compare equal and get merged during routing.
+ */
+unsigned int Greenpak4BitstreamEntity::LookupOutputPort(const string& name)
+{
+	unsigned int id = LookupPort(name);
+	if(id == PORT_NONE)
+		LogError("%s has no port named \"%s\"\n", GetDescription().c_str(), name.c_str());
+	return id;
+}
+
+void Greenpak4BitstreamEntity::SetInput(const string& port, Greenpak4EntityOutput src)
+{
+	//ignore unknown ports silently (should not be possible since synthesis would error out)
+	unsigned int id = LookupPort(port);
+	if(id != PORT_NONE)
+		SetInputByID(id, src);
+}
+
+unsigned int Greenpak4BitstreamEntity::GetOutputNetNumber(const string& port)
+{
+	unsigned int id = LookupPort(port);
+	if(id == PORT_NONE)
+		return -1;
+	return GetOutputNetNumberByID(id);
+}
+
+vector<string> Greenpak4BitstreamEntity::GetInputPorts() const
+{
+	vector<string> r;
+	auto& table = GetPortTable();
+	for(unsigned int i=0; i<table.m_count; i++)
+	{
+		if(IsGeneralFabricInput(i))
+			r.push_back(table.m_ports[i].m_name);
+	}
+	return r;
+}
+
+vector<string> Greenpak4BitstreamEntity::GetOutputPorts() const
+{
+	vector<string> r;
+	auto& table = GetPortTable();
+	uint32_t mask = GetFabricPortMask();
+	for(unsigned int i=0; i<table.m_count; i++)
+	{
+		if( ( (mask >> i) & 1 ) && table.m_ports[i].m_output )
+			r.push_back(table.m_ports[i].m_name);
+	}
+	return r;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Net numbering helpers
 
@@ -101,24 +209,22 @@ Greenpak4EntityOutput Greenpak4BitstreamEntity::GetOutput(std::string port)
 
 Greenpak4NetlistEntity* Greenpak4BitstreamEntity::GetNetlistEntity()
 {
+	//Not part of a PAR graph (e.g. loaded from a bitstream)
+	if(m_parnode == NULL)
+		return NULL;
+
 	PARGraphNode* mate = m_parnode->GetMate();
 	if(mate == NULL)
 		return NULL;
 	return static_cast<Greenpak4NetlistEntity*>(mate->GetData());
 }
 
-/**
-	@brief Returns true if the given named port is general fabric routing
- */
-bool Greenpak4BitstreamEntity::IsGeneralFabricInput(string port) const
+Greenpak4NetlistCell* Greenpak4BitstreamEntity::GetNetlistCell()
 {
-	auto ports = GetInputPorts();
-	for(auto p : ports)
-	{
-		if(p == port)
-			return true;
-	}
-	return false;
+	auto entity = GetNetlistEntity();
+	if(entity == NULL)
+		return NULL;
+	return entity->AsCell();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -126,17 +232,19 @@ bool Greenpak4BitstreamEntity::IsGeneralFabricInput(string port) const
 
 string Greenpak4BitstreamEntity::GetOutputName()
 {
+	if(m_parnode == NULL)
+		return "";
 	auto mate = m_parnode->GetMate();
 	if(mate == NULL)
 		return "";
 	auto entity = static_cast<Greenpak4NetlistEntity*>(mate->GetData());
 
 	//If it's an IOB, return the IOB name
-	if(dynamic_cast<Greenpak4NetlistPort*>(entity))
+	if(entity->GetKind() == Greenpak4NetlistEntity::KIND_PORT)
 		return entity->m_name;
 
 	//Nope, it's a cell
-	auto cell = dynamic_cast<Greenpak4NetlistCell*>(entity);
+	auto cell = entity->AsCell();
 	if(!cell)
 		return "error";
 
@@ -162,7 +270,7 @@ Greenpak4BitstreamEntity* Greenpak4BitstreamEntity::GetRealEntity()
 }
 
 bool Greenpak4BitstreamEntity::WriteMatrixSelector(
-	bool* bitstream,
+	Greenpak4Bitstream& bitstream,
 	unsigned int wordpos,
 	Greenpak4EntityOutput signal,
 	bool cross_matrix)
@@ -214,13 +322,49 @@ bool Greenpak4BitstreamEntity::WriteMatrixSelector(
 	unsigned int nbits = m_device->GetMatrixBits();
 	unsigned int startbit = m_device->GetMatrixBase(matrix) + wordpos * nbits;
 
-	//Need to flip bit ordering since lowest array index is the MSB
-	for(unsigned int i=0; i<nbits; i++)
+	bitstream.SetField(startbit, nbits, sel);
+
+	return true;
+}
+
+void Greenpak4BitstreamEntity::RegisterMatrixSelector(
+	Greenpak4BitFieldMap& map,
+	string name,
+	unsigned int wordpos,
+	bool cross_matrix,
+	bool shared)
+{
+	unsigned int matrix = m_matrix;
+	if(cross_matrix)
+		matrix = 1 - matrix;
+
+	unsigned int nbits = m_device->GetMatrixBits();
+	unsigned int startbit = m_device->GetMatrixBase(matrix) + wordpos * nbits;
+
+	map.AddField(this, name, startbit, nbits, shared);
+}
+
+bool Greenpak4BitstreamEntity::ReadMatrixSelector(
+	const Greenpak4Bitstream& bitstream,
+	unsigned int wordpos,
+	Greenpak4EntityOutput& signal,
+	bool cross_matrix)
+{
+	//Cross connections read from the opposite matrix
+	unsigned int matrix = m_matrix;
+	if(cross_matrix)
+		matrix = 1 - matrix;
+
+	unsigned int nbits = m_device->GetMatrixBits();
+	unsigned int startbit = m_device->GetMatrixBase(matrix) + wordpos * nbits;
+	unsigned int sel = bitstream.GetField(startbit, nbits);
+
+	signal = m_device->GetNetSource(matrix, sel);
+	if(signal.m_src == NULL)
 	{
-		if( (sel >> i) & 1 )
-			bitstream[startbit + i] = true;
-		else
-			bitstream[startbit + i] = false;
+		LogError("%s: input word %u selects net %u of matrix %u, which has no driver\n",
+			GetDescription().c_str(), wordpos, sel, matrix);
+		return false;
 	}
 
 	return true;
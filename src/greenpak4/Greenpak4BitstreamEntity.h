@@ -23,12 +23,35 @@ class Greenpak4Device;
 class PARGraphNode;
 class Greenpak4DualEntity;
 class Greenpak4NetlistEntity;
+class Greenpak4NetlistCell;
 
+#include <map>
 #include <string>
 #include <vector>
 #include <xbpar.h>
 
 class Greenpak4EntityOutput;
+class Greenpak4BitFieldMap;
+
+/**
+	@brief A single port of a bitstream entity
+ */
+struct Greenpak4EntityPort
+{
+	const char* m_name;
+	bool m_output;
+};
+
+/**
+	@brief Every port of one kind of bitstream entity, declared once per class. A port's ID is its index here.
+ */
+struct Greenpak4PortTable
+{
+	const Greenpak4EntityPort* m_ports;
+	unsigned int m_count;
+};
+
+#define PORT_TABLE(ports) { ports, sizeof(ports) / sizeof(ports[0]) }
 
 /**
 	@brief An entity which is serialized to/from the bitstream
@@ -36,7 +59,52 @@ class Greenpak4EntityOutput;
 class Greenpak4BitstreamEntity
 {
 public:
+
+	/**
+		@brief The concrete class of an entity.
+
+		Set at construction so hot loops can switch on it instead of walking a chain of dynamic_casts.
+	 */
+	enum Kind
+	{
+		KIND_ABUF,
+		KIND_BANDGAP,
+		KIND_COMPARATOR,
+		KIND_COUNTER,
+		KIND_CROSS_CONNECTION,
+		KIND_DAC,
+		KIND_DELAY,
+		KIND_DUAL,
+		KIND_FLIPFLOP,
+		KIND_INVERTER,
+		KIND_IOB_TYPE_A,
+		KIND_IOB_TYPE_B,
+		KIND_LFOSC,
+		KIND_LUT,
+		KIND_PAIRED,
+		KIND_PATTERN_GENERATOR,
+		KIND_PGA,
+		KIND_POWER_ON_RESET,
+		KIND_POWER_RAIL,
+		KIND_RCOSC,
+		KIND_RINGOSC,
+		KIND_SHIFT_REGISTER,
+		KIND_SYSTEM_RESET,
+		KIND_VREF,
+
+		KIND_COUNT
+	};
+
+	///Properties shared by several kinds of entity
+	enum Capability
+	{
+		CAP_IOB				= 0x01,		//I/O buffer of either type (derived from Greenpak4IOB)
+		CAP_OSCILLATOR		= 0x02,		//Clock source that can drive a counter's dedicated clock input
+		CAP_ANALOG_OUTPUT	= 0x04		//Drives an analog signal rather than a digital one
+	};
+
 	Greenpak4BitstreamEntity(
+		Kind kind,
 		Greenpak4Device* device,
 		unsigned int matrix,
 		unsigned int ibase,
@@ -48,10 +116,10 @@ public:
 	//TODO: Print for debugging
 
 	///Deserialize from an external bitstream
-	virtual bool Load(bool* bitstream) =0;
+	virtual bool Load(const Greenpak4Bitstream& bitstream) =0;
 
 	///Serialize to an external bitstream
-	virtual bool Save(bool* bitstream) =0;
+	virtual bool Save(Greenpak4Bitstream& bitstream) =0;
 
 	/**
 		@brief Returns the index of the routing matrix our OUTPUT is attached to
@@ -59,15 +127,44 @@ public:
 	unsigned int GetMatrix()
 	{ return m_matrix; }
 
+	///Port ID for names that aren't in the port table
+	static const unsigned int PORT_NONE = static_cast<unsigned int>(-1);
+
+	/**
+		@brief Returns the table of every port this entity has (including dedicated and analog ones)
+	 */
+	virtual const Greenpak4PortTable& GetPortTable() const =0;
+
+	/**
+		@brief Returns a bitmask of the port IDs that connect to general fabric routing
+	 */
+	virtual uint32_t GetFabricPortMask() const =0;
+
+	unsigned int LookupPort(const std::string& name) const;
+	unsigned int LookupOutputPort(const std::string& name);
+
+	const char* GetPortName(unsigned int port) const
+	{ return (port < GetPortTable().m_count) ? GetPortTable().m_ports[port].m_name : ""; }
+
 	/**
 		@brief Sets the input with the given name to the specified net
 	 */
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src) =0;
+	void SetInput(const std::string& port, Greenpak4EntityOutput src);
+
+	/**
+		@brief Sets the input with the given port ID to the specified net
+	 */
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src) =0;
 
 	/**
 		@brief Gets the net number for the given output
 	 */
-	virtual unsigned int GetOutputNetNumber(std::string port) =0;
+	unsigned int GetOutputNetNumber(const std::string& port);
+
+	/**
+		@brief Gets the net number for the output with the given port ID
+	 */
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port) =0;
 
 	/**
 		@brief Gets the net number for the given output
@@ -88,7 +185,7 @@ public:
 		@brief Returns true if this entity maps to a node in the netlist.
 	 */
 	bool IsUsed()
-	{ return (m_parnode->GetMate() != NULL); }
+	{ return (m_parnode != NULL) && (m_parnode->GetMate() != NULL); }
 
 	void SetPARNode(PARGraphNode* node)
 	{ m_parnode = node; }
@@ -103,6 +200,19 @@ public:
 	Greenpak4Device* GetDevice()
 	{ return m_device; }
 
+	Kind GetKind() const
+	{ return m_kind; }
+
+	uint32_t GetCapabilities() const
+	{ return m_capabilities; }
+
+	bool HasCapability(Capability cap) const
+	{ return (m_capabilities & cap) != 0; }
+
+	///Position of this entity in the order the device created its entities (stable for a given part)
+	unsigned int GetEntityIndex() const
+	{ return m_entityIndex; }
+
 	/**
 		@brief Returns a human-readable description of this node (like LUT3_1)
 	 */
@@ -118,15 +228,44 @@ public:
 	{ return m_dual; }
 
 	//Get a list of input ports on this node that connect to general fabric routing (may be empty)
-	virtual std::vector<std::string> GetInputPorts() const =0;
+	std::vector<std::string> GetInputPorts() const;
 
 	//Get a list of output ports on this node that connect to general fabric routing (may be empty)
-	virtual std::vector<std::string> GetOutputPorts() const =0;
+	std::vector<std::string> GetOutputPorts() const;
 
 	//Commit changes from the assigned PAR graph node to us
 	virtual bool CommitChanges() =0;
 
-	bool IsGeneralFabricInput(std::string port) const;
+	/**
+		@brief Gets the signal driving the given input port.
+
+		Unlike GetInputPorts() this covers dedicated and analog inputs too, using the port names of the HDL
+		primitive. Used to walk a configuration after Load().
+	 */
+	virtual Greenpak4EntityOutput GetInput(std::string port) =0;
+
+	/**
+		@brief Returns the name of the HDL primitive (GP_*) our current configuration implements
+	 */
+	virtual std::string GetPrimitiveName() =0;
+
+	/**
+		@brief Returns the HDL parameters describing our current configuration, as Verilog literals
+	 */
+	virtual std::map<std::string, std::string> GetParameters() =0;
+
+	/**
+		@brief Declares every bitstream field we read or write (matrix selectors are named after their port)
+	 */
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map) =0;
+
+	bool IsGeneralFabricInput(const std::string& port) const
+	{ return IsGeneralFabricInput(LookupPort(port)); }
+
+	bool IsGeneralFabricInput(unsigned int port) const
+	{
+		return (port < 32) && ( (GetFabricPortMask() >> port) & 1 ) && !GetPortTable().m_ports[port].m_output;
+	}
 
 	bool HasLoadsOnPort(std::string port);
 
@@ -135,20 +274,55 @@ protected:
 	///Return our assigned netlist entity, if we have one (or NULL if not)
 	Greenpak4NetlistEntity* GetNetlistEntity();
 
+	///Return our assigned netlist entity if it's a cell (or NULL if not)
+	Greenpak4NetlistCell* GetNetlistCell();
+
 	/**
 		@brief Writes a matrix select value to the bitstream
 
 		Set cross_matrix for cross connections only
 	 */
 	bool WriteMatrixSelector(
-		bool* bitstream,
+		Greenpak4Bitstream& bitstream,
 		unsigned int wordpos,
 		Greenpak4EntityOutput signal,
 		bool cross_matrix = false);
 
+	/**
+		@brief Reads a matrix select value from the bitstream and looks up the signal it selects
+
+		Inverse of WriteMatrixSelector(). Set cross_matrix for cross connections only.
+	 */
+	bool ReadMatrixSelector(
+		const Greenpak4Bitstream& bitstream,
+		unsigned int wordpos,
+		Greenpak4EntityOutput& signal,
+		bool cross_matrix = false);
+
+	/**
+		@brief Declares a matrix select word as one of our fields
+
+		Arguments match WriteMatrixSelector(); set shared if other entities use the same word.
+	 */
+	void RegisterMatrixSelector(
+		Greenpak4BitFieldMap& map,
+		std::string name,
+		unsigned int wordpos,
+		bool cross_matrix = false,
+		bool shared = false);
+
+	///Our concrete class
+	Kind m_kind;
+
+	///Capability flags for our kind
+	uint32_t m_capabilities;
+
 	///The device we're attached to
 	Greenpak4Device* m_device;
 
+	///Creation order within the device
+	unsigned int m_entityIndex;
+
 	///Number of the routing matrix we're attached to (currently 0 or 1 for all GP4 devices)
 	unsigned int m_matrix;
 
@@ -37,7 +37,7 @@ Greenpak4Comparator::Greenpak4Comparator(
 		unsigned int cbase_hyst,
 		unsigned int cbase_vref
 		)
-		: Greenpak4BitstreamEntity(device, matrix, ibase, oword, -1)
+		: Greenpak4BitstreamEntity(KIND_COMPARATOR, device, matrix, ibase, oword, -1)
 		, m_pwren(device->GetGround())
 		, m_vin(device->GetGround())
 		, m_vref(device->GetGround())
@@ -70,35 +70,40 @@ string Greenpak4Comparator::GetDescription()
 	return string(buf);
 }
 
-vector<string> Greenpak4Comparator::GetInputPorts() const
+static const Greenpak4EntityPort g_acmpPorts[] =
 {
-	vector<string> r;
-	r.push_back("PWREN");
-	return r;
+	{ "PWREN",  false },
+	{ "VIN",    false },
+	{ "VREF",   false },
+	{ "OUT",    true },
+};
+static const Greenpak4PortTable g_acmpPortTable = PORT_TABLE(g_acmpPorts);
+
+const Greenpak4PortTable& Greenpak4Comparator::GetPortTable() const
+{
+	return g_acmpPortTable;
 }
 
-void Greenpak4Comparator::SetInput(string port, Greenpak4EntityOutput src)
+uint32_t Greenpak4Comparator::GetFabricPortMask() const
 {
-	if(port == "PWREN")
+	return (1 << PORT_PWREN) | (1 << PORT_OUT);
+}
+
+void Greenpak4Comparator::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
+{
+	if(port == PORT_PWREN)
 		m_pwren = src;
-	if(port == "VIN")
+	if(port == PORT_VIN)
 		m_vin = src;
-	if(port == "VREF")
+	if(port == PORT_VREF)
 		m_vref = src;
 
 	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-vector<string> Greenpak4Comparator::GetOutputPorts() const
-{
-	vector<string> r;
-	r.push_back("OUT");
-	return r;
-}
-
-unsigned int Greenpak4Comparator::GetOutputNetNumber(string port)
+unsigned int Greenpak4Comparator::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "OUT")
+	if(port == PORT_OUT)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -110,7 +115,7 @@ unsigned int Greenpak4Comparator::GetOutputNetNumber(string port)
 bool Greenpak4Comparator::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -129,14 +134,81 @@ bool Greenpak4Comparator::CommitChanges()
 	return true;
 }
 
-bool Greenpak4Comparator::Load(bool* /*bitstream*/)
+bool Greenpak4Comparator::Load(const Greenpak4Bitstream& bitstream)
 {
-	//TODO: Do our inputs
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord, m_pwren))
+		return false;
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// CONFIGURATION
+
+	if(m_cbaseIsrc > 0)
+		m_isrcEn = bitstream[m_cbaseIsrc];
+
+	if(m_cbaseBw > 0)
+		m_bandwidthHigh = !bitstream[m_cbaseBw];
+
+	if(m_cbaseGain > 0)
+		m_vinAtten = bitstream.GetField(m_cbaseGain, 2) + 1;
+
+	if(m_cbaseHyst > 0)
+	{
+		static const int hysteresis[] = { 0, 25, 50, 200 };
+		m_hysteresis = hysteresis[bitstream.GetField(m_cbaseHyst, 2)];
+	}
+
+	//Each comparator has its own reference.
+	//Decode it even if we're never powered on, since the VREF may only be driving a pin.
+	auto vref = m_device->GetVref(m_cmpNum);
+	if(!vref->DecodeACMPMuxSel(bitstream.GetField(m_cbaseVref, 5)))
+		return false;
+	m_vref = vref->GetOutput("VOUT");
+
+	//If we're never powered on, treat the signal input as unused
+	if(m_pwren.IsPowerRail() && !m_pwren.GetPowerRailValue())
+	{
+		m_vin = m_device->GetGround();
+		return true;
+	}
+
+	//Input mux: only as many bits as the selector is wide are ours
+	unsigned int maxsel = 0;
+	for(auto it : m_muxsels)
+		maxsel = max(maxsel, it.second);
+	unsigned int sel = 0;
+	if(maxsel >= 1)
+		sel |= bitstream[m_cbaseVin] ? 1 : 0;
+	if(maxsel >= 2)
+		sel |= bitstream[m_cbaseVin + 1] ? 2 : 0;
+
+	//Several sources can share one selector value when it picks up ACMP0's input mux.
+	//Prefer whatever ACMP0 is actually looking at, if it's one of them.
+	vector<Greenpak4EntityOutput> candidates;
+	for(auto it : m_muxsels)
+	{
+		if(it.second == sel)
+			candidates.push_back(it.first);
+	}
+	if(candidates.empty())
+	{
+		LogError("%s: input mux selector %u is not a valid input\n", GetDescription().c_str(), sel);
+		return false;
+	}
+	m_vin = candidates[0];
+	Greenpak4EntityOutput shared = m_device->GetAcmp(0)->GetInput();
+	for(auto c : candidates)
+	{
+		if(c == shared)
+			m_vin = c;
+	}
+
+	return true;
 }
 
-bool Greenpak4Comparator::Save(bool* bitstream)
+bool Greenpak4Comparator::Save(Greenpak4Bitstream& bitstream)
 {
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// INPUT BUS
@@ -266,7 +338,7 @@ bool Greenpak4Comparator::Save(bool* bitstream)
 	unsigned int muxsel = 0;
 	if(m_vref.IsVoltageReference())
 	{
-		Greenpak4VoltageReference* vref = dynamic_cast<Greenpak4VoltageReference*>(m_vref.GetRealEntity());
+		Greenpak4VoltageReference* vref = static_cast<Greenpak4VoltageReference*>(m_vref.GetRealEntity());
 		muxsel = vref->GetACMPMuxSel();
 
 		//TODO: how do we do routing when there's a dedicated reference input used?
@@ -290,11 +362,66 @@ bool Greenpak4Comparator::Save(bool* bitstream)
 			);
 	}
 
-	bitstream[m_cbaseVref + 0] = (muxsel & 1) ? true : false;
-	bitstream[m_cbaseVref + 1] = (muxsel & 2) ? true : false;
-	bitstream[m_cbaseVref + 2] = (muxsel & 4) ? true : false;
-	bitstream[m_cbaseVref + 3] = (muxsel & 8) ? true : false;
-	bitstream[m_cbaseVref + 4] = (muxsel & 16) ? true : false;
+	bitstream.SetField(m_cbaseVref, 5, muxsel);
 
 	return true;
 }
+
+void Greenpak4Comparator::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	RegisterMatrixSelector(map, "PWREN", m_inputBaseWord);
+
+	if(m_cbaseIsrc > 0)
+		map.AddField(this, "VIN_ISRC_EN", m_cbaseIsrc, 1);
+	if(m_cbaseBw > 0)
+		map.AddField(this, "BANDWIDTH", m_cbaseBw, 1);
+	if(m_cbaseGain > 0)
+		map.AddField(this, "VIN_ATTEN", m_cbaseGain, 2);
+	if(m_cbaseHyst > 0)
+		map.AddField(this, "HYSTERESIS", m_cbaseHyst, 2);
+
+	//Input mux is only as wide as the largest selector value
+	unsigned int maxsel = 0;
+	for(auto it : m_muxsels)
+		maxsel = max(maxsel, it.second);
+	if(maxsel >= 2)
+		map.AddField(this, "VIN_SEL", m_cbaseVin, 2);
+	else if(maxsel >= 1)
+		map.AddField(this, "VIN_SEL", m_cbaseVin, 1);
+
+	//Our voltage reference's setting lives here too
+	map.AddField(this, "VREF_SEL", m_cbaseVref, 5);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4Comparator::GetInput(string port)
+{
+	if(port == "PWREN")
+		return m_pwren;
+	else if(port == "VIN")
+		return m_vin;
+	else if(port == "VREF")
+		return m_vref;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4Comparator::GetPrimitiveName()
+{
+	return "GP_ACMP";
+}
+
+map<string, string> Greenpak4Comparator::GetParameters()
+{
+	map<string, string> params;
+	char buf[32];
+	params["BANDWIDTH"] = m_bandwidthHigh ? "\"HIGH\"" : "\"LOW\"";
+	snprintf(buf, sizeof(buf), "%d", m_vinAtten);
+	params["VIN_ATTEN"] = buf;
+	params["VIN_ISRC_EN"] = m_isrcEn ? "1'b1" : "1'b0";
+	snprintf(buf, sizeof(buf), "%d", m_hysteresis);
+	params["HYSTERESIS"] = buf;
+	return params;
+}
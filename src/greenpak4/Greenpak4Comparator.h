@@ -25,6 +25,15 @@ class Greenpak4Comparator : public Greenpak4BitstreamEntity
 {
 public:
 
+	///IDs of our ports (indexes into our port table)
+	enum Port
+	{
+		PORT_PWREN,
+		PORT_VIN,
+		PORT_VREF,
+		PORT_OUT
+	};
+
 	//Construction / destruction
 	Greenpak4Comparator(
 		Greenpak4Device* device,
@@ -41,21 +50,26 @@ public:
 		);
 
 	//Serialization
-	virtual bool Load(bool* bitstream);
-	virtual bool Save(bool* bitstream);
+	virtual bool Load(const Greenpak4Bitstream& bitstream);
+	virtual bool Save(Greenpak4Bitstream& bitstream);
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map);
 
 	virtual ~Greenpak4Comparator();
 
 	virtual std::string GetDescription();
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
-	virtual unsigned int GetOutputNetNumber(std::string port);
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
 	//Accessors
 	void AddInputMuxEntry(Greenpak4EntityOutput net, unsigned int sel)
 	{ m_muxsels[net] = sel; }
@@ -63,6 +77,9 @@ public:
 	Greenpak4EntityOutput GetInput()
 	{ return m_vin; }
 
+	//Port-name setter from the base class (hidden by the overload below otherwise)
+	using Greenpak4BitstreamEntity::SetInput;
+
 	//Helper used by DRC to poke ACMP0's config if necessary
 	void SetInput(Greenpak4EntityOutput input)
 	{ m_vin = input; }
@@ -36,7 +36,7 @@ Greenpak4Counter::Greenpak4Counter(
 	unsigned int ibase,
 	unsigned int oword,
 	unsigned int cbase)
-	: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+	: Greenpak4BitstreamEntity(KIND_COUNTER, device, matrix, ibase, oword, cbase)
 	, m_depth(depth)
 	, m_countnum(countnum)
 	, m_reset(device->GetGround())	//default reset is ground
@@ -79,7 +79,7 @@ string Greenpak4Counter::GetDescription()
 bool Greenpak4Counter::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -132,53 +132,130 @@ bool Greenpak4Counter::CommitChanges()
 	return true;
 }
 
-vector<string> Greenpak4Counter::GetInputPorts() const
+static const Greenpak4EntityPort g_counterPorts[] =
 {
-	vector<string> r;
-	r.push_back("RST");
-	if(m_hasFSM) {
-		r.push_back("UP");
-		r.push_back("KEEP");
-	}
-	return r;
+	{ "CLK",   false },
+	{ "RST",   false },
+	{ "UP",    false },
+	{ "KEEP",  false },
+	{ "OUT",   true },
+};
+static const Greenpak4PortTable g_counterPortTable = PORT_TABLE(g_counterPorts);
+
+const Greenpak4PortTable& Greenpak4Counter::GetPortTable() const
+{
+	return g_counterPortTable;
 }
 
-void Greenpak4Counter::SetInput(string port, Greenpak4EntityOutput src)
+uint32_t Greenpak4Counter::GetFabricPortMask() const
 {
-	if(port == "RST")
+	uint32_t mask = (1 << PORT_RST) | (1 << PORT_OUT);
+	if(m_hasFSM)
+		mask |= (1 << PORT_UP) | (1 << PORT_KEEP);
+	return mask;
+}
+
+void Greenpak4Counter::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
+{
+	if(port == PORT_RST)
 		m_reset = src;
-	else if(port == "CLK")
+	else if(port == PORT_CLK)
 		m_clock = src;
-	else if(port == "UP")
+	else if(port == PORT_UP)
 		m_up = src;
-	else if(port == "KEEP")
+	else if(port == PORT_KEEP)
 		m_keep = src;
 
 	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-vector<string> Greenpak4Counter::GetOutputPorts() const
-{
-	vector<string> r;
-	r.push_back("OUT");
-	return r;
-}
-
-unsigned int Greenpak4Counter::GetOutputNetNumber(string port)
+unsigned int Greenpak4Counter::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "OUT")
+	if(port == PORT_OUT)
 		return m_outputBaseWord;
 	else
 		return -1;
 }
 
-bool Greenpak4Counter::Load(bool* /*bitstream*/)
+bool Greenpak4Counter::Load(const Greenpak4Bitstream& bitstream)
 {
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 0, m_reset))
+		return false;
+	if(m_hasFSM)
+	{
+		if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 1, m_keep))
+			return false;
+		if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 2, m_up))
+			return false;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Configuration
+
+	m_countVal = bitstream.GetField(m_configBase, (m_depth > 8) ? 14 : 8);
+
+	//Clock selector, decoded once we know if we're in counter mode (unused counters leave it zeroed)
+	uint32_t nbase = m_configBase + m_depth;
+	bool wide_clksel = (m_hasFSM || m_hasPWM);
+	unsigned int clksel = bitstream.GetField(nbase, wide_clksel ? 4 : 3);
+	nbase += wide_clksel ? 4 : 3;
+
+	//Reset mode is in the same place for both kinds of counter
+	m_resetMode = static_cast<ResetMode>(bitstream.GetField(nbase, 2));
+
+	//Block function: the low bit of the field is set for counter mode, clear for delay mode
+	bool unused;
+	if(m_hasFSM)
+	{
+		nbase += 2;
+		unused = !bitstream[nbase];
+		nbase += m_hasEdgeDetect ? 2 : 1;
+
+		//Value control
+		m_resetValue = bitstream[nbase + 2] ? COUNT_TO : ZERO;
+	}
+	else
+		unused = !bitstream[nbase + 2];
+
+	m_preDivide = 1;
+	if(unused)
+	{
+		m_clock = m_device->GetGround();
+		return true;
+	}
+
+	//Low-frequency oscillator
+	if(clksel == (wide_clksel ? 10u : 4u))
+		m_clock = m_device->GetLFOscillator()->GetOutput("CLKOUT");
+
+	//Ring oscillator
+	else if(clksel == (wide_clksel ? 8u : 6u))
+		m_clock = m_device->GetRingOscillator()->GetOutput("CLKOUT_HARDIP");
+
+	//RC oscillator, with a pre-divider
+	else
+	{
+		static const unsigned int narrow_divs[] = { 1, 4, 24, 64 };
+		static const unsigned int wide_divs[] = { 1, 4, 12, 24, 64 };
+		if(wide_clksel && (clksel < 5))
+			m_preDivide = wide_divs[clksel];
+		else if(!wide_clksel && (clksel < 4))
+			m_preDivide = narrow_divs[clksel];
+		else
+		{
+			LogError("Counter %d input from clock selector %u not implemented\n", m_countnum, clksel);
+			return false;
+		}
+		m_clock = m_device->GetRCOscillator()->GetOutput("CLKOUT_HARDIP");
+	}
+
+	return true;
 }
 
-bool Greenpak4Counter::Save(bool* bitstream)
+bool Greenpak4Counter::Save(Greenpak4Bitstream& bitstream)
 {
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// INPUT BUS
@@ -215,23 +292,7 @@ bool Greenpak4Counter::Save(bool* bitstream)
 	// Configuration
 
 	//Count value (the same in all modes, just varies with depth)
-	if(m_depth > 8)
-	{
-		bitstream[m_configBase + 13] = (m_countVal & 0x2000) ? true : false;
-		bitstream[m_configBase + 12] = (m_countVal & 0x1000) ? true : false;
-		bitstream[m_configBase + 11] = (m_countVal & 0x0800) ? true : false;
-		bitstream[m_configBase + 10] = (m_countVal & 0x0400) ? true : false;
-		bitstream[m_configBase + 9]  = (m_countVal & 0x0200) ? true : false;
-		bitstream[m_configBase + 8]  = (m_countVal & 0x0100) ? true : false;
-	}
-	bitstream[m_configBase + 7] = (m_countVal & 0x80) ? true : false;
-	bitstream[m_configBase + 6] = (m_countVal & 0x40) ? true : false;
-	bitstream[m_configBase + 5] = (m_countVal & 0x20) ? true : false;
-	bitstream[m_configBase + 4] = (m_countVal & 0x10) ? true : false;
-	bitstream[m_configBase + 3] = (m_countVal & 0x08) ? true : false;
-	bitstream[m_configBase + 2] = (m_countVal & 0x04) ? true : false;
-	bitstream[m_configBase + 1] = (m_countVal & 0x02) ? true : false;
-	bitstream[m_configBase + 0] = (m_countVal & 0x01) ? true : false;
+	bitstream.SetField(m_configBase, (m_depth > 8) ? 14 : 8, m_countVal);
 
 	//Base for remaining configuration data
 	uint32_t nbase = m_configBase + m_depth;
@@ -251,7 +312,7 @@ bool Greenpak4Counter::Save(bool* bitstream)
 	if(m_hasFSM || m_hasPWM)
 	{
 		//Low-frequency oscillator
-		if(dynamic_cast<Greenpak4LFOscillator*>(clk) != NULL)
+		if(clk->GetKind() == KIND_LFOSC)
 		{
 			if(m_preDivide != 1)
 			{
@@ -271,7 +332,7 @@ bool Greenpak4Counter::Save(bool* bitstream)
 		//TODO: Matrix outputs
 
 		//Ring oscillator
-		else if(dynamic_cast<Greenpak4RingOscillator*>(clk) != NULL)
+		else if(clk->GetKind() == KIND_RINGOSC)
 		{
 			if(m_preDivide != 1)
 			{
@@ -290,7 +351,7 @@ bool Greenpak4Counter::Save(bool* bitstream)
 
 		//RC oscillator
 		//TODO: 12 is a legal value for some counters but not others, need to consider this during placement??
-		else if(dynamic_cast<Greenpak4RCOscillator*>(clk) != NULL)
+		else if(clk->GetKind() == KIND_RCOSC)
 		{
 			switch(m_preDivide)
 			{
@@ -360,7 +421,7 @@ bool Greenpak4Counter::Save(bool* bitstream)
 	else
 	{
 		//Low-frequency oscillator
-		if(dynamic_cast<Greenpak4LFOscillator*>(clk) != NULL)
+		if(clk->GetKind() == KIND_LFOSC)
 		{
 			if(m_preDivide != 1)
 			{
@@ -377,7 +438,7 @@ bool Greenpak4Counter::Save(bool* bitstream)
 		}
 
 		//Ring oscillator
-		else if(dynamic_cast<Greenpak4RingOscillator*>(clk) != NULL)
+		else if(clk->GetKind() == KIND_RINGOSC)
 		{
 			if(m_preDivide != 1)
 			{
@@ -394,7 +455,7 @@ bool Greenpak4Counter::Save(bool* bitstream)
 		}
 
 		//RC oscillator
-		else if(dynamic_cast<Greenpak4RCOscillator*>(clk) != NULL)
+		else if(clk->GetKind() == KIND_RCOSC)
 		{
 			switch(m_preDivide)
 			{
@@ -458,8 +519,7 @@ bool Greenpak4Counter::Save(bool* bitstream)
 		////////////////////////////////////////////////////////////////////////////////////////////////////////////
 		// Reset mode
 
-		bitstream[nbase + 1] = (m_resetMode & 2) ? true : false;
-		bitstream[nbase + 0] = (m_resetMode & 1) ? true : false;
+		bitstream.SetField(nbase, 2, m_resetMode);
 
 		////////////////////////////////////////////////////////////////////////////////////////////////////////////
 		// Block function
@@ -532,8 +592,7 @@ bool Greenpak4Counter::Save(bool* bitstream)
 		////////////////////////////////////////////////////////////////////////////////////////////////////////////
 		// Reset mode
 
-		bitstream[nbase + 1] = (m_resetMode & 2) ? true : false;
-		bitstream[nbase + 0] = (m_resetMode & 1) ? true : false;
+		bitstream.SetField(nbase, 2, m_resetMode);
 
 		////////////////////////////////////////////////////////////////////////////////////////////////////////////
 		// Block function
@@ -554,18 +613,12 @@ bool Greenpak4Counter::Save(bool* bitstream)
 		else
 		{
 			//if unused, 2'b00 = delay
-			if(unused)
-			{
-				bitstream[nbase + 3] = false;
-				bitstream[nbase + 2] = false;
-			}
-
 			//2'b01 = CNT
-			else
-			{
+			bitstream[nbase + 2] = !unused;
+
+			//8-bit counters only have the low bit, the next bit is the following counter's count value
+			if(m_depth > 8)
 				bitstream[nbase + 3] = false;
-				bitstream[nbase + 2] = true;
-			}
 		}
 
 		////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -579,3 +632,83 @@ bool Greenpak4Counter::Save(bool* bitstream)
 
 	return true;
 }
+
+void Greenpak4Counter::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	RegisterMatrixSelector(map, "RST", m_inputBaseWord + 0);
+	if(m_hasFSM)
+	{
+		RegisterMatrixSelector(map, "KEEP", m_inputBaseWord + 1);
+		RegisterMatrixSelector(map, "UP", m_inputBaseWord + 2);
+	}
+
+	map.AddField(this, "COUNT_TO", m_configBase, (m_depth > 8) ? 14 : 8);
+	uint32_t nbase = m_configBase + m_depth;
+
+	//FSM/PWM have 4-bit clock selector, others have 3
+	unsigned int clkbits = (m_hasFSM || m_hasPWM) ? 4 : 3;
+	map.AddField(this, "CLK_SEL", nbase, clkbits);
+	nbase += clkbits;
+
+	map.AddField(this, "RESET_MODE", nbase, 2);
+	nbase += 2;
+
+	if(m_hasFSM)
+	{
+		unsigned int fbits = m_hasEdgeDetect ? 2 : 1;
+		map.AddField(this, "FUNCTION", nbase, fbits);
+		nbase += fbits;
+
+		map.AddField(this, "FSM_DATA_SEL", nbase, 2);
+		map.AddField(this, "RESET_VALUE", nbase + 2, 1);
+	}
+
+	else
+	{
+		//8-bit and PWM counters only have the low bit of the block function
+		unsigned int fbits = (m_hasPWM || (m_depth <= 8)) ? 1 : 2;
+		map.AddField(this, "FUNCTION", nbase, fbits);
+		if(m_hasWakeSleepPowerDown)
+			map.AddField(this, "WAKE_SLEEP", nbase + 2, 1);
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4Counter::GetInput(string port)
+{
+	if(port == "RST")
+		return m_reset;
+	else if(port == "CLK")
+		return m_clock;
+	else if(port == "UP")
+		return m_up;
+	else if(port == "KEEP")
+		return m_keep;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4Counter::GetPrimitiveName()
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "GP_COUNT%u%s", m_depth, m_hasFSM ? "_ADV" : "");
+	return string(buf);
+}
+
+map<string, string> Greenpak4Counter::GetParameters()
+{
+	static const char* reset_modes[] = { "\"BOTH\"", "\"FALLING\"", "\"RISING\"", "\"LEVEL\"" };
+
+	map<string, string> params;
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%u", m_countVal);
+	params["COUNT_TO"] = buf;
+	snprintf(buf, sizeof(buf), "%u", m_preDivide);
+	params["CLKIN_DIVIDE"] = buf;
+	params["RESET_MODE"] = reset_modes[m_resetMode];
+	if(m_hasFSM)
+		params["RESET_VALUE"] = (m_resetValue == COUNT_TO) ? "\"COUNT_TO\"" : "\"ZERO\"";
+	return params;
+}
@@ -26,6 +26,16 @@ class Greenpak4Counter : public Greenpak4BitstreamEntity
 {
 public:
 
+	///IDs of our ports (indexes into our port table)
+	enum Port
+	{
+		PORT_CLK,
+		PORT_RST,
+		PORT_UP,
+		PORT_KEEP,
+		PORT_OUT
+	};
+
 	//Construction / destruction
 	Greenpak4Counter(
 		Greenpak4Device* device,
@@ -42,8 +52,9 @@ public:
 	virtual ~Greenpak4Counter();
 
 	//Serialization
-	virtual bool Load(bool* bitstream);
-	virtual bool Save(bool* bitstream);
+	virtual bool Load(const Greenpak4Bitstream& bitstream);
+	virtual bool Save(Greenpak4Bitstream& bitstream);
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map);
 
 	virtual std::string GetDescription();
 
@@ -56,6 +67,12 @@ public:
 	bool HasFSM()
 	{ return m_hasFSM; }
 
+	unsigned int GetCountValue()
+	{ return m_countVal; }
+
+	unsigned int GetClockDivider()
+	{ return m_preDivide; }
+
 	enum ResetMode
 	{
 		BOTH_EDGE = 0,
@@ -70,14 +87,18 @@ public:
 		COUNT_TO = 1
 	};
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
-	virtual unsigned int GetOutputNetNumber(std::string port);
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
 protected:
 
 	///Bit depth of this counter
@@ -30,7 +30,7 @@ Greenpak4CrossConnection::Greenpak4CrossConnection(
 		unsigned int ibase,
 		unsigned int oword,
 		unsigned int cbase)
-		: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+		: Greenpak4BitstreamEntity(KIND_CROSS_CONNECTION, device, matrix, ibase, oword, cbase)
 		, m_input(device->GetGround())
 {
 }
@@ -50,7 +50,24 @@ string Greenpak4CrossConnection::GetDescription()
 	return string(buf);
 }
 
-void Greenpak4CrossConnection::SetInput(std::string /*port*/, Greenpak4EntityOutput input)
+static const Greenpak4EntityPort g_xconnPorts[] =
+{
+	{ "I",  false },
+	{ "O",  true },
+};
+static const Greenpak4PortTable g_xconnPortTable = PORT_TABLE(g_xconnPorts);
+
+const Greenpak4PortTable& Greenpak4CrossConnection::GetPortTable() const
+{
+	return g_xconnPortTable;
+}
+
+uint32_t Greenpak4CrossConnection::GetFabricPortMask() const
+{
+	return (1 << PORT_I) | (1 << PORT_O);
+}
+
+void Greenpak4CrossConnection::SetInputByID(unsigned int /*port*/, Greenpak4EntityOutput input)
 {
 	//Don't complain if input is a power rail, those are the sole exception
 	if(input.IsPowerRail())
@@ -78,21 +95,7 @@ bool Greenpak4CrossConnection::CommitChanges()
 	return true;
 }
 
-vector<string> Greenpak4CrossConnection::GetInputPorts() const
-{
-	vector<string> r;
-	r.push_back("I");
-	return r;
-}
-
-vector<string> Greenpak4CrossConnection::GetOutputPorts() const
-{
-	vector<string> r;
-	r.push_back("O");
-	return r;
-}
-
-unsigned int Greenpak4CrossConnection::GetOutputNetNumber(string /*port*/)
+unsigned int Greenpak4CrossConnection::GetOutputNetNumberByID(unsigned int /*port*/)
 {
 	//we respond to any net name for convenience
 	return m_outputBaseWord;
@@ -101,17 +104,45 @@ unsigned int Greenpak4CrossConnection::GetOutputNetNumber(string /*port*/)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Load/save logic
 
-bool Greenpak4CrossConnection::Load(bool* /*bitstream*/)
+bool Greenpak4CrossConnection::Load(const Greenpak4Bitstream& bitstream)
 {
-	//TODO: Do our inputs
-	LogError("Unimplemented\n");
-	return false;
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord, m_input, true))
+		return false;
+
+	return true;
 }
 
-bool Greenpak4CrossConnection::Save(bool* bitstream)
+bool Greenpak4CrossConnection::Save(Greenpak4Bitstream& bitstream)
 {
 	if(!WriteMatrixSelector(bitstream, m_inputBaseWord, m_input, true))
 		return false;
 
 	return true;
 }
+
+void Greenpak4CrossConnection::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	RegisterMatrixSelector(map, "I", m_inputBaseWord, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4CrossConnection::GetInput(string port)
+{
+	if(port == "I")
+		return m_input;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4CrossConnection::GetPrimitiveName()
+{
+	//Routing resource, not a primitive
+	return "";
+}
+
+map<string, string> Greenpak4CrossConnection::GetParameters()
+{
+	return map<string, string>();
+}
@@ -31,7 +31,7 @@ Greenpak4DAC::Greenpak4DAC(
 	unsigned int cbase_insel,
 	unsigned int cbase_aon,
 	unsigned int dacnum)
-	: Greenpak4BitstreamEntity(device, 0, -1, -1, -1)
+	: Greenpak4BitstreamEntity(KIND_DAC, device, 0, -1, -1, -1)
 		, m_vref(device->GetGround())
 		, m_dacnum(dacnum)
 		, m_cbaseReg(cbase_reg)
@@ -67,46 +67,44 @@ string Greenpak4DAC::GetDescription()
 	return string(buf);
 }
 
-vector<string> Greenpak4DAC::GetInputPorts() const
+static const Greenpak4EntityPort g_dacPorts[] =
 {
-	vector<string> r;
-	//no general fabric inputs
-	return r;
+	{ "DIN[0]",  false },
+	{ "DIN[1]",  false },
+	{ "DIN[2]",  false },
+	{ "DIN[3]",  false },
+	{ "DIN[4]",  false },
+	{ "DIN[5]",  false },
+	{ "DIN[6]",  false },
+	{ "DIN[7]",  false },
+	{ "VREF",    false },
+	{ "VOUT",    true },
+};
+static const Greenpak4PortTable g_dacPortTable = PORT_TABLE(g_dacPorts);
+
+const Greenpak4PortTable& Greenpak4DAC::GetPortTable() const
+{
+	return g_dacPortTable;
 }
 
-void Greenpak4DAC::SetInput(string port, Greenpak4EntityOutput src)
+uint32_t Greenpak4DAC::GetFabricPortMask() const
 {
-	if(port == "VREF")
+	//no general fabric ports
+	return 0;
+}
+
+void Greenpak4DAC::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
+{
+	if(port == PORT_VREF)
 		m_vref = src;
 
-	else if(port.find("DIN") == 0)
-	{
-		int b = 0;
-		if(1 != sscanf(port.c_str(), "DIN[%d]", &b))
-		{
-			LogError("Greenpak4DAC: Malformed input name\n");
-			return;
-		}
-		if( (b < 0) || (b >= 8) )
-		{
-			LogError("Greenpak4DAC: Out of range input index\n");
-			return;
-		}
-
-		m_din[b] = src;
-	}
+	else if( (port >= PORT_DIN0) && (port <= PORT_DIN7) )
+		m_din[port - PORT_DIN0] = src;
 
 	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-vector<string> Greenpak4DAC::GetOutputPorts() const
-{
-	vector<string> r;
-	//no general fabric outputs
-	return r;
-}
-
-unsigned int Greenpak4DAC::GetOutputNetNumber(string /*port*/)
+unsigned int Greenpak4DAC::GetOutputNetNumberByID(unsigned int /*port*/)
 {
 	//no general fabric outputs
 	return -1;
@@ -121,14 +119,33 @@ bool Greenpak4DAC::CommitChanges()
 	return true;
 }
 
-bool Greenpak4DAC::Load(bool* /*bitstream*/)
+bool Greenpak4DAC::Load(const Greenpak4Bitstream& bitstream)
 {
-	//TODO: Do our inputs
-	LogError("Unimplemented\n");
-	return false;
+	//Powered down? Leave everything tied off.
+	//NB: on SLG4662x DAC1 turns on DAC0's power bit too, so a DAC1-only design loads with DAC0 enabled
+	//and a zero input. This is harmless (it saves back to the same bits).
+	if(!bitstream[m_cbasePwr])
+		return true;
+
+	//Reference is always a constant 1.0V from our dedicated VREF (see Save)
+	auto vref = m_device->GetVref(6 + m_dacnum);
+	vref->SetConstantVoltage(1000);
+	m_vref = vref->GetOutput("VOUT");
+
+	//Only the register input selector is implemented
+	if(bitstream[m_cbaseInsel] != (m_dacnum != 0))
+	{
+		LogError("Greenpak4DAC: input from counters etc not implemented yet\n");
+		return false;
+	}
+
+	for(unsigned int i=0; i<8; i++)
+		m_din[i] = m_device->GetPowerNet(bitstream[m_cbaseReg + i]);
+
+	return true;
 }
 
-bool Greenpak4DAC::Save(bool* bitstream)
+bool Greenpak4DAC::Save(Greenpak4Bitstream& bitstream)
 {
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// INPUT BUS
@@ -145,7 +162,7 @@ bool Greenpak4DAC::Save(bool* bitstream)
 		LogError("DRC: DAC should have a voltage reference driving VREF, but something else was supplied instead\n");
 		return false;
 	}
-	auto v = dynamic_cast<Greenpak4VoltageReference*>(m_vref.GetRealEntity());
+	auto v = static_cast<Greenpak4VoltageReference*>(m_vref.GetRealEntity());
 	if(!v->IsConstantVoltage() || (v->GetOutputVoltage() != 1000) )
 	{
 		LogError("DRC: DAC should be driven by a constant 1000 mV reference\n");
@@ -209,3 +226,41 @@ bool Greenpak4DAC::Save(bool* bitstream)
 
 	return true;
 }
+
+void Greenpak4DAC::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	map.AddField(this, "DIN", m_cbaseReg, 8);
+
+	//DAC0's power bit is also the always-on bit DAC1 needs, so both of us use it
+	map.AddField(this, "PWREN", m_cbasePwr, 1, (m_cbasePwr == m_cbaseAon));
+	if(m_cbaseAon != m_cbasePwr)
+		map.AddField(this, "DAC0_PWREN", m_cbaseAon, 1, true);
+
+	map.AddField(this, "INSEL", m_cbaseInsel, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4DAC::GetInput(string port)
+{
+	if(port == "VREF")
+		return m_vref;
+
+	int b = 0;
+	if( (1 == sscanf(port.c_str(), "DIN[%d]", &b)) && (b >= 0) && (b < 8) )
+		return m_din[b];
+
+	return Greenpak4EntityOutput();
+}
+
+string Greenpak4DAC::GetPrimitiveName()
+{
+	return "GP_DAC";
+}
+
+map<string, string> Greenpak4DAC::GetParameters()
+{
+	//No configuration
+	return map<string, string>();
+}
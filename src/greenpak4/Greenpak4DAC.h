@@ -25,6 +25,21 @@ class Greenpak4DAC : public Greenpak4BitstreamEntity
 {
 public:
 
+	///IDs of our ports (indexes into our port table)
+	enum Port
+	{
+		PORT_DIN0,
+		PORT_DIN1,
+		PORT_DIN2,
+		PORT_DIN3,
+		PORT_DIN4,
+		PORT_DIN5,
+		PORT_DIN6,
+		PORT_DIN7,
+		PORT_VREF,
+		PORT_VOUT
+	};
+
 	//Construction / destruction
 	Greenpak4DAC(
 		Greenpak4Device* device,
@@ -35,21 +50,26 @@ public:
 		unsigned int dacnum);
 
 	//Serialization
-	virtual bool Load(bool* bitstream);
-	virtual bool Save(bool* bitstream);
+	virtual bool Load(const Greenpak4Bitstream& bitstream);
+	virtual bool Save(Greenpak4Bitstream& bitstream);
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map);
 
 	virtual ~Greenpak4DAC();
 
 	virtual std::string GetDescription();
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
-	virtual unsigned int GetOutputNetNumber(std::string port);
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
 	unsigned int GetDACNum()
 	{ return m_dacnum; }
 
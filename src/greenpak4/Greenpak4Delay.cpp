@@ -30,7 +30,7 @@ Greenpak4Delay::Greenpak4Delay(
 		unsigned int ibase,
 		unsigned int obase,
 		unsigned int cbase)
-		: Greenpak4BitstreamEntity(device, matrix, ibase, obase, cbase)
+		: Greenpak4BitstreamEntity(KIND_DELAY, device, matrix, ibase, obase, cbase)
 		, m_input(device->GetGround())
 		, m_delayTap(1)
 		, m_mode(DELAY)
@@ -53,31 +53,34 @@ string Greenpak4Delay::GetDescription()
 	return string(buf);
 }
 
-vector<string> Greenpak4Delay::GetInputPorts() const
+static const Greenpak4EntityPort g_delayPorts[] =
 {
-	vector<string> r;
-	r.push_back("IN");
-	return r;
-}
+	{ "IN",   false },
+	{ "OUT",  true },
+};
+static const Greenpak4PortTable g_delayPortTable = PORT_TABLE(g_delayPorts);
 
-void Greenpak4Delay::SetInput(string port, Greenpak4EntityOutput src)
+const Greenpak4PortTable& Greenpak4Delay::GetPortTable() const
 {
-	if(port == "IN")
-		m_input = src;
+	return g_delayPortTable;
+}
 
-	//ignore anything else silently (should not be possible since synthesis would error out)
+uint32_t Greenpak4Delay::GetFabricPortMask() const
+{
+	return (1 << PORT_IN) | (1 << PORT_OUT);
 }
 
-vector<string> Greenpak4Delay::GetOutputPorts() const
+void Greenpak4Delay::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	vector<string> r;
-	r.push_back("OUT");
-	return r;
+	if(port == PORT_IN)
+		m_input = src;
+
+	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-unsigned int Greenpak4Delay::GetOutputNetNumber(string port)
+unsigned int Greenpak4Delay::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "OUT")
+	if(port == PORT_OUT)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -89,12 +92,12 @@ unsigned int Greenpak4Delay::GetOutputNetNumber(string port)
 bool Greenpak4Delay::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
 	//Delay line
-	if(ncell->m_type == "GP_DELAY")
+	if(ncell->IsType(GP_PRIM_DELAY))
 		m_mode = DELAY;
 
 	//Edge detector
@@ -128,14 +131,28 @@ bool Greenpak4Delay::CommitChanges()
 	return true;
 }
 
-bool Greenpak4Delay::Load(bool* /*bitstream*/)
+bool Greenpak4Delay::Load(const Greenpak4Bitstream& bitstream)
 {
-	//TODO: Do our inputs
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord, m_input))
+		return false;
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// CONFIGURATION
+
+	//Mode selector
+	static const modes mode_sels[] = { RISING_EDGE, FALLING_EDGE, BOTH_EDGE, DELAY };
+	m_mode = mode_sels[bitstream.GetField(m_configBase + 0, 2)];
+
+	m_delayTap = bitstream.GetField(m_configBase + 2, 2) + 1;
+	m_glitchFilter = bitstream[m_configBase + 4];
+
+	return true;
 }
 
-bool Greenpak4Delay::Save(bool* bitstream)
+bool Greenpak4Delay::Save(Greenpak4Bitstream& bitstream)
 {
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// INPUT BUS
@@ -179,11 +196,54 @@ bool Greenpak4Delay::Save(bool* bitstream)
 	}
 
 	//Number of taps
-	bitstream[m_configBase + 2] = (ntap & 1) ? true : false;
-	bitstream[m_configBase + 3] = (ntap & 2) ? true : false;
+	bitstream.SetField(m_configBase + 2, 2, ntap);
 
 	//Glitch filter
 	bitstream[m_configBase + 4] = m_glitchFilter;
 
 	return true;
 }
+
+void Greenpak4Delay::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	RegisterMatrixSelector(map, "IN", m_inputBaseWord);
+
+	map.AddField(this, "MODE", m_configBase + 0, 2);
+	map.AddField(this, "DELAY_STEPS", m_configBase + 2, 2);
+	map.AddField(this, "GLITCH_FILTER", m_configBase + 4, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4Delay::GetInput(string port)
+{
+	if(port == "IN")
+		return m_input;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4Delay::GetPrimitiveName()
+{
+	if(m_mode == DELAY)
+		return "GP_DELAY";
+	else
+		return "GP_EDGEDET";
+}
+
+map<string, string> Greenpak4Delay::GetParameters()
+{
+	map<string, string> params;
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%d", m_delayTap);
+	params["DELAY_STEPS"] = buf;
+	params["GLITCH_FILTER"] = m_glitchFilter ? "1" : "0";
+	if(m_mode == RISING_EDGE)
+		params["EDGE_DIRECTION"] = "\"RISING\"";
+	else if(m_mode == FALLING_EDGE)
+		params["EDGE_DIRECTION"] = "\"FALLING\"";
+	else if(m_mode == BOTH_EDGE)
+		params["EDGE_DIRECTION"] = "\"BOTH\"";
+	return params;
+}
@@ -30,6 +30,9 @@ Greenpak4Device::Greenpak4Device(
 	Greenpak4IOB::PullDirection default_pull,
 	Greenpak4IOB::PullStrength default_drive)
 	: m_part(part)
+	, m_description(NULL)
+	, m_partMask(0)
+	, m_nextEntityIndex(0)
 {
 	//Initialize everything
 	switch(part)
@@ -39,11 +42,11 @@ Greenpak4Device::Greenpak4Device(
 		break;
 
 	case GREENPAK4_SLG46620:
-		CreateDevice_SLG4662x(false);
+		CreateDevice(g_slg4662xDescription, GP_PART_SLG46620);
 		break;
 
 	case GREENPAK4_SLG46621:
-		CreateDevice_SLG4662x(true);
+		CreateDevice(g_slg4662xDescription, GP_PART_SLG46621);
 		break;
 
 	default:
@@ -72,422 +75,238 @@ void Greenpak4Device::CreateDevice_SLG46140()
 	LogFatal("unimplemented\n");
 }
 
-void Greenpak4Device::CreateDevice_SLG4662x(bool dual_rail)
+/**
+	@brief Instantiates every entity the description has for this part, in table order
+ */
+void Greenpak4Device::CreateDevice(const Greenpak4DeviceDescription& desc, unsigned int parts)
 {
-	//64 inputs per routing matrix
-	m_matrixBits = 6;
+	m_description = &desc;
+	m_partMask = parts;
 
-	//Create power rails
-	//These have to come first, since all other devices will refer to these during construction
-	m_constantZero = new Greenpak4PowerRail(this, 0, 0);
-	m_constantOne = new Greenpak4PowerRail(this, 0, 63);
+	m_matrixBits = desc.m_matrixBits;
+	m_bitlen = desc.m_bitlen;
+	m_matrixBase[0] = desc.m_matrixBase[0];
+	m_matrixBase[1] = desc.m_matrixBase[1];
 
-	//Create the LUT2s (4 per device half)
-	for(int i=0; i<4; i++)
-	{
-		m_lut2s.push_back(new Greenpak4LUT(
-			this,
-			i,
-			0,			//First half of LUT2s are attached to crossbar #0
-			i*2,		//LUT2 base is row 0, then 2 inputs per LUT
-			i+1,		//First mux entry is ground, then the LUT2s
-			576 + i*4,	//LUT2s start at bitstream offset 576, 2^2 bits per LUT
-			2));		//this is a LUT2
-	}
-	for(int i=0; i<4; i++)
+	for(unsigned int i=0; i<desc.m_siteCount; i++)
 	{
-		m_lut2s.push_back(new Greenpak4LUT(
-			this,
-			i+4,
-			1,			//Second half are attached to crossbar #1
-			i*2,		//LUT2 base is row 0, then 2 inputs per LUT
-			i+1,		//First mux entry is ground, then the LUT2s
-			698 + i*4,	//LUT2s start at bitstream offset 698, 2^2 bits per LUT
-			2));		//this is a LUT2
+		if(HasPart(desc.m_sites[i].m_parts))
+			CreateSite(desc.m_sites[i]);
 	}
 
-	//Create the LUT3s (8 per device half)
-	for(int i=0; i<8; i++)
-	{
-		m_lut3s.push_back(new Greenpak4LUT(
-			this,
-			i,
-			0,			//First half of LUT3s are attached to crossbar #0
-			i*3 + 8,	//LUT3 base is row 8, then 3 inputs per LUT
-			i+5,		//we come after the last LUT2
-			592 + i*8,	//LUT2s start at bitstream offset 592, 2^3 bits per LUT
-			3));		//this is a LUT3
-	}
-	for(int i=0; i<8; i++)
-	{
-		m_lut3s.push_back(new Greenpak4LUT(
-			this,
-			i+8,
-			1,			//Second half are attached to crossbar #1
-			i*3 + 8,	//LUT3 base is row 8, then 3 inputs per LUT
-			i+5,		//we come after the last LUT2
-			714 + i*8,	//LUT3s start at bitstream offset 714, 2^3 bits per LUT
-			3));		//this is a LUT3
-	}
+	//Do final initialization
+	CreateDevice_common();
+}
 
-	//Create the second LUT4 (no special functionality)
-	//Put it FIRST in the array so that initial placement prefers it
-	//and doesn't take up the PGEN site right away
-	m_lut4s.push_back(new Greenpak4LUT(
-		this,
-		1,
-		1,		//Attached to crossbar #1
-		32,		//LUT4 base is row 32
-		13,		//we come after the last LUT3
-		778,	//LUT4s start at bitstream offset 778, 2^4 bits per LUT
-		4));	//this is a LUT4
-
-	//Create the first LUT, and its pattern-generator alter ego
-	auto lut40 = new Greenpak4LUT(
-		this,
-		0,
-		0,		//Attached to crossbar #0
-		32,		//LUT4 base is row 32
-		13,		//we come after the last LUT3
-		656,	//LUT4 starts after last LUT3
-		4);	//this is a LUT4
-	auto pgen = new Greenpak4PatternGenerator(
-		this,
-		0,
-		32,
-		13,
-		656);
-
-	//Create the paired cell for them
-	auto lpgen = new Greenpak4PairedEntity(
-		this,
-		0,		//Attached to crossbar #0
-		676,	//Selector bit for LUT or PGEN mode
-		lut40,	//select=0 means we're a LUT
-		pgen);	//select=1 means we're a PGEN
-
-	lpgen->AddType("GP_INV", 0);	//Combinatorial logic all uses the LUT
-	lpgen->AddType("GP_2LUT", 0);
-	lpgen->AddType("GP_3LUT", 0);
-	lpgen->AddType("GP_4LUT", 0);
-	lpgen->AddType("GP_PGEN", 1);	//Pattern generator is the only block mapped to the PGEN
-
-	m_lut4s.push_back(lpgen);
-
-	//Create the Type-A IOBs (with output enable).
-	//Pin 14 is a used as VCCIO in the SLG46621, the GPIO driver is not bonded out
-	m_iobs[2] =  new Greenpak4IOBTypeA(this, 2,  0, -1, 24, 941, Greenpak4IOB::IOB_FLAG_INPUTONLY);
-	m_iobs[3] =  new Greenpak4IOBTypeA(this, 3,  0, 56, 25, 946);
-	m_iobs[5] =  new Greenpak4IOBTypeA(this, 5,  0, 59, 27, 960);
-	m_iobs[7] =  new Greenpak4IOBTypeA(this, 7,  0, 62, 29, 974);
-	m_iobs[9] =  new Greenpak4IOBTypeA(this, 9,  0, 65, 31, 988);
-	m_iobs[10] = new Greenpak4IOBTypeA(this, 10, 0, 67, 32, 995, Greenpak4IOB::IOB_FLAG_X4DRIVE);
-	m_iobs[13] = new Greenpak4IOBTypeA(this, 13, 1, 57, 25, 1919);
-	if(!dual_rail)
-		m_iobs[14] = new Greenpak4IOBTypeA(this, 14, 1, 59, 26, 1926);
-	m_iobs[16] = new Greenpak4IOBTypeA(this, 16, 1, 62, 28, 1940);
-	m_iobs[18] = new Greenpak4IOBTypeA(this, 18, 1, 65, 30, 1954);
-	m_iobs[19] = new Greenpak4IOBTypeA(this, 19, 1, 67, 31, 1961);
-
-	m_iobs[19]->SetAnalogConfigBase(878);
-	m_iobs[18]->SetAnalogConfigBase(876);
-
-	//Create the Type-B IOBs (no output enable)
-	m_iobs[4]  = new Greenpak4IOBTypeB(this,  4, 0, 58, 26, 953);
-	m_iobs[6]  = new Greenpak4IOBTypeB(this,  6, 0, 61, 28, 967);
-	m_iobs[8]  = new Greenpak4IOBTypeB(this,  8, 0, 64, 30, 981);
-	m_iobs[12] = new Greenpak4IOBTypeB(this, 12, 1, 56, 24, 1911, Greenpak4IOB::IOB_FLAG_X4DRIVE);
-	m_iobs[15] = new Greenpak4IOBTypeB(this, 15, 1, 61, 27, 1933);
-	m_iobs[17] = new Greenpak4IOBTypeB(this, 17, 1, 64, 29, 1947);
-	m_iobs[20] = new Greenpak4IOBTypeB(this, 20, 1, 69, 32, 1968);
-
-	//DFF/latches
-	//NOTE: Datasheet bug
-	//Figure 42 of SLG46620_DS_r075 (page 97) says DFF5 config range is bits 708-710
-	//but this collides with LUT2_7 and does not reflect actual silicon behavior.
-	//Actual range is bits 695-697 (listed on page 151)
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 0,  true,  0, 36, 14, 677));
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 1,  true,  0, 39, 15, 681));
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 2,  true,  0, 42, 16, 685));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 3,  false, 0, 45, 17, 689));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 4,  false, 0, 47, 18, 692));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 5,  false, 0, 49, 19, 695));
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 6,  true,  1, 36, 14, 794));
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 7,  true,  1, 39, 15, 798));
-	m_dffsr.push_back(new Greenpak4Flipflop(this, 8,  true,  1, 42, 16, 802));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 9,  false, 1, 45, 17, 806));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 10, false, 1, 47, 18, 809));
-	m_dffs.push_back( new Greenpak4Flipflop(this, 11, false, 1, 49, 19, 812));
-
-	//Shift registers
-	m_shregs.push_back(new Greenpak4ShiftRegister(this, 0, 51, 20, 1610));
-	m_shregs.push_back(new Greenpak4ShiftRegister(this, 1, 51, 20, 1619));
-
-	//Edge detector/prog delays
-	m_delays.push_back(new Greenpak4Delay(this, 0, 54, 22, 1600));
-	m_delays.push_back(new Greenpak4Delay(this, 1, 54, 22, 1609));
-
-	//Inverters
-	m_inverters.push_back(new Greenpak4Inverter(this, 0, 55, 23));
-	m_inverters.push_back(new Greenpak4Inverter(this, 1, 55, 23));
-
-	//TODO: External clocks??
-
-	//Low-frequency oscillator
-	m_lfosc = new Greenpak4LFOscillator(
-		this,
-		0, 		//Matrix applies to inputs, we can route output globally
-		84,		//input base (single power-down input)
-		50,		//output word (plus dedicated routing to counters etc)
-		1652);	//bitstream location
-
-	//Ring oscillator
-	m_ringosc = new Greenpak4RingOscillator(
-		this,
-		0,		//Matrix applies to inputs, we can route output globally
-		84,		//input base (single power-down input)
-		48,		//output word (plus dedicated routing to counters etc)
-		1630);	//bitstream location
-
-	//RC oscillator
-	m_rcosc = new Greenpak4RCOscillator(
-		this,
-		0,		//Matrix applies to inputs, we can route output globally
-		84,		//input base (single power-down input)
-		49,		//output word (plus dedicated routing to counters etc)
-		1642);	//bitstream location
-
-	//Counters
-	m_counters14bit.push_back(new Greenpak4Counter(
-		this,
-		14,		//depth
-		false,	//no FSM mode
-		true,	//wake-sleep powerdown bit
-		false,	//no edge detector
-		false,	//no PWM
-		0,		//counter number
-		0,		//matrix
-		74,		//ibase
-		36,		//oword
-		1731));	//cbase
-	m_counters14bit.push_back(new Greenpak4Counter(
-		this,
-		14,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		1,		//counter number
-		1,		//matrix
-		75,		//ibase
-		36,		//oword
-		1753));	//cbase
-	m_counters14bit.push_back(new Greenpak4Counter(
-		this,
-		14,		//depth
-		true,	//we have FSM mode
-		false,	//no wake-sleep powerdown
-		true,	//we have edge detector
-		false,	//no PWM
-		2,		//counter number
-		0,		//matrix
-		75,		//ibase
-		37,		//oword
-		1774));	//cbase
-	m_counters14bit.push_back(new Greenpak4Counter(
-		this,
-		14,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		3,		//counter number
-		1,		//matrix
-		76,		//ibase
-		37,		//oword
-		1799));	//cbase (datasheet has a typo, this is correct)
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		true,	//we have FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		4,		//counter number
-		1,		//matrix
-		77,		//ibase
-		38,		//oword,
-		1820));	//cbase
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		5,		//counter number
-		0,		//matrix
-		78,		//ibase
-		38,		//oword,
-		1838));	//cbase
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		6,		//counter number
-		0,		//matrix
-		79,		//ibase
-		39,		//oword,
-		1852));	//cbase
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		false,	//no PWM
-		7,		//counter number
-		1,		//matrix (datasheet has a typo, this is correct)
-		80,		//ibase
-		39,		//oword,
-		1866));	//cbase
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		true,	//PWM mode
-		8,		//counter number
-		1,		//matrix
-		81,		//ibase
-		40,		//oword,
-		1880));	//cbase
-	m_counters8bit.push_back(new Greenpak4Counter(
-		this,
-		8,		//depth
-		false,	//no FSM mode
-		false,	//no wake-sleep powerdown
-		false,	//no edge detector
-		true,	//PWM mode
-		9,		//counter number
-		0,		//matrix
-		80,		//ibase
-		40,		//oword,
-		1895));	//cbase
-
-	//TODO: Slave SPI
-
-	//TODO: ADC
-
-	//The DACs
-	m_dacs.push_back(new Greenpak4DAC(this, 844, 840, 843, 840, 0));
-	m_dacs.push_back(new Greenpak4DAC(this, 823, 834, 883, 840, 1));
-
-	//Bandgap reference
-	m_bandgap = new Greenpak4Bandgap(this, 0, 0, 41, 923);
-
-	//Voltage references for comparators
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 0, 1));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 1, 2));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 2, 1));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 3, 2));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 4));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 5));
-
-	//Extra voltage references for the DACs (always 1.0V but having them declared as GP_VREF makes HDL cleaner)
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 6));
-	m_vrefs.push_back(new Greenpak4VoltageReference(this, 7));
-
-	//Analog comparators
-	//TODO speed doubler for ACMP5? Need to double check latest datasheet, this may have been changed
-	m_acmps.push_back(new Greenpak4Comparator(this, 0, 0, 69, 33, 832, 852, 853, 855, 934, 892));
-	m_acmps.push_back(new Greenpak4Comparator(this, 1, 1, 70, 33, 831, 861, 857, 859, 932, 897));
-	m_acmps.push_back(new Greenpak4Comparator(this, 2, 1, 71, 34,  0,  862, 864, 863, 930, 902));
-	m_acmps.push_back(new Greenpak4Comparator(this, 3, 1, 72, 35,  0,  866, 867, 869, 928, 907));
-	m_acmps.push_back(new Greenpak4Comparator(this, 4, 0, 70, 34,  0,  875, 871, 873, 926, 912));
-	m_acmps.push_back(new Greenpak4Comparator(this, 5, 0, 71, 35,  0,  880,  0,   0,  924, 917));
-
-	//PGA
-	m_pga = new Greenpak4PGA(this, 815);
-
-	//Analog buffer
-	m_abuf = new Greenpak4Abuf(this);
-
-	//Comparator input routing
-	auto pin3 = m_iobs[3]->GetOutput("OUT");
-	auto pin4 = m_iobs[4]->GetOutput("OUT");
-	auto pin6 = m_iobs[6]->GetOutput("OUT");
-	auto pin12 = m_iobs[12]->GetOutput("OUT");
-	auto pin13 = m_iobs[13]->GetOutput("OUT");
-	auto pin15 = m_iobs[15]->GetOutput("OUT");
-	auto vdd = m_constantOne->GetOutput("OUT");
-	auto pga = m_pga->GetOutput("VOUT");
-	auto pin6_buf = m_abuf->GetOutput("OUT");
-	m_acmps[0]->AddInputMuxEntry(pin6, 0);
-	m_acmps[0]->AddInputMuxEntry(pin6_buf, 1);
-	m_acmps[0]->AddInputMuxEntry(vdd, 2);
-	m_acmps[1]->AddInputMuxEntry(pin12, 0);
-	m_acmps[1]->AddInputMuxEntry(pga, 1);
-	m_acmps[1]->AddInputMuxEntry(pin6, 2);
-	m_acmps[1]->AddInputMuxEntry(pin6_buf, 2);
-	m_acmps[1]->AddInputMuxEntry(vdd, 2);
-	m_acmps[2]->AddInputMuxEntry(pin13, 0);
-	m_acmps[2]->AddInputMuxEntry(pin6, 1);
-	m_acmps[2]->AddInputMuxEntry(pin6_buf, 1);
-	m_acmps[2]->AddInputMuxEntry(vdd, 1);
-	m_acmps[3]->AddInputMuxEntry(pin15, 0);
-	m_acmps[3]->AddInputMuxEntry(pin13, 1);
-	m_acmps[3]->AddInputMuxEntry(pin6, 2);
-	m_acmps[3]->AddInputMuxEntry(pin6_buf, 2);
-	m_acmps[3]->AddInputMuxEntry(vdd, 2);
-	m_acmps[4]->AddInputMuxEntry(pin3, 0);
-	m_acmps[4]->AddInputMuxEntry(pin15, 1);
-	m_acmps[4]->AddInputMuxEntry(pin6, 2);
-	m_acmps[4]->AddInputMuxEntry(pin6_buf, 2);
-	m_acmps[4]->AddInputMuxEntry(vdd, 2);
-	m_acmps[5]->AddInputMuxEntry(pin4, 0);
-
-	//TODO: Reserved bits
-
-	//TODO: Vdd bypass
-
-	//Power-on reset
-	m_por = new Greenpak4PowerOnReset(this, 0, -1, 62, 2009);
-
-	//TODO: IO pad precharge? what does this involve?
-
-	//System reset
-	m_sysrst = new Greenpak4SystemReset(this, 0, 24, -1, 2018);
-
-	//Total length of our bitstream
-	m_bitlen = 2048;
-
-	//Initialize matrix base addresses
-	m_matrixBase[0] = 0;
-	m_matrixBase[1] = 1024;
-
-	//Create cross connections
-	for(unsigned int matrix=0; matrix<2; matrix++)
+/**
+	@brief Instantiates a single row of the device description
+ */
+void Greenpak4Device::CreateSite(const Greenpak4SiteInfo& site)
+{
+	Greenpak4BitstreamEntity* entity = NULL;
+
+	switch(site.m_kind)
 	{
-		for(unsigned int i=0; i<10; i++)
-		{
-			auto cc = new Greenpak4CrossConnection(
+		case GP_SITE_VSS:
+			m_constantZero = new Greenpak4PowerRail(this, site.m_matrix, site.m_oword);
+			entity = m_constantZero;
+			break;
+
+		case GP_SITE_VDD:
+			m_constantOne = new Greenpak4PowerRail(this, site.m_matrix, site.m_oword);
+			entity = m_constantOne;
+			break;
+
+		case GP_SITE_LUT2:
+		case GP_SITE_LUT3:
+		case GP_SITE_LUT4:
+			{
+				unsigned int order = 2 + (site.m_kind - GP_SITE_LUT2);
+				auto lut = new Greenpak4LUT(this, site.m_num, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase, order);
+				if(order == 2)
+					m_lut2s.push_back(lut);
+				else if(order == 3)
+					m_lut3s.push_back(lut);
+				else
+					m_lut4s.push_back(lut);
+				entity = lut;
+			}
+			break;
+
+		case GP_SITE_LUT4_PGEN:
+			{
+				auto lut = new Greenpak4LUT(this, site.m_num, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase, 4);
+				auto pgen = new Greenpak4PatternGenerator(this, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase);
+
+				//select=0 means we're a LUT, select=1 means we're a PGEN
+				auto lpgen = new Greenpak4PairedEntity(this, site.m_matrix, site.m_extra[0], lut, pgen);
+				lpgen->AddType("GP_INV", 0);	//Combinatorial logic all uses the LUT
+				lpgen->AddType("GP_2LUT", 0);
+				lpgen->AddType("GP_3LUT", 0);
+				lpgen->AddType("GP_4LUT", 0);
+				lpgen->AddType("GP_PGEN", 1);	//Pattern generator is the only block mapped to the PGEN
+
+				m_lut4s.push_back(lpgen);
+				entity = lpgen;
+			}
+			break;
+
+		case GP_SITE_IOB_A:
+		case GP_SITE_IOB_B:
+			{
+				Greenpak4IOB* iob;
+				if(site.m_kind == GP_SITE_IOB_A)
+				{
+					iob = new Greenpak4IOBTypeA(
+						this, site.m_num, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase, site.m_flags);
+				}
+				else
+				{
+					iob = new Greenpak4IOBTypeB(
+						this, site.m_num, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase, site.m_flags);
+				}
+				if(site.m_extra[0] != GP_SITE_NONE)
+					iob->SetAnalogConfigBase(site.m_extra[0]);
+				m_iobs[site.m_num] = iob;
+				entity = iob;
+			}
+			break;
+
+		case GP_SITE_DFF:
+		case GP_SITE_DFFSR:
+			{
+				bool has_sr = (site.m_kind == GP_SITE_DFFSR);
+				auto ff = new Greenpak4Flipflop(
+					this, site.m_num, has_sr, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase);
+				if(has_sr)
+					m_dffsr.push_back(ff);
+				else
+					m_dffs.push_back(ff);
+				entity = ff;
+			}
+			break;
+
+		case GP_SITE_SHREG:
+			m_shregs.push_back(new Greenpak4ShiftRegister(this, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase));
+			entity = m_shregs.back();
+			break;
+
+		case GP_SITE_DELAY:
+			m_delays.push_back(new Greenpak4Delay(this, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase));
+			entity = m_delays.back();
+			break;
+
+		case GP_SITE_INV:
+			m_inverters.push_back(new Greenpak4Inverter(this, site.m_matrix, site.m_ibase, site.m_oword));
+			entity = m_inverters.back();
+			break;
+
+		case GP_SITE_LFOSC:
+			m_lfosc = new Greenpak4LFOscillator(this, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase);
+			entity = m_lfosc;
+			break;
+
+		case GP_SITE_RINGOSC:
+			m_ringosc = new Greenpak4RingOscillator(this, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase);
+			entity = m_ringosc;
+			break;
+
+		case GP_SITE_RCOSC:
+			m_rcosc = new Greenpak4RCOscillator(this, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase);
+			entity = m_rcosc;
+			break;
+
+		case GP_SITE_COUNT8:
+		case GP_SITE_COUNT14:
+			{
+				bool wide = (site.m_kind == GP_SITE_COUNT14);
+				auto counter = new Greenpak4Counter(
+					this,
+					wide ? 14 : 8,
+					(site.m_flags & GP_SITE_FLAG_FSM) ? true : false,
+					(site.m_flags & GP_SITE_FLAG_WSPWRDN) ? true : false,
+					(site.m_flags & GP_SITE_FLAG_EDGEDET) ? true : false,
+					(site.m_flags & GP_SITE_FLAG_PWM) ? true : false,
+					site.m_num,
+					site.m_matrix,
+					site.m_ibase,
+					site.m_oword,
+					site.m_cbase);
+				if(wide)
+					m_counters14bit.push_back(counter);
+				else
+					m_counters8bit.push_back(counter);
+				entity = counter;
+			}
+			break;
+
+		case GP_SITE_DAC:
+			m_dacs.push_back(new Greenpak4DAC(
+				this, site.m_cbase, site.m_extra[0], site.m_extra[1], site.m_extra[2], site.m_num));
+			entity = m_dacs.back();
+			break;
+
+		case GP_SITE_BANDGAP:
+			m_bandgap = new Greenpak4Bandgap(this, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase);
+			entity = m_bandgap;
+			break;
+
+		case GP_SITE_VREF:
+			m_vrefs.push_back(new Greenpak4VoltageReference(this, site.m_num, site.m_extra[0]));
+			entity = m_vrefs.back();
+			break;
+
+		case GP_SITE_ACMP:
+			m_acmps.push_back(new Greenpak4Comparator(
 				this,
-				1 - matrix,	//invert, since matrix is OUTPUT location
-				85 + i,		//ibase
-				52 + i,		//oword
-				0			//cbase is invalid, we have no configuration at all
-				);
-			m_crossConnections[matrix][i] = cc;
-		}
+				site.m_num,
+				site.m_matrix,
+				site.m_ibase,
+				site.m_oword,
+				site.m_extra[0],
+				site.m_extra[1],
+				site.m_extra[2],
+				site.m_extra[3],
+				site.m_extra[4],
+				site.m_extra[5]));
+			entity = m_acmps.back();
+			break;
+
+		case GP_SITE_PGA:
+			m_pga = new Greenpak4PGA(this, site.m_cbase);
+			entity = m_pga;
+			break;
+
+		case GP_SITE_ABUF:
+			m_abuf = new Greenpak4Abuf(this);
+			entity = m_abuf;
+			break;
+
+		case GP_SITE_POR:
+			m_por = new Greenpak4PowerOnReset(this, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase);
+			entity = m_por;
+			break;
+
+		case GP_SITE_SYSRESET:
+			m_sysrst = new Greenpak4SystemReset(this, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase);
+			entity = m_sysrst;
+			break;
+
+		case GP_SITE_CROSS_CONNECTION:
+			{
+				//The array is indexed by the matrix the connection drives
+				auto cc = new Greenpak4CrossConnection(this, site.m_matrix, site.m_ibase, site.m_oword, site.m_cbase);
+				m_crossConnections[1 - site.m_matrix][site.m_num] = cc;
+				entity = cc;
+			}
+			break;
+
+		default:
+			LogFatal("Invalid site kind %d in device description\n", site.m_kind);
+			break;
 	}
 
-	//Do final initialization
-	CreateDevice_common();
+	m_sites[make_pair(site.m_kind, site.m_num)] = entity;
 }
 
 void Greenpak4Device::CreateDevice_common()
@@ -548,6 +367,102 @@ void Greenpak4Device::CreateDevice_common()
 	for(unsigned int matrix=0; matrix<2; matrix++)
 		for(unsigned int i=0; i<10; i++)
 			m_bitstuff.push_back(m_crossConnections[matrix][i]);
+
+	//Program the comparator input muxes from the dedicated routes that feed them
+	for(unsigned int i=0; i<m_description->m_routeCount; i++)
+	{
+		auto& route = m_description->m_routes[i];
+		if( (route.m_muxsel == GP_SITE_NONE) || !HasPart(route.m_parts) )
+			continue;
+		if(route.m_dstKind != GP_SITE_ACMP)
+			LogFatal("Device description has an input mux selector on a route to a non-comparator\n");
+
+		for(auto src : GetSites(route.m_srcKind, route.m_srcNum))
+		{
+			for(auto dst : GetSites(route.m_dstKind, route.m_dstNum))
+				static_cast<Greenpak4Comparator*>(dst)->AddInputMuxEntry(src->GetOutput(route.m_srcPort), route.m_muxsel);
+		}
+	}
+
+	//Index the driver of every routable net, in both matrices for entities with a dual
+	unsigned int nnets = 1 << m_matrixBits;
+	for(unsigned int matrix=0; matrix<2; matrix++)
+		m_netSources[matrix].resize(nnets);
+	for(auto x : m_bitstuff)
+	{
+		for(auto port : x->GetOutputPorts())
+		{
+			unsigned int net = x->GetOutputNetNumber(port);
+			if(net >= nnets)
+				continue;
+
+			//Aliases for the same net (DFF Q/nQ) resolve to the first name
+			unsigned int matrix = x->GetMatrix();
+			if(m_netSources[matrix][net].m_src != NULL)
+				continue;
+			m_netSources[matrix][net] = x->GetOutput(port);
+			if(x->GetDual())
+				m_netSources[1 - matrix][net] = x->GetDual()->GetOutput(port);
+		}
+	}
+
+	//Index which field every bit of the bitstream belongs to. This also catches blocks whose bits collide.
+	m_bitFields.Reset(m_bitlen);
+	CreateChipBitFields();
+	for(auto x : m_bitstuff)
+		x->RegisterBitFields(m_bitFields);
+
+	//Every bit must belong to exactly one field (or to several shared ones), or nothing built on the map can be trusted
+	if(m_bitFields.GetOverlapCount() != 0)
+		LogFatal("%u bitstream fields collide, the device description is broken\n", m_bitFields.GetOverlapCount());
+}
+
+/**
+	@brief Registers the chip-wide parts of the bitstream that don't belong to any entity (trim values, ID codes...)
+
+	Reserved ranges follow the grouping in the datasheet, which blacks out bits but doesn't merge unrelated groups.
+ */
+void Greenpak4Device::CreateChipBitFields()
+{
+	switch(m_part)
+	{
+		case GREENPAK4_SLG46621:
+
+			//Unused on-die IOB for pin 14 (the pin is VCCIO)
+			m_bitFields.AddField(NULL, "pin 14 IOB (not bonded out)", 1378, 12);
+
+			//Everything else is shared with the 46620
+			//fall through
+		case GREENPAK4_SLG46620:
+			m_bitFields.AddField(NULL, "ADC power-down input", 486, 6);
+			m_bitFields.AddField(NULL, "reserved", 570, 6);
+			m_bitFields.AddField(NULL, "ACMP5 speed double", 833, 1);
+			m_bitFields.AddField(NULL, "ACMP4 speed double", 835, 1);
+			m_bitFields.AddField(NULL, "reserved", 881, 1);
+			m_bitFields.AddField(NULL, "Vref value fine tune", 887, 5);
+			m_bitFields.AddField(NULL, "bandgap 1x buffer enable", 922, 1);
+			m_bitFields.AddField(NULL, "Vref op amp chopper frequency select", 937, 1);
+			m_bitFields.AddField(NULL, "Vref op amp offset chopper enable", 939, 1);
+			m_bitFields.AddField(NULL, "reserved", 1003, 13);
+			m_bitFields.AddField(NULL, "device ID", 1016, 8);
+			m_bitFields.AddField(NULL, "reserved", 1594, 6);
+			m_bitFields.AddField(NULL, "RC oscillator trimming value", 1975, 7);
+			m_bitFields.AddField(NULL, "reserved", 1982, 6);
+			m_bitFields.AddField(NULL, "reserved", 1988, 8);
+			m_bitFields.AddField(NULL, "reserved", 1996, 6);
+			m_bitFields.AddField(NULL, "reserved", 2002, 6);
+			m_bitFields.AddField(NULL, "reserved", 2013, 2);
+			m_bitFields.AddField(NULL, "reserved", 2021, 7);
+			m_bitFields.AddField(NULL, "reserved", 2028, 2);
+			m_bitFields.AddField(NULL, "reserved", 2030, 1);
+			m_bitFields.AddField(NULL, "pattern ID", 2031, 8);
+			m_bitFields.AddField(NULL, "read protection", 2039, 1);
+			m_bitFields.AddField(NULL, "device ID", 2040, 8);
+			break;
+
+		case GREENPAK4_SLG46140:
+			break;
+	}
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -568,6 +483,33 @@ Greenpak4IOB* Greenpak4Device::GetIOB(unsigned int pin)
 	return m_iobs[pin];
 }
 
+/**
+	@brief Gets the site(s) instantiated from a row of the device description
+
+	An instance number of GP_SITE_ALL returns every site of the kind, sorted by instance number. It's a fatal error
+	for a description to refer to a site that doesn't exist on this part.
+ */
+vector<Greenpak4BitstreamEntity*> Greenpak4Device::GetSites(Greenpak4SiteKind kind, unsigned int num)
+{
+	vector<Greenpak4BitstreamEntity*> ret;
+
+	if(num == GP_SITE_ALL)
+	{
+		auto end = m_sites.upper_bound(make_pair(kind, GP_SITE_ALL));
+		for(auto it = m_sites.lower_bound(make_pair(kind, 0u)); it != end; it++)
+			ret.push_back(it->second);
+	}
+	else
+	{
+		auto it = m_sites.find(make_pair(kind, num));
+		if(it == m_sites.end())
+			LogFatal("Device description refers to site %u of kind %d, which doesn't exist\n", num, kind);
+		ret.push_back(it->second);
+	}
+
+	return ret;
+}
+
 Greenpak4BitstreamEntity* Greenpak4Device::GetLUT(unsigned int i)
 {
 	if(i >= m_luts.size())
@@ -604,32 +546,29 @@ unsigned int Greenpak4Device::GetMatrixBase(unsigned int matrix)
 	return m_matrixBase[matrix];
 }
 
+Greenpak4EntityOutput Greenpak4Device::GetNetSource(unsigned int matrix, unsigned int net)
+{
+	if( (matrix > 1) || (net >= m_netSources[matrix].size()) )
+		return Greenpak4EntityOutput();
+	return m_netSources[matrix][net];
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // File I/O
 
 /**
-	@brief Writes the bitstream to a file
+	@brief Generates the bitstream for the current configuration
 
-	@param fname		Name of the file to write to
+	@param bitstream	Bitstream to write to (resized to the device's length)
 	@param userid		ID code to write to the "user ID" area of the bitstream
 	@param readProtect	True to disable readout of the design
  */
-bool Greenpak4Device::WriteToFile(string fname, uint8_t userid, bool readProtect)
+bool Greenpak4Device::Save(Greenpak4Bitstream& bitstream, uint8_t userid, bool readProtect)
 {
-	//Open the file
-	FILE* fp = fopen(fname.c_str(), "w");
-	if(!fp)
-	{
-		LogError("Couldn't open %s for writing\n", fname.c_str());
-		return false;
-	}
-
-	//Allocate the bitstream and initialize to zero
+	//Initialize the bitstream to zero
 	//According to phone conversation w Silego FAE, 0 is legal default state for everything incl reserved bits
 	//All IOs will be floating digital inputs
-	bool* bitstream = new bool[m_bitlen];
-	for(unsigned int i=0; i<m_bitlen; i++)
-		bitstream[i] = false;
+	bitstream.Resize(m_bitlen);
 
 	//Get the config data from each of our blocks
 	for(auto x : m_bitstuff)
@@ -637,7 +576,6 @@ bool Greenpak4Device::WriteToFile(string fname, uint8_t userid, bool readProtect
 		if(!x->Save(bitstream))
 		{
 			LogError("Bitstream node %s failed to save\n", x->GetDescription().c_str());
-			fclose(fp);
 			return false;
 		}
 	}
@@ -648,56 +586,24 @@ bool Greenpak4Device::WriteToFile(string fname, uint8_t userid, bool readProtect
 		case GREENPAK4_SLG46621:
 
 			//Tie the unused on-die IOB for pin 14 to ground
-			for(int i=1378; i<=1389; i++)
-				bitstream[i] = false;
-
-			//fall through to 46620 for shared config
+			bitstream.SetField(1378, 12, 0);
 
+			//Everything else is shared with the 46620
+			//fall through
 		case GREENPAK4_SLG46620:
 
 			//FIXME: Disable ADC block (until we have the logic for that implemented)
-			bitstream[486] = true;
-			bitstream[487] = true;
-			bitstream[488] = true;
-			bitstream[489] = true;
-			bitstream[490] = true;
-			bitstream[491] = true;
+			bitstream.SetField(486, 6, 0x3f);
 
 			//Vref fine tune, magic value from datasheet
-			bitstream[891] = true;
-			bitstream[890] = false;
-			bitstream[889] = false;
-			bitstream[888] = true;
-			bitstream[887] = false;
+			bitstream.SetField(887, 5, 0x12);
 
 			//Device ID; immutable on the device but added to aid verification
-			bitstream[1016] = false;
-			bitstream[1017] = true;
-			bitstream[1018] = false;
-			bitstream[1019] = true;
-			bitstream[1020] = true;
-			bitstream[1021] = false;
-			bitstream[1022] = true;
-			bitstream[1023] = false;
-
-			bitstream[2040] = true;
-			bitstream[2041] = false;
-			bitstream[2042] = true;
-			bitstream[2043] = false;
-			bitstream[2044] = false;
-			bitstream[2045] = true;
-			bitstream[2046] = false;
-			bitstream[2047] = true;
+			bitstream.SetField(1016, 8, 0x5a);
+			bitstream.SetField(2040, 8, 0xa5);
 
 			//User ID of the bitstream
-			bitstream[2031] = (userid & 0x01) ? true : false;
-			bitstream[2032] = (userid & 0x02) ? true : false;
-			bitstream[2033] = (userid & 0x04) ? true : false;
-			bitstream[2034] = (userid & 0x08) ? true : false;
-			bitstream[2035] = (userid & 0x10) ? true : false;
-			bitstream[2036] = (userid & 0x20) ? true : false;
-			bitstream[2037] = (userid & 0x40) ? true : false;
-			bitstream[2038] = (userid & 0x80) ? true : false;
+			bitstream.SetField(2031, 8, userid);
 
 			//Read protection flag
 			bitstream[2039] = readProtect;
@@ -709,13 +615,182 @@ bool Greenpak4Device::WriteToFile(string fname, uint8_t userid, bool readProtect
 			break;
 	}
 
-	//Write the bitfile
-	fprintf(fp, "index\t\tvalue\t\tcomment\n");
-	for(unsigned int i=0; i<m_bitlen; i++)
-		fprintf(fp, "%u\t\t%d\t\t//\n", i, (int)bitstream[i]);
+	return true;
+}
+
+/**
+	@brief Configures every entity from a bitstream. Inverse of Save().
+
+	Expects a freshly constructed device: entities that are configured by their consumers (voltage references)
+	only have their state overwritten when something uses them.
+
+	@param bitstream	Bitstream to read
+	@param userid		Set to the "user ID" area of the bitstream
+	@param readProtect	Set to the read protection flag of the bitstream
+ */
+bool Greenpak4Device::Load(const Greenpak4Bitstream& bitstream, uint8_t& userid, bool& readProtect)
+{
+	if(bitstream.GetLength() != m_bitlen)
+	{
+		LogError("Bitstream is %u bits long, but this device needs %u\n", bitstream.GetLength(), m_bitlen);
+		return false;
+	}
+
+	//Read chip-wide data and check the ID code
+	switch(m_part)
+	{
+		case GREENPAK4_SLG46620:
+		case GREENPAK4_SLG46621:
+			if( (bitstream.GetField(1016, 8) != 0x5a) || (bitstream.GetField(2040, 8) != 0xa5) )
+			{
+				LogError("Bitstream does not have the SLG4662x device ID\n");
+				return false;
+			}
+			userid = bitstream.GetField(2031, 8);
+			readProtect = bitstream[2039];
+			break;
+
+		case GREENPAK4_SLG46140:
+			LogError("Greenpak4Device: Not implemented for SLG46140 yet\n");
+			return false;
+	}
+
+	//Get the config data for each of our blocks
+	for(auto x : m_bitstuff)
+	{
+		if(!x->Load(bitstream))
+		{
+			LogError("Bitstream node %s failed to load\n", x->GetDescription().c_str());
+			return false;
+		}
+	}
 
-	//Done
-	delete[] bitstream;
-	fclose(fp);
 	return true;
 }
+
+/**
+	@brief Reads a bitstream file (text or binary container) and configures the device from it
+
+	@param fname		Name of the file to read
+	@param userid		Set to the "user ID" area of the bitstream
+	@param readProtect	Set to the read protection flag of the bitstream
+ */
+bool Greenpak4Device::LoadFromFile(string fname, uint8_t& userid, bool& readProtect)
+{
+	Greenpak4Bitstream bitstream;
+	uint16_t part;
+	if(!bitstream.ReadFile(fname, &part))
+		return false;
+
+	//Text files don't say what part they're for
+	if( (part != 0) && (part != GetPartCode()) )
+	{
+		LogError("%s is for part 0x%03x, but this device is 0x%03x\n", fname.c_str(), part, GetPartCode());
+		return false;
+	}
+
+	return Load(bitstream, userid, readProtect);
+}
+
+/**
+	@brief Takes a snapshot of the configuration of every entity
+
+	The bitstream already is the compact form of the configuration: everything that matters ends up in it, and Load()
+	rebuilds every entity from it. A snapshot is a bitstream without user ID or read protection, so it can be copied,
+	compared and hashed (see Greenpak4Bitstream::Hash()) as a plain value, and put back with RestoreState().
+
+	@param state		Set to the current configuration
+ */
+bool Greenpak4Device::SaveState(Greenpak4Bitstream& state)
+{
+	return Save(state, 0, false);
+}
+
+/**
+	@brief Puts the configuration back the way it was when a snapshot was taken, discarding all changes since then
+
+	Every setting that reaches the bitstream is overwritten, so this works whatever the device was configured to before.
+
+	@param state		Snapshot from SaveState() on this device, or on another one of the same part
+ */
+bool Greenpak4Device::RestoreState(const Greenpak4Bitstream& state)
+{
+	uint8_t userid;
+	bool readProtect;
+	return Load(state, userid, readProtect);
+}
+
+/**
+	@brief Makes a new device of the same part with the same configuration. The caller owns it.
+
+	The copy shares nothing with this device, so both can be committed to and checked independently.
+
+	@return The copy, or NULL if the configuration couldn't be copied
+ */
+Greenpak4Device* Greenpak4Device::Clone()
+{
+	Greenpak4Bitstream state;
+	if(!SaveState(state))
+		return NULL;
+
+	Greenpak4Device* copy = new Greenpak4Device(m_part);
+	if(!copy->RestoreState(state))
+	{
+		delete copy;
+		return NULL;
+	}
+	return copy;
+}
+
+/**
+	@brief Writes the bitstream to a file
+
+	@param fname		Name of the file to write to
+	@param userid		ID code to write to the "user ID" area of the bitstream
+	@param readProtect	True to disable readout of the design
+	@param format		File format to write
+ */
+bool Greenpak4Device::WriteToFile(
+	string fname,
+	uint8_t userid,
+	bool readProtect,
+	Greenpak4Bitstream::FileFormat format)
+{
+	Greenpak4Bitstream bitstream;
+	if(!Save(bitstream, userid, readProtect))
+		return false;
+
+	switch(format)
+	{
+		case Greenpak4Bitstream::FORMAT_TEXT:
+			return bitstream.WriteText(fname);
+
+		case Greenpak4Bitstream::FORMAT_BINARY:
+			return bitstream.WriteBinary(fname, GetPartCode(), userid, readProtect);
+
+		default:
+			LogError("Unknown bitstream format\n");
+			return false;
+	}
+}
+
+/**
+	@brief Gets the part number as coded in bitstream container headers (0x620 for SLG46620 etc)
+ */
+uint16_t Greenpak4Device::GetPartCode()
+{
+	switch(m_part)
+	{
+		case GREENPAK4_SLG46140:
+			return 0x140;
+
+		case GREENPAK4_SLG46620:
+			return 0x620;
+
+		case GREENPAK4_SLG46621:
+			return 0x621;
+
+		default:
+			return 0xfff;
+	}
+}
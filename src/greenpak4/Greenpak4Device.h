@@ -44,12 +44,49 @@ public:
 
 	virtual ~Greenpak4Device();
 
+	//Generate the bitstream for the current configuration
+	bool Save(Greenpak4Bitstream& bitstream, uint8_t userid, bool readProtect);
+
 	//Write to a bitfile
-	bool WriteToFile(std::string fname, uint8_t userid, bool readProtect);
+	bool WriteToFile(
+		std::string fname,
+		uint8_t userid,
+		bool readProtect,
+		Greenpak4Bitstream::FileFormat format = Greenpak4Bitstream::FORMAT_TEXT);
+
+	//Configure the device from a bitstream
+	bool Load(const Greenpak4Bitstream& bitstream, uint8_t& userid, bool& readProtect);
+
+	//Read a bitfile (text or binary container) and configure the device from it
+	bool LoadFromFile(std::string fname, uint8_t& userid, bool& readProtect);
+
+	//Snapshots of the configuration, to compare, hash, roll back to or copy into another device
+	bool SaveState(Greenpak4Bitstream& state);
+	bool RestoreState(const Greenpak4Bitstream& state);
+	Greenpak4Device* Clone();
+
+	unsigned int GetBitLength()
+	{ return m_bitlen; }
 
 	GREENPAK4_PART GetPart()
 	{ return m_part; }
 
+	uint16_t GetPartCode();
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// DEVICE DESCRIPTION
+
+	//Get the tables this device was built from
+	const Greenpak4DeviceDescription* GetDescription()
+	{ return m_description; }
+
+	//Check if a row of the description applies to this part
+	bool HasPart(unsigned int parts)
+	{ return (parts & m_partMask) ? true : false; }
+
+	//Get the site(s) instantiated from a row of the description (num may be GP_SITE_ALL)
+	std::vector<Greenpak4BitstreamEntity*> GetSites(Greenpak4SiteKind kind, unsigned int num);
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// POWER RAILS
 
@@ -90,9 +127,23 @@ public:
 
 	unsigned int GetMatrixBase(unsigned int matrix);
 
+	//Get the signal driving a given net of a routing matrix (NULL source if nothing drives it)
+	Greenpak4EntityOutput GetNetSource(unsigned int matrix, unsigned int net);
+
 	Greenpak4CrossConnection* GetCrossConnection(unsigned int src_matrix, unsigned int index)
 	{ return m_crossConnections[src_matrix][index]; }
 
+	//Number of cross connections leaving each matrix
+	unsigned int GetCrossConnectionCount()
+	{ return sizeof(m_crossConnections[0]) / sizeof(m_crossConnections[0][0]); }
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// BITSTREAM LAYOUT
+
+	//Get the field every bit of the bitstream belongs to
+	const Greenpak4BitFieldMap& GetBitFields()
+	{ return m_bitFields; }
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// LUTS
 
@@ -266,6 +317,10 @@ public:
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// ALL NODES
 
+	//Get the index for a newly constructed entity (called by Greenpak4BitstreamEntity)
+	unsigned int AllocateEntityIndex()
+	{ return m_nextEntityIndex ++; }
+
 	unsigned int GetEntityCount()
 	{ return m_bitstuff.size(); }
 
@@ -275,12 +330,26 @@ public:
 protected:
 
 	void CreateDevice_SLG46140();
-	void CreateDevice_SLG4662x(bool dual_rail);
+	void CreateDevice(const Greenpak4DeviceDescription& desc, unsigned int parts);
+	void CreateSite(const Greenpak4SiteInfo& site);
 	void CreateDevice_common();
+	void CreateChipBitFields();
 
 	///The part number
 	GREENPAK4_PART m_part;
 
+	///The tables the device was built from
+	const Greenpak4DeviceDescription* m_description;
+
+	///Which GP_PART_* bit the device is in the description's part masks
+	unsigned int m_partMask;
+
+	///Index the next entity created will get
+	unsigned int m_nextEntityIndex;
+
+	///Every entity instantiated from the description, by kind and instance number
+	std::map<std::pair<Greenpak4SiteKind, unsigned int>, Greenpak4BitstreamEntity*> m_sites;
+
 	///The number of bits in a routing matrix selector
 	unsigned int m_matrixBits;
 
@@ -384,6 +453,17 @@ protected:
 
 	//Base address of each routing matrix
 	unsigned int m_matrixBase[2];
+
+	/**
+		@brief Driver of each net of each routing matrix, indexed by matrix selector value
+
+		Built once at construction so a matrix selector read from a bitstream can be mapped back to a signal
+		in constant time.
+	 */
+	std::vector<Greenpak4EntityOutput> m_netSources[2];
+
+	///Which field of which entity each bit of the bitstream belongs to
+	Greenpak4BitFieldMap m_bitFields;
 };
 
 #endif
@@ -0,0 +1,327 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <Greenpak4.h>
+
+using namespace std;
+
+#define X4662	GP_PART_SLG4662X
+#define NONE	GP_SITE_NONE
+#define ALL		GP_SITE_ALL
+
+#define TABLE_SIZE(t) (sizeof(t) / sizeof(t[0]))
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SLG46620 / SLG46621
+
+/*
+	Rows are instantiated in order. Power rails have to come first, since all other entities refer to them during
+	construction, and rows of the same kind are kept in the order the device's accessors should return them.
+ */
+static const Greenpak4SiteInfo g_slg4662xSites[] =
+{
+	//kind					parts	num	matrix	ibase	oword	cbase	flags	extra
+
+	//Power rails
+	{ GP_SITE_VSS,			X4662,	0,	0,		NONE,	0,		NONE,	0,		{} },
+	{ GP_SITE_VDD,			X4662,	0,	0,		NONE,	63,		NONE,	0,		{} },
+
+	//LUT2s: 4 per matrix, 2 inputs each starting at row 0, first mux entry is ground then the LUT2s, 2^2 config bits
+	{ GP_SITE_LUT2,			X4662,	0,	0,		0,		1,		576,	0,		{} },
+	{ GP_SITE_LUT2,			X4662,	1,	0,		2,		2,		580,	0,		{} },
+	{ GP_SITE_LUT2,			X4662,	2,	0,		4,		3,		584,	0,		{} },
+	{ GP_SITE_LUT2,			X4662,	3,	0,		6,		4,		588,	0,		{} },
+	{ GP_SITE_LUT2,			X4662,	4,	1,		0,		1,		698,	0,		{} },
+	{ GP_SITE_LUT2,			X4662,	5,	1,		2,		2,		702,	0,		{} },
+	{ GP_SITE_LUT2,			X4662,	6,	1,		4,		3,		706,	0,		{} },
+	{ GP_SITE_LUT2,			X4662,	7,	1,		6,		4,		710,	0,		{} },
+
+	//LUT3s: 8 per matrix, 3 inputs each starting at row 8, after the last LUT2 in the mux, 2^3 config bits
+	{ GP_SITE_LUT3,			X4662,	0,	0,		8,		5,		592,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	1,	0,		11,		6,		600,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	2,	0,		14,		7,		608,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	3,	0,		17,		8,		616,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	4,	0,		20,		9,		624,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	5,	0,		23,		10,		632,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	6,	0,		26,		11,		640,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	7,	0,		29,		12,		648,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	8,	1,		8,		5,		714,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	9,	1,		11,		6,		722,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	10,	1,		14,		7,		730,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	11,	1,		17,		8,		738,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	12,	1,		20,		9,		746,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	13,	1,		23,		10,		754,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	14,	1,		26,		11,		762,	0,		{} },
+	{ GP_SITE_LUT3,			X4662,	15,	1,		29,		12,		770,	0,		{} },
+
+	//LUT4s. The plain one goes FIRST so that initial placement prefers it and doesn't take up the PGEN site right
+	//away. LUT4_0 shares its site with the pattern generator, bit 676 selects between them.
+	{ GP_SITE_LUT4,			X4662,	1,	1,		32,		13,		778,	0,		{} },
+	{ GP_SITE_LUT4_PGEN,	X4662,	0,	0,		32,		13,		656,	0,		{ 676 } },
+
+	//Type-A IOBs (with output enable).
+	//Pin 14 is a used as VCCIO in the SLG46621, the GPIO driver is not bonded out
+	{ GP_SITE_IOB_A,		X4662,	2,	0,		NONE,	24,		941,	Greenpak4IOB::IOB_FLAG_INPUTONLY,	{ NONE } },
+	{ GP_SITE_IOB_A,		X4662,	3,	0,		56,		25,		946,	0,		{ NONE } },
+	{ GP_SITE_IOB_A,		X4662,	5,	0,		59,		27,		960,	0,		{ NONE } },
+	{ GP_SITE_IOB_A,		X4662,	7,	0,		62,		29,		974,	0,		{ NONE } },
+	{ GP_SITE_IOB_A,		X4662,	9,	0,		65,		31,		988,	0,		{ NONE } },
+	{ GP_SITE_IOB_A,		X4662,	10,	0,		67,		32,		995,	Greenpak4IOB::IOB_FLAG_X4DRIVE,		{ NONE } },
+	{ GP_SITE_IOB_A,		X4662,	13,	1,		57,		25,		1919,	0,		{ NONE } },
+	{ GP_SITE_IOB_A, GP_PART_SLG46620,	14,	1,	59,		26,		1926,	0,		{ NONE } },
+	{ GP_SITE_IOB_A,		X4662,	16,	1,		62,		28,		1940,	0,		{ NONE } },
+	{ GP_SITE_IOB_A,		X4662,	18,	1,		65,		30,		1954,	0,		{ 876 } },
+	{ GP_SITE_IOB_A,		X4662,	19,	1,		67,		31,		1961,	0,		{ 878 } },
+
+	//Type-B IOBs (no output enable)
+	{ GP_SITE_IOB_B,		X4662,	4,	0,		58,		26,		953,	0,		{ NONE } },
+	{ GP_SITE_IOB_B,		X4662,	6,	0,		61,		28,		967,	0,		{ NONE } },
+	{ GP_SITE_IOB_B,		X4662,	8,	0,		64,		30,		981,	0,		{ NONE } },
+	{ GP_SITE_IOB_B,		X4662,	12,	1,		56,		24,		1911,	Greenpak4IOB::IOB_FLAG_X4DRIVE,		{ NONE } },
+	{ GP_SITE_IOB_B,		X4662,	15,	1,		61,		27,		1933,	0,		{ NONE } },
+	{ GP_SITE_IOB_B,		X4662,	17,	1,		64,		29,		1947,	0,		{ NONE } },
+	{ GP_SITE_IOB_B,		X4662,	20,	1,		69,		32,		1968,	0,		{ NONE } },
+
+	//DFF/latches
+	//NOTE: Datasheet bug
+	//Figure 42 of SLG46620_DS_r075 (page 97) says DFF5 config range is bits 708-710
+	//but this collides with LUT2_7 and does not reflect actual silicon behavior.
+	//Actual range is bits 695-697 (listed on page 151)
+	{ GP_SITE_DFFSR,		X4662,	0,	0,		36,		14,		677,	0,		{} },
+	{ GP_SITE_DFFSR,		X4662,	1,	0,		39,		15,		681,	0,		{} },
+	{ GP_SITE_DFFSR,		X4662,	2,	0,		42,		16,		685,	0,		{} },
+	{ GP_SITE_DFF,			X4662,	3,	0,		45,		17,		689,	0,		{} },
+	{ GP_SITE_DFF,			X4662,	4,	0,		47,		18,		692,	0,		{} },
+	{ GP_SITE_DFF,			X4662,	5,	0,		49,		19,		695,	0,		{} },
+	{ GP_SITE_DFFSR,		X4662,	6,	1,		36,		14,		794,	0,		{} },
+	{ GP_SITE_DFFSR,		X4662,	7,	1,		39,		15,		798,	0,		{} },
+	{ GP_SITE_DFFSR,		X4662,	8,	1,		42,		16,		802,	0,		{} },
+	{ GP_SITE_DFF,			X4662,	9,	1,		45,		17,		806,	0,		{} },
+	{ GP_SITE_DFF,			X4662,	10,	1,		47,		18,		809,	0,		{} },
+	{ GP_SITE_DFF,			X4662,	11,	1,		49,		19,		812,	0,		{} },
+
+	//Shift registers
+	{ GP_SITE_SHREG,		X4662,	0,	0,		51,		20,		1610,	0,		{} },
+	{ GP_SITE_SHREG,		X4662,	1,	1,		51,		20,		1619,	0,		{} },
+
+	//Edge detector/prog delays
+	//5 config bits each, packed together directly before the shift registers
+	{ GP_SITE_DELAY,		X4662,	0,	0,		54,		22,		1600,	0,		{} },
+	{ GP_SITE_DELAY,		X4662,	1,	1,		54,		22,		1605,	0,		{} },
+
+	//Inverters
+	{ GP_SITE_INV,			X4662,	0,	0,		55,		23,		NONE,	0,		{} },
+	{ GP_SITE_INV,			X4662,	1,	1,		55,		23,		NONE,	0,		{} },
+
+	//TODO: External clocks??
+
+	//Oscillators. Matrix applies to the single power-down input, outputs are routed globally (plus dedicated
+	//routing to counters etc)
+	{ GP_SITE_LFOSC,		X4662,	0,	0,		84,		50,		1652,	0,		{} },
+	{ GP_SITE_RINGOSC,		X4662,	0,	0,		84,		48,		1630,	0,		{} },
+	{ GP_SITE_RCOSC,		X4662,	0,	0,		84,		49,		1642,	0,		{} },
+
+	//Counters (the datasheet has typos in COUNT14_3's cbase and COUNT8_7's matrix, these are correct)
+	{ GP_SITE_COUNT14,		X4662,	0,	0,		74,		36,		1731,	GP_SITE_FLAG_WSPWRDN,	{} },
+	{ GP_SITE_COUNT14,		X4662,	1,	1,		75,		36,		1753,	0,		{} },
+	{ GP_SITE_COUNT14,		X4662,	2,	0,		75,		37,		1774,	GP_SITE_FLAG_FSM | GP_SITE_FLAG_EDGEDET,	{} },
+	{ GP_SITE_COUNT14,		X4662,	3,	1,		76,		37,		1799,	0,		{} },
+	{ GP_SITE_COUNT8,		X4662,	4,	1,		77,		38,		1820,	GP_SITE_FLAG_FSM,	{} },
+	{ GP_SITE_COUNT8,		X4662,	5,	0,		78,		38,		1838,	0,		{} },
+	{ GP_SITE_COUNT8,		X4662,	6,	0,		79,		39,		1852,	0,		{} },
+	{ GP_SITE_COUNT8,		X4662,	7,	1,		80,		39,		1866,	0,		{} },
+	{ GP_SITE_COUNT8,		X4662,	8,	1,		81,		40,		1880,	GP_SITE_FLAG_PWM,	{} },
+	{ GP_SITE_COUNT8,		X4662,	9,	0,		80,		40,		1895,	GP_SITE_FLAG_PWM,	{} },
+
+	//TODO: Slave SPI
+
+	//TODO: ADC
+
+	//DACs (extra: power, input select, always-on)
+	{ GP_SITE_DAC,			X4662,	0,	0,		NONE,	NONE,	844,	0,		{ 840, 843, 840 } },
+	{ GP_SITE_DAC,			X4662,	1,	0,		NONE,	NONE,	823,	0,		{ 834, 883, 840 } },
+
+	//Bandgap reference
+	{ GP_SITE_BANDGAP,		X4662,	0,	0,		0,		41,		923,	0,		{} },
+
+	//Voltage references for comparators (extra: output mux selector)
+	{ GP_SITE_VREF,			X4662,	0,	0,		NONE,	NONE,	NONE,	0,		{ 1 } },
+	{ GP_SITE_VREF,			X4662,	1,	0,		NONE,	NONE,	NONE,	0,		{ 2 } },
+	{ GP_SITE_VREF,			X4662,	2,	0,		NONE,	NONE,	NONE,	0,		{ 1 } },
+	{ GP_SITE_VREF,			X4662,	3,	0,		NONE,	NONE,	NONE,	0,		{ 2 } },
+	{ GP_SITE_VREF,			X4662,	4,	0,		NONE,	NONE,	NONE,	0,		{ NONE } },
+	{ GP_SITE_VREF,			X4662,	5,	0,		NONE,	NONE,	NONE,	0,		{ NONE } },
+
+	//Extra voltage references for the DACs (always 1.0V but having them declared as GP_VREF makes HDL cleaner)
+	{ GP_SITE_VREF,			X4662,	6,	0,		NONE,	NONE,	NONE,	0,		{ NONE } },
+	{ GP_SITE_VREF,			X4662,	7,	0,		NONE,	NONE,	NONE,	0,		{ NONE } },
+
+	//Analog comparators (extra: current source, bandwidth, gain, input, hysteresis, reference)
+	//TODO speed doubler for ACMP5? Need to double check latest datasheet, this may have been changed
+	{ GP_SITE_ACMP,			X4662,	0,	0,		69,		33,		NONE,	0,		{ 832, 852, 853, 855, 934, 892 } },
+	{ GP_SITE_ACMP,			X4662,	1,	1,		70,		33,		NONE,	0,		{ 831, 861, 857, 859, 932, 897 } },
+	{ GP_SITE_ACMP,			X4662,	2,	1,		71,		34,		NONE,	0,		{ 0,   862, 864, 863, 930, 902 } },
+	{ GP_SITE_ACMP,			X4662,	3,	1,		72,		35,		NONE,	0,		{ 0,   866, 867, 869, 928, 907 } },
+	{ GP_SITE_ACMP,			X4662,	4,	0,		70,		34,		NONE,	0,		{ 0,   875, 871, 873, 926, 912 } },
+	{ GP_SITE_ACMP,			X4662,	5,	0,		71,		35,		NONE,	0,		{ 0,   880, 0,   0,   924, 917 } },
+
+	//PGA and analog buffer
+	{ GP_SITE_PGA,			X4662,	0,	0,		NONE,	NONE,	815,	0,		{} },
+	{ GP_SITE_ABUF,			X4662,	0,	0,		NONE,	NONE,	NONE,	0,		{} },
+
+	//TODO: Vdd bypass
+
+	//Power-on reset
+	{ GP_SITE_POR,			X4662,	0,	0,		NONE,	62,		2009,	0,		{} },
+
+	//TODO: IO pad precharge? what does this involve?
+
+	//System reset
+	{ GP_SITE_SYSRESET,		X4662,	0,	0,		24,		NONE,	2018,	0,		{} },
+
+	//Cross connections, 10 in each direction. No configuration at all besides the input selector.
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	0,	1,	85,		52,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	1,	1,	86,		53,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	2,	1,	87,		54,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	3,	1,	88,		55,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	4,	1,	89,		56,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	5,	1,	90,		57,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	6,	1,	91,		58,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	7,	1,	92,		59,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	8,	1,	93,		60,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	9,	1,	94,		61,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	0,	0,	85,		52,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	1,	0,	86,		53,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	2,	0,	87,		54,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	3,	0,	88,		55,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	4,	0,	89,		56,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	5,	0,	90,		57,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	6,	0,	91,		58,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	7,	0,	92,		59,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	8,	0,	93,		60,		0,		0,		{} },
+	{ GP_SITE_CROSS_CONNECTION,	X4662,	9,	0,	94,		61,		0,		0,		{} },
+};
+
+static const Greenpak4RouteInfo g_slg4662xRoutes[] =
+{
+	//parts	source							destination						width	muxsel
+
+	//Clock inputs to counters
+	//TODO: other clock sources
+	//TODO: Disable clock outputs to dedicated routing in matrix 1 if SPI slave is enabled?
+	{ X4662,	GP_SITE_LFOSC,		0,	"CLKOUT",			GP_SITE_COUNT8,		ALL,	"CLK",		1,	NONE },
+	{ X4662,	GP_SITE_LFOSC,		0,	"CLKOUT",			GP_SITE_COUNT14,	ALL,	"CLK",		1,	NONE },
+	{ X4662,	GP_SITE_RINGOSC,	0,	"CLKOUT_HARDIP",	GP_SITE_COUNT8,		ALL,	"CLK",		1,	NONE },
+	{ X4662,	GP_SITE_RINGOSC,	0,	"CLKOUT_HARDIP",	GP_SITE_COUNT14,	ALL,	"CLK",		1,	NONE },
+	{ X4662,	GP_SITE_RCOSC,		0,	"CLKOUT_HARDIP",	GP_SITE_COUNT8,		ALL,	"CLK",		1,	NONE },
+	{ X4662,	GP_SITE_RCOSC,		0,	"CLKOUT_HARDIP",	GP_SITE_COUNT14,	ALL,	"CLK",		1,	NONE },
+
+	//Can drive system reset with ground or pin 2 only
+	{ X4662,	GP_SITE_IOB_A,		2,	"OUT",				GP_SITE_SYSRESET,	0,		"RST",		1,	NONE },
+	{ X4662,	GP_SITE_VSS,		0,	"OUT",				GP_SITE_SYSRESET,	0,		"RST",		1,	NONE },
+
+	//VREF0/1 can drive pin 19, VREF2/3 can drive pin 18
+	{ X4662,	GP_SITE_VREF,		0,	"VOUT",				GP_SITE_IOB_A,		19,		"IN",		1,	NONE },
+	{ X4662,	GP_SITE_VREF,		1,	"VOUT",				GP_SITE_IOB_A,		19,		"IN",		1,	NONE },
+	{ X4662,	GP_SITE_VREF,		2,	"VOUT",				GP_SITE_IOB_A,		18,		"IN",		1,	NONE },
+	{ X4662,	GP_SITE_VREF,		3,	"VOUT",				GP_SITE_IOB_A,		18,		"IN",		1,	NONE },
+
+	//Only allow one VREF to drive its attached comparator, we hide the complexity of the actual routing structure
+	//TODO: Add a 6th vref for DAC reference
+	{ X4662,	GP_SITE_VREF,		0,	"VOUT",				GP_SITE_ACMP,		0,		"VREF",		1,	NONE },
+	{ X4662,	GP_SITE_VREF,		1,	"VOUT",				GP_SITE_ACMP,		1,		"VREF",		1,	NONE },
+	{ X4662,	GP_SITE_VREF,		2,	"VOUT",				GP_SITE_ACMP,		2,		"VREF",		1,	NONE },
+	{ X4662,	GP_SITE_VREF,		3,	"VOUT",				GP_SITE_ACMP,		3,		"VREF",		1,	NONE },
+	{ X4662,	GP_SITE_VREF,		4,	"VOUT",				GP_SITE_ACMP,		4,		"VREF",		1,	NONE },
+	{ X4662,	GP_SITE_VREF,		5,	"VOUT",				GP_SITE_ACMP,		5,		"VREF",		1,	NONE },
+
+	//Input to analog buffer
+	{ X4662,	GP_SITE_IOB_B,		6,	"OUT",				GP_SITE_ABUF,		0,		"IN",		1,	NONE },
+
+	//Dedicated inputs to comparators (ACMP0 has none)
+	{ X4662,	GP_SITE_IOB_B,		12,	"OUT",				GP_SITE_ACMP,		1,		"VIN",		1,	0 },
+	{ X4662,	GP_SITE_PGA,		0,	"VOUT",				GP_SITE_ACMP,		1,		"VIN",		1,	1 },
+	{ X4662,	GP_SITE_IOB_A,		13,	"OUT",				GP_SITE_ACMP,		2,		"VIN",		1,	0 },
+	{ X4662,	GP_SITE_IOB_B,		15,	"OUT",				GP_SITE_ACMP,		3,		"VIN",		1,	0 },
+	{ X4662,	GP_SITE_IOB_A,		13,	"OUT",				GP_SITE_ACMP,		3,		"VIN",		1,	1 },
+	{ X4662,	GP_SITE_IOB_A,		3,	"OUT",				GP_SITE_ACMP,		4,		"VIN",		1,	0 },
+	{ X4662,	GP_SITE_IOB_B,		15,	"OUT",				GP_SITE_ACMP,		4,		"VIN",		1,	1 },
+	{ X4662,	GP_SITE_IOB_B,		4,	"OUT",				GP_SITE_ACMP,		5,		"VIN",		1,	0 },
+
+	//ACMP0 input before gain stage is fed to everything but ACMP5
+	{ X4662,	GP_SITE_IOB_B,		6,	"OUT",				GP_SITE_ACMP,		0,		"VIN",		1,	0 },
+	{ X4662,	GP_SITE_VDD,		0,	"OUT",				GP_SITE_ACMP,		0,		"VIN",		1,	2 },
+	{ X4662,	GP_SITE_ABUF,		0,	"OUT",				GP_SITE_ACMP,		0,		"VIN",		1,	1 },
+	{ X4662,	GP_SITE_IOB_B,		6,	"OUT",				GP_SITE_ACMP,		1,		"VIN",		1,	2 },
+	{ X4662,	GP_SITE_VDD,		0,	"OUT",				GP_SITE_ACMP,		1,		"VIN",		1,	2 },
+	{ X4662,	GP_SITE_ABUF,		0,	"OUT",				GP_SITE_ACMP,		1,		"VIN",		1,	2 },
+	{ X4662,	GP_SITE_IOB_B,		6,	"OUT",				GP_SITE_ACMP,		2,		"VIN",		1,	1 },
+	{ X4662,	GP_SITE_VDD,		0,	"OUT",				GP_SITE_ACMP,		2,		"VIN",		1,	1 },
+	{ X4662,	GP_SITE_ABUF,		0,	"OUT",				GP_SITE_ACMP,		2,		"VIN",		1,	1 },
+	{ X4662,	GP_SITE_IOB_B,		6,	"OUT",				GP_SITE_ACMP,		3,		"VIN",		1,	2 },
+	{ X4662,	GP_SITE_VDD,		0,	"OUT",				GP_SITE_ACMP,		3,		"VIN",		1,	2 },
+	{ X4662,	GP_SITE_ABUF,		0,	"OUT",				GP_SITE_ACMP,		3,		"VIN",		1,	2 },
+	{ X4662,	GP_SITE_IOB_B,		6,	"OUT",				GP_SITE_ACMP,		4,		"VIN",		1,	2 },
+	{ X4662,	GP_SITE_VDD,		0,	"OUT",				GP_SITE_ACMP,		4,		"VIN",		1,	2 },
+	{ X4662,	GP_SITE_ABUF,		0,	"OUT",				GP_SITE_ACMP,		4,		"VIN",		1,	2 },
+
+	//Inputs to PGA
+	//TODO: DAC output to VIN_N
+	{ X4662,	GP_SITE_VDD,		0,	"OUT",				GP_SITE_PGA,		0,		"VIN_P",	1,	NONE },
+	{ X4662,	GP_SITE_IOB_B,		8,	"OUT",				GP_SITE_PGA,		0,		"VIN_P",	1,	NONE },
+	{ X4662,	GP_SITE_IOB_A,		9,	"OUT",				GP_SITE_PGA,		0,		"VIN_N",	1,	NONE },
+	{ X4662,	GP_SITE_VSS,		0,	"OUT",				GP_SITE_PGA,		0,		"VIN_N",	1,	NONE },
+	{ X4662,	GP_SITE_IOB_A,		16,	"OUT",				GP_SITE_PGA,		0,		"VIN_SEL",	1,	NONE },
+	{ X4662,	GP_SITE_VDD,		0,	"OUT",				GP_SITE_PGA,		0,		"VIN_SEL",	1,	NONE },
+
+	//PGA to IOB
+	//TODO: Output to ADC
+	{ X4662,	GP_SITE_PGA,		0,	"VOUT",				GP_SITE_IOB_A,		7,		"IN",		1,	NONE },
+
+	//DAC voltage references driving DAC inputs
+	{ X4662,	GP_SITE_VREF,		6,	"VOUT",				GP_SITE_DAC,		0,		"VREF",		1,	NONE },
+	{ X4662,	GP_SITE_VREF,		7,	"VOUT",				GP_SITE_DAC,		1,		"VREF",		1,	NONE },
+
+	//Static 1/0 for register configuration
+	//TODO: Direct inputs from counters
+	{ X4662,	GP_SITE_VDD,		0,	"OUT",				GP_SITE_DAC,		ALL,	"DIN",		8,	NONE },
+	{ X4662,	GP_SITE_VSS,		0,	"OUT",				GP_SITE_DAC,		ALL,	"DIN",		8,	NONE },
+
+	//Both DACs can drive every comparator vref
+	{ X4662,	GP_SITE_DAC,		ALL,	"VOUT",			GP_SITE_VREF,		0,		"VIN",		1,	NONE },
+	{ X4662,	GP_SITE_DAC,		ALL,	"VOUT",			GP_SITE_VREF,		1,		"VIN",		1,	NONE },
+	{ X4662,	GP_SITE_DAC,		ALL,	"VOUT",			GP_SITE_VREF,		2,		"VIN",		1,	NONE },
+	{ X4662,	GP_SITE_DAC,		ALL,	"VOUT",			GP_SITE_VREF,		3,		"VIN",		1,	NONE },
+	{ X4662,	GP_SITE_DAC,		ALL,	"VOUT",			GP_SITE_VREF,		4,		"VIN",		1,	NONE },
+	{ X4662,	GP_SITE_DAC,		ALL,	"VOUT",			GP_SITE_VREF,		5,		"VIN",		1,	NONE },
+
+	//DACs can drive I/O pins directly without going through a GP_VREF
+	{ X4662,	GP_SITE_DAC,		0,	"VOUT",				GP_SITE_IOB_A,		19,		"IN",		1,	NONE },
+	{ X4662,	GP_SITE_DAC,		1,	"VOUT",				GP_SITE_IOB_A,		18,		"IN",		1,	NONE },
+};
+
+const Greenpak4DeviceDescription g_slg4662xDescription =
+{
+	2048,			//bitstream length
+	6,				//64 inputs per routing matrix
+	{ 0, 1024 },	//matrix base addresses
+	g_slg4662xSites,
+	TABLE_SIZE(g_slg4662xSites),
+	g_slg4662xRoutes,
+	TABLE_SIZE(g_slg4662xRoutes)
+};
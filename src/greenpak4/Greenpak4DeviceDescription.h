@@ -0,0 +1,155 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4DeviceDescription_h
+#define Greenpak4DeviceDescription_h
+
+/**
+	@file
+	@brief Declarative description of the sites and dedicated routing of a GreenPAK part
+
+	Greenpak4Device instantiates its entities, and gp4par its dedicated routing edges, by walking these tables.
+	Adding a part (or a variant of one) means adding rows, not code.
+ */
+
+///Kinds of site a device description can instantiate
+enum Greenpak4SiteKind
+{
+	GP_SITE_VSS,
+	GP_SITE_VDD,
+	GP_SITE_LUT2,
+	GP_SITE_LUT3,
+	GP_SITE_LUT4,
+	GP_SITE_LUT4_PGEN,			//LUT4 paired with a pattern generator
+	GP_SITE_IOB_A,
+	GP_SITE_IOB_B,
+	GP_SITE_DFF,
+	GP_SITE_DFFSR,
+	GP_SITE_SHREG,
+	GP_SITE_DELAY,
+	GP_SITE_INV,
+	GP_SITE_LFOSC,
+	GP_SITE_RINGOSC,
+	GP_SITE_RCOSC,
+	GP_SITE_COUNT8,
+	GP_SITE_COUNT14,
+	GP_SITE_DAC,
+	GP_SITE_BANDGAP,
+	GP_SITE_VREF,
+	GP_SITE_ACMP,
+	GP_SITE_PGA,
+	GP_SITE_ABUF,
+	GP_SITE_POR,
+	GP_SITE_SYSRESET,
+	GP_SITE_CROSS_CONNECTION,
+
+	GP_SITE_NUM_KINDS
+};
+
+///Bit masks of the parts a row of a description applies to
+enum Greenpak4PartMask
+{
+	GP_PART_SLG46620	= 1,
+	GP_PART_SLG46621	= 2,
+
+	GP_PART_SLG4662X	= GP_PART_SLG46620 | GP_PART_SLG46621
+};
+
+///Value for a base address or mux selector that isn't used by a site
+static const unsigned int GP_SITE_NONE = static_cast<unsigned int>(-1);
+
+///Instance number matching every site of a kind (in the order the device's accessors return them)
+static const unsigned int GP_SITE_ALL = static_cast<unsigned int>(-1);
+
+///Flags for counter sites
+enum Greenpak4SiteFlags
+{
+	GP_SITE_FLAG_FSM		= 1,
+	GP_SITE_FLAG_WSPWRDN	= 2,
+	GP_SITE_FLAG_EDGEDET	= 4,
+	GP_SITE_FLAG_PWM		= 8
+};
+
+/**
+	@brief A single entity of a device
+
+	Meaning of m_flags and m_extra depends on the kind:
+		LUT4_PGEN:	m_extra[0] is the LUT/PGEN select bit
+		IOB_A/B:	m_flags are Greenpak4IOB::IOB_FLAG_*, m_extra[0] is the analog config base (or GP_SITE_NONE)
+		COUNT8/14:	m_flags are GP_SITE_FLAG_*
+		DAC:		m_cbase is the register base, m_extra[] are the power, input select and always-on bases
+		VREF:		m_extra[0] is the output mux selector (or GP_SITE_NONE)
+		ACMP:		m_extra[] are the current source, bandwidth, gain, input, hysteresis and reference bases
+		CROSS_CONNECTION:	m_num is the index among the connections from m_matrix to the other matrix
+ */
+struct Greenpak4SiteInfo
+{
+	Greenpak4SiteKind m_kind;
+	unsigned int m_parts;
+
+	///Instance number (pin number for IOBs)
+	unsigned int m_num;
+
+	unsigned int m_matrix;
+	unsigned int m_ibase;
+	unsigned int m_oword;
+	unsigned int m_cbase;
+	unsigned int m_flags;
+	unsigned int m_extra[6];
+};
+
+/**
+	@brief A dedicated (non-fabric) connection between two sites
+
+	An instance number of GP_SITE_ALL expands to every site of that kind. If m_width is greater than one the
+	destination port is a bus and each bit gets its own edge. Routes into a comparator's VIN also program its input
+	mux; m_muxsel is the selector value for this source (GP_SITE_NONE for every other route).
+ */
+struct Greenpak4RouteInfo
+{
+	unsigned int m_parts;
+
+	Greenpak4SiteKind m_srcKind;
+	unsigned int m_srcNum;
+	const char* m_srcPort;
+
+	Greenpak4SiteKind m_dstKind;
+	unsigned int m_dstNum;
+	const char* m_dstPort;
+
+	unsigned int m_width;
+	unsigned int m_muxsel;
+};
+
+///Everything needed to build one family of parts
+struct Greenpak4DeviceDescription
+{
+	unsigned int m_bitlen;
+	unsigned int m_matrixBits;
+	unsigned int m_matrixBase[2];
+
+	const Greenpak4SiteInfo* m_sites;
+	unsigned int m_siteCount;
+
+	const Greenpak4RouteInfo* m_routes;
+	unsigned int m_routeCount;
+};
+
+extern const Greenpak4DeviceDescription g_slg4662xDescription;
+
+#endif
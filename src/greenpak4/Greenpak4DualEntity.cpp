@@ -25,6 +25,7 @@ using namespace std;
 
 Greenpak4DualEntity::Greenpak4DualEntity(Greenpak4BitstreamEntity* dual)
 	: Greenpak4BitstreamEntity(
+		KIND_DUAL,
 		dual->GetDevice(),
 		1 - dual->GetMatrix(),
 		0,	//no inputs
@@ -48,19 +49,19 @@ string Greenpak4DualEntity::GetDescription()
 	return m_dual->GetDescription();
 }
 
-vector<string> Greenpak4DualEntity::GetInputPorts() const
+const Greenpak4PortTable& Greenpak4DualEntity::GetPortTable() const
 {
-	return m_dual->GetInputPorts();
+	return m_dual->GetPortTable();
 }
 
-vector<string> Greenpak4DualEntity::GetOutputPorts() const
+uint32_t Greenpak4DualEntity::GetFabricPortMask() const
 {
-	return m_dual->GetOutputPorts();
+	return m_dual->GetFabricPortMask();
 }
 
-void Greenpak4DualEntity::SetInput(string port, Greenpak4EntityOutput src)
+void Greenpak4DualEntity::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	m_dual->SetInput(port, src);
+	m_dual->SetInputByID(port, src);
 }
 
 Greenpak4EntityOutput Greenpak4DualEntity::GetOutput(std::string port)
@@ -68,9 +69,9 @@ Greenpak4EntityOutput Greenpak4DualEntity::GetOutput(std::string port)
 	return Greenpak4EntityOutput(m_dual, port, m_matrix);
 }
 
-unsigned int Greenpak4DualEntity::GetOutputNetNumber(string port)
+unsigned int Greenpak4DualEntity::GetOutputNetNumberByID(unsigned int port)
 {
-	return m_dual->GetOutputNetNumber(port);
+	return m_dual->GetOutputNetNumberByID(port);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -82,12 +83,35 @@ bool Greenpak4DualEntity::CommitChanges()
 	return true;
 }
 
-bool Greenpak4DualEntity::Load(bool* /*bitstream*/)
+bool Greenpak4DualEntity::Load(const Greenpak4Bitstream& /*bitstream*/)
 {
 	return true;
 }
 
-bool Greenpak4DualEntity::Save(bool* /*bitstream*/)
+bool Greenpak4DualEntity::Save(Greenpak4Bitstream& /*bitstream*/)
 {
 	return true;
 }
+
+void Greenpak4DualEntity::RegisterBitFields(Greenpak4BitFieldMap& /*map*/)
+{
+	//Our bits belong to the real entity
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4DualEntity::GetInput(string port)
+{
+	return m_dual->GetInput(port);
+}
+
+string Greenpak4DualEntity::GetPrimitiveName()
+{
+	return m_dual->GetPrimitiveName();
+}
+
+map<string, string> Greenpak4DualEntity::GetParameters()
+{
+	return m_dual->GetParameters();
+}
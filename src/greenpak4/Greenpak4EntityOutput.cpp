@@ -26,32 +26,32 @@ using namespace std;
 
 Greenpak4EntityOutput Greenpak4EntityOutput::GetDual()
 {
-	return m_src->GetDual()->GetOutput(m_port);
+	return m_src->GetDual()->GetOutput(GetPort());
 }
 
 bool Greenpak4EntityOutput::IsPowerRail()
 {
-	return dynamic_cast<Greenpak4PowerRail*>(m_src) != NULL;
+	return (m_src != NULL) && (m_src->GetKind() == Greenpak4BitstreamEntity::KIND_POWER_RAIL);
 }
 
 bool Greenpak4EntityOutput::IsVoltageReference()
 {
-	return dynamic_cast<Greenpak4VoltageReference*>(m_src) != NULL;
+	return (m_src != NULL) && (m_src->GetKind() == Greenpak4BitstreamEntity::KIND_VREF);
 }
 
 bool Greenpak4EntityOutput::IsPGA()
 {
-	return dynamic_cast<Greenpak4PGA*>(m_src) != NULL;
+	return (m_src != NULL) && (m_src->GetKind() == Greenpak4BitstreamEntity::KIND_PGA);
 }
 
 bool Greenpak4EntityOutput::IsDAC()
 {
-	return dynamic_cast<Greenpak4DAC*>(m_src) != NULL;
+	return (m_src != NULL) && (m_src->GetKind() == Greenpak4BitstreamEntity::KIND_DAC);
 }
 
 bool Greenpak4EntityOutput::GetPowerRailValue()
 {
 	if(!IsPowerRail())
 		return false;
-	return dynamic_cast<Greenpak4PowerRail*>(m_src)->GetDigitalValue();
+	return static_cast<Greenpak4PowerRail*>(m_src)->GetDigitalValue();
 }
@@ -19,22 +19,27 @@
 #ifndef Greenpak4EntityOutput_h
 #define Greenpak4EntityOutput_h
 
+#include <functional>
+
 /**
 	@brief A single output from a general fabric signal
+
+	This is a small value type: the source entity plus the ID of the port in its port table, so copying, comparing and
+	hashing one never touches a string. Ordering follows entity construction order, then port table order.
  */
 class Greenpak4EntityOutput
 {
 public:
-	Greenpak4EntityOutput(Greenpak4BitstreamEntity* src=NULL, std::string port="", unsigned int matrix=0)
+	Greenpak4EntityOutput(Greenpak4BitstreamEntity* src=NULL, const std::string& port="", unsigned int matrix=0)
 	: m_src(src)
-	, m_port(port)
+	, m_portID( (src && !port.empty()) ? src->LookupOutputPort(port) : Greenpak4BitstreamEntity::PORT_NONE )
 	, m_matrix(matrix)
 	{}
 
 	//Equality test. Do NOT check for matrix equality
 	//as both outputs of a dual-matrix node are considered equal
 	bool operator==(const Greenpak4EntityOutput& rhs) const
-	{ return (m_src == rhs.m_src) && (m_port == rhs.m_port); }
+	{ return (m_src == rhs.m_src) && (m_portID == rhs.m_portID); }
 
 	bool operator!=(const Greenpak4EntityOutput& rhs) const
 	{ return !(rhs == *this); }
@@ -43,7 +48,14 @@ public:
 	{ return m_src->GetDescription(); }
 
 	std::string GetOutputName() const
-	{ return m_src->GetDescription() + " port " + m_port; }
+	{ return m_src->GetDescription() + " port " + GetPort(); }
+
+	///Name of the port on the source entity
+	std::string GetPort() const
+	{ return m_src ? m_src->GetPortName(m_portID) : ""; }
+
+	unsigned int GetPortID() const
+	{ return m_portID; }
 
 	Greenpak4EntityOutput GetDual();
 
@@ -63,16 +75,32 @@ public:
 	{ return m_matrix; }
 
 	unsigned int GetNetNumber()
-	{ return m_src->GetOutputNetNumber(m_port); }
+	{ return m_src->GetOutputNetNumberByID(m_portID); }
+
+	///(entity index, port ID) packed into one integer, for ordering and hashing. The matrix is not included.
+	uint64_t GetKey() const
+	{
+		uint64_t index = m_src ? (m_src->GetEntityIndex() + 1) : 0;
+		return (index << 32) | static_cast<uint32_t>(m_portID + 1);
+	}
 
 	//comparison operator for std::map
 	bool operator<(const Greenpak4EntityOutput& rhs) const
-	{ return GetOutputName() < rhs.GetOutputName(); }
+	{ return GetKey() < rhs.GetKey(); }
 
 public:
 	Greenpak4BitstreamEntity* m_src;
-	std::string m_port;
+	unsigned int m_portID;
 	unsigned int m_matrix;
 };
 
+namespace std
+{
+	template<> struct hash<Greenpak4EntityOutput>
+	{
+		size_t operator()(const Greenpak4EntityOutput& out) const
+		{ return hash<uint64_t>()(out.GetKey()); }
+	};
+}
+
 #endif
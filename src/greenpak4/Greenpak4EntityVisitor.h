@@ -0,0 +1,114 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#ifndef Greenpak4EntityVisitor_h
+#define Greenpak4EntityVisitor_h
+
+/**
+	@brief Calls visitor.Visit() with the entity downcast to its concrete class
+
+	Dispatch is a single switch on the entity's kind tag, with no RTTI. The visitor provides a Visit() overload for
+	each class it cares about, plus Visit(Greenpak4BitstreamEntity*) as a catch-all for everything else. IOBs of
+	either type can be handled by one Visit(Greenpak4IOB*) overload.
+ */
+template<class Visitor>
+void Greenpak4VisitEntity(Greenpak4BitstreamEntity* entity, Visitor& visitor)
+{
+	switch(entity->GetKind())
+	{
+		case Greenpak4BitstreamEntity::KIND_ABUF:
+			visitor.Visit(static_cast<Greenpak4Abuf*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_BANDGAP:
+			visitor.Visit(static_cast<Greenpak4Bandgap*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_COMPARATOR:
+			visitor.Visit(static_cast<Greenpak4Comparator*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_COUNTER:
+			visitor.Visit(static_cast<Greenpak4Counter*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_CROSS_CONNECTION:
+			visitor.Visit(static_cast<Greenpak4CrossConnection*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_DAC:
+			visitor.Visit(static_cast<Greenpak4DAC*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_DELAY:
+			visitor.Visit(static_cast<Greenpak4Delay*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_DUAL:
+			visitor.Visit(static_cast<Greenpak4DualEntity*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_FLIPFLOP:
+			visitor.Visit(static_cast<Greenpak4Flipflop*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_INVERTER:
+			visitor.Visit(static_cast<Greenpak4Inverter*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_IOB_TYPE_A:
+			visitor.Visit(static_cast<Greenpak4IOBTypeA*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_IOB_TYPE_B:
+			visitor.Visit(static_cast<Greenpak4IOBTypeB*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_LFOSC:
+			visitor.Visit(static_cast<Greenpak4LFOscillator*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_LUT:
+			visitor.Visit(static_cast<Greenpak4LUT*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_PAIRED:
+			visitor.Visit(static_cast<Greenpak4PairedEntity*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_PATTERN_GENERATOR:
+			visitor.Visit(static_cast<Greenpak4PatternGenerator*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_PGA:
+			visitor.Visit(static_cast<Greenpak4PGA*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_POWER_ON_RESET:
+			visitor.Visit(static_cast<Greenpak4PowerOnReset*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_POWER_RAIL:
+			visitor.Visit(static_cast<Greenpak4PowerRail*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_RCOSC:
+			visitor.Visit(static_cast<Greenpak4RCOscillator*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_RINGOSC:
+			visitor.Visit(static_cast<Greenpak4RingOscillator*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_SHIFT_REGISTER:
+			visitor.Visit(static_cast<Greenpak4ShiftRegister*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_SYSTEM_RESET:
+			visitor.Visit(static_cast<Greenpak4SystemReset*>(entity));
+			break;
+		case Greenpak4BitstreamEntity::KIND_VREF:
+			visitor.Visit(static_cast<Greenpak4VoltageReference*>(entity));
+			break;
+
+		default:
+			visitor.Visit(entity);
+			break;
+	}
+}
+
+#endif
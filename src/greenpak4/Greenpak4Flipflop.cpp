@@ -32,7 +32,7 @@ Greenpak4Flipflop::Greenpak4Flipflop(
 	unsigned int ibase,
 	unsigned int oword,
 	unsigned int cbase)
-	: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+	: Greenpak4BitstreamEntity(KIND_FLIPFLOP, device, matrix, ibase, oword, cbase)
 	, m_ffnum(ffnum)
 	, m_hasSR(has_sr)
 	, m_initValue(false)
@@ -52,32 +52,47 @@ Greenpak4Flipflop::~Greenpak4Flipflop()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Accessors
 
-vector<string> Greenpak4Flipflop::GetInputPorts() const
+static const Greenpak4EntityPort g_dffPorts[] =
 {
-	vector<string> r;
-	r.push_back("D");
-	r.push_back("CLK");
+	{ "D",     false },
+	{ "CLK",   false },
+	{ "nSR",   false },
+	{ "nSET",  false },
+	{ "nRST",  false },
+	{ "Q",     true },
+	{ "nQ",    true },
+};
+static const Greenpak4PortTable g_dffPortTable = PORT_TABLE(g_dffPorts);
+
+const Greenpak4PortTable& Greenpak4Flipflop::GetPortTable() const
+{
+	return g_dffPortTable;
+}
+
+uint32_t Greenpak4Flipflop::GetFabricPortMask() const
+{
+	uint32_t mask = (1 << PORT_D) | (1 << PORT_CLK) | (1 << PORT_Q) | (1 << PORT_NQ);
 	if(m_hasSR)
-		r.push_back("nSR");
-	return r;
+		mask |= (1 << PORT_NSR);
+	return mask;
 }
 
-void Greenpak4Flipflop::SetInput(string port, Greenpak4EntityOutput src)
+void Greenpak4Flipflop::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	if(port == "CLK")
+	if(port == PORT_CLK)
 		m_clock = src;
-	else if(port == "D")
+	else if(port == PORT_D)
 		m_input = src;
 
 	//multiple set/reset modes possible
-	else if(port == "nSR")
+	else if(port == PORT_NSR)
 		m_nsr = src;
-	else if(port == "nSET")
+	else if(port == PORT_NSET)
 	{
 		m_srmode = true;
 		m_nsr = src;
 	}
-	else if(port == "nRST")
+	else if(port == PORT_NRST)
 	{
 		m_srmode = false;
 		m_nsr = src;
@@ -86,17 +101,9 @@ void Greenpak4Flipflop::SetInput(string port, Greenpak4EntityOutput src)
 	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-vector<string> Greenpak4Flipflop::GetOutputPorts() const
-{
-	vector<string> r;
-	r.push_back("Q");
-	r.push_back("nQ");
-	return r;
-}
-
-unsigned int Greenpak4Flipflop::GetOutputNetNumber(string port)
+unsigned int Greenpak4Flipflop::GetOutputNetNumberByID(unsigned int port)
 {
-	if( (port == "Q") || (port == "nQ") )
+	if( (port == PORT_Q) || (port == PORT_NQ) )
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -115,7 +122,7 @@ string Greenpak4Flipflop::GetDescription()
 bool Greenpak4Flipflop::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -132,13 +139,58 @@ bool Greenpak4Flipflop::CommitChanges()
 	return true;
 }
 
-bool Greenpak4Flipflop::Load(bool* /*bitstream*/)
+bool Greenpak4Flipflop::Load(const Greenpak4Bitstream& bitstream)
 {
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	if(m_hasSR)
+	{
+		Greenpak4EntityOutput sr;
+		if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 0, sr))
+			return false;
+		if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 1, m_input))
+			return false;
+		if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 2, m_clock))
+			return false;
+
+		//Constant set/reset means no set/reset at all (Save() ties it to ground when we're unused)
+		if(sr.IsPowerRail())
+			m_nsr = m_device->GetPower();
+		else
+			m_nsr = sr;
+	}
+
+	else
+	{
+		if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 0, m_input))
+			return false;
+		if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 1, m_clock))
+			return false;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Configuration
+
+	if(bitstream[m_configBase + 0])
+	{
+		LogError("%s is configured as a latch, which is not supported\n", GetDescription().c_str());
+		return false;
+	}
+
+	m_outputInvert = bitstream[m_configBase + 1];
+	if(m_hasSR)
+	{
+		m_srmode = bitstream[m_configBase + 2];
+		m_initValue = bitstream[m_configBase + 3];
+	}
+	else
+		m_initValue = bitstream[m_configBase + 2];
+
+	return true;
 }
 
-bool Greenpak4Flipflop::Save(bool* bitstream)
+bool Greenpak4Flipflop::Save(Greenpak4Bitstream& bitstream)
 {
 	//Sanity check: cannot have set/reset on a DFF, only a DFFSR
 	bool has_sr = !m_nsr.IsPowerRail();
@@ -215,3 +267,60 @@ bool Greenpak4Flipflop::Save(bool* bitstream)
 	return true;
 }
 
+void Greenpak4Flipflop::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	if(m_hasSR)
+	{
+		RegisterMatrixSelector(map, "nSR", m_inputBaseWord + 0);
+		RegisterMatrixSelector(map, "D", m_inputBaseWord + 1);
+		RegisterMatrixSelector(map, "CLK", m_inputBaseWord + 2);
+
+		map.AddField(this, "MODE", m_configBase + 0, 1);
+		map.AddField(this, "INVERT", m_configBase + 1, 1);
+		map.AddField(this, "SRMODE", m_configBase + 2, 1);
+		map.AddField(this, "INIT", m_configBase + 3, 1);
+	}
+
+	else
+	{
+		RegisterMatrixSelector(map, "D", m_inputBaseWord + 0);
+		RegisterMatrixSelector(map, "CLK", m_inputBaseWord + 1);
+
+		map.AddField(this, "MODE", m_configBase + 0, 1);
+		map.AddField(this, "INVERT", m_configBase + 1, 1);
+		map.AddField(this, "INIT", m_configBase + 2, 1);
+	}
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4Flipflop::GetInput(string port)
+{
+	if(port == "CLK")
+		return m_clock;
+	else if(port == "D")
+		return m_input;
+	else if( (port == "nSR") || (port == "nSET") || (port == "nRST") )
+		return m_nsr;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4Flipflop::GetPrimitiveName()
+{
+	string name = "GP_DFF";
+	if(!m_nsr.IsPowerRail())
+		name += m_srmode ? "S" : "R";
+	if(m_outputInvert)
+		name += "I";
+	return name;
+}
+
+map<string, string> Greenpak4Flipflop::GetParameters()
+{
+	map<string, string> params;
+	params["INIT"] = m_initValue ? "1'b1" : "1'b0";
+	return params;
+}
@@ -0,0 +1,50 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include <Greenpak4.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <vector>
+
+using namespace std;
+
+/**
+	@brief Appends printf-style formatted text to a string
+
+	@param buf		String to append to
+	@param format	printf format string
+ */
+void Greenpak4AppendFormat(string& buf, const char* format, ...)
+{
+	va_list list;
+	va_start(list, format);
+	va_list copy;
+	va_copy(copy, list);
+	int len = vsnprintf(NULL, 0, format, copy);
+	va_end(copy);
+
+	if(len > 0)
+	{
+		vector<char> line(len + 1);
+		vsnprintf(&line[0], line.size(), format, list);
+		buf += &line[0];
+	}
+	va_end(list);
+}
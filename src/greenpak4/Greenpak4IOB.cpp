@@ -25,6 +25,7 @@ using namespace std;
 // Construction / destruction
 
 Greenpak4IOB::Greenpak4IOB(
+	Kind kind,
 	Greenpak4Device* device,
 	unsigned int pin_num,
 	unsigned int matrix,
@@ -32,7 +33,7 @@ Greenpak4IOB::Greenpak4IOB(
 	unsigned int oword,
 	unsigned int cbase,
 	unsigned int flags)
-	: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+	: Greenpak4BitstreamEntity(kind, device, matrix, ibase, oword, cbase)
 	, m_pinNumber(pin_num)
 	, m_schmittTrigger(false)
 	, m_pullStrength(PULL_10K)
@@ -59,17 +60,17 @@ Greenpak4IOB::~Greenpak4IOB()
 bool Greenpak4IOB::CommitChanges()
 {
 	//Get our IOB cell
-	auto cell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto cell = GetNetlistCell();
 	if(cell == NULL)
 		return true;
 
 	//Get the net
 	Greenpak4NetlistNode* net = NULL;
-	if(cell->m_type == "GP_IBUF")
+	if(cell->IsType(GP_PRIM_IBUF))
 		net = cell->m_connections["IN"][0];
-	else if(cell->m_type == "GP_OBUF")
+	else if(cell->IsType(GP_PRIM_OBUF))
 		net = cell->m_connections["OUT"][0];
-	else if(cell->m_type == "GP_IOBUF")
+	else if(cell->IsType(GP_PRIM_IOBUF))
 		net = cell->m_connections["IO"][0];
 	if(net == NULL)
 		return true;
@@ -80,16 +81,17 @@ bool Greenpak4IOB::CommitChanges()
 	m_pullDirection = PULL_NONE;
 
 	//Apply attributes to configure the net
-	for(auto x : net->m_attributes)
+	for(auto& x : net->m_attributes)
 	{
+		const string& name = net->m_attributes.GetName(x.first);
 		bool bad_value = false;
 
 		//do nothing, only for debugging
-		if(x.first == "src")
+		if(x.first == GP_SYM_SRC)
 		{}
 
 		//IO schmitt trigger
-		else if(x.first == "SCHMITT_TRIGGER")
+		else if(name == "SCHMITT_TRIGGER")
 		{
 			if(x.second == "0")
 				m_schmittTrigger = false;
@@ -100,7 +102,7 @@ bool Greenpak4IOB::CommitChanges()
 		}
 
 		//Pullup strength/direction
-		else if(x.first == "PULLUP")
+		else if(name == "PULLUP")
 		{
 			m_pullDirection = Greenpak4IOB::PULL_UP;
 			if(x.second == "10k")
@@ -114,7 +116,7 @@ bool Greenpak4IOB::CommitChanges()
 		}
 
 		//Pulldown strength/direction
-		else if(x.first == "PULLDOWN")
+		else if(name == "PULLDOWN")
 		{
 			m_pullDirection = Greenpak4IOB::PULL_DOWN;
 			if(x.second == "10k")
@@ -128,7 +130,7 @@ bool Greenpak4IOB::CommitChanges()
 		}
 
 		//Driver configuration
-		else if(x.first == "DRIVE_STRENGTH")
+		else if(name == "DRIVE_STRENGTH")
 		{
 			if(x.second == "1X")
 				m_driveStrength = Greenpak4IOB::DRIVE_1X;
@@ -141,7 +143,7 @@ bool Greenpak4IOB::CommitChanges()
 		}
 
 		//Driver configuration
-		else if(x.first == "DRIVE_TYPE")
+		else if(name == "DRIVE_TYPE")
 		{
 			m_driveType = Greenpak4IOB::DRIVE_PUSHPULL;
 			if(x.second == "PUSHPULL")
@@ -155,7 +157,7 @@ bool Greenpak4IOB::CommitChanges()
 		}
 
 		//Input buffer configuration
-		else if(x.first == "IBUF_TYPE")
+		else if(name == "IBUF_TYPE")
 		{
 			m_inputThreshold = Greenpak4IOB::THRESHOLD_NORMAL;
 			if(x.second == "NORMAL")
@@ -169,7 +171,7 @@ bool Greenpak4IOB::CommitChanges()
 		}
 
 		//Ignore flipflop initialization, that's handled elsewhere
-		else if(x.first == "init")
+		else if(name == "init")
 		{
 		}
 
@@ -178,25 +180,25 @@ bool Greenpak4IOB::CommitChanges()
 		else
 		{
 			LogWarning("Top-level port \"%s\" has unrecognized attribute %s, ignoring\n",
-				cell->m_name.c_str(), x.first.c_str());
+				cell->m_name.c_str(), name.c_str());
 		}
 
 		if(bad_value)
 		{
 			LogError("Top-level port \"%s\" has attribute %s with unrecognized value \"%s\"\n",
-				cell->m_name.c_str(), x.first.c_str(), x.second.c_str());
+				cell->m_name.c_str(), name.c_str(), x.second.c_str());
 			return false;
 		}
 
-		//LogNotice("        %s = %s\n", x.first.c_str(), x.second.c_str());
+		//LogNotice("        %s = %s\n", name.c_str(), x.second.c_str());
 	}
 
 	//Configure output enable
-	if(cell->m_type == "GP_OBUF")
+	if(cell->IsType(GP_PRIM_OBUF))
 		m_outputEnable = m_device->GetPower();
-	else if(cell->m_type == "GP_IBUF")
+	else if(cell->IsType(GP_PRIM_IBUF))
 		m_outputEnable = m_device->GetGround();
-	else if(cell->m_type == "GP_IOBUF")
+	else if(cell->IsType(GP_PRIM_IOBUF))
 	{
 		//output enable will be hooked up by SetInput()
 	}
@@ -209,35 +211,132 @@ bool Greenpak4IOB::CommitChanges()
 	return true;
 }
 
-void Greenpak4IOB::SetInput(string port, Greenpak4EntityOutput src)
+static const Greenpak4EntityPort g_iobPorts[] =
 {
-	if(port == "IN")
+	{ "IN",   false },
+	{ "OE",   false },
+	{ "OUT",  true },
+};
+static const Greenpak4PortTable g_iobPortTable = PORT_TABLE(g_iobPorts);
+
+const Greenpak4PortTable& Greenpak4IOB::GetPortTable() const
+{
+	return g_iobPortTable;
+}
+
+uint32_t Greenpak4IOB::GetFabricPortMask() const
+{
+	return (1 << PORT_IN) | (1 << PORT_OE) | (1 << PORT_OUT);
+}
+
+void Greenpak4IOB::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
+{
+	if(port == PORT_IN)
 		m_outputSignal = src;
-	else if(port == "OE")
+	else if(port == PORT_OE)
 		m_outputEnable = src;
 
 	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-unsigned int Greenpak4IOB::GetOutputNetNumber(string port)
+unsigned int Greenpak4IOB::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "OUT")
+	if(port == PORT_OUT)
 		return m_outputBaseWord;
 	else
 		return -1;
 }
 
-vector<string> Greenpak4IOB::GetInputPorts() const
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Serialization
+
+bool Greenpak4IOB::LoadPull(const Greenpak4Bitstream& bitstream, unsigned int base)
 {
-	vector<string> r;
-	r.push_back("IN");
-	r.push_back("OE");
-	return r;
+	switch(bitstream.GetField(base, 2))
+	{
+		//Pull circuit disconnected, direction is a don't-care
+		case 0:
+			m_pullDirection = PULL_NONE;
+			return true;
+
+		case 1:
+			m_pullStrength = PULL_10K;
+			break;
+
+		case 2:
+			m_pullStrength = PULL_100K;
+			break;
+
+		case 3:
+			m_pullStrength = PULL_1M;
+			break;
+	}
+
+	m_pullDirection = bitstream[base + 2] ? PULL_UP : PULL_DOWN;
+	return true;
 }
 
-vector<string> Greenpak4IOB::GetOutputPorts() const
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4IOB::GetInput(string port)
 {
-	vector<string> r;
-	r.push_back("OUT");
-	return r;
+	if(port == "IN")
+		return m_outputSignal;
+	else if(port == "OE")
+		return m_outputEnable;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4IOB::GetPrimitiveName()
+{
+	if(m_outputEnable.IsPowerRail())
+	{
+		if(m_outputEnable.GetPowerRailValue())
+			return "GP_OBUF";
+
+		//Analog outputs float the digital driver
+		if(m_outputSignal.IsVoltageReference() || m_outputSignal.IsDAC())
+			return "GP_OBUF";
+
+		return "GP_IBUF";
+	}
+
+	return "GP_IOBUF";
+}
+
+/**
+	@brief Gets our pad configuration.
+
+	These are attributes on the top-level port rather than cell parameters in HDL, so only non-default values
+	are reported.
+ */
+map<string, string> Greenpak4IOB::GetParameters()
+{
+	static const char* strengths[] = { "\"10k\"", "\"100k\"", "\"1M\"" };
+	static const char* drives[] = { "\"1X\"", "\"2X\"", "\"4X\"" };
+	static const char* types[] = { "\"PUSHPULL\"", "\"NMOS_OD\"", "\"PMOS_OD\"" };
+	static const char* thresholds[] = { "\"NORMAL\"", "\"LOW_VOLTAGE\"", "\"ANALOG\"" };
+
+	map<string, string> params;
+	if(m_schmittTrigger)
+		params["SCHMITT_TRIGGER"] = "1";
+	if(m_pullDirection == PULL_UP)
+		params["PULLUP"] = strengths[m_pullStrength];
+	else if(m_pullDirection == PULL_DOWN)
+		params["PULLDOWN"] = strengths[m_pullStrength];
+	if(m_inputThreshold != THRESHOLD_NORMAL)
+		params["IBUF_TYPE"] = thresholds[m_inputThreshold];
+
+	//Driver settings only matter if the driver is ever on
+	if(!m_outputEnable.IsPowerRail() || m_outputEnable.GetPowerRailValue())
+	{
+		if(m_driveStrength != DRIVE_1X)
+			params["DRIVE_STRENGTH"] = drives[m_driveStrength];
+		if(m_driveType != DRIVE_PUSHPULL)
+			params["DRIVE_TYPE"] = types[m_driveType];
+	}
+
+	return params;
 }
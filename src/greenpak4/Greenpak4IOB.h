@@ -26,8 +26,17 @@ class Greenpak4IOB : public Greenpak4BitstreamEntity
 {
 public:
 
+	///IDs of our ports (indexes into our port table)
+	enum Port
+	{
+		PORT_IN,
+		PORT_OE,
+		PORT_OUT
+	};
+
 	//Construction / destruction
 	Greenpak4IOB(
+		Kind kind,
 		Greenpak4Device* device,
 		unsigned int pin_num,
 		unsigned int matrix,
@@ -107,14 +116,18 @@ public:
 	unsigned int GetPinNumber()
 	{ return m_pinNumber; }
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
-	virtual unsigned int GetOutputNetNumber(std::string port);
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
 	//Used to set defaults in Greenpak4Device constructor
 	void SetPullDirection(PullDirection dir)
 	{ m_pullDirection = dir; }
@@ -134,6 +147,9 @@ public:
 
 protected:
 
+	//Decode the 3-bit pull resistor field (strength 1:0, direction 2) shared by both IOB types
+	bool LoadPull(const Greenpak4Bitstream& bitstream, unsigned int base);
+
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// Abstracted version of format-dependent bitstream state
 
@@ -32,7 +32,7 @@ Greenpak4IOBTypeA::Greenpak4IOBTypeA(
 	unsigned int oword,
 	unsigned int cbase,
 	unsigned int flags)
-	: Greenpak4IOB(device, pin_num, matrix, ibase, oword, cbase, flags)
+	: Greenpak4IOB(KIND_IOB_TYPE_A, device, pin_num, matrix, ibase, oword, cbase, flags)
 {
 
 }
@@ -55,14 +55,87 @@ string Greenpak4IOBTypeA::GetDescription()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Serialization
 
-bool Greenpak4IOBTypeA::Load(bool* /*bitstream*/)
+bool Greenpak4IOBTypeA::Load(const Greenpak4Bitstream& bitstream)
 {
-	//TODO
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	//Input-only pins keep the tied-off defaults
+	if(! (m_flags & IOB_FLAG_INPUTONLY) )
+	{
+		//Analog output? The digital driver is floated, so leave OE grounded
+		unsigned int asel = 0;
+		if(m_analogConfigBase != 0)
+			asel = bitstream.GetField(m_analogConfigBase, 2);
+
+		//2'b11 is the DAC (SLG4662x specific!)
+		if(asel == 3)
+		{
+			if(
+				(m_device->GetPart() != Greenpak4Device::GREENPAK4_SLG46620) &&
+				(m_device->GetPart() != Greenpak4Device::GREENPAK4_SLG46621)
+			)
+			{
+				LogError("Greenpak4IOBTypeA: not implemented for 46140 yet\n");
+				return false;
+			}
+			m_outputSignal = m_device->GetDAC( (m_pinNumber == 19) ? 0 : 1)->GetOutput("VOUT");
+		}
+
+		//Anything else nonzero is a voltage reference (VREF0/1 on pin 19, VREF2/3 on pin 18)
+		else if(asel != 0)
+		{
+			unsigned int base = (m_pinNumber == 19) ? 0 : 2;
+			m_outputSignal = m_device->GetVref(base + asel - 1)->GetOutput("VOUT");
+		}
+
+		//Digital output and enable
+		else
+		{
+			if(!ReadMatrixSelector(bitstream, m_inputBaseWord, m_outputSignal))
+				return false;
+			if(!ReadMatrixSelector(bitstream, m_inputBaseWord+1, m_outputEnable))
+				return false;
+		}
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// CONFIGURATION
+
+	//Input threshold 1:0
+	m_schmittTrigger = false;
+	if(bitstream[m_configBase+1])
+		m_inputThreshold = bitstream[m_configBase+0] ? THRESHOLD_ANALOG : THRESHOLD_LOW;
+	else
+	{
+		m_inputThreshold = THRESHOLD_NORMAL;
+		m_schmittTrigger = bitstream[m_configBase+0];
+	}
+
+	//Base address for upcoming stuff, skipping output driver if not implemented
+	unsigned int base = m_configBase + 2;
+
+	if(! (m_flags & IOB_FLAG_INPUTONLY) )
+	{
+		//Output drive strength 2, 7 if super driver present
+		if( (m_flags & IOB_FLAG_X4DRIVE) && bitstream[m_configBase+7])
+			m_driveStrength = DRIVE_4X;
+		else if(bitstream[m_configBase+2])
+			m_driveStrength = DRIVE_2X;
+		else
+			m_driveStrength = DRIVE_1X;
+
+		//Output buffer type 3
+		m_driveType = bitstream[m_configBase+3] ? DRIVE_NMOS_OPENDRAIN : DRIVE_PUSHPULL;
+
+		base += 2;
+	}
+
+	//Pullup/down resistor strength 5:4, direction 6
+	return LoadPull(bitstream, base);
 }
 
-bool Greenpak4IOBTypeA::Save(bool* bitstream)
+bool Greenpak4IOBTypeA::Save(Greenpak4Bitstream& bitstream)
 {
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// INPUT BUS
@@ -97,10 +170,9 @@ bool Greenpak4IOBTypeA::Save(bool* bitstream)
 				return false;
 
 			//Configure the analog output
-			auto vref = dynamic_cast<Greenpak4VoltageReference*>(m_outputSignal.GetRealEntity());
+			auto vref = static_cast<Greenpak4VoltageReference*>(m_outputSignal.GetRealEntity());
 			unsigned int sel = vref->GetMuxSel();
-			bitstream[m_analogConfigBase + 1] = (sel & 2) ? true : false;
-			bitstream[m_analogConfigBase + 0] = (sel & 1) ? true : false;
+			bitstream.SetField(m_analogConfigBase, 2, sel);
 		}
 
 		//If our output is from a DAC, special processing needed
@@ -283,3 +355,31 @@ bool Greenpak4IOBTypeA::Save(bool* bitstream)
 
 	return true;
 }
+
+void Greenpak4IOBTypeA::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	if(! (m_flags & IOB_FLAG_INPUTONLY) )
+	{
+		RegisterMatrixSelector(map, "IN", m_inputBaseWord);
+		RegisterMatrixSelector(map, "OE", m_inputBaseWord + 1);
+	}
+
+	if(m_analogConfigBase != 0)
+		map.AddField(this, "ANALOG_SEL", m_analogConfigBase, 2);
+
+	map.AddField(this, "THRESHOLD", m_configBase + 0, 2);
+
+	unsigned int base = m_configBase + 2;
+	if(! (m_flags & IOB_FLAG_INPUTONLY) )
+	{
+		map.AddField(this, "DRIVE_STRENGTH", m_configBase + 2, 1);
+		map.AddField(this, "DRIVE_TYPE", m_configBase + 3, 1);
+		base += 2;
+	}
+
+	map.AddField(this, "PULL_STRENGTH", base, 2);
+	map.AddField(this, "PULL_DIR", base + 2, 1);
+
+	if(m_flags & IOB_FLAG_X4DRIVE)
+		map.AddField(this, "DRIVE_X4", m_configBase + 7, 1);
+}
@@ -32,7 +32,7 @@ Greenpak4IOBTypeB::Greenpak4IOBTypeB(
 	unsigned int oword,
 	unsigned int cbase,
 	unsigned int flags)
-	: Greenpak4IOB(device, pin_num, matrix, ibase, oword, cbase, flags)
+	: Greenpak4IOB(KIND_IOB_TYPE_B, device, pin_num, matrix, ibase, oword, cbase, flags)
 {
 
 }
@@ -55,14 +55,72 @@ string Greenpak4IOBTypeB::GetDescription()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Serialization
 
-bool Greenpak4IOBTypeB::Load(bool* /*bitstream*/)
+bool Greenpak4IOBTypeB::Load(const Greenpak4Bitstream& bitstream)
 {
-	//TODO
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	//NB: the pin 8 dedicated POR route is always written alongside the matrix selector, so we needn't decode it
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord, m_outputSignal))
+		return false;
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// CONFIGURATION
+
+	//MODE CONTROL 2:0. 2 is direction, 1:0 is type
+	m_schmittTrigger = false;
+	if(bitstream[m_configBase + 2])
+	{
+		m_outputEnable = m_device->GetPower();
+
+		switch(bitstream.GetField(m_configBase, 2))
+		{
+			case 0:
+				m_driveType = DRIVE_PUSHPULL;
+				break;
+
+			case 1:
+				m_driveType = DRIVE_NMOS_OPENDRAIN;
+				break;
+
+			case 2:
+				m_driveType = DRIVE_PMOS_OPENDRAIN;
+				break;
+
+			default:
+				LogError("Greenpak4IOBTypeB: analog output mode not implemented\n");
+				return false;
+		}
+	}
+	else
+	{
+		m_outputEnable = m_device->GetGround();
+
+		if(bitstream[m_configBase+1])
+			m_inputThreshold = bitstream[m_configBase+0] ? THRESHOLD_ANALOG : THRESHOLD_LOW;
+		else
+		{
+			m_inputThreshold = THRESHOLD_NORMAL;
+			m_schmittTrigger = bitstream[m_configBase+0];
+		}
+	}
+
+	//Pullup/down resistor strength 4:3, direction 5
+	if(!LoadPull(bitstream, m_configBase + 3))
+		return false;
+
+	//Output drive strength 6, 7 if super driver present
+	if( (m_flags & IOB_FLAG_X4DRIVE) && bitstream[m_configBase + 7])
+		m_driveStrength = DRIVE_4X;
+	else if(bitstream[m_configBase + 6])
+		m_driveStrength = DRIVE_2X;
+	else
+		m_driveStrength = DRIVE_1X;
+
+	return true;
 }
 
-bool Greenpak4IOBTypeB::Save(bool* bitstream)
+bool Greenpak4IOBTypeB::Save(Greenpak4Bitstream& bitstream)
 {
 	//See if we're an input or output.
 	//Throw an error if OE isn't tied to a power rail, because we don't have runtime adjustable direction
@@ -247,3 +305,24 @@ bool Greenpak4IOBTypeB::Save(bool* bitstream)
 
 	return true;
 }
+
+void Greenpak4IOBTypeB::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	RegisterMatrixSelector(map, "IN", m_inputBaseWord);
+
+	//Dedicated POR output routing for pin 8
+	if( (m_pinNumber == 8) &&
+		( (m_device->GetPart() == Greenpak4Device::GREENPAK4_SLG46620) ||
+		  (m_device->GetPart() == Greenpak4Device::GREENPAK4_SLG46621) ) )
+	{
+		map.AddField(this, "POR_ROUTE", 2011, 2);
+	}
+
+	map.AddField(this, "MODE", m_configBase + 0, 3);
+	map.AddField(this, "PULL_STRENGTH", m_configBase + 3, 2);
+	map.AddField(this, "PULL_DIR", m_configBase + 5, 1);
+	map.AddField(this, "DRIVE_STRENGTH", m_configBase + 6, 1);
+
+	if(m_flags & IOB_FLAG_X4DRIVE)
+		map.AddField(this, "DRIVE_X4", m_configBase + 7, 1);
+}
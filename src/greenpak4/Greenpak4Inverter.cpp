@@ -29,7 +29,7 @@ Greenpak4Inverter::Greenpak4Inverter(
 		unsigned int matrix,
 		unsigned int ibase,
 		unsigned int oword)
-		: Greenpak4BitstreamEntity(device, matrix, ibase, oword, -1)
+		: Greenpak4BitstreamEntity(KIND_INVERTER, device, matrix, ibase, oword, -1)
 		, m_input(device->GetGround())
 {
 }
@@ -49,31 +49,34 @@ string Greenpak4Inverter::GetDescription()
 	return string(buf);
 }
 
-vector<string> Greenpak4Inverter::GetInputPorts() const
+static const Greenpak4EntityPort g_invPorts[] =
 {
-	vector<string> r;
-	r.push_back("IN");
-	return r;
-}
+	{ "IN",   false },
+	{ "OUT",  true },
+};
+static const Greenpak4PortTable g_invPortTable = PORT_TABLE(g_invPorts);
 
-void Greenpak4Inverter::SetInput(string port, Greenpak4EntityOutput src)
+const Greenpak4PortTable& Greenpak4Inverter::GetPortTable() const
 {
-	if(port == "IN")
-		m_input = src;
+	return g_invPortTable;
+}
 
-	//ignore anything else silently (should not be possible since synthesis would error out)
+uint32_t Greenpak4Inverter::GetFabricPortMask() const
+{
+	return (1 << PORT_IN) | (1 << PORT_OUT);
 }
 
-vector<string> Greenpak4Inverter::GetOutputPorts() const
+void Greenpak4Inverter::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	vector<string> r;
-	r.push_back("OUT");
-	return r;
+	if(port == PORT_IN)
+		m_input = src;
+
+	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-unsigned int Greenpak4Inverter::GetOutputNetNumber(string port)
+unsigned int Greenpak4Inverter::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "OUT")
+	if(port == PORT_OUT)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -88,17 +91,45 @@ bool Greenpak4Inverter::CommitChanges()
 	return true;
 }
 
-bool Greenpak4Inverter::Load(bool* /*bitstream*/)
+bool Greenpak4Inverter::Load(const Greenpak4Bitstream& bitstream)
 {
-	//TODO: Do our inputs
-	LogError("Unimplemented\n");
-	return false;
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord, m_input))
+		return false;
+
+	return true;
 }
 
-bool Greenpak4Inverter::Save(bool* bitstream)
+bool Greenpak4Inverter::Save(Greenpak4Bitstream& bitstream)
 {
 	if(!WriteMatrixSelector(bitstream, m_inputBaseWord, m_input))
 		return false;
 
 	return true;
 }
+
+void Greenpak4Inverter::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	RegisterMatrixSelector(map, "IN", m_inputBaseWord);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4Inverter::GetInput(string port)
+{
+	if(port == "IN")
+		return m_input;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4Inverter::GetPrimitiveName()
+{
+	return "GP_INV";
+}
+
+map<string, string> Greenpak4Inverter::GetParameters()
+{
+	//No configuration
+	return map<string, string>();
+}
@@ -0,0 +1,592 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <log.h>
+#include <Greenpak4.h>
+
+#include <string.h>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+Greenpak4JSONReader::Greenpak4JSONReader()
+	: m_start(NULL)
+	, m_end(NULL)
+	, m_pos(NULL)
+	, m_failed(false)
+{
+}
+
+Greenpak4JSONReader::~Greenpak4JSONReader()
+{
+	Close();
+}
+
+void Greenpak4JSONReader::Close()
+{
+	m_file.Close();
+	m_start = m_end = m_pos = NULL;
+	m_first.clear();
+	m_failed = false;
+}
+
+/**
+	@brief Opens a file for reading.
+
+	The file is mapped read-only where the platform supports it, so the only memory used is the page cache.
+ */
+bool Greenpak4JSONReader::Open(string fname)
+{
+	Close();
+
+	if(!m_file.Open(fname, "JSON file"))
+	{
+		m_failed = true;
+		return false;
+	}
+
+	m_start = m_pos = m_file.GetData();
+	m_end = m_start + m_file.GetLength();
+	return true;
+}
+
+void Greenpak4JSONReader::Open(const char* buf, size_t len)
+{
+	Close();
+	m_start = m_pos = buf;
+	m_end = buf + len;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Low-level helpers
+
+void Greenpak4JSONReader::Error(const char* what)
+{
+	//Don't cascade, the first error is the only useful one
+	if(m_failed)
+		return;
+	m_failed = true;
+
+	//Only compute the position when we need it, keeps the fast path free of line counting
+	unsigned int line = 1;
+	unsigned int col = 1;
+	for(const char* p = m_start; p < m_pos; p++)
+	{
+		if(*p == '\n')
+		{
+			line ++;
+			col = 1;
+		}
+		else
+			col ++;
+	}
+
+	LogError("JSON parsing failed at line %u, column %u: %s\n", line, col, what);
+}
+
+void Greenpak4JSONReader::SkipWhitespace()
+{
+	while(m_pos < m_end)
+	{
+		char c = *m_pos;
+		if( (c == ' ') || (c == '\n') || (c == '\t') || (c == '\r') )
+			m_pos ++;
+		else
+			break;
+	}
+}
+
+bool Greenpak4JSONReader::Expect(char c, const char* what)
+{
+	SkipWhitespace();
+	if( (m_pos >= m_end) || (*m_pos != c) )
+	{
+		Error(what);
+		return false;
+	}
+	m_pos ++;
+	return true;
+}
+
+bool Greenpak4JSONReader::AtEnd()
+{
+	SkipWhitespace();
+	return (m_pos >= m_end);
+}
+
+Greenpak4JSONReader::ValueType Greenpak4JSONReader::PeekType()
+{
+	if(m_failed)
+		return TYPE_INVALID;
+
+	SkipWhitespace();
+	if(m_pos >= m_end)
+		return TYPE_INVALID;
+
+	switch(*m_pos)
+	{
+		case '{':
+			return TYPE_OBJECT;
+		case '[':
+			return TYPE_ARRAY;
+		case '"':
+			return TYPE_STRING;
+		case 't':
+		case 'f':
+			return TYPE_BOOL;
+		case 'n':
+			return TYPE_NULL;
+		case '-':
+			return TYPE_NUMBER;
+		default:
+			if( (*m_pos >= '0') && (*m_pos <= '9') )
+				return TYPE_NUMBER;
+			return TYPE_INVALID;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Structure navigation
+
+bool Greenpak4JSONReader::BeginObject()
+{
+	if(m_failed)
+		return false;
+	if(!Expect('{', "expected an object"))
+		return false;
+	m_first.push_back(true);
+	return true;
+}
+
+/**
+	@brief Advances to the next key of the innermost open object.
+
+	Returns false (and closes the object) when there are no more keys, or if a syntax error occurred.
+ */
+bool Greenpak4JSONReader::NextKey(string& key)
+{
+	if(m_failed || m_first.empty())
+		return false;
+
+	SkipWhitespace();
+	if(m_pos >= m_end)
+	{
+		Error("unexpected end of file inside object");
+		return false;
+	}
+
+	//End of the object?
+	if(*m_pos == '}')
+	{
+		m_pos ++;
+		m_first.pop_back();
+		return false;
+	}
+
+	//Separator, if not the first key
+	if(m_first.back())
+		m_first.back() = false;
+	else
+	{
+		if(*m_pos != ',')
+		{
+			Error("expected ',' or '}' in object");
+			return false;
+		}
+		m_pos ++;
+		SkipWhitespace();
+	}
+
+	if( (m_pos >= m_end) || (*m_pos != '"') )
+	{
+		Error("expected a string key in object");
+		return false;
+	}
+	m_pos ++;
+	if(!ReadStringBody(key))
+		return false;
+
+	return Expect(':', "expected ':' after object key");
+}
+
+bool Greenpak4JSONReader::BeginArray()
+{
+	if(m_failed)
+		return false;
+	if(!Expect('[', "expected an array"))
+		return false;
+	m_first.push_back(true);
+	return true;
+}
+
+/**
+	@brief Advances to the next element of the innermost open array.
+
+	Returns false (and closes the array) when there are no more elements, or if a syntax error occurred.
+ */
+bool Greenpak4JSONReader::NextElement()
+{
+	if(m_failed || m_first.empty())
+		return false;
+
+	SkipWhitespace();
+	if(m_pos >= m_end)
+	{
+		Error("unexpected end of file inside array");
+		return false;
+	}
+
+	if(*m_pos == ']')
+	{
+		m_pos ++;
+		m_first.pop_back();
+		return false;
+	}
+
+	if(m_first.back())
+	{
+		m_first.back() = false;
+		return true;
+	}
+
+	if(*m_pos != ',')
+	{
+		Error("expected ',' or ']' in array");
+		return false;
+	}
+	m_pos ++;
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Scalar values
+
+bool Greenpak4JSONReader::ReadString(string& str)
+{
+	if(m_failed)
+		return false;
+	if(!Expect('"', "expected a string"))
+		return false;
+	return ReadStringBody(str);
+}
+
+/**
+	@brief Reads the remainder of a string (opening quote already consumed)
+ */
+bool Greenpak4JSONReader::ReadStringBody(string& str)
+{
+	//Fast path: no escapes, copy the whole run in one go
+	const char* begin = m_pos;
+	const char* p = begin;
+	while( (p < m_end) && (*p != '"') && (*p != '\\') )
+		p ++;
+	if(p >= m_end)
+	{
+		Error("unterminated string");
+		return false;
+	}
+	str.assign(begin, p - begin);
+	m_pos = p;
+
+	//Slow path for escaped strings
+	while(true)
+	{
+		if(m_pos >= m_end)
+		{
+			Error("unterminated string");
+			return false;
+		}
+
+		char c = *m_pos++;
+		if(c == '"')
+			return true;
+		if(c != '\\')
+		{
+			str += c;
+			continue;
+		}
+
+		if(m_pos >= m_end)
+		{
+			Error("unterminated string");
+			return false;
+		}
+		c = *m_pos++;
+		switch(c)
+		{
+			case '"':
+			case '\\':
+			case '/':
+				str += c;
+				break;
+			case 'b':
+				str += '\b';
+				break;
+			case 'f':
+				str += '\f';
+				break;
+			case 'n':
+				str += '\n';
+				break;
+			case 'r':
+				str += '\r';
+				break;
+			case 't':
+				str += '\t';
+				break;
+			case 'u':
+				if(!ReadUnicodeEscape(str))
+					return false;
+				break;
+			default:
+				m_pos --;
+				Error("invalid escape sequence in string");
+				return false;
+		}
+	}
+}
+
+/**
+	@brief Decodes a \\uXXXX escape (and its low surrogate, if any) to UTF-8
+ */
+bool Greenpak4JSONReader::ReadUnicodeEscape(string& str)
+{
+	uint32_t code = 0;
+	for(int pass=0; pass<2; pass++)
+	{
+		if(m_end - m_pos < 4)
+		{
+			Error("truncated unicode escape");
+			return false;
+		}
+		uint32_t v = 0;
+		for(int i=0; i<4; i++)
+		{
+			char c = *m_pos++;
+			v <<= 4;
+			if( (c >= '0') && (c <= '9') )
+				v |= c - '0';
+			else if( (c >= 'a') && (c <= 'f') )
+				v |= c - 'a' + 10;
+			else if( (c >= 'A') && (c <= 'F') )
+				v |= c - 'A' + 10;
+			else
+			{
+				Error("invalid unicode escape");
+				return false;
+			}
+		}
+
+		if(pass == 0)
+		{
+			code = v;
+
+			//High surrogate needs a low one right behind it
+			if( (code >= 0xd800) && (code < 0xdc00) )
+			{
+				if( (m_end - m_pos < 2) || (m_pos[0] != '\\') || (m_pos[1] != 'u') )
+				{
+					Error("unpaired surrogate in unicode escape");
+					return false;
+				}
+				m_pos += 2;
+				continue;
+			}
+			break;
+		}
+
+		if( (v < 0xdc00) || (v >= 0xe000) )
+		{
+			Error("invalid low surrogate in unicode escape");
+			return false;
+		}
+		code = 0x10000 + ((code - 0xd800) << 10) + (v - 0xdc00);
+	}
+
+	if(code < 0x80)
+		str += static_cast<char>(code);
+	else if(code < 0x800)
+	{
+		str += static_cast<char>(0xc0 | (code >> 6));
+		str += static_cast<char>(0x80 | (code & 0x3f));
+	}
+	else if(code < 0x10000)
+	{
+		str += static_cast<char>(0xe0 | (code >> 12));
+		str += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+		str += static_cast<char>(0x80 | (code & 0x3f));
+	}
+	else
+	{
+		str += static_cast<char>(0xf0 | (code >> 18));
+		str += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+		str += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+		str += static_cast<char>(0x80 | (code & 0x3f));
+	}
+	return true;
+}
+
+bool Greenpak4JSONReader::ReadInt(int32_t& value)
+{
+	if(PeekType() != TYPE_NUMBER)
+	{
+		Error("expected an integer");
+		return false;
+	}
+
+	bool negative = false;
+	if(*m_pos == '-')
+	{
+		negative = true;
+		m_pos ++;
+	}
+
+	int64_t v = 0;
+	const char* digits = m_pos;
+	while( (m_pos < m_end) && (*m_pos >= '0') && (*m_pos <= '9') )
+	{
+		v = v*10 + (*m_pos - '0');
+		if(v > 0x80000000LL)
+		{
+			Error("integer out of range");
+			return false;
+		}
+		m_pos ++;
+	}
+	if(m_pos == digits)
+	{
+		Error("expected an integer");
+		return false;
+	}
+	if( (m_pos < m_end) && ( (*m_pos == '.') || (*m_pos == 'e') || (*m_pos == 'E') ) )
+	{
+		Error("expected an integer but got a real number");
+		return false;
+	}
+
+	if(negative)
+		v = -v;
+	if(v > 0x7fffffffLL)
+	{
+		Error("integer out of range");
+		return false;
+	}
+	value = static_cast<int32_t>(v);
+	return true;
+}
+
+/**
+	@brief Reads any value and converts it to a string.
+
+	Strings are returned unquoted, everything else is returned as its literal JSON text.
+ */
+bool Greenpak4JSONReader::ReadScalar(string& str)
+{
+	ValueType type = PeekType();
+	if(type == TYPE_STRING)
+		return ReadString(str);
+	if(type == TYPE_INVALID)
+	{
+		Error("expected a value");
+		return false;
+	}
+
+	const char* begin = m_pos;
+	if(!Skip())
+		return false;
+	str.assign(begin, m_pos - begin);
+	return true;
+}
+
+bool Greenpak4JSONReader::SkipNumber()
+{
+	if( (m_pos < m_end) && (*m_pos == '-') )
+		m_pos ++;
+	const char* digits = m_pos;
+	while(m_pos < m_end)
+	{
+		char c = *m_pos;
+		if( ( (c >= '0') && (c <= '9') ) || (c == '.') || (c == 'e') || (c == 'E') || (c == '+') || (c == '-') )
+			m_pos ++;
+		else
+			break;
+	}
+	if(m_pos == digits)
+	{
+		Error("malformed number");
+		return false;
+	}
+	return true;
+}
+
+bool Greenpak4JSONReader::SkipLiteral(const char* lit)
+{
+	size_t len = strlen(lit);
+	if( (static_cast<size_t>(m_end - m_pos) < len) || (0 != memcmp(m_pos, lit, len)) )
+	{
+		Error("invalid literal");
+		return false;
+	}
+	m_pos += len;
+	return true;
+}
+
+bool Greenpak4JSONReader::Skip()
+{
+	string dummy;
+	switch(PeekType())
+	{
+		case TYPE_OBJECT:
+			if(!BeginObject())
+				return false;
+			while(NextKey(dummy))
+			{
+				if(!Skip())
+					return false;
+			}
+			return !m_failed;
+
+		case TYPE_ARRAY:
+			if(!BeginArray())
+				return false;
+			while(NextElement())
+			{
+				if(!Skip())
+					return false;
+			}
+			return !m_failed;
+
+		case TYPE_STRING:
+			return ReadString(dummy);
+
+		case TYPE_NUMBER:
+			return SkipNumber();
+
+		case TYPE_BOOL:
+			return SkipLiteral( (*m_pos == 't') ? "true" : "false");
+
+		case TYPE_NULL:
+			return SkipLiteral("null");
+
+		default:
+			Error("expected a value");
+			return false;
+	}
+}
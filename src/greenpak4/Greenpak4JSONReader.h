@@ -0,0 +1,138 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4JSONReader_h
+#define Greenpak4JSONReader_h
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+	@brief Streaming (pull-style) JSON reader over a memory-mapped file
+
+	No document tree is ever built. The caller walks the file in order with BeginObject() / NextKey() and
+	BeginArray() / NextElement(), and must consume (or Skip()) exactly one value after every key or element.
+
+	Typical usage:
+
+		if(!reader.BeginObject())
+			return false;
+		string key;
+		while(reader.NextKey(key))
+		{
+			if(key == "foo")
+				reader.ReadString(foo);
+			else
+				reader.Skip();
+		}
+		if(reader.Failed())
+			return false;
+
+	All errors are reported via LogError() with the line and column of the offending token. Once an error occurs
+	every subsequent call fails, so callers only have to check Failed() at the end of a loop.
+ */
+class Greenpak4JSONReader
+{
+public:
+	Greenpak4JSONReader();
+	virtual ~Greenpak4JSONReader();
+
+	//Open a file (memory-mapped if possible)
+	bool Open(std::string fname);
+
+	//Parse an in-memory buffer (not copied, must outlive the reader)
+	void Open(const char* buf, size_t len);
+
+	enum ValueType
+	{
+		TYPE_OBJECT,
+		TYPE_ARRAY,
+		TYPE_STRING,
+		TYPE_NUMBER,
+		TYPE_BOOL,
+		TYPE_NULL,
+		TYPE_INVALID
+	};
+
+	//Type of the next value in the stream (does not consume anything)
+	ValueType PeekType();
+
+	//Structure navigation
+	bool BeginObject();
+	bool NextKey(std::string& key);
+	bool BeginArray();
+	bool NextElement();
+
+	//Scalar values
+	bool ReadString(std::string& str);
+	bool ReadInt(int32_t& value);
+	bool ReadScalar(std::string& str);
+
+	//Discard the next value (and all of its children)
+	bool Skip();
+
+	//True if there's nothing but whitespace left
+	bool AtEnd();
+
+	bool Failed()
+	{ return m_failed; }
+
+	//Report an error at the current position
+	void Error(const char* what);
+
+	//Raw bytes of the document (valid while the reader is open)
+	const char* GetBuffer()
+	{ return m_start; }
+
+	size_t GetLength()
+	{ return m_end - m_start; }
+
+protected:
+	void Close();
+
+	void SkipWhitespace();
+	bool Expect(char c, const char* what);
+	bool ReadStringBody(std::string& str);
+	bool ReadUnicodeEscape(std::string& str);
+	bool SkipNumber();
+	bool SkipLiteral(const char* lit);
+
+	///Start of the document
+	const char* m_start;
+
+	///One past the end of the document
+	const char* m_end;
+
+	///Read pointer
+	const char* m_pos;
+
+	///The file we're reading, if we opened one ourselves
+	Greenpak4MappedFile m_file;
+
+	/**
+		@brief One entry per currently open object/array.
+
+		True if no members have been read from it yet (so we know whether to expect a comma)
+	 */
+	std::vector<bool> m_first;
+
+	bool m_failed;
+};
+
+#endif
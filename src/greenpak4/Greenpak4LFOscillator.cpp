@@ -30,7 +30,7 @@ Greenpak4LFOscillator::Greenpak4LFOscillator(
 	unsigned int ibase,
 	unsigned int oword,
 	unsigned int cbase)
-	: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+	: Greenpak4BitstreamEntity(KIND_LFOSC, device, matrix, ibase, oword, cbase)
 	, m_powerDown(device->GetGround())	//default to auto powerdown only
 	, m_powerDownEn(false)
 	, m_autoPowerDown(true)
@@ -52,31 +52,34 @@ bool Greenpak4LFOscillator::IsConstantPowerDown()
 	return m_powerDown.IsPowerRail();
 }
 
-vector<string> Greenpak4LFOscillator::GetInputPorts() const
+static const Greenpak4EntityPort g_lfoscPorts[] =
 {
-	vector<string> r;
-	r.push_back("PWRDN");
-	return r;
-}
+	{ "PWRDN",   false },
+	{ "CLKOUT",  true },
+};
+static const Greenpak4PortTable g_lfoscPortTable = PORT_TABLE(g_lfoscPorts);
 
-void Greenpak4LFOscillator::SetInput(string port, Greenpak4EntityOutput src)
+const Greenpak4PortTable& Greenpak4LFOscillator::GetPortTable() const
 {
-	if(port == "PWRDN")
-		m_powerDown = src;
+	return g_lfoscPortTable;
+}
 
-	//ignore anything else silently (should not be possible since synthesis would error out)
+uint32_t Greenpak4LFOscillator::GetFabricPortMask() const
+{
+	return (1 << PORT_PWRDN) | (1 << PORT_CLKOUT);
 }
 
-vector<string> Greenpak4LFOscillator::GetOutputPorts() const
+void Greenpak4LFOscillator::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	vector<string> r;
-	r.push_back("CLKOUT");
-	return r;
+	if(port == PORT_PWRDN)
+		m_powerDown = src;
+
+	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-unsigned int Greenpak4LFOscillator::GetOutputNetNumber(string port)
+unsigned int Greenpak4LFOscillator::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "CLKOUT")
+	if(port == PORT_CLKOUT)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -93,7 +96,7 @@ string Greenpak4LFOscillator::GetDescription()
 bool Greenpak4LFOscillator::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -123,13 +126,33 @@ bool Greenpak4LFOscillator::CommitChanges()
 	return true;
 }
 
-bool Greenpak4LFOscillator::Load(bool* /*bitstream*/)
+bool Greenpak4LFOscillator::Load(const Greenpak4Bitstream& bitstream)
 {
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	//Power-down input is only written if enabled
+	m_powerDownEn = bitstream[m_configBase + 0];
+	if(m_powerDownEn)
+	{
+		if(!ReadMatrixSelector(bitstream, m_inputBaseWord, m_powerDown))
+			return false;
+	}
+	else
+		m_powerDown = m_device->GetGround();
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Configuration
+
+	m_autoPowerDown = !bitstream[m_configBase + 1];
+
+	static const int out_divs[] = { 1, 2, 4, 16 };
+	m_outDiv = out_divs[bitstream.GetField(m_configBase + 2, 2)];
+
+	return true;
 }
 
-bool Greenpak4LFOscillator::Save(bool* bitstream)
+bool Greenpak4LFOscillator::Save(Greenpak4Bitstream& bitstream)
 {
 	//Optimize PWRDN = 1'b0 and PWRDN_EN = 1 to PWRDN = dontcare and PWRDN_EN = 0
 	bool real_pwrdn_en = m_powerDownEn;
@@ -185,3 +208,40 @@ bool Greenpak4LFOscillator::Save(bool* bitstream)
 
 	return true;
 }
+
+void Greenpak4LFOscillator::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	//All of the oscillators share one power-down input
+	RegisterMatrixSelector(map, "PWRDN", m_inputBaseWord, false, true);
+
+	map.AddField(this, "PWRDN_EN", m_configBase + 0, 1);
+	map.AddField(this, "AUTO_PWRDN", m_configBase + 1, 1);
+	map.AddField(this, "OUT_DIV", m_configBase + 2, 2);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4LFOscillator::GetInput(string port)
+{
+	if(port == "PWRDN")
+		return m_powerDown;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4LFOscillator::GetPrimitiveName()
+{
+	return "GP_LFOSC";
+}
+
+map<string, string> Greenpak4LFOscillator::GetParameters()
+{
+	map<string, string> params;
+	char buf[32];
+	params["PWRDN_EN"] = m_powerDownEn ? "1" : "0";
+	params["AUTO_PWRDN"] = m_autoPowerDown ? "1" : "0";
+	snprintf(buf, sizeof(buf), "%d", m_outDiv);
+	params["OUT_DIV"] = buf;
+	return params;
+}
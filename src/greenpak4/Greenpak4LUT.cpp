@@ -32,7 +32,7 @@ Greenpak4LUT::Greenpak4LUT(
 	unsigned int oword,
 	unsigned int cbase,
 	unsigned int order)
-	: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+	: Greenpak4BitstreamEntity(KIND_LUT, device, matrix, ibase, oword, cbase)
 	, m_lutnum(lutnum)
 	, m_order(order)
 {
@@ -51,11 +51,20 @@ Greenpak4LUT::~Greenpak4LUT()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Serialization of the truth table
 
-bool Greenpak4LUT::Load(bool* bitstream)
+bool Greenpak4LUT::Load(const Greenpak4Bitstream& bitstream)
 {
-	//TODO: Do our inputs
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	for(unsigned int i=0; i<m_order; i++)
+	{
+		if(!ReadMatrixSelector(bitstream, m_inputBaseWord + i, m_inputs[i]))
+			return false;
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// LUT CONTENTS
 
-	//Do the LUT
 	unsigned int nmax = 1 << m_order;
 	for(unsigned int i=0; i<nmax; i++)
 		m_truthtable[i] = bitstream[m_configBase + i];
@@ -63,7 +72,7 @@ bool Greenpak4LUT::Load(bool* bitstream)
 	return true;
 }
 
-bool Greenpak4LUT::Save(bool* bitstream)
+bool Greenpak4LUT::Save(Greenpak4Bitstream& bitstream)
 {
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// INPUT BUS
@@ -84,18 +93,26 @@ bool Greenpak4LUT::Save(bool* bitstream)
 	return true;
 }
 
+void Greenpak4LUT::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	for(unsigned int i=0; i<m_order; i++)
+		RegisterMatrixSelector(map, "IN" + to_string(i), m_inputBaseWord + i);
+
+	map.AddField(this, "INIT", m_configBase, 1 << m_order);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Accessors
 
 bool Greenpak4LUT::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
 	//If the cell is an inverter, we need special processing to up-map
-	if(ncell->m_type == "GP_INV")
+	if(ncell->IsType(GP_PRIM_INV))
 	{
 		//Set up the truth table
 		m_truthtable[0] = true;
@@ -110,77 +127,73 @@ bool Greenpak4LUT::CommitChanges()
 	//Not an inverter, treat it as a LUT
 	else
 	{
-		for(auto x : ncell->m_parameters)
+		for(auto& x : ncell->m_parameters)
 		{
-			//LUT initialization value, as decimal
-			if(x.first == "INIT")
-			{
-				//convert to bit array format for the bitstream library
-				uint32_t truth_table = atoi(x.second.c_str());
-				unsigned int nbits = 1 << m_order;
-				for(unsigned int i=0; i<nbits; i++)
-				{
-					bool a3 = (i & 8) ? true : false;
-					bool a2 = (i & 4) ? true : false;
-					bool a1 = (i & 2) ? true : false;
-					bool a0 = (i & 1) ? true : false;
-					m_truthtable[a3*8 | a2*4 | a1*2 | a0] = (truth_table & (1 << i)) ? true : false;
-				}
-			}
-
-			else
+			const string& name = ncell->m_parameters.GetName(x.first);
+			if(name != "INIT")
 			{
 				LogWarning("Cell\"%s\" has unrecognized parameter %s, ignoring\n",
-					ncell->m_name.c_str(), x.first.c_str());
+					ncell->m_name.c_str(), name.c_str());
 			}
 		}
+
+		//The netlist edges were already renamed to our physical inputs when the graph was built,
+		//so all that's left is the truth table to match
+		InputMap map;
+		if(!MapCellInputs(ncell, map))
+			return false;
+		unsigned int nbits = 1 << m_order;
+		for(unsigned int i=0; i<nbits; i++)
+			m_truthtable[i] = (i < (1u << map.m_count)) && ( (map.m_table >> i) & 1 );
 	}
 
 	return true;
 }
 
-vector<string> Greenpak4LUT::GetInputPorts() const
+static const Greenpak4EntityPort g_lutPorts[] =
 {
-	vector<string> r;
-	switch(m_order)
-	{
-		case 4: r.push_back("IN3");
-		case 3: r.push_back("IN2");
-		case 2: r.push_back("IN1");
-		case 1: r.push_back("IN0");
-		default:
-			r.push_back("IN");	//used for up-mapping GP_INV to GP_LUTx
-			break;
-	}
-	return r;
+	{ "IN0",  false },
+	{ "IN1",  false },
+	{ "IN2",  false },
+	{ "IN3",  false },
+	{ "IN",   false },
+	{ "OUT",  true },
+};
+static const Greenpak4PortTable g_lutPortTable = PORT_TABLE(g_lutPorts);
+
+const Greenpak4PortTable& Greenpak4LUT::GetPortTable() const
+{
+	return g_lutPortTable;
 }
 
-void Greenpak4LUT::SetInput(string port, Greenpak4EntityOutput src)
+uint32_t Greenpak4LUT::GetFabricPortMask() const
+{
+	//IN is used for up-mapping GP_INV to GP_LUTx
+	uint32_t mask = (1 << PORT_IN) | (1 << PORT_OUT);
+	for(unsigned int i=0; i<m_order; i++)
+		mask |= (1 << (PORT_IN0 + i));
+	return mask;
+}
+
+void Greenpak4LUT::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
 	//used for up-mapping GP_INV to GP_LUTx
-	if( (port == "IN0") || (port == "IN") )
+	if( (port == PORT_IN0) || (port == PORT_IN) )
 		m_inputs[0] = src;
 
-	else if(port == "IN1")
+	else if(port == PORT_IN1)
 		m_inputs[1] = src;
-	else if(port == "IN2")
+	else if(port == PORT_IN2)
 		m_inputs[2] = src;
-	else if(port == "IN3")
+	else if(port == PORT_IN3)
 		m_inputs[3] = src;
 
 	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-vector<string> Greenpak4LUT::GetOutputPorts() const
-{
-	vector<string> r;
-	r.push_back("OUT");
-	return r;
-}
-
-unsigned int Greenpak4LUT::GetOutputNetNumber(string port)
+unsigned int Greenpak4LUT::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "OUT")
+	if(port == PORT_OUT)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -192,3 +205,158 @@ string Greenpak4LUT::GetDescription()
 	snprintf(buf, sizeof(buf), "LUT%u_%u", m_order, m_lutnum);
 	return string(buf);
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Input permutation
+
+/**
+	@brief Truth table with input a forced to the same value as input b
+ */
+static uint32_t TieInputs(uint32_t table, unsigned int nbits, unsigned int a, unsigned int b)
+{
+	uint32_t ret = 0;
+	for(unsigned int i=0; i<nbits; i++)
+	{
+		unsigned int j = (i & ~(1 << a)) | ( ((i >> b) & 1) << a );
+		if( (table >> j) & 1 )
+			ret |= (1 << i);
+	}
+	return ret;
+}
+
+/**
+	@brief Returns true if the truth table depends on the given input
+ */
+static bool DependsOn(uint32_t table, unsigned int nbits, unsigned int input)
+{
+	for(unsigned int i=0; i<nbits; i++)
+	{
+		if( ((table >> i) & 1) != ((table >> (i ^ (1 << input))) & 1) )
+			return true;
+	}
+	return false;
+}
+
+/**
+	@brief Decides which physical input each input of a LUT cell goes to
+
+	Inputs the function doesn't depend on are dropped, as are inputs on the same net as a lower numbered one (the
+	truth table is folded so the survivor stands in for both). What's left is packed onto the lowest physical inputs
+	in order, and the truth table permuted to match, so a LUT4 cell that only really uses three inputs fits a LUT3.
+
+	The result only depends on the cell, so graph building (which names the edges after the physical inputs) and
+	CommitChanges() (which writes the truth table) agree without passing anything around.
+
+	@return false if the cell isn't a LUT
+ */
+bool Greenpak4LUT::MapCellInputs(Greenpak4NetlistCell* cell, InputMap& map)
+{
+	unsigned int order;
+	if(cell->IsType(GP_PRIM_2LUT))
+		order = 2;
+	else if(cell->IsType(GP_PRIM_3LUT))
+		order = 3;
+	else if(cell->IsType(GP_PRIM_4LUT))
+		order = 4;
+	else
+	{
+		LogError("Cell \"%s\" of type %s is not a LUT\n", cell->m_name.c_str(), cell->m_type.c_str());
+		return false;
+	}
+
+	//INIT is stored as decimal (see the netlist parser)
+	unsigned int nbits = 1 << order;
+	uint32_t table = 0;
+	auto it = cell->m_parameters.find("INIT");
+	if(it != cell->m_parameters.end())
+		table = atoi(it->second.c_str());
+	table &= (1u << nbits) - 1;
+
+	//Fold inputs that share a net onto the first one
+	Greenpak4NetlistNode* nets[4] = {NULL, NULL, NULL, NULL};
+	for(unsigned int i=0; i<order; i++)
+	{
+		auto c = cell->m_connections.find("IN" + to_string(i));
+		if( (c == cell->m_connections.end()) || (c->second.size() != 1) )
+			continue;
+		nets[i] = c->second[0];
+
+		for(unsigned int j=0; j<i; j++)
+		{
+			if(nets[j] == nets[i])
+			{
+				table = TieInputs(table, nbits, i, j);
+				break;
+			}
+		}
+	}
+
+	//Pack the inputs that still matter
+	unsigned int logical[4];
+	map.m_count = 0;
+	for(unsigned int i=0; i<4; i++)
+	{
+		map.m_pins[i] = PIN_DROPPED;
+		if( (i < order) && DependsOn(table, nbits, i) )
+		{
+			map.m_pins[i] = map.m_count;
+			logical[map.m_count] = i;
+			map.m_count ++;
+		}
+	}
+
+	//Permute the truth table. Dropped inputs don't matter, so read them as zero
+	map.m_table = 0;
+	for(unsigned int p=0; p<(1u << map.m_count); p++)
+	{
+		unsigned int i = 0;
+		for(unsigned int k=0; k<map.m_count; k++)
+			i |= ( (p >> k) & 1 ) << logical[k];
+		if( (table >> i) & 1 )
+			map.m_table |= (1 << p);
+	}
+
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4LUT::GetInput(string port)
+{
+	if( (port == "IN0") || (port == "IN") )
+		return m_inputs[0];
+	else if(port == "IN1")
+		return m_inputs[1];
+	else if(port == "IN2")
+		return m_inputs[2];
+	else if(port == "IN3")
+		return m_inputs[3];
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4LUT::GetPrimitiveName()
+{
+	char buf[16];
+	snprintf(buf, sizeof(buf), "GP_%uLUT", m_order);
+	return string(buf);
+}
+
+map<string, string> Greenpak4LUT::GetParameters()
+{
+	//Same bit ordering as the INIT parameter (see CommitChanges)
+	unsigned int nbits = 1 << m_order;
+	uint32_t truth_table = 0;
+	for(unsigned int i=0; i<nbits; i++)
+	{
+		if(m_truthtable[i])
+			truth_table |= (1 << i);
+	}
+
+	map<string, string> params;
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%u'h%x", nbits, truth_table);
+	params["INIT"] = buf;
+	return params;
+}
@@ -26,6 +26,17 @@ class Greenpak4LUT : public Greenpak4BitstreamEntity
 {
 public:
 
+	///IDs of our ports (indexes into our port table)
+	enum Port
+	{
+		PORT_IN0,
+		PORT_IN1,
+		PORT_IN2,
+		PORT_IN3,
+		PORT_IN,
+		PORT_OUT
+	};
+
 	//Construction / destruction
 	Greenpak4LUT(
 		Greenpak4Device* device,
@@ -38,8 +49,9 @@ public:
 	virtual ~Greenpak4LUT();
 
 	//Serialization
-	virtual bool Load(bool* bitstream);
-	virtual bool Save(bool* bitstream);
+	virtual bool Load(const Greenpak4Bitstream& bitstream);
+	virtual bool Save(Greenpak4Bitstream& bitstream);
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map);
 
 	unsigned int GetOrder()
 	{ return m_order; }
@@ -49,14 +61,40 @@ public:
 
 	virtual std::string GetDescription();
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
-	virtual unsigned int GetOutputNetNumber(std::string port);
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
+	///Marks a cell input that isn't connected to any physical input
+	static const int PIN_DROPPED = -1;
+
+	/**
+		@brief Assignment of the inputs of a LUT cell to the physical inputs of the site it's placed at
+
+		The inputs of a LUT are interchangeable as long as the truth table is permuted to match.
+	 */
+	struct InputMap
+	{
+		///Physical input for each input of the cell, or PIN_DROPPED
+		int m_pins[4];
+
+		///Number of physical inputs used (the smallest LUT the cell fits in has max(2, m_count) inputs)
+		unsigned int m_count;
+
+		///Truth table over the physical inputs, same bit ordering as INIT
+		uint32_t m_table;
+	};
+
+	static bool MapCellInputs(Greenpak4NetlistCell* cell, InputMap& map);
+
 protected:
 
 	///Index of our LUT
@@ -0,0 +1,153 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include <log.h>
+#include <Greenpak4.h>
+
+#include <stdio.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+Greenpak4MappedFile::Greenpak4MappedFile()
+	: m_mapping(NULL)
+	, m_mappingLen(0)
+	, m_mapped(false)
+{
+}
+
+Greenpak4MappedFile::~Greenpak4MappedFile()
+{
+	Close();
+}
+
+void Greenpak4MappedFile::Close()
+{
+	if(m_mapping != NULL)
+	{
+#ifndef _WIN32
+		if(m_mapped)
+			munmap(m_mapping, m_mappingLen);
+		else
+#endif
+			delete[] static_cast<char*>(m_mapping);
+	}
+
+	m_mapping = NULL;
+	m_mappingLen = 0;
+	m_mapped = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Mapping
+
+bool Greenpak4MappedFile::Exists(string fname)
+{
+	FILE* fp = fopen(fname.c_str(), "rb");
+	if(fp == NULL)
+		return false;
+	fclose(fp);
+	return true;
+}
+
+bool Greenpak4MappedFile::Open(string fname, const char* what)
+{
+	Close();
+
+#ifndef _WIN32
+	int fd = open(fname.c_str(), O_RDONLY);
+	if(fd < 0)
+	{
+		LogError("Failed to open %s %s\n", what, fname.c_str());
+		return false;
+	}
+	struct stat st;
+	if(0 != fstat(fd, &st))
+	{
+		LogError("Failed to stat %s %s\n", what, fname.c_str());
+		close(fd);
+		return false;
+	}
+	size_t len = st.st_size;
+
+	//mmap() refuses zero-length mappings, leave the buffer empty and let the caller complain
+	if(len == 0)
+	{
+		close(fd);
+		return true;
+	}
+
+	void* map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(map == MAP_FAILED)
+	{
+		LogError("Failed to map %s %s\n", what, fname.c_str());
+		return false;
+	}
+
+	//Everything we read is parsed front to back
+	madvise(map, len, MADV_SEQUENTIAL);
+
+	m_mapping = map;
+	m_mappingLen = len;
+	m_mapped = true;
+#else
+	//No mmap, fall back to reading the whole thing
+	FILE* fp = fopen(fname.c_str(), "rb");
+	if(fp == NULL)
+	{
+		LogError("Failed to open %s %s\n", what, fname.c_str());
+		return false;
+	}
+	fseek(fp, 0, SEEK_END);
+	long flen = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if(flen < 0)
+	{
+		LogError("Failed to get the size of %s %s\n", what, fname.c_str());
+		fclose(fp);
+		return false;
+	}
+	size_t len = flen;
+	char* buf = new char[len + 1];
+	if(len != fread(buf, 1, len, fp))
+	{
+		LogError("Failed to read contents of %s %s\n", what, fname.c_str());
+		delete[] buf;
+		fclose(fp);
+		return false;
+	}
+	fclose(fp);
+
+	m_mapping = buf;
+	m_mappingLen = len;
+	m_mapped = false;
+#endif
+
+	return true;
+}
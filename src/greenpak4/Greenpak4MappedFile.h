@@ -0,0 +1,58 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#ifndef Greenpak4MappedFile_h
+#define Greenpak4MappedFile_h
+
+#include <string>
+#include <stddef.h>
+
+/**
+	@brief A read-only view of a whole file
+
+	Memory-mapped where the platform supports it (so the only memory used is the page cache), read into a heap
+	buffer otherwise. Zero-length files open successfully with a NULL, zero-length buffer.
+ */
+class Greenpak4MappedFile
+{
+public:
+	Greenpak4MappedFile();
+	virtual ~Greenpak4MappedFile();
+
+	//Map a file. "what" describes the file in error messages.
+	bool Open(std::string fname, const char* what = "file");
+	void Close();
+
+	//Check if a file exists and is readable, without complaining if it doesn't
+	static bool Exists(std::string fname);
+
+	const char* GetData()
+	{ return static_cast<const char*>(m_mapping); }
+
+	size_t GetLength()
+	{ return m_mappingLen; }
+
+protected:
+	///Mapping (or heap buffer) to release on close
+	void* m_mapping;
+	size_t m_mappingLen;
+	bool m_mapped;
+};
+
+#endif
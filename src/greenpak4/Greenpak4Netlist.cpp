@@ -28,80 +28,124 @@ Greenpak4NetlistEntity::~Greenpak4NetlistEntity()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
-Greenpak4Netlist::Greenpak4Netlist(std::string fname)
+/**
+	@brief Loads a netlist
+
+	@param fname		Yosys JSON netlist, or a binary netlist image
+	@param cachefname	If not empty, a netlist image to use as a cache. It's loaded instead of the JSON if it was
+						built from an identical file, and (re)written otherwise.
+ */
+Greenpak4Netlist::Greenpak4Netlist(std::string fname, std::string cachefname)
 	: m_topModule(NULL)
 	, m_parseOK(true)
 {
-	//Read the netlist
-	FILE* fp = fopen(fname.c_str(), "rb");
-	if(fp == NULL)
+	//Map the netlist and parse it in a single pass, without building a document tree
+	Greenpak4JSONReader reader;
+	if(!reader.Open(fname))
 	{
-		LogError("Failed to open netlist file %s\n", fname.c_str());
 		m_parseOK = false;
 		return;
 	}
-	if(0 != fseek(fp, 0, SEEK_END))
-	{
-		LogError("Failed to seek to end of netlist file %s\n", fname.c_str());
-		m_parseOK = false;
-		fclose(fp);
-		return;
-	}
-	size_t len = ftell(fp);
-	if(0 != fseek(fp, 0, SEEK_SET))
+	const char* buf = reader.GetBuffer();
+	size_t len = reader.GetLength();
+
+	//Already a binary image? Load it as is
+	if(Greenpak4NetlistImageReader::IsImage(buf, len))
 	{
-		LogError("Failed to seek to start of netlist file %s\n", fname.c_str());
-		m_parseOK = false;
-		fclose(fp);
+		Greenpak4NetlistImageReader image;
+		if(!image.Open(buf, len) || !LoadImage(image))
+		{
+			LogError("Couldn't load netlist image %s\n", fname.c_str());
+			m_parseOK = false;
+		}
 		return;
 	}
-	char* json_string = new char[len + 1];
-	json_string[len] = '\0';
-	if(len != fread(json_string, 1, len, fp))
+
+	//Use the cached image if it was built from this exact file
+	uint64_t hash = 0;
+	if(!cachefname.empty())
 	{
-		LogError("Failed read contents of netlist file %s\n", fname.c_str());
-		m_parseOK = false;
-		delete[] json_string;
-		fclose(fp);
-		return;
+		hash = Greenpak4NetlistImageReader::HashSource(buf, len);
+
+		Greenpak4MappedFile cache;
+		Greenpak4NetlistImageReader image;
+		if(Greenpak4MappedFile::Exists(cachefname) && cache.Open(cachefname, "netlist image"))
+		{
+			if(image.Open(cache.GetData(), cache.GetLength()) &&
+				(image.GetSourceHash() == hash) && (image.GetSourceLength() == len) )
+			{
+				if(LoadImage(image))
+				{
+					LogNotice("Loaded cached netlist image \"%s\"\n", cachefname.c_str());
+					return;
+				}
+
+				//Broken, start over from the JSON
+				Reset();
+			}
+
+			LogNotice("Netlist image \"%s\" is out of date, rebuilding\n", cachefname.c_str());
+		}
 	}
-	fclose(fp);
 
-	//Parse the JSON
-	json_tokener* tok = json_tokener_new();
-	if(!tok)
+	Load(reader);
+
+	if(m_parseOK && !cachefname.empty())
 	{
-		LogError("Failed to create JSON tokenizer object\n");
-		m_parseOK = false;
-		delete[] json_string;
-		return;
+		if(SaveImage(cachefname, hash, len))
+			LogVerbose("Wrote netlist image \"%s\"\n", cachefname.c_str());
 	}
-	json_tokener_error err;
-	json_object* object = json_tokener_parse_verbose(json_string, &err);
-	if(NULL == object)
+}
+
+/**
+	@brief Loads a netlist from memory rather than from a file
+
+	@param buf	Yosys JSON, or a binary netlist image. Only used during the constructor, nothing points into it later.
+	@param len	Length of buf in bytes
+ */
+Greenpak4Netlist::Greenpak4Netlist(const char* buf, size_t len)
+	: m_topModule(NULL)
+	, m_parseOK(true)
+{
+	if(Greenpak4NetlistImageReader::IsImage(buf, len))
 	{
-		const char* desc = json_tokener_error_desc(err);
-		LogError("JSON parsing failed (err = %s)\n", desc);
-		m_parseOK = false;
-		delete[] json_string;
+		Greenpak4NetlistImageReader image;
+		if(!image.Open(buf, len) || !LoadImage(image))
+		{
+			LogError("Couldn't load netlist image from memory\n");
+			m_parseOK = false;
+		}
 		return;
 	}
 
-	//Read stuff from it
-	Load(object);
-
-	//Clean up
-	json_object_put(object);
-	json_tokener_free(tok);
-	delete[] json_string;
+	Greenpak4JSONReader reader;
+	reader.Open(buf, len);
+	Load(reader);
 }
 
 Greenpak4Netlist::~Greenpak4Netlist()
+{
+	Reset();
+}
+
+/**
+	@brief Throw away everything we've loaded
+ */
+void Greenpak4Netlist::Reset()
 {
 	//Delete modules
 	for(auto x : m_modules)
 		delete x.second;
 	m_modules.clear();
+
+	//then everything they pointed to
+	m_nodes.clear();
+	m_arena.Clear();
+	m_strings.Clear();
+
+	m_topModule = NULL;
+	m_creator = "";
+	m_parseOK = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -112,34 +156,35 @@ Greenpak4Netlist::~Greenpak4Netlist()
 
 	Should only have creator and modules
  */
-void Greenpak4Netlist::Load(json_object* object)
+void Greenpak4Netlist::Load(Greenpak4JSONReader& reader)
 {
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
+	if(!reader.BeginObject())
 	{
-		//See what we got
-		string name = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+		m_parseOK = false;
+		return;
+	}
 
+	string name;
+	while(reader.NextKey(name))
+	{
 		//Creator of the file (expecting a string)
 		if(name == "creator")
 		{
-			if(!json_object_is_type(child, json_type_string))
+			if(reader.PeekType() != Greenpak4JSONReader::TYPE_STRING)
 			{
 				LogError("netlist creator should be of type string but isn't\n");
 				m_parseOK = false;
 				return;
 			}
-			m_creator = json_object_get_string(child);
+			if(!reader.ReadString(m_creator))
+				break;
 			LogNotice("Netlist creator: %s\n", m_creator.c_str());
 		}
 
 		//Modules in the file (expecting an object)
 		else if(name == "modules")
 		{
-			if(!json_object_is_type(child, json_type_object))
+			if(reader.PeekType() != Greenpak4JSONReader::TYPE_OBJECT)
 			{
 				LogError("netlist modules should be of type object but isn't\n");
 				m_parseOK = false;
@@ -147,7 +192,9 @@ void Greenpak4Netlist::Load(json_object* object)
 			}
 
 			//Load them
-			LoadModules(child);
+			LoadModules(reader);
+			if(!m_parseOK)
+				return;
 		}
 
 		//Something bad
@@ -159,7 +206,23 @@ void Greenpak4Netlist::Load(json_object* object)
 		}
 	}
 
-	IndexNets(true);
+	if(reader.Failed() || !reader.AtEnd())
+	{
+		reader.Error("trailing garbage after top-level object");
+		m_parseOK = false;
+		return;
+	}
+
+	//Verify we got the top-level module we expected
+	if(m_topModule == NULL)
+	{
+		LogError("Unable to find a top-level module in netlist\n");
+		m_parseOK = false;
+		return;
+	}
+
+	if(!IndexNets(true))
+		m_parseOK = false;
 }
 
 /**
@@ -174,24 +237,36 @@ void Greenpak4Netlist::ClearIndexes()
 	}
 
 	m_nodes.clear();
+
+	//Nets with no name aren't in m_nodes, but cells still connect to them
+	if(m_topModule == NULL)
+		return;
+	for(auto it = m_topModule->node_begin(); it != m_topModule->node_end(); it ++)
+	{
+		it->second->m_nodeports.clear();
+		it->second->m_ports.clear();
+	}
 }
 
 /**
 	@brief Force a re-index after changing the netlist (by PAR-level optimizations etc)
  */
-void Greenpak4Netlist::Reindex(bool verbose)
+bool Greenpak4Netlist::Reindex(bool verbose)
 {
 	ClearIndexes();
-	IndexNets(verbose);
+	return IndexNets(verbose);
 }
 
 /**
 	@brief Index the nets so that each net has a list of cell ports it connects to.
 
 	Has to be done as a second pass because there may be cycles in the netlist preventing us from resolving names
-	as we parse the JSON
+	as we parse the JSON.
+
+	This is also where port names get resolved against the primitive library (cell types were resolved at load
+	time), once per cell port, so later passes can look up port directions without any string comparisons.
  */
-void Greenpak4Netlist::IndexNets(bool verbose)
+bool Greenpak4Netlist::IndexNets(bool verbose)
 {
 	if(verbose)
 		LogNotice("Indexing...\n");
@@ -203,7 +278,7 @@ void Greenpak4Netlist::IndexNets(bool verbose)
 	{
 		Greenpak4NetlistPort* port = it->second;
 		if(verbose)
-			LogDebug("Port %s connects to:\n", it->first.c_str());
+			LogDebug("Port %s connects to:\n", port->m_name.c_str());
 		LogIndenter li;
 
 		for(unsigned int i=0; i<port->m_nodes.size(); i++)
@@ -221,15 +296,32 @@ void Greenpak4Netlist::IndexNets(bool verbose)
 	{
 		Greenpak4NetlistCell* cell = it->second;
 		if(verbose)
-			LogDebug("Cell %s connects to:\n", it->first.c_str());
+			LogDebug("Cell %s connects to:\n", cell->m_name.c_str());
 		LogIndenter li;
-		for(auto jt : cell->m_connections)
+
+		for(auto& jt : cell->m_connections)
 		{
-			string cellname = jt.first;
-			auto net = jt.second;
+			const string& cellname = cell->m_connections.GetName(jt.first);
+			auto& net = jt.second;
 			bool vector = false;
 			if(net.size() != 1)
 				vector = true;
+
+			const Greenpak4PrimitivePort* pport = NULL;
+			if(cell->m_primitive)
+			{
+				pport = cell->m_primitive->GetPort(cellname);
+				if(pport == NULL)
+				{
+					LogError(
+						"Cell \"%s\" of type %s has no port named \"%s\"\n",
+						cell->m_name.c_str(),
+						cell->m_type.c_str(),
+						cellname.c_str());
+					return false;
+				}
+			}
+
 			for(unsigned int i=0; i<net.size(); i++)
 			{
 				Greenpak4NetlistNode* node = net[i];
@@ -240,7 +332,7 @@ void Greenpak4Netlist::IndexNets(bool verbose)
 					else
 						LogDebug("%s: net %s\n", cellname.c_str(), node->m_name.c_str());
 				}
-				node->m_nodeports.push_back(Greenpak4NetlistNodePoint(cell, cellname, i, vector));
+				node->m_nodeports.push_back(Greenpak4NetlistNodePoint(cell, cellname, i, vector, pport));
 			}
 		}
 	}
@@ -266,6 +358,8 @@ void Greenpak4Netlist::IndexNets(bool verbose)
 				LogDebug("cell %s port %s\n", c.m_cell->m_name.c_str(), c.m_portname.c_str());
 		}
 	}
+
+	return true;
 }
 
 /**
@@ -273,32 +367,39 @@ void Greenpak4Netlist::IndexNets(bool verbose)
 
 	Loads all of the modules in the netlist
  */
-void Greenpak4Netlist::LoadModules(json_object* object)
+void Greenpak4Netlist::LoadModules(Greenpak4JSONReader& reader)
 {
 	LogNotice("\nLoading modules...\n");
 	LogIndenter li;
 
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
+	if(!reader.BeginObject())
 	{
-		//See what we got
-		string name = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+		m_parseOK = false;
+		return;
+	}
 
+	string name;
+	while(reader.NextKey(name))
+	{
 		//Verify it's an object
-		if(!json_object_is_type(child, json_type_object))
+		if(reader.PeekType() != Greenpak4JSONReader::TYPE_OBJECT)
 		{
 			LogError("netlist module entry should be of type object but isn't\n");
 			m_parseOK = false;
 			return;
 		}
 
-		//TODO: If the child object is a standard library cell, don't bother parsing it?
+		//Standard library cells are blackboxes and we already know their ports, don't bother parsing them
+		if(Greenpak4LookupPrimitive(name) != NULL)
+		{
+			LogDebug("%s (library cell, skipped)\n", name.c_str());
+			if(!reader.Skip())
+				break;
+			continue;
+		}
 
 		//Load it
-		Greenpak4NetlistModule *module = new Greenpak4NetlistModule(this, name, child);
+		Greenpak4NetlistModule *module = new Greenpak4NetlistModule(this, name, reader);
 		if(!module->Validate())
 		{
 			delete module;
@@ -308,7 +409,7 @@ void Greenpak4Netlist::LoadModules(json_object* object)
 		m_modules[name] = module;
 
 		//Did we get a top-level module?
-		if(module->m_attributes.find("top") != module->m_attributes.end())
+		if(module->m_attributes.contains(GP_SYM_TOP))
 		{
 			if(m_topModule)
 			{
@@ -320,11 +421,100 @@ void Greenpak4Netlist::LoadModules(json_object* object)
 		}
 	}
 
-	//Verify we got the top-level module we expected
-	if(m_topModule == NULL)
-	{
-		LogError("Unable to find a top-level module in netlist\n");
+	if(reader.Failed())
 		m_parseOK = false;
-		return;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Binary images
+
+/**
+	@brief Writes the netlist, including net indexes, to a binary image
+
+	Netlist layout (after the header and string pool):
+		symbol table
+		creator
+		module count, then per module: name, module data (see Greenpak4NetlistModule::SaveImage())
+		index of the top-level module
+ */
+bool Greenpak4Netlist::SaveImage(std::string fname, uint64_t sourceHash, uint64_t sourceLength)
+{
+	Greenpak4NetlistImageWriter writer;
+	writer.WriteSymbolTable(&m_strings);
+	writer.WriteString(m_creator);
+
+	uint32_t top = 0;
+	uint32_t index = 0;
+	writer.Write(m_modules.size());
+	for(auto it : m_modules)
+	{
+		if(it.second == m_topModule)
+			top = index;
+		index ++;
+		writer.WriteString(it.first);
+		it.second->SaveImage(writer, it.second == m_topModule);
+	}
+	writer.Write(top);
+
+	return writer.Save(fname, sourceHash, sourceLength);
+}
+
+/**
+	@brief Loads a netlist image. The indexes are stored in the image, so there's no need to call IndexNets().
+ */
+bool Greenpak4Netlist::LoadImage(Greenpak4NetlistImageReader& reader)
+{
+	LogNotice("Loading netlist image...\n");
+	LogIndenter li;
+
+	if(!reader.ReadSymbolTable(&m_strings))
+		return false;
+	if(!reader.ReadString(m_creator))
+		return false;
+	LogNotice("Netlist creator: %s\n", m_creator.c_str());
+
+	uint32_t count;
+	if(!reader.Read(count))
+		return false;
+	vector<Greenpak4NetlistModule*> modules;
+	for(uint32_t i=0; i<count; i++)
+	{
+		string name;
+		if(!reader.ReadString(name))
+			return false;
+		if(m_modules.find(name) != m_modules.end())
+		{
+			reader.Error("duplicate module name");
+			return false;
+		}
+
+		Greenpak4NetlistModule* module = new Greenpak4NetlistModule(this, name, reader);
+		if(!module->Validate())
+		{
+			delete module;
+			return false;
+		}
+		m_modules[name] = module;
+		modules.push_back(module);
+	}
+
+	uint32_t top;
+	if(!reader.ReadIndex(top, modules.size()))
+		return false;
+	m_topModule = modules[top];
+
+	if(!reader.AtEnd())
+	{
+		reader.Error("trailing data after netlist");
+		return false;
+	}
+
+	//Make a set of the nodes, same as IndexNets() does
+	for(auto it = m_topModule->net_begin(); it != m_topModule->net_end(); it ++)
+	{
+		if(it->second != NULL)
+			m_nodes.insert(it->second);
 	}
+
+	return true;
 }
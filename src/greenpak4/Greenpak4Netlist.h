@@ -23,17 +23,21 @@
 #include <map>
 #include <set>
 
-#include <json-c/json.h>
-
+#include "Greenpak4StringTable.h"
+#include "Greenpak4NetlistArena.h"
 #include "Greenpak4NetlistModule.h"
 
+class Greenpak4JSONReader;
+class Greenpak4NetlistImageReader;
+
 /**
 	@brief An UNPLACED netlist for a Greenpak4 device
  */
 class Greenpak4Netlist
 {
 public:
-	Greenpak4Netlist(std::string fname);
+	Greenpak4Netlist(std::string fname, std::string cachefname = "");
+	Greenpak4Netlist(const char* buf, size_t len);
 	virtual ~Greenpak4Netlist();
 
 	Greenpak4NetlistModule* GetTopModule()
@@ -47,10 +51,26 @@ public:
 	nodeset::iterator nodeend()
 	{ return m_nodes.end(); }
 
+	//Returns NULL for primitive cells (see Greenpak4NetlistCell::m_primitive instead)
 	Greenpak4NetlistModule* GetModule(std::string name)
-	{ return m_modules[name]; }
+	{
+		auto it = m_modules.find(name);
+		if(it == m_modules.end())
+			return NULL;
+		return it->second;
+	}
+
+	bool Reindex(bool verbose = true);
+
+	//Write a binary image of the netlist (see Greenpak4NetlistImage.h)
+	bool SaveImage(std::string fname, uint64_t sourceHash, uint64_t sourceLength);
 
-	void Reindex(bool verbose = true);
+	Greenpak4StringTable* GetStringTable()
+	{ return &m_strings; }
+
+	//Owner of every cell, node and port in the netlist
+	Greenpak4NetlistArena* GetArena()
+	{ return &m_arena; }
 
 	//Returns true if we're good, false if parsing failed for some reason
 	bool Validate()
@@ -58,15 +78,24 @@ public:
 
 protected:
 
-	void IndexNets(bool verbose);
+	bool IndexNets(bool verbose);
 	void ClearIndexes();
 
 	//Init helpers
-	void Load(json_object* object);
-	void LoadModules(json_object* object);
+	void Load(Greenpak4JSONReader& reader);
+	void LoadModules(Greenpak4JSONReader& reader);
+	bool LoadImage(Greenpak4NetlistImageReader& reader);
+
+	void Reset();
 
 	std::string m_creator;
 
+	//Interned names of everything in the netlist
+	Greenpak4StringTable m_strings;
+
+	//Storage for all cells, nodes and ports
+	Greenpak4NetlistArena m_arena;
+
 	//All of the modules in the netlist
 	std::map<std::string, Greenpak4NetlistModule*> m_modules;
 
@@ -0,0 +1,85 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include <log.h>
+#include <Greenpak4.h>
+
+using namespace std;
+
+//Size of a normal block. Anything bigger than this gets a block to itself.
+static const size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+Greenpak4NetlistArena::Greenpak4NetlistArena()
+	: m_next(NULL)
+	, m_end(NULL)
+	, m_capacity(0)
+	, m_lastObject(NULL)
+{
+}
+
+Greenpak4NetlistArena::~Greenpak4NetlistArena()
+{
+	Clear();
+}
+
+void Greenpak4NetlistArena::Clear()
+{
+	//Objects may point to each other, so tear down newest first
+	for(ObjectHeader* h = m_lastObject; h != NULL; h = h->m_prev)
+		h->m_destroy(h->m_object);
+	m_lastObject = NULL;
+
+	for(auto b : m_blocks)
+		delete[] b;
+	m_blocks.clear();
+
+	m_next = NULL;
+	m_end = NULL;
+	m_capacity = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Allocation
+
+void* Greenpak4NetlistArena::Allocate(size_t size, size_t align)
+{
+	//Fast path: fits in the current block
+	char* p = reinterpret_cast<char*>(Align(reinterpret_cast<size_t>(m_next), align));
+	if( (m_next != NULL) && (p + size <= m_end) )
+	{
+		m_next = p + size;
+		return p;
+	}
+
+	//Need a new block. new[] returns memory aligned for any fundamental type, which is all we ever store.
+	size_t blocksize = ARENA_BLOCK_SIZE;
+	if(size + align > blocksize)
+		blocksize = size + align;
+	char* block = new char[blocksize];
+	m_blocks.push_back(block);
+	m_capacity += blocksize;
+
+	p = reinterpret_cast<char*>(Align(reinterpret_cast<size_t>(block), align));
+	m_next = p + size;
+	m_end = block + blocksize;
+	return p;
+}
@@ -0,0 +1,102 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#ifndef Greenpak4NetlistArena_h
+#define Greenpak4NetlistArena_h
+
+#include <vector>
+#include <new>
+#include <utility>
+#include <stddef.h>
+
+/**
+	@brief Bump allocator that owns every object in a Greenpak4Netlist
+
+	Cells, nodes and ports (including ones inferred after parsing, like replicated GP_VREFs) are carved out of large
+	blocks in allocation order, so objects that are created together sit together in memory. Nothing is freed
+	individually: when the arena goes away every object is destroyed in reverse order of creation and the blocks are
+	released in one go.
+
+	Objects must not be deleted by anyone else.
+ */
+class Greenpak4NetlistArena
+{
+public:
+	Greenpak4NetlistArena();
+	virtual ~Greenpak4NetlistArena();
+
+	//Destroy everything in the arena
+	void Clear();
+
+	///Construct a new object in the arena
+	template<class T, class... Args>
+	T* New(Args&&... args)
+	{
+		//Each object is preceded by a header so we can find its destructor at teardown
+		size_t offset = Align(sizeof(ObjectHeader), alignof(T));
+		char* base = static_cast<char*>(Allocate(offset + sizeof(T), alignof(T) > alignof(ObjectHeader) ?
+			alignof(T) : alignof(ObjectHeader)));
+
+		T* obj = new(base + offset) T(std::forward<Args>(args)...);
+
+		//Don't link the object in until it's fully constructed, so a throwing constructor isn't destroyed twice
+		ObjectHeader* header = reinterpret_cast<ObjectHeader*>(base);
+		header->m_destroy = &Destroy<T>;
+		header->m_object = obj;
+		header->m_prev = m_lastObject;
+		m_lastObject = header;
+
+		return obj;
+	}
+
+	///Total bytes of backing storage held by the arena
+	size_t GetCapacity()
+	{ return m_capacity; }
+
+protected:
+	struct ObjectHeader
+	{
+		void (*m_destroy)(void*);
+		void* m_object;
+		ObjectHeader* m_prev;
+	};
+
+	template<class T>
+	static void Destroy(void* obj)
+	{ static_cast<T*>(obj)->~T(); }
+
+	static size_t Align(size_t n, size_t align)
+	{ return (n + align - 1) & ~(align - 1); }
+
+	void* Allocate(size_t size, size_t align);
+
+	///Blocks of backing storage
+	std::vector<char*> m_blocks;
+
+	///Bump pointer and end of the current block
+	char* m_next;
+	char* m_end;
+
+	size_t m_capacity;
+
+	///Most recently constructed object (head of the teardown list)
+	ObjectHeader* m_lastObject;
+};
+
+#endif
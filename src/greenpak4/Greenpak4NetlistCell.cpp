@@ -24,25 +24,71 @@ using namespace std;
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
+Greenpak4NetlistCell::Greenpak4NetlistCell(Greenpak4NetlistModule* module)
+	: Greenpak4NetlistEntity(KIND_CELL)
+	, m_primitive(NULL)
+	, m_parameters(module->GetNetlist()->GetStringTable())
+	, m_attributes(module->GetNetlist()->GetStringTable())
+	, m_connections(module->GetNetlist()->GetStringTable())
+	, m_parnode(NULL)
+	, m_parent(module)
+{
+}
+
 Greenpak4NetlistCell::~Greenpak4NetlistCell()
 {
 	//do not delete wires, module dtor handles that
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type checks
+
+void Greenpak4NetlistCell::SetType(const string& type)
+{
+	m_type = type;
+	m_primitive = Greenpak4LookupPrimitive(type);
+}
+
+bool Greenpak4NetlistCell::IsType(Greenpak4PrimitiveType type)
+{
+	return (m_primitive != NULL) && (m_primitive->m_type == type);
+}
+
+bool Greenpak4NetlistCell::IsIOB()
+{
+	if(m_primitive == NULL)
+		return false;
+
+	switch(m_primitive->m_type)
+	{
+		case GP_PRIM_IBUF:
+		case GP_PRIM_IOBUF:
+		case GP_PRIM_OBUF:
+		case GP_PRIM_OBUFT:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
 string Greenpak4NetlistCell::GetLOC()
 {
-	string loc = m_attributes.at("LOC");
+	auto it = m_attributes.find(GP_SYM_LOC);
+	if(it == m_attributes.end())
+		return "";
+	string loc = it->second;
 
 	//If we're an IOB, do vector processing
 	if(IsIOB())
 	{
 		//Get the top-level pad signal as this is always the vector
 		string port;
-		if( (m_type == "GP_OBUF") || (m_type == "GP_OBUFT") )
+		if(IsType(GP_PRIM_OBUF) || IsType(GP_PRIM_OBUFT))
 			port = "OUT";
-		else if(m_type == "GP_IBUF")
+		else if(IsType(GP_PRIM_IBUF))
 			port = "IN";
-		else if(m_type == "GP_IOBUF")
+		else if(IsType(GP_PRIM_IOBUF))
 			port = "IO";
 		auto cn = m_connections[port];
 
@@ -20,18 +20,41 @@
 #define Greenpak4NetlistCell_h
 
 class Greenpak4NetlistModule;
+class Greenpak4NetlistCell;
+class Greenpak4NetlistPort;
+struct Greenpak4Primitive;
+enum Greenpak4PrimitiveType : unsigned int;
 
-//only for RTTI support and naming
+//Common base of cells and ports, for naming and type dispatch
 class Greenpak4NetlistEntity
 {
 public:
-	Greenpak4NetlistEntity(std::string name = "")
+
+	//What we really are (so callers don't need dynamic_cast)
+	enum Kind
+	{
+		KIND_CELL,
+		KIND_PORT
+	};
+
+	Greenpak4NetlistEntity(Kind kind, std::string name = "")
 	: m_name(name)
+	, m_kind(kind)
 	{}
 
 	virtual ~Greenpak4NetlistEntity();
 
+	Kind GetKind() const
+	{ return m_kind; }
+
+	//Downcasts that return NULL if we're of the wrong kind
+	inline Greenpak4NetlistCell* AsCell();
+	inline Greenpak4NetlistPort* AsPort();
+
 	std::string m_name;
+
+protected:
+	Kind m_kind;
 };
 
 //A single primitive cell in the netlist
@@ -39,31 +62,37 @@ public:
 class Greenpak4NetlistCell : public Greenpak4NetlistEntity
 {
 public:
-	Greenpak4NetlistCell(Greenpak4NetlistModule* module)
-	: m_parent(module)
-	{ m_parnode = NULL; }
+	Greenpak4NetlistCell(Greenpak4NetlistModule* module);
 	virtual ~Greenpak4NetlistCell();
 
 	bool HasParameter(std::string att)
-	{ return m_parameters.find(att) != m_parameters.end(); }
+	{ return m_parameters.contains(att); }
 
 	bool HasAttribute(std::string att)
-	{ return m_attributes.find(att) != m_attributes.end(); }
+	{ return m_attributes.contains(att); }
+
+	//Set the module name and look up the primitive for it
+	void SetType(const std::string& type);
+
+	//Indicates whether the cell is an instance of a given primitive
+	bool IsType(Greenpak4PrimitiveType type);
 
 	//Indicates whether the cell is an I/O buffer
-	bool IsIOB()
-	{ return (m_type == "GP_IBUF") || (m_type == "GP_IOBUF") || (m_type == "GP_OBUF") || (m_type == "GP_OBUFT"); }
+	bool IsIOB();
 
 	std::string GetLOC();
 
 	bool HasLOC()
-	{ return (m_attributes.find("LOC") != m_attributes.end()); }
+	{ return m_attributes.contains(GP_SYM_LOC); }
 
 	///Module name
 	std::string m_type;
 
-	std::map<std::string, std::string> m_parameters;
-	std::map<std::string, std::string> m_attributes;
+	///The primitive we're an instance of (NULL if not a GreenPAK primitive)
+	const Greenpak4Primitive* m_primitive;
+
+	Greenpak4SymbolMap<std::string> m_parameters;
+	Greenpak4SymbolMap<std::string> m_attributes;
 
 	typedef std::vector<Greenpak4NetlistNode*> cellnet;
 
@@ -72,7 +101,7 @@ public:
 
 		connections[portname] = {bit2, bit1, bit0}
 	 */
-	std::map<std::string, cellnet > m_connections;
+	Greenpak4SymbolMap<cellnet> m_connections;
 
 	PARGraphNode* m_parnode;
 
@@ -80,4 +109,7 @@ public:
 	Greenpak4NetlistModule* m_parent;
 };
 
+Greenpak4NetlistCell* Greenpak4NetlistEntity::AsCell()
+{ return (m_kind == KIND_CELL) ? static_cast<Greenpak4NetlistCell*>(this) : NULL; }
+
 #endif
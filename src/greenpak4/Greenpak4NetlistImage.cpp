@@ -0,0 +1,306 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include <log.h>
+#include <Greenpak4.h>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+static const size_t GP4NL_HEADER_SIZE = 32;
+
+static void PutWord(vector<uint8_t>& buf, uint32_t word)
+{
+	buf.push_back(word & 0xff);
+	buf.push_back((word >> 8) & 0xff);
+	buf.push_back((word >> 16) & 0xff);
+	buf.push_back((word >> 24) & 0xff);
+}
+
+static uint32_t GetWord(const char* p)
+{
+	const uint8_t* u = reinterpret_cast<const uint8_t*>(p);
+	return u[0] | (u[1] << 8) | (u[2] << 16) | ((uint32_t)u[3] << 24);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Writer
+
+Greenpak4NetlistImageWriter::Greenpak4NetlistImageWriter()
+{
+}
+
+Greenpak4NetlistImageWriter::~Greenpak4NetlistImageWriter()
+{
+}
+
+void Greenpak4NetlistImageWriter::WriteSymbolTable(Greenpak4StringTable* table)
+{
+	//Both tables start out with the same well-known symbols, so interning in order keeps the IDs identical
+	for(Greenpak4Symbol sym = GP_SYM_NONE+1; sym < table->size(); sym++)
+		m_pool.Intern(table->GetString(sym));
+	Write(table->size());
+}
+
+/**
+	@brief Assemble the header, string pool and body and write them to a file
+ */
+bool Greenpak4NetlistImageWriter::Save(string fname, uint64_t sourceHash, uint64_t sourceLength)
+{
+	vector<uint8_t> buf;
+
+	//Header
+	const char* magic = GP4NL_MAGIC;
+	buf.insert(buf.end(), magic, magic + 8);
+	PutWord(buf, GP4NL_VERSION);
+	PutWord(buf, 0);
+	PutWord(buf, sourceHash & 0xffffffff);
+	PutWord(buf, sourceHash >> 32);
+	PutWord(buf, sourceLength & 0xffffffff);
+	PutWord(buf, sourceLength >> 32);
+
+	//String pool
+	uint32_t count = m_pool.size();
+	PutWord(buf, count);
+	uint32_t offset = 0;
+	for(uint32_t i=0; i<count; i++)
+	{
+		PutWord(buf, offset);
+		offset += m_pool.GetString(i).length();
+	}
+	PutWord(buf, offset);
+	for(uint32_t i=0; i<count; i++)
+	{
+		auto& str = m_pool.GetString(i);
+		buf.insert(buf.end(), str.begin(), str.end());
+	}
+	while(buf.size() % 4)
+		buf.push_back(0);
+
+	//Body
+	for(auto w : m_words)
+		PutWord(buf, w);
+
+	FILE* fp = fopen(fname.c_str(), "wb");
+	if(fp == NULL)
+	{
+		LogError("Couldn't open netlist image %s for writing\n", fname.c_str());
+		return false;
+	}
+	if(buf.size() != fwrite(&buf[0], 1, buf.size(), fp))
+	{
+		LogError("Couldn't write netlist image %s\n", fname.c_str());
+		fclose(fp);
+		return false;
+	}
+	fclose(fp);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reader
+
+Greenpak4NetlistImageReader::Greenpak4NetlistImageReader()
+	: m_sourceHash(0)
+	, m_sourceLength(0)
+	, m_poolOffsets(NULL)
+	, m_poolData(NULL)
+	, m_poolCount(0)
+	, m_poolDataLength(0)
+	, m_pos(NULL)
+	, m_end(NULL)
+	, m_failed(false)
+{
+}
+
+Greenpak4NetlistImageReader::~Greenpak4NetlistImageReader()
+{
+}
+
+bool Greenpak4NetlistImageReader::IsImage(const char* buf, size_t len)
+{
+	return (len >= 8) && (0 == memcmp(buf, GP4NL_MAGIC, 8));
+}
+
+/**
+	@brief FNV-1a 64
+ */
+uint64_t Greenpak4NetlistImageReader::HashSource(const char* buf, size_t len)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for(size_t i=0; i<len; i++)
+	{
+		hash ^= (uint8_t)buf[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+bool Greenpak4NetlistImageReader::Open(const char* buf, size_t len)
+{
+	m_failed = false;
+	m_symbols.clear();
+
+	if(!IsImage(buf, len) || (len < GP4NL_HEADER_SIZE + 8) )
+		return false;
+
+	//Images from other versions are just stale, not broken
+	if(GetWord(buf + 8) != GP4NL_VERSION)
+	{
+		LogVerbose("Netlist image is version %u, expected %u\n", GetWord(buf + 8), GP4NL_VERSION);
+		return false;
+	}
+
+	m_sourceHash = GetWord(buf + 16) | ((uint64_t)GetWord(buf + 20) << 32);
+	m_sourceLength = GetWord(buf + 24) | ((uint64_t)GetWord(buf + 28) << 32);
+
+	//String pool
+	m_pos = buf + GP4NL_HEADER_SIZE;
+	m_end = buf + len;
+	uint32_t count;
+	if(!Read(count))
+		return false;
+	if( (count > (size_t)(m_end - m_pos) / 4) || ((size_t)(count + 1) * 4 > (size_t)(m_end - m_pos)) )
+	{
+		Error("string pool index is truncated");
+		return false;
+	}
+	m_poolCount = count;
+	m_poolOffsets = m_pos;
+	m_poolData = m_pos + (count + 1) * 4;
+	m_poolDataLength = GetWord(m_poolOffsets + count*4);
+	size_t padded = (m_poolDataLength + 3) & ~3;
+	if(padded > (size_t)(m_end - m_poolData))
+	{
+		Error("string pool is truncated");
+		return false;
+	}
+	m_pos = m_poolData + padded;
+
+	m_symbols.resize(count, GP_SYM_NONE);
+	return true;
+}
+
+void Greenpak4NetlistImageReader::Error(const char* what)
+{
+	//Don't cascade, the first error is the only useful one
+	if(m_failed)
+		return;
+	m_failed = true;
+
+	LogError("Netlist image is corrupt: %s\n", what);
+}
+
+bool Greenpak4NetlistImageReader::Read(uint32_t& word)
+{
+	if(m_failed)
+		return false;
+	if(m_end - m_pos < 4)
+	{
+		Error("unexpected end of file");
+		return false;
+	}
+	word = GetWord(m_pos);
+	m_pos += 4;
+	return true;
+}
+
+bool Greenpak4NetlistImageReader::PoolString(uint32_t index, string& str)
+{
+	if(index >= m_poolCount)
+	{
+		Error("string index out of range");
+		return false;
+	}
+
+	uint32_t start = GetWord(m_poolOffsets + index*4);
+	uint32_t end = GetWord(m_poolOffsets + index*4 + 4);
+	if( (start > end) || (end > m_poolDataLength) )
+	{
+		Error("string offset out of range");
+		return false;
+	}
+
+	str.assign(m_poolData + start, end - start);
+	return true;
+}
+
+bool Greenpak4NetlistImageReader::ReadString(string& str)
+{
+	uint32_t index;
+	if(!Read(index))
+		return false;
+	return PoolString(index, str);
+}
+
+bool Greenpak4NetlistImageReader::ReadSymbolTable(Greenpak4StringTable* table)
+{
+	uint32_t count;
+	if(!Read(count))
+		return false;
+	if(count > m_poolCount)
+	{
+		Error("symbol table is bigger than the string pool");
+		return false;
+	}
+
+	//Interning in pool order keeps symbol IDs (and thus map iteration order) the same as in the original netlist
+	string str;
+	for(uint32_t i=GP_SYM_NONE+1; i<count; i++)
+	{
+		if(!PoolString(i, str))
+			return false;
+		m_symbols[i] = table->Intern(str);
+	}
+	return true;
+}
+
+bool Greenpak4NetlistImageReader::ReadSymbol(Greenpak4StringTable* table, Greenpak4Symbol& sym)
+{
+	uint32_t index;
+	if(!Read(index))
+		return false;
+
+	if( (index >= m_poolCount) || (m_symbols[index] == GP_SYM_NONE) )
+	{
+		string str;
+		if(!PoolString(index, str))
+			return false;
+		m_symbols[index] = table->Intern(str);
+	}
+
+	sym = m_symbols[index];
+	return true;
+}
+
+bool Greenpak4NetlistImageReader::ReadIndex(uint32_t& index, size_t count, bool nullable)
+{
+	if(!Read(index))
+		return false;
+	if(nullable && (index == GP4NL_NONE))
+		return true;
+	if(index >= count)
+	{
+		Error("object index out of range");
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,155 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#ifndef Greenpak4NetlistImage_h
+#define Greenpak4NetlistImage_h
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/**
+	@brief Binary netlist image (.gp4nl) format
+
+	A fully parsed and indexed netlist, so repeat runs on the same design skip JSON parsing and IndexNets()
+	entirely. The layout has no pointers, only indexes, so it can be mapped and read in place:
+
+		Header (32 bytes)
+			char		magic[8]		GP4NL_MAGIC
+			uint32		version			GP4NL_VERSION
+			uint32		reserved		0
+			uint64		source_hash		FNV-1a 64 of the JSON the image was built from
+			uint64		source_length	Size of that JSON, in bytes
+
+		String pool
+			uint32		count
+			uint32		offsets[count+1]	Start of each string (and end of the last) within the pool data
+			char		data[]				Padded to a multiple of 4 bytes
+
+		Body
+			Little-endian uint32 words. Strings are pool indexes, cells/nodes/ports are indexes into their module's
+			tables. See Greenpak4Netlist::SaveImage() and friends for the order.
+
+	Images are tied to the version of gp4par that wrote them (GP4NL_VERSION is bumped whenever the layout or the
+	meaning of anything in it changes) and are never loaded if the version doesn't match.
+ */
+
+#define GP4NL_MAGIC		"GP4NL\r\n\x1a"
+#define GP4NL_VERSION	1
+
+//Marker for "no object" wherever an index is expected
+#define GP4NL_NONE		0xffffffff
+
+/**
+	@brief Accumulates a netlist image in memory, then writes it out in one go
+ */
+class Greenpak4NetlistImageWriter
+{
+public:
+	Greenpak4NetlistImageWriter();
+	virtual ~Greenpak4NetlistImageWriter();
+
+	void Write(uint32_t word)
+	{ m_words.push_back(word); }
+
+	//Copy a string table into the pool, so that pool index == symbol. Must come before anything else.
+	void WriteSymbolTable(Greenpak4StringTable* table);
+
+	//Write a symbol from the table passed to WriteSymbolTable()
+	void WriteSymbol(Greenpak4Symbol sym)
+	{ Write(sym); }
+
+	//Write a pool index for a string, adding it to the pool if needed
+	void WriteString(const std::string& str)
+	{ Write(m_pool.Intern(str)); }
+
+	bool Save(std::string fname, uint64_t sourceHash, uint64_t sourceLength);
+
+protected:
+	Greenpak4StringTable m_pool;
+	std::vector<uint32_t> m_words;
+};
+
+/**
+	@brief Reads a netlist image from a memory buffer, with bounds checking on everything
+ */
+class Greenpak4NetlistImageReader
+{
+public:
+	Greenpak4NetlistImageReader();
+	virtual ~Greenpak4NetlistImageReader();
+
+	//Check the header and string pool. Returns false (with no error logged) if it's not an image at all.
+	bool Open(const char* buf, size_t len);
+
+	//True if the buffer starts with the image magic number
+	static bool IsImage(const char* buf, size_t len);
+
+	//Hash used to tie an image to its source JSON
+	static uint64_t HashSource(const char* buf, size_t len);
+
+	uint64_t GetSourceHash()
+	{ return m_sourceHash; }
+
+	uint64_t GetSourceLength()
+	{ return m_sourceLength; }
+
+	bool Read(uint32_t& word);
+	bool ReadString(std::string& str);
+
+	//Intern everything written by WriteSymbolTable(), in order, so symbols come out the same as when it was written
+	bool ReadSymbolTable(Greenpak4StringTable* table);
+
+	//Read a pool index and intern the string it refers to (each pool entry is only interned once)
+	bool ReadSymbol(Greenpak4StringTable* table, Greenpak4Symbol& sym);
+
+	//Read an object index and check that it's in range (GP4NL_NONE is allowed if nullable is set)
+	bool ReadIndex(uint32_t& index, size_t count, bool nullable = false);
+
+	bool AtEnd()
+	{ return m_pos == m_end; }
+
+	bool Failed()
+	{ return m_failed; }
+
+	void Error(const char* what);
+
+protected:
+	bool PoolString(uint32_t index, std::string& str);
+
+	uint64_t m_sourceHash;
+	uint64_t m_sourceLength;
+
+	///Pool index
+	const char* m_poolOffsets;
+	const char* m_poolData;
+	uint32_t m_poolCount;
+	uint32_t m_poolDataLength;
+
+	///Symbols already interned for each pool entry (GP_SYM_NONE if not yet)
+	std::vector<Greenpak4Symbol> m_symbols;
+
+	///Body read pointer
+	const char* m_pos;
+	const char* m_end;
+
+	bool m_failed;
+};
+
+#endif
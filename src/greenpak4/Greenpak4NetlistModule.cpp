@@ -27,9 +27,13 @@ using namespace std;
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
-Greenpak4NetlistModule::Greenpak4NetlistModule(Greenpak4Netlist* parent, std::string name, json_object* object)
-	: m_parent(parent)
+Greenpak4NetlistModule::Greenpak4NetlistModule(Greenpak4Netlist* parent, std::string name, Greenpak4JSONReader& reader)
+	: m_attributes(parent->GetStringTable())
+	, m_parent(parent)
 	, m_name(name)
+	, m_ports(parent->GetStringTable())
+	, m_nets(parent->GetStringTable())
+	, m_cells(parent->GetStringTable())
 	, m_nextNetNumber(0)
 	, m_parseOK(true)
 {
@@ -37,40 +41,35 @@ Greenpak4NetlistModule::Greenpak4NetlistModule(Greenpak4Netlist* parent, std::st
 
 	LogVerbose("%s\n", name.c_str());
 
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
+	if(!reader.BeginObject())
 	{
-		//See what we got
-		string name = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+		m_parseOK = false;
+		return;
+	}
 
+	string section;
+	string cname;
+	while(reader.NextKey(section))
+	{
 		//Whatever it is, it should be an object
-		if(!json_object_is_type(child, json_type_object))
+		if(reader.PeekType() != Greenpak4JSONReader::TYPE_OBJECT)
 		{
 			LogError("module child should be of type object but isn't\n");
 			m_parseOK = false;
 			return;
 		}
 
-		if(name == "attributes")
-			LoadAttributes(child);
+		if(section == "attributes")
+			LoadAttributes(reader);
 
 		else
 		{
 			//Go over the children's children and process it
-			json_object_iterator end = json_object_iter_end(child);
-			for(json_object_iterator it2 = json_object_iter_begin(child);
-				!json_object_iter_equal(&it2, &end);
-				json_object_iter_next(&it2))
+			reader.BeginObject();
+			while(reader.NextKey(cname))
 			{
-				//See what we got
-				string cname = json_object_iter_peek_name(&it2);
-				json_object* cobject = json_object_iter_peek_value(&it2);
-
 				//Whatever it is, it should be an object
-				if(!json_object_is_type(cobject, json_type_object))
+				if(reader.PeekType() != Greenpak4JSONReader::TYPE_OBJECT)
 				{
 					LogError("module child should be of type object but isn't\n");
 					m_parseOK = false;
@@ -78,18 +77,18 @@ Greenpak4NetlistModule::Greenpak4NetlistModule(Greenpak4Netlist* parent, std::st
 				}
 
 				//Load ports
-				if(name == "ports")
+				if(section == "ports")
 				{
 					//Make sure it doesn't exist
-					if(m_ports.find(cname) != m_ports.end())
+					if(m_ports.contains(cname))
 					{
-						LogError("Attempted redeclaration of module port \"%s\"\n", name.c_str());
+						LogError("Attempted redeclaration of module port \"%s\"\n", cname.c_str());
 						m_parseOK = false;
 						return;
 					}
 
 					//Create the port
-					Greenpak4NetlistPort* port = new Greenpak4NetlistPort(this, cname, cobject);
+					Greenpak4NetlistPort* port = m_parent->GetArena()->New<Greenpak4NetlistPort>(this, cname, reader);
 					if(!port->Validate())
 					{
 						m_parseOK = false;
@@ -99,22 +98,34 @@ Greenpak4NetlistModule::Greenpak4NetlistModule(Greenpak4Netlist* parent, std::st
 				}
 
 				//Load cells
-				else if(name == "cells")
-					LoadCell(cname, cobject);
+				else if(section == "cells")
+					LoadCell(cname, reader);
 
 				//Load net names
-				else if(name == "netnames")
-					LoadNetName(cname, cobject);
+				else if(section == "netnames")
+					LoadNetName(cname, reader);
 
 				//Whatever it is, we don't want it
 				else
 				{
-					LogError("Unknown top-level JSON object \"%s\"\n", name.c_str());
+					LogError("Unknown top-level JSON object \"%s\"\n", section.c_str());
 					m_parseOK = false;
 					return;
 				}
+
+				if(!m_parseOK)
+					return;
 			}
 		}
+
+		if(!m_parseOK)
+			return;
+	}
+
+	if(reader.Failed())
+	{
+		m_parseOK = false;
+		return;
 	}
 
 	//Assign port nets
@@ -124,24 +135,7 @@ Greenpak4NetlistModule::Greenpak4NetlistModule(Greenpak4Netlist* parent, std::st
 
 Greenpak4NetlistModule::~Greenpak4NetlistModule()
 {
-	//Clean up in reverse order
-
-	//cells depend on everything
-	for(auto x : m_cells)
-		delete x.second;
-	m_cells.clear();
-
-	//don't delete nets, it's just a re-indexing of nodes
-
-	//ports don't depend on anything but nodes
-	for(auto x : m_ports)
-		delete x.second;
-	m_ports.clear();
-
-	//then nodes at end
-	for(auto x : m_nodes)
-		delete x.second;
-	m_nodes.clear();
+	//Cells, ports and nodes belong to the netlist's arena, nothing to delete here
 }
 
 void Greenpak4NetlistModule::CreatePowerNets()
@@ -150,10 +144,11 @@ void Greenpak4NetlistModule::CreatePowerNets()
 	string vss = "GP_VSS";
 
 	//Create power/ground nets
-	m_vdd = new Greenpak4NetlistNode;
+	auto arena = m_parent->GetArena();
+	m_vdd = arena->New<Greenpak4NetlistNode>(m_parent->GetStringTable());
 	m_vdd->m_name = vdd;
 
-	m_vss = new Greenpak4NetlistNode;
+	m_vss = arena->New<Greenpak4NetlistNode>(m_parent->GetStringTable());
 	m_vss->m_name = vss;
 
 	m_nodes[VDD_NETNUM] = m_vdd;
@@ -163,15 +158,15 @@ void Greenpak4NetlistModule::CreatePowerNets()
 	m_nets[vss] = m_vss;
 
 	//Create driver cells for them
-	Greenpak4NetlistCell* vcell = new Greenpak4NetlistCell(this);
+	Greenpak4NetlistCell* vcell = arena->New<Greenpak4NetlistCell>(this);
 	vcell->m_name = vdd;
-	vcell->m_type = vdd;
+	vcell->SetType(vdd);
 	vcell->m_connections["OUT"].push_back(m_vdd);
 	m_cells[vdd] = vcell;
 
-	Greenpak4NetlistCell* gcell = new Greenpak4NetlistCell(this);
+	Greenpak4NetlistCell* gcell = arena->New<Greenpak4NetlistCell>(this);
 	gcell->m_name = vss;
-	gcell->m_type = vss;
+	gcell->SetType(vss);
 	gcell->m_connections["OUT"].push_back(m_vss);
 	m_cells[vss] = gcell;
 }
@@ -179,18 +174,15 @@ void Greenpak4NetlistModule::CreatePowerNets()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Loading
 
-void Greenpak4NetlistModule::LoadAttributes(json_object* object)
+void Greenpak4NetlistModule::LoadAttributes(Greenpak4JSONReader& reader)
 {
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
-	{
-		string cname = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+	reader.BeginObject();
 
+	string cname;
+	while(reader.NextKey(cname))
+	{
 		//Make sure we don't have it already
-		if(m_attributes.find(cname) != m_attributes.end())
+		if(m_attributes.contains(cname))
 		{
 			LogError("Attempted redeclaration of module attribute \"%s\"\n", cname.c_str());
 			m_parseOK = false;
@@ -198,8 +190,11 @@ void Greenpak4NetlistModule::LoadAttributes(json_object* object)
 		}
 
 		//Save the attribute
-		m_attributes[cname] = json_object_get_string(child);
+		reader.ReadScalar(m_attributes[cname]);
 	}
+
+	if(reader.Failed())
+		m_parseOK = false;
 }
 
 Greenpak4NetlistNode* Greenpak4NetlistModule::GetNode(int32_t netnum)
@@ -208,7 +203,7 @@ Greenpak4NetlistNode* Greenpak4NetlistModule::GetNode(int32_t netnum)
 	//If not, create it
 	if(m_nodes.find(netnum) == m_nodes.end())
 	{
-		m_nodes[netnum] = new Greenpak4NetlistNode;
+		m_nodes[netnum] = m_parent->GetArena()->New<Greenpak4NetlistNode>(m_parent->GetStringTable());
 
 		//Keep running total of max net number in use
 		if(netnum >= m_nextNetNumber)
@@ -218,53 +213,48 @@ Greenpak4NetlistNode* Greenpak4NetlistModule::GetNode(int32_t netnum)
 	return m_nodes[netnum];
 }
 
-void Greenpak4NetlistModule::LoadCell(std::string name, json_object* object)
+void Greenpak4NetlistModule::LoadCell(std::string name, Greenpak4JSONReader& reader)
 {
-	Greenpak4NetlistCell* cell = new Greenpak4NetlistCell(this);
+	Greenpak4NetlistCell* cell = m_parent->GetArena()->New<Greenpak4NetlistCell>(this);
 	cell->m_name = name;
 	m_cells[name] = cell;
 
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
-	{
-		//See what we got
-		string cname = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+	reader.BeginObject();
 
+	string cname;
+	while(reader.NextKey(cname))
+	{
 		//Ignore hide_name request for now
 		if(cname == "hide_name")
-		{
-
-		}
+			reader.Skip();
 
 		//Type of cell
 		else if(cname == "type")
 		{
-			if(!json_object_is_type(child, json_type_string))
+			if(reader.PeekType() != Greenpak4JSONReader::TYPE_STRING)
 			{
 				LogError("Cell type should be of type string but isn't\n");
 				m_parseOK = false;
 				return;
 			}
 
-			cell->m_type = json_object_get_string(child);
+			string type;
+			reader.ReadString(type);
+			cell->SetType(type);
 		}
 
 		else if(cname == "attributes")
-			LoadCellAttributes(cell, child);
+			LoadCellAttributes(cell, reader);
 
 		else if(cname == "parameters")
-			LoadCellParameters(cell, child);
+			LoadCellParameters(cell, reader);
 
 		else if(cname == "connections")
-			LoadCellConnections(cell, child);
+			LoadCellConnections(cell, reader);
 
 		//redundant, we can look this up from the module
 		else if(cname == "port_directions")
-		{
-		}
+			reader.Skip();
 
 		//Unsupported
 		else
@@ -273,13 +263,19 @@ void Greenpak4NetlistModule::LoadCell(std::string name, json_object* object)
 			m_parseOK = false;
 			return;
 		}
+
+		if(!m_parseOK)
+			return;
 	}
+
+	if(reader.Failed())
+		m_parseOK = false;
 }
 
-void Greenpak4NetlistModule::LoadNetName(std::string name, json_object* object)
+void Greenpak4NetlistModule::LoadNetName(std::string name, Greenpak4JSONReader& reader)
 {
 	//Create the named net
-	if(m_nets.find(name) != m_nets.end())
+	if(m_nets.contains(name))
 	{
 		LogError("Attempted redeclaration of net \"%s\" \n", name.c_str());
 		m_parseOK = false;
@@ -288,41 +284,37 @@ void Greenpak4NetlistModule::LoadNetName(std::string name, json_object* object)
 
 	vector<Greenpak4NetlistNode*> nodes;
 
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
-	{
-		string cname = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+	reader.BeginObject();
 
+	string cname;
+	string value;
+	while(reader.NextKey(cname))
+	{
 		//Ignore hide_name request for now
 		if(cname == "hide_name")
-		{
-		}
+			reader.Skip();
 
 		//Bits - list of nets this name is assigned to
 		else if(cname == "bits")
 		{
-			if(!json_object_is_type(child, json_type_array))
+			if(reader.PeekType() != Greenpak4JSONReader::TYPE_ARRAY)
 			{
 				LogError("Net name bits should be of type array but isn't\n");
 				m_parseOK = false;
 				return;
 			}
 
-			//Walk the array
-			int len = json_object_array_length(child);
-			for(int i=0; i<len; i++)
+			//Walk the array. We don't know the length up front, so remember the net numbers and name them after.
+			vector<int32_t> netnums;
+			reader.BeginArray();
+			while(reader.NextElement())
 			{
-				json_object* jnode = json_object_array_get_idx(child, i);
-
-				int netnum = -1;
+				int32_t netnum = -1;
 
 				//If it's the string "x", the remaining bits of the signal are unused
-				if(json_object_is_type(jnode, json_type_string))
+				if(reader.PeekType() == Greenpak4JSONReader::TYPE_STRING)
 				{
-					string value = json_object_get_string(jnode);
+					reader.ReadString(value);
 					if(value != "x")
 					{
 						LogError("Net number in module should be of type integer, or \"x\", but isn't\n");
@@ -334,16 +326,27 @@ void Greenpak4NetlistModule::LoadNetName(std::string name, json_object* object)
 				//Should be an integer if we get here
 				else
 				{
-					if(!json_object_is_type(jnode, json_type_int))
+					if(reader.PeekType() != Greenpak4JSONReader::TYPE_NUMBER)
 					{
 						LogError("Net number in module should be of type integer but isn't\n");
 						m_parseOK = false;
 						return;
 					}
 
-					netnum = json_object_get_int(jnode);
+					if(!reader.ReadInt(netnum))
+						break;
 				}
 
+				netnums.push_back(netnum);
+			}
+			if(reader.Failed())
+				break;
+
+			int len = netnums.size();
+			for(int i=0; i<len; i++)
+			{
+				int32_t netnum = netnums[i];
+
 				//Look up net number and name
 				string bname = name;
 				if(len > 1)
@@ -373,7 +376,7 @@ void Greenpak4NetlistModule::LoadNetName(std::string name, json_object* object)
 		//Attributes - array of name-value pairs
 		else if(cname == "attributes")
 		{
-			if(!json_object_is_type(child, json_type_object))
+			if(reader.PeekType() != Greenpak4JSONReader::TYPE_OBJECT)
 			{
 				LogError("Net attributes should be of type object but isn't\n");
 				m_parseOK = false;
@@ -381,8 +384,7 @@ void Greenpak4NetlistModule::LoadNetName(std::string name, json_object* object)
 			}
 
 			//Same attributes for all nodes in the vector net
-			for(auto node : nodes)
-				LoadNetAttributes(node, child);
+			LoadNetAttributes(nodes, reader);
 		}
 
 		//Unsupported
@@ -392,56 +394,62 @@ void Greenpak4NetlistModule::LoadNetName(std::string name, json_object* object)
 			m_parseOK = false;
 			return;
 		}
+
+		if(!m_parseOK)
+			return;
 	}
+
+	if(reader.Failed())
+		m_parseOK = false;
 }
 
-void Greenpak4NetlistModule::LoadNetAttributes(Greenpak4NetlistNode* net, json_object* object)
+void Greenpak4NetlistModule::LoadNetAttributes(vector<Greenpak4NetlistNode*>& nodes, Greenpak4JSONReader& reader)
 {
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
-	{
-		string cname = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+	reader.BeginObject();
 
+	string cname;
+	string value;
+	while(reader.NextKey(cname))
+	{
 		//no type check, convert whatever it is to a string
-		string value = json_object_get_string(child);
+		if(!reader.ReadScalar(value))
+			break;
 
-		//We can have multiple source locations for a single net
-		if(cname == "src")
+		for(auto net : nodes)
 		{
-			net->m_src_locations.push_back(value);
-			continue;
-		}
-
-		//Make sure we don't have it already
-		if(net->m_attributes.find(cname) != net->m_attributes.end())
-		{
-			LogError("Attempted redeclaration of net attribute \"%s\"\n", cname.c_str());
-			m_parseOK = false;
-			return;
-		}
+			//We can have multiple source locations for a single net
+			if(cname == "src")
+			{
+				net->m_src_locations.push_back(value);
+				continue;
+			}
 
-		//LogNotice("    net %s attribute %s = %s\n", net->m_name.c_str(), cname.c_str(), json_object_get_string(child));
+			//Make sure we don't have it already
+			if(net->m_attributes.contains(cname))
+			{
+				LogError("Attempted redeclaration of net attribute \"%s\"\n", cname.c_str());
+				m_parseOK = false;
+				return;
+			}
 
-		//Save the attribute
-		net->m_attributes[cname] = value;
+			//Save the attribute
+			net->m_attributes[cname] = value;
+		}
 	}
+
+	if(reader.Failed())
+		m_parseOK = false;
 }
 
-void Greenpak4NetlistModule::LoadCellAttributes(Greenpak4NetlistCell* cell, json_object* object)
+void Greenpak4NetlistModule::LoadCellAttributes(Greenpak4NetlistCell* cell, Greenpak4JSONReader& reader)
 {
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
-	{
-		string cname = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+	reader.BeginObject();
 
+	string cname;
+	while(reader.NextKey(cname))
+	{
 		//Make sure we don't have it already
-		if(cell->m_attributes.find(cname) != cell->m_attributes.end())
+		if(cell->m_attributes.contains(cname))
 		{
 			LogError("Attempted redeclaration of cell attribute \"%s\"\n", cname.c_str());
 			m_parseOK = false;
@@ -449,24 +457,24 @@ void Greenpak4NetlistModule::LoadCellAttributes(Greenpak4NetlistCell* cell, json
 		}
 
 		//Save the attribute
-		cell->m_attributes[cname] = json_object_get_string(child);
+		reader.ReadScalar(cell->m_attributes[cname]);
 	}
+
+	if(reader.Failed())
+		m_parseOK = false;
 }
 
-void Greenpak4NetlistModule::LoadCellParameters(Greenpak4NetlistCell* cell, json_object* object)
+void Greenpak4NetlistModule::LoadCellParameters(Greenpak4NetlistCell* cell, Greenpak4JSONReader& reader)
 {
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
-	{
-		string cname = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+	reader.BeginObject();
 
+	string cname;
+	while(reader.NextKey(cname))
+	{
 		//No type check, just convert back to string
 
 		//Make sure we don't have it already
-		if(cell->m_parameters.find(cname) != cell->m_parameters.end())
+		if(cell->m_parameters.contains(cname))
 		{
 			LogError("Attempted redeclaration of cell parameter \"%s\"\n", cname.c_str());
 			m_parseOK = false;
@@ -474,52 +482,47 @@ void Greenpak4NetlistModule::LoadCellParameters(Greenpak4NetlistCell* cell, json
 		}
 
 		//Save the attribute
-		cell->m_parameters[cname] = json_object_get_string(child);
+		reader.ReadScalar(cell->m_parameters[cname]);
 	}
+
+	if(reader.Failed())
+		m_parseOK = false;
 }
 
-void Greenpak4NetlistModule::LoadCellConnections(Greenpak4NetlistCell* cell, json_object* object)
+void Greenpak4NetlistModule::LoadCellConnections(Greenpak4NetlistCell* cell, Greenpak4JSONReader& reader)
 {
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
-	{
-		string cname = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+	reader.BeginObject();
 
-		if(!json_object_is_type(child, json_type_array))
+	string cname;
+	string value;
+	while(reader.NextKey(cname))
+	{
+		if(reader.PeekType() != Greenpak4JSONReader::TYPE_ARRAY)
 		{
 			LogError("Cell connection value should be of type array but isn't\n");
 			m_parseOK = false;
 			return;
 		}
 
-		//Sanity check the length. If empty, bail without creating a floating net.
-		//Otherwise should be 1 bit
-		int len = json_object_array_length(child);
-		if(len == 0)
-			continue;
-
-		//May have multiple bits if it's a vector port
-		for(int i=0; i<len; i++)
+		//May have multiple bits if it's a vector port.
+		//If empty, bail without creating a floating net.
+		reader.BeginArray();
+		while(reader.NextElement())
 		{
 			Greenpak4NetlistNode* node = NULL;
 
-			json_object* jnode = json_object_array_get_idx(child, i);
-
 			//If it's a string, it's a constant one or zero
-			if(json_object_is_type(jnode, json_type_string))
+			if(reader.PeekType() == Greenpak4JSONReader::TYPE_STRING)
 			{
-				string s = json_object_get_string(jnode);
-				if(s == "1")
+				reader.ReadString(value);
+				if(value == "1")
 					node = m_vdd;
 				else
 					node = m_vss;
 			}
 
 			//Otherwise it has to be an integer
-			else if(!json_object_is_type(jnode, json_type_int))
+			else if(reader.PeekType() != Greenpak4JSONReader::TYPE_NUMBER)
 			{
 				LogError("Net number for cell should be of type integer but isn't\n");
 				m_parseOK = false;
@@ -527,10 +530,378 @@ void Greenpak4NetlistModule::LoadCellConnections(Greenpak4NetlistCell* cell, jso
 			}
 
 			else
-				node = GetNode(json_object_get_int(jnode));
+			{
+				int32_t netnum;
+				if(!reader.ReadInt(netnum))
+					break;
+				node = GetNode(netnum);
+			}
 
 			//Hook up the connection
 			cell->m_connections[cname].push_back(node);
 		}
 	}
+
+	if(reader.Failed())
+		m_parseOK = false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Binary images
+
+/**
+	@brief Loads a module from a netlist image (see Greenpak4NetlistImage.h)
+ */
+Greenpak4NetlistModule::Greenpak4NetlistModule(Greenpak4Netlist* parent, std::string name, Greenpak4NetlistImageReader& reader)
+	: m_attributes(parent->GetStringTable())
+	, m_parent(parent)
+	, m_vdd(NULL)
+	, m_vss(NULL)
+	, m_name(name)
+	, m_ports(parent->GetStringTable())
+	, m_nets(parent->GetStringTable())
+	, m_cells(parent->GetStringTable())
+	, m_nextNetNumber(0)
+	, m_parseOK(true)
+{
+	LogVerbose("%s\n", name.c_str());
+
+	if(!LoadImage(reader) || reader.Failed())
+		m_parseOK = false;
+}
+
+/**
+	@brief Writes the module out in the same order LoadImage() reads it back
+
+	Module layout:
+		attributes
+		node count, then per node: net number, name, attributes, source location count, source locations
+		port count, then per port: name, direction, node count, nodes, named net (or none)
+		net count, then per net: name, node (or none)
+		cell count, then per cell: name, type, parameters, attributes, connection count, then per connection:
+			port name, bit count, nodes
+		next net number, VDD node, VSS node
+		1 if net indexes follow, 0 if not. Then per node: port count, ports, point count, then per point:
+			cell, port name, bit, vector flag, primitive port index (or none)
+
+	Attributes are a count followed by key symbol / value string pairs.
+ */
+void Greenpak4NetlistModule::SaveImage(Greenpak4NetlistImageWriter& writer, bool indexed)
+{
+	SaveImageAttributes(m_attributes, writer);
+
+	//Nodes, numbered in net number order
+	map<Greenpak4NetlistNode*, uint32_t> nodeids;
+	writer.Write(m_nodes.size());
+	for(auto it : m_nodes)
+	{
+		Greenpak4NetlistNode* node = it.second;
+		uint32_t id = nodeids.size();
+		nodeids[node] = id;
+
+		writer.Write(it.first);
+		writer.WriteString(node->m_name);
+		SaveImageAttributes(node->m_attributes, writer);
+		writer.Write(node->m_src_locations.size());
+		for(auto& src : node->m_src_locations)
+			writer.WriteString(src);
+	}
+
+	//Ports
+	map<Greenpak4NetlistPort*, uint32_t> portids;
+	writer.Write(m_ports.size());
+	for(auto it : m_ports)
+	{
+		Greenpak4NetlistPort* port = it.second;
+		uint32_t id = portids.size();
+		portids[port] = id;
+
+		writer.WriteSymbol(it.first);
+		writer.Write(port->m_direction);
+		writer.Write(port->m_nodes.size());
+		for(auto node : port->m_nodes)
+			writer.Write(nodeids[node]);
+		writer.Write(port->m_net ? nodeids[port->m_net] : GP4NL_NONE);
+	}
+
+	//Net names
+	writer.Write(m_nets.size());
+	for(auto it : m_nets)
+	{
+		writer.WriteSymbol(it.first);
+		writer.Write(it.second ? nodeids[it.second] : GP4NL_NONE);
+	}
+
+	//Cells
+	map<Greenpak4NetlistCell*, uint32_t> cellids;
+	writer.Write(m_cells.size());
+	for(auto it : m_cells)
+	{
+		Greenpak4NetlistCell* cell = it.second;
+		uint32_t id = cellids.size();
+		cellids[cell] = id;
+
+		writer.WriteSymbol(it.first);
+		writer.WriteString(cell->m_type);
+		SaveImageAttributes(cell->m_parameters, writer);
+		SaveImageAttributes(cell->m_attributes, writer);
+		writer.Write(cell->m_connections.size());
+		for(auto& jt : cell->m_connections)
+		{
+			writer.WriteSymbol(jt.first);
+			writer.Write(jt.second.size());
+			for(auto node : jt.second)
+				writer.Write(nodeids[node]);
+		}
+	}
+
+	writer.Write(m_nextNetNumber);
+	writer.Write(nodeids[m_vdd]);
+	writer.Write(nodeids[m_vss]);
+
+	//Net indexes (only valid for the top-level module)
+	writer.Write(indexed ? 1 : 0);
+	if(!indexed)
+		return;
+	for(auto it : m_nodes)
+	{
+		Greenpak4NetlistNode* node = it.second;
+
+		writer.Write(node->m_ports.size());
+		for(auto port : node->m_ports)
+			writer.Write(portids[port]);
+
+		writer.Write(node->m_nodeports.size());
+		for(auto& point : node->m_nodeports)
+		{
+			writer.Write(cellids[point.m_cell]);
+			writer.WriteString(point.m_portname);
+			writer.Write(point.m_nbit);
+			writer.Write(point.m_vector ? 1 : 0);
+			writer.Write(point.m_port ? point.m_port->m_index : GP4NL_NONE);
+		}
+	}
+}
+
+void Greenpak4NetlistModule::SaveImageAttributes(Greenpak4SymbolMap<string>& map, Greenpak4NetlistImageWriter& writer)
+{
+	writer.Write(map.size());
+	for(auto& it : map)
+	{
+		writer.WriteSymbol(it.first);
+		writer.WriteString(it.second);
+	}
+}
+
+bool Greenpak4NetlistModule::LoadImageAttributes(Greenpak4SymbolMap<string>& map, Greenpak4NetlistImageReader& reader)
+{
+	uint32_t count;
+	if(!reader.Read(count))
+		return false;
+	for(uint32_t i=0; i<count; i++)
+	{
+		Greenpak4Symbol key;
+		if(!reader.ReadSymbol(m_parent->GetStringTable(), key))
+			return false;
+		if(!reader.ReadString(map[key]))
+			return false;
+	}
+	return true;
+}
+
+/**
+	@brief Loads everything written by SaveImage()
+
+	Counts come straight from the file, so every index is range checked before use, and nothing is reserved up
+	front based on a count we haven't verified.
+ */
+bool Greenpak4NetlistModule::LoadImage(Greenpak4NetlistImageReader& reader)
+{
+	auto strings = m_parent->GetStringTable();
+	auto arena = m_parent->GetArena();
+
+	if(!LoadImageAttributes(m_attributes, reader))
+		return false;
+
+	//Nodes
+	uint32_t count;
+	vector<Greenpak4NetlistNode*> nodes;
+	if(!reader.Read(count))
+		return false;
+	for(uint32_t i=0; i<count; i++)
+	{
+		uint32_t netnum;
+		if(!reader.Read(netnum))
+			return false;
+		Greenpak4NetlistNode* node = arena->New<Greenpak4NetlistNode>(strings);
+		m_nodes[(int32_t)netnum] = node;
+		nodes.push_back(node);
+
+		if(!reader.ReadString(node->m_name) || !LoadImageAttributes(node->m_attributes, reader))
+			return false;
+
+		uint32_t nsrc;
+		if(!reader.Read(nsrc))
+			return false;
+		for(uint32_t j=0; j<nsrc; j++)
+		{
+			node->m_src_locations.push_back("");
+			if(!reader.ReadString(node->m_src_locations.back()))
+				return false;
+		}
+	}
+
+	//Ports
+	vector<Greenpak4NetlistPort*> ports;
+	if(!reader.Read(count))
+		return false;
+	for(uint32_t i=0; i<count; i++)
+	{
+		Greenpak4Symbol name;
+		uint32_t dir;
+		if(!reader.ReadSymbol(strings, name) || !reader.Read(dir))
+			return false;
+		if(dir > Greenpak4NetlistPort::DIR_INOUT)
+		{
+			reader.Error("invalid port direction");
+			return false;
+		}
+
+		Greenpak4NetlistPort* port = arena->New<Greenpak4NetlistPort>(
+			this, strings->GetString(name), static_cast<Greenpak4NetlistPort::Direction>(dir));
+		m_ports[name] = port;
+		ports.push_back(port);
+
+		uint32_t nbits;
+		if(!reader.Read(nbits))
+			return false;
+		for(uint32_t j=0; j<nbits; j++)
+		{
+			uint32_t index;
+			if(!reader.ReadIndex(index, nodes.size()))
+				return false;
+			port->m_nodes.push_back(nodes[index]);
+		}
+
+		uint32_t net;
+		if(!reader.ReadIndex(net, nodes.size(), true))
+			return false;
+		if(net != GP4NL_NONE)
+			port->m_net = nodes[net];
+	}
+
+	//Net names
+	if(!reader.Read(count))
+		return false;
+	for(uint32_t i=0; i<count; i++)
+	{
+		Greenpak4Symbol name;
+		uint32_t index;
+		if(!reader.ReadSymbol(strings, name) || !reader.ReadIndex(index, nodes.size(), true))
+			return false;
+		m_nets[name] = (index == GP4NL_NONE) ? NULL : nodes[index];
+	}
+
+	//Cells
+	vector<Greenpak4NetlistCell*> cells;
+	if(!reader.Read(count))
+		return false;
+	for(uint32_t i=0; i<count; i++)
+	{
+		Greenpak4Symbol name;
+		string type;
+		if(!reader.ReadSymbol(strings, name) || !reader.ReadString(type))
+			return false;
+
+		Greenpak4NetlistCell* cell = arena->New<Greenpak4NetlistCell>(this);
+		cell->m_name = strings->GetString(name);
+		cell->SetType(type);
+		m_cells[name] = cell;
+		cells.push_back(cell);
+
+		if(!LoadImageAttributes(cell->m_parameters, reader) || !LoadImageAttributes(cell->m_attributes, reader))
+			return false;
+
+		uint32_t nconns;
+		if(!reader.Read(nconns))
+			return false;
+		for(uint32_t j=0; j<nconns; j++)
+		{
+			Greenpak4Symbol port;
+			uint32_t nbits;
+			if(!reader.ReadSymbol(strings, port) || !reader.Read(nbits))
+				return false;
+			auto& net = cell->m_connections[port];
+			for(uint32_t k=0; k<nbits; k++)
+			{
+				uint32_t index;
+				if(!reader.ReadIndex(index, nodes.size()))
+					return false;
+				net.push_back(nodes[index]);
+			}
+		}
+	}
+
+	uint32_t nextnet;
+	uint32_t vdd;
+	uint32_t vss;
+	if(!reader.Read(nextnet) || !reader.ReadIndex(vdd, nodes.size()) || !reader.ReadIndex(vss, nodes.size()))
+		return false;
+	m_nextNetNumber = (int32_t)nextnet;
+	m_vdd = nodes[vdd];
+	m_vss = nodes[vss];
+
+	//Net indexes, if present
+	uint32_t indexed;
+	if(!reader.Read(indexed))
+		return false;
+	if(!indexed)
+		return true;
+	for(auto node : nodes)
+	{
+		uint32_t nports;
+		if(!reader.Read(nports))
+			return false;
+		for(uint32_t i=0; i<nports; i++)
+		{
+			uint32_t index;
+			if(!reader.ReadIndex(index, ports.size()))
+				return false;
+			node->m_ports.push_back(ports[index]);
+		}
+
+		uint32_t npoints;
+		if(!reader.Read(npoints))
+			return false;
+		for(uint32_t i=0; i<npoints; i++)
+		{
+			uint32_t index;
+			string portname;
+			uint32_t nbit;
+			uint32_t vector;
+			uint32_t pindex;
+			if(!reader.ReadIndex(index, cells.size()) || !reader.ReadString(portname) || !reader.Read(nbit) ||
+				!reader.Read(vector) || !reader.Read(pindex) )
+			{
+				return false;
+			}
+
+			//Primitive port, by index into the cell's port table
+			Greenpak4NetlistCell* cell = cells[index];
+			const Greenpak4PrimitivePort* pport = NULL;
+			if(pindex != GP4NL_NONE)
+			{
+				if( (cell->m_primitive == NULL) || (pindex >= cell->m_primitive->m_portCount) )
+				{
+					reader.Error("primitive port index out of range");
+					return false;
+				}
+				pport = &cell->m_primitive->m_ports[pindex];
+			}
+
+			node->m_nodeports.push_back(Greenpak4NetlistNodePoint(cell, portname, nbit, vector != 0, pport));
+		}
+	}
+
+	return true;
 }
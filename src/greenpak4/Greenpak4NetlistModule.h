@@ -21,11 +21,13 @@
 
 #include <string>
 #include <vector>
-#include <json-c/json.h>
 
 class Greenpak4Netlist;
 class Greenpak4NetlistPort;
 class Greenpak4NetlistNode;
+class Greenpak4JSONReader;
+class Greenpak4NetlistImageReader;
+class Greenpak4NetlistImageWriter;
 
 /**
 	@brief A single module in a Greenpak4Netlist
@@ -33,7 +35,8 @@ class Greenpak4NetlistNode;
 class Greenpak4NetlistModule
 {
 public:
-	Greenpak4NetlistModule(Greenpak4Netlist* parent, std::string name, json_object* object);
+	Greenpak4NetlistModule(Greenpak4Netlist* parent, std::string name, Greenpak4JSONReader& reader);
+	Greenpak4NetlistModule(Greenpak4Netlist* parent, std::string name, Greenpak4NetlistImageReader& reader);
 	virtual ~Greenpak4NetlistModule();
 
 	Greenpak4NetlistNode* GetNode(int32_t netnum);
@@ -41,11 +44,12 @@ public:
 	std::string GetName()
 	{ return m_name; }
 
-	std::map<std::string, std::string> m_attributes;
+	Greenpak4SymbolMap<std::string> m_attributes;
 
-	typedef std::map<std::string, Greenpak4NetlistPort*> portmap;
-	typedef std::map<std::string, Greenpak4NetlistCell*> cellmap;
-	typedef std::map<std::string, Greenpak4NetlistNode*> netmap;
+	typedef Greenpak4SymbolMap<Greenpak4NetlistPort*> portmap;
+	typedef Greenpak4SymbolMap<Greenpak4NetlistCell*> cellmap;
+	typedef Greenpak4SymbolMap<Greenpak4NetlistNode*> netmap;
+	typedef std::map<int32_t, Greenpak4NetlistNode*> nodemap;
 
 	portmap::iterator port_begin()
 	{ return m_ports.begin(); }
@@ -59,6 +63,13 @@ public:
 	cellmap::iterator cell_end()
 	{ return m_cells.end(); }
 
+	//Every node, including ones with no name
+	nodemap::iterator node_begin()
+	{ return m_nodes.begin(); }
+
+	nodemap::iterator node_end()
+	{ return m_nodes.end(); }
+
 	netmap::iterator net_begin()
 	{ return m_nets.begin(); }
 
@@ -66,13 +77,31 @@ public:
 	{ return m_nets.end(); }
 
 	bool HasNet(std::string name)
-	{ return (m_nets.find(name) != m_nets.end()); }
+	{ return m_nets.contains(name); }
 
 	Greenpak4NetlistNode* GetNet(std::string name)
-	{ return m_nets[name]; }
+	{
+		auto it = m_nets.find(name);
+		if(it == m_nets.end())
+			return NULL;
+		return it->second;
+	}
+
+	Greenpak4NetlistCell* GetCell(std::string name)
+	{
+		auto it = m_cells.find(name);
+		if(it == m_cells.end())
+			return NULL;
+		return it->second;
+	}
 
 	Greenpak4NetlistPort* GetPort(std::string name)
-	{ return m_ports[name]; }
+	{
+		auto it = m_ports.find(name);
+		if(it == m_ports.end())
+			return NULL;
+		return it->second;
+	}
 
 	Greenpak4Netlist* GetNetlist()
 	{ return m_parent; }
@@ -81,6 +110,14 @@ public:
 	void AddCell(Greenpak4NetlistCell* cell)
 	{ m_cells[cell->m_name] = cell; }
 
+	//Remove a cell (used by the netlist optimizer). The cell still belongs to the arena, so pointers to it stay valid.
+	void RemoveCell(Greenpak4NetlistCell* cell)
+	{
+		auto it = m_cells.find(cell->m_name);
+		if( (it != m_cells.end()) && (it->second == cell) )
+			m_cells.erase(it);
+	}
+
 	//Add an extra net (used by make_graphs to add inferred VREFs etc)
 	void AddNet(Greenpak4NetlistNode* net)
 	{
@@ -92,6 +129,9 @@ public:
 	bool Validate()
 	{ return m_parseOK; }
 
+	//Serialize the module (and, if requested, the net indexes) to a netlist image
+	void SaveImage(Greenpak4NetlistImageWriter& writer, bool indexed);
+
 protected:
 	Greenpak4Netlist* m_parent;
 
@@ -103,15 +143,19 @@ protected:
 
 	std::string m_name;
 
-	void LoadAttributes(json_object* object);
-	void LoadNetName(std::string name, json_object* object);
-	void LoadNetAttributes(Greenpak4NetlistNode* net, json_object* object);
-	void LoadCell(std::string name, json_object* object);
-	void LoadCellAttributes(Greenpak4NetlistCell* cell, json_object* object);
-	void LoadCellParameters(Greenpak4NetlistCell* cell, json_object* object);
-	void LoadCellConnections(Greenpak4NetlistCell* cell, json_object* object);
+	void LoadAttributes(Greenpak4JSONReader& reader);
+	void LoadNetName(std::string name, Greenpak4JSONReader& reader);
+	void LoadNetAttributes(std::vector<Greenpak4NetlistNode*>& nodes, Greenpak4JSONReader& reader);
+	void LoadCell(std::string name, Greenpak4JSONReader& reader);
+	void LoadCellAttributes(Greenpak4NetlistCell* cell, Greenpak4JSONReader& reader);
+	void LoadCellParameters(Greenpak4NetlistCell* cell, Greenpak4JSONReader& reader);
+	void LoadCellConnections(Greenpak4NetlistCell* cell, Greenpak4JSONReader& reader);
+
+	bool LoadImage(Greenpak4NetlistImageReader& reader);
+	bool LoadImageAttributes(Greenpak4SymbolMap<std::string>& map, Greenpak4NetlistImageReader& reader);
+	void SaveImageAttributes(Greenpak4SymbolMap<std::string>& map, Greenpak4NetlistImageWriter& writer);
 
-	std::map<int32_t, Greenpak4NetlistNode*> m_nodes;
+	nodemap m_nodes;
 	portmap m_ports;
 	netmap m_nets;
 	cellmap m_cells;
@@ -21,17 +21,24 @@
 
 class Greenpak4NetlistCell;
 class Greenpak4NetlistPort;
+struct Greenpak4PrimitivePort;
 
 ///A single scalar wire in the netlist
 class Greenpak4NetlistNodePoint
 {
 public:
 
-	Greenpak4NetlistNodePoint(Greenpak4NetlistCell* cell, std::string port, unsigned int nbit, bool vector)
+	Greenpak4NetlistNodePoint(
+		Greenpak4NetlistCell* cell,
+		std::string port,
+		unsigned int nbit,
+		bool vector,
+		const Greenpak4PrimitivePort* pport = NULL)
 		: m_cell(cell)
 		, m_portname(port)
 		, m_nbit(nbit)
 		, m_vector(vector)
+		, m_port(pport)
 	{}
 
 	bool IsNull()
@@ -41,6 +48,9 @@ public:
 	std::string m_portname;
 	unsigned int m_nbit;
 	bool m_vector;
+
+	///The primitive port we connect to (resolved once at indexing time, NULL if not a primitive)
+	const Greenpak4PrimitivePort* m_port;
 };
 
 //A single named node in the netlist (may be a wire or part of a bus)
@@ -48,18 +58,23 @@ class Greenpak4NetlistNode
 {
 public:
 
-	Greenpak4NetlistNode();
+	Greenpak4NetlistNode(Greenpak4StringTable* strings);
 
 	std::string m_name;
 
 	//Attributes
-	std::map<std::string, std::string> m_attributes;
+	Greenpak4SymbolMap<std::string> m_attributes;
 
 	bool HasAttribute(std::string name)
-	{ return (m_attributes.find(name) != m_attributes.end() ); }
+	{ return m_attributes.contains(name); }
 
 	std::string GetAttribute(std::string name)
-	{ return m_attributes[name]; }
+	{
+		auto it = m_attributes.find(name);
+		if(it == m_attributes.end())
+			return "";
+		return it->second;
+	}
 
 	//Source file locations
 	std::vector<std::string> m_src_locations;
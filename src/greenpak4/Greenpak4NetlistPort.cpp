@@ -21,35 +21,33 @@
 
 using namespace std;
 
-Greenpak4NetlistNode::Greenpak4NetlistNode()
-	: m_driver(NULL, "", -1, false)
+Greenpak4NetlistNode::Greenpak4NetlistNode(Greenpak4StringTable* strings)
+	: m_attributes(strings)
+	, m_driver(NULL, "", -1, false)
 {
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Construction / destruction
 
-Greenpak4NetlistPort::Greenpak4NetlistPort(Greenpak4NetlistModule* module, std::string name, json_object* object)
-	: Greenpak4NetlistEntity(name)
+Greenpak4NetlistPort::Greenpak4NetlistPort(Greenpak4NetlistModule* module, std::string name, Greenpak4JSONReader& reader)
+	: Greenpak4NetlistEntity(KIND_PORT, name)
 	, m_direction(DIR_INPUT)
 	, m_module(module)
 	, m_net(NULL)
 	, m_parnode(NULL)
 	, m_parseOK(true)
 {
-	json_object_iterator end = json_object_iter_end(object);
-	for(json_object_iterator it = json_object_iter_begin(object);
-		!json_object_iter_equal(&it, &end);
-		json_object_iter_next(&it))
-	{
-		//See what we got
-		string name = json_object_iter_peek_name(&it);
-		json_object* child = json_object_iter_peek_value(&it);
+	reader.BeginObject();
 
+	string key;
+	string str;
+	while(reader.NextKey(key))
+	{
 		//Direction should be a string from the enumerated list
-		if(name == "direction")
+		if(key == "direction")
 		{
-			if(!json_object_is_type(child, json_type_string))
+			if(reader.PeekType() != Greenpak4JSONReader::TYPE_STRING)
 			{
 				LogError("Port direction should be of type string but isn't\n");
 				m_parseOK = false;
@@ -57,7 +55,8 @@ Greenpak4NetlistPort::Greenpak4NetlistPort(Greenpak4NetlistModule* module, std::
 			}
 
 			//See what the direction is
-			string str = json_object_get_string(child);
+			if(!reader.ReadString(str))
+				break;
 			if(str == "input")
 				m_direction = Greenpak4NetlistPort::DIR_INPUT;
 			else if(str == "output")
@@ -73,9 +72,9 @@ Greenpak4NetlistPort::Greenpak4NetlistPort(Greenpak4NetlistModule* module, std::
 		}
 
 		//List of nodes in the object (should be an array)
-		else if(name == "bits")
+		else if(key == "bits")
 		{
-			if(!json_object_is_type(child, json_type_array))
+			if(reader.PeekType() != Greenpak4JSONReader::TYPE_ARRAY)
 			{
 				LogError("Port bits (for module %s, port %s) should be of type array but isn't\n",
 					module->GetName().c_str(), name.c_str());
@@ -84,30 +83,45 @@ Greenpak4NetlistPort::Greenpak4NetlistPort(Greenpak4NetlistModule* module, std::
 			}
 
 			//Walk the array
-			int len = json_object_array_length(child);
-			for(int i=0; i<len; i++)
+			reader.BeginArray();
+			while(reader.NextElement())
 			{
-				json_object* jnode = json_object_array_get_idx(child, i);
-				if(!json_object_is_type(jnode, json_type_int))
+				if(reader.PeekType() != Greenpak4JSONReader::TYPE_NUMBER)
 				{
 					LogError("Net number of port \"%s\" should be of type integer but isn't\n",
 						m_name.c_str());
 					m_parseOK = false;
-				return;
+					return;
 				}
 
-				m_nodes.push_back(module->GetNode(json_object_get_int(jnode)));
+				int32_t netnum;
+				if(!reader.ReadInt(netnum))
+					break;
+				m_nodes.push_back(module->GetNode(netnum));
 			}
 		}
 
 		//Garbage
 		else
 		{
-			LogError("Unknown JSON blob \"%s\" under module port list\n", name.c_str());
+			LogError("Unknown JSON blob \"%s\" under module port list\n", key.c_str());
 			m_parseOK = false;
 			return;
 		}
 	}
+
+	if(reader.Failed())
+		m_parseOK = false;
+}
+
+Greenpak4NetlistPort::Greenpak4NetlistPort(Greenpak4NetlistModule* module, std::string name, Direction dir)
+	: Greenpak4NetlistEntity(KIND_PORT, name)
+	, m_direction(dir)
+	, m_module(module)
+	, m_net(NULL)
+	, m_parnode(NULL)
+	, m_parseOK(true)
+{
 }
 
 Greenpak4NetlistPort::~Greenpak4NetlistPort()
@@ -21,13 +21,12 @@
 
 #include <string>
 #include <vector>
-#include <json-c/json.h>
 
 //A module port (attached to one or more nodes)
 class Greenpak4NetlistPort : public Greenpak4NetlistEntity
 {
 public:
-	Greenpak4NetlistPort(Greenpak4NetlistModule* module, std::string name, json_object* object);
+	Greenpak4NetlistPort(Greenpak4NetlistModule* module, std::string name, Greenpak4JSONReader& reader);
 	virtual ~Greenpak4NetlistPort();
 
 	enum Direction
@@ -36,6 +35,10 @@ public:
 		DIR_OUTPUT,
 		DIR_INOUT
 	};
+
+	//Create a port with no nodes yet (used when loading netlist images)
+	Greenpak4NetlistPort(Greenpak4NetlistModule* module, std::string name, Direction dir);
+
 	Direction m_direction;
 
 	Greenpak4NetlistModule* m_module;
@@ -57,4 +60,7 @@ protected:
 	bool m_parseOK;
 };
 
+Greenpak4NetlistPort* Greenpak4NetlistEntity::AsPort()
+{ return (m_kind == KIND_PORT) ? static_cast<Greenpak4NetlistPort*>(this) : NULL; }
+
 #endif
@@ -27,7 +27,7 @@ using namespace std;
 Greenpak4PGA::Greenpak4PGA(
 		Greenpak4Device* device,
 		unsigned int cbase)
-		: Greenpak4BitstreamEntity(device, 0, -1, -1, cbase)
+		: Greenpak4BitstreamEntity(KIND_PGA, device, 0, -1, -1, cbase)
 		, m_vinp(device->GetGround())
 		, m_vinn(device->GetGround())
 		, m_vinsel(device->GetPower())
@@ -50,33 +50,39 @@ string Greenpak4PGA::GetDescription()
 	return "PGA0";
 }
 
-vector<string> Greenpak4PGA::GetInputPorts() const
+static const Greenpak4EntityPort g_pgaPorts[] =
 {
-	vector<string> r;
-	//no general fabric inputs
-	return r;
+	{ "VIN_P",    false },
+	{ "VIN_N",    false },
+	{ "VIN_SEL",  false },
+	{ "VOUT",     true },
+};
+static const Greenpak4PortTable g_pgaPortTable = PORT_TABLE(g_pgaPorts);
+
+const Greenpak4PortTable& Greenpak4PGA::GetPortTable() const
+{
+	return g_pgaPortTable;
 }
 
-void Greenpak4PGA::SetInput(string port, Greenpak4EntityOutput src)
+uint32_t Greenpak4PGA::GetFabricPortMask() const
 {
-	if(port == "VIN_P")
+	//no general fabric ports
+	return 0;
+}
+
+void Greenpak4PGA::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
+{
+	if(port == PORT_VIN_P)
 		m_vinp = src;
-	else if(port == "VIN_N")
+	else if(port == PORT_VIN_N)
 		m_vinn = src;
-	else if(port == "VIN_SEL")
+	else if(port == PORT_VIN_SEL)
 		m_vinsel = src;
 
 	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-vector<string> Greenpak4PGA::GetOutputPorts() const
-{
-	vector<string> r;
-	//VOUT is not general fabric routing
-	return r;
-}
-
-unsigned int Greenpak4PGA::GetOutputNetNumber(string /*port*/)
+unsigned int Greenpak4PGA::GetOutputNetNumberByID(unsigned int /*port*/)
 {
 	//no general fabric outputs
 	return -1;
@@ -93,7 +99,7 @@ bool Greenpak4PGA::IsUsed()
 bool Greenpak4PGA::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -158,14 +164,47 @@ bool Greenpak4PGA::CommitChanges()
 	return true;
 }
 
-bool Greenpak4PGA::Load(bool* /*bitstream*/)
+bool Greenpak4PGA::Load(const Greenpak4Bitstream& bitstream)
 {
-	//TODO: Do our inputs
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Configuration
+
+	//Input mux: pin 16 or Vdd
+	if(bitstream[m_configBase + 1])
+		m_vinsel = m_device->GetIOB(16)->GetOutput("OUT");
+	else
+		m_vinsel = m_device->GetPower();
+
+	if(!bitstream[m_configBase + 2])
+		m_inputMode = MODE_SINGLE;
+	else if(!bitstream[m_configBase + 7])
+		m_inputMode = MODE_DIFF;
+	else
+		m_inputMode = MODE_PDIFF;
+
+	static const unsigned int gains[] = { 25, 50, 100, 200, 400, 800, 1600 };
+	unsigned int gsel = bitstream.GetField(m_configBase + 3, 3);
+	if(gsel >= sizeof(gains) / sizeof(gains[0]))
+	{
+		LogError("PGA gain selector %u not implemented\n", gsel);
+		return false;
+	}
+	m_gain = gains[gsel];
+
+	m_hasNonADCLoads = bitstream[m_configBase + 6];
+
+	//Inputs are dedicated routing with no selector, so assume the pins
+	//(a constant Vdd on VIN_P is indistinguishable from pin 8)
+	m_vinp = m_device->GetIOB(8)->GetOutput("OUT");
+	if(m_inputMode == MODE_SINGLE)
+		m_vinn = m_device->GetGround();
+	else
+		m_vinn = m_device->GetIOB(9)->GetOutput("OUT");
+
+	return true;
 }
 
-bool Greenpak4PGA::Save(bool* bitstream)
+bool Greenpak4PGA::Save(Greenpak4Bitstream& bitstream)
 {
 	/*
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -328,3 +367,47 @@ bool Greenpak4PGA::Save(bool* bitstream)
 
 	return true;
 }
+
+void Greenpak4PGA::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	map.AddField(this, "VIN_DAC", m_configBase + 0, 1);
+	map.AddField(this, "VIN_SEL", m_configBase + 1, 1);
+	map.AddField(this, "INPUT_MODE", m_configBase + 2, 1);
+	map.AddField(this, "GAIN", m_configBase + 3, 3);
+	map.AddField(this, "PWREN", m_configBase + 6, 1);
+	map.AddField(this, "PDIFF", m_configBase + 7, 1);
+	map.AddField(this, "ADC_PWREN", m_configBase + 70, 1);
+	map.AddField(this, "OUT_EN", m_configBase + 71, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4PGA::GetInput(string port)
+{
+	if(port == "VIN_P")
+		return m_vinp;
+	else if(port == "VIN_N")
+		return m_vinn;
+	else if(port == "VIN_SEL")
+		return m_vinsel;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4PGA::GetPrimitiveName()
+{
+	return "GP_PGA";
+}
+
+map<string, string> Greenpak4PGA::GetParameters()
+{
+	static const char* modes[] = { "\"SINGLE\"", "\"DIFF\"", "\"PDIFF\"" };
+
+	map<string, string> params;
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%u.%02u", m_gain / 100, m_gain % 100);
+	params["GAIN"] = buf;
+	params["INPUT_MODE"] = modes[m_inputMode];
+	return params;
+}
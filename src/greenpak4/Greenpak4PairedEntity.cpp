@@ -30,12 +30,47 @@ Greenpak4PairedEntity::Greenpak4PairedEntity(
 	unsigned int select,
 	Greenpak4BitstreamEntity* a,
 	Greenpak4BitstreamEntity* b)
-	: Greenpak4BitstreamEntity(device, matrix, -1, -1, select)
+	: Greenpak4BitstreamEntity(KIND_PAIRED, device, matrix, -1, -1, select)
 	, m_select(select)
 	, m_activeEntity(false)
 {
 	m_entities[0] = a;
 	m_entities[1] = b;
+
+	//Our ports are the union of both entities' ports.
+	//The names live in the entities' static tables so we can just point to them.
+	for(int output=0; output<2; output++)
+	{
+		map<string, const char*> names;
+		for(auto e : m_entities)
+		{
+			auto& table = e->GetPortTable();
+			for(unsigned int i=0; i<table.m_count; i++)
+			{
+				if(table.m_ports[i].m_output == (output != 0))
+					names[table.m_ports[i].m_name] = table.m_ports[i].m_name;
+			}
+		}
+		for(auto it : names)
+			m_ports.push_back(Greenpak4EntityPort{it.second, (output != 0)});
+	}
+	m_portTable.m_ports = &m_ports[0];
+	m_portTable.m_count = m_ports.size();
+	if(m_portTable.m_count > 32)
+		LogFatal("Greenpak4PairedEntity: too many ports for the fabric mask\n");
+
+	//Map our IDs to theirs, and a port is general fabric if it is in either entity
+	m_fabricMask = 0;
+	for(unsigned int i=0; i<m_portTable.m_count; i++)
+	{
+		for(unsigned int j=0; j<2; j++)
+		{
+			unsigned int id = m_entities[j]->LookupPort(m_ports[i].m_name);
+			m_portMap[j].push_back(id);
+			if( (id < 32) && (m_entities[j]->GetFabricPortMask() & (1 << id)) )
+				m_fabricMask |= (1 << i);
+		}
+	}
 }
 
 Greenpak4PairedEntity::~Greenpak4PairedEntity()
@@ -53,50 +88,33 @@ string Greenpak4PairedEntity::GetDescription()
 	return GetActiveEntity()->GetDescription();
 }
 
-vector<string> Greenpak4PairedEntity::GetInputPorts() const
+const Greenpak4PortTable& Greenpak4PairedEntity::GetPortTable() const
 {
-	auto pa = m_entities[0]->GetInputPorts();
-	auto pb = m_entities[1]->GetInputPorts();
-
-	//return the union of both devices' ports
-	set<string> p;
-	for(auto s : pa)
-		p.emplace(s);
-	for(auto s : pb)
-		p.emplace(s);
-
-	vector<string> r;
-	for(auto s : p)
-		r.push_back(s);
-	return r;
+	return m_portTable;
 }
 
-void Greenpak4PairedEntity::SetInput(string port, Greenpak4EntityOutput src)
+uint32_t Greenpak4PairedEntity::GetFabricPortMask() const
 {
-	GetActiveEntity()->SetInput(port, src);
+	return m_fabricMask;
 }
 
-vector<string> Greenpak4PairedEntity::GetOutputPorts() const
+void Greenpak4PairedEntity::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	auto pa = m_entities[0]->GetOutputPorts();
-	auto pb = m_entities[1]->GetOutputPorts();
-
-	//return the union of both devices' ports
-	set<string> p;
-	for(auto s : pa)
-		p.emplace(s);
-	for(auto s : pb)
-		p.emplace(s);
-
-	vector<string> r;
-	for(auto s : p)
-		r.push_back(s);
-	return r;
+	if(port >= m_portTable.m_count)
+		return;
+	unsigned int id = m_portMap[m_activeEntity][port];
+	if(id != PORT_NONE)
+		GetActiveEntity()->SetInputByID(id, src);
 }
 
-unsigned int Greenpak4PairedEntity::GetOutputNetNumber(string port)
+unsigned int Greenpak4PairedEntity::GetOutputNetNumberByID(unsigned int port)
 {
-	return GetActiveEntity()->GetOutputNetNumber(port);
+	if(port >= m_portTable.m_count)
+		return -1;
+	unsigned int id = m_portMap[m_activeEntity][port];
+	if(id == PORT_NONE)
+		return -1;
+	return GetActiveEntity()->GetOutputNetNumberByID(id);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -126,7 +144,7 @@ bool Greenpak4PairedEntity::SetEntityType(string type)
 bool Greenpak4PairedEntity::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -138,13 +156,13 @@ bool Greenpak4PairedEntity::CommitChanges()
 	return GetActiveEntity()->CommitChanges();
 }
 
-bool Greenpak4PairedEntity::Load(bool* bitstream)
+bool Greenpak4PairedEntity::Load(const Greenpak4Bitstream& bitstream)
 {
 	m_activeEntity = bitstream[m_configBase];
 	return GetActiveEntity()->Load(bitstream);
 }
 
-bool Greenpak4PairedEntity::Save(bool* bitstream)
+bool Greenpak4PairedEntity::Save(Greenpak4Bitstream& bitstream)
 {
 	//Write the select bit
 	bitstream[m_configBase] = m_activeEntity;
@@ -152,3 +170,32 @@ bool Greenpak4PairedEntity::Save(bool* bitstream)
 	//and the config data
 	return GetActiveEntity()->Save(bitstream);
 }
+
+void Greenpak4PairedEntity::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	map.AddField(this, "MODE", m_configBase, 1);
+
+	//Only one of the two is ever configured, so they share everything else
+	map.BeginShared();
+	m_entities[0]->RegisterBitFields(map);
+	m_entities[1]->RegisterBitFields(map);
+	map.EndShared();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4PairedEntity::GetInput(string port)
+{
+	return GetActiveEntity()->GetInput(port);
+}
+
+string Greenpak4PairedEntity::GetPrimitiveName()
+{
+	return GetActiveEntity()->GetPrimitiveName();
+}
+
+map<string, string> Greenpak4PairedEntity::GetParameters()
+{
+	return GetActiveEntity()->GetParameters();
+}
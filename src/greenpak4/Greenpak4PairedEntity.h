@@ -36,19 +36,24 @@ public:
 	virtual ~Greenpak4PairedEntity();
 
 	//Serialization
-	virtual bool Load(bool* bitstream);
-	virtual bool Save(bool* bitstream);
+	virtual bool Load(const Greenpak4Bitstream& bitstream);
+	virtual bool Save(Greenpak4Bitstream& bitstream);
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map);
 
 	virtual std::string GetDescription();
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
-	virtual unsigned int GetOutputNetNumber(std::string port);
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
 	Greenpak4BitstreamEntity* GetEntity(std::string type)
 	{ return m_entities[m_emap[type]]; }
 
@@ -71,6 +76,14 @@ protected:
 
 	//The underlying entities
 	Greenpak4BitstreamEntity* m_entities[2];
+
+	//Union of both entities' ports, in name order (inputs first)
+	std::vector<Greenpak4EntityPort> m_ports;
+	Greenpak4PortTable m_portTable;
+	uint32_t m_fabricMask;
+
+	//Map from our port IDs to each entity's port IDs (PORT_NONE if it lacks the port)
+	std::vector<unsigned int> m_portMap[2];
 };
 
 #endif
@@ -30,7 +30,7 @@ Greenpak4PatternGenerator::Greenpak4PatternGenerator(
 	unsigned int ibase,
 	unsigned int oword,
 	unsigned int cbase)
-	: Greenpak4BitstreamEntity(device,  matrix, ibase, oword, cbase)
+	: Greenpak4BitstreamEntity(KIND_PATTERN_GENERATOR, device, matrix, ibase, oword, cbase)
 	, m_clk(device->GetGround())
 	, m_reset(device->GetGround())
 	, m_patternLen(2)
@@ -49,9 +49,27 @@ string Greenpak4PatternGenerator::GetDescription()
 	return "PGEN_0";
 }
 
-unsigned int Greenpak4PatternGenerator::GetOutputNetNumber(string port)
+static const Greenpak4EntityPort g_pgenPorts[] =
 {
-	if(port == "OUT")
+	{ "nRST",  false },
+	{ "CLK",   false },
+	{ "OUT",   true },
+};
+static const Greenpak4PortTable g_pgenPortTable = PORT_TABLE(g_pgenPorts);
+
+const Greenpak4PortTable& Greenpak4PatternGenerator::GetPortTable() const
+{
+	return g_pgenPortTable;
+}
+
+uint32_t Greenpak4PatternGenerator::GetFabricPortMask() const
+{
+	return (1 << PORT_NRST) | (1 << PORT_CLK) | (1 << PORT_OUT);
+}
+
+unsigned int Greenpak4PatternGenerator::GetOutputNetNumberByID(unsigned int port)
+{
+	if(port == PORT_OUT)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -63,13 +81,14 @@ unsigned int Greenpak4PatternGenerator::GetOutputNetNumber(string port)
 bool Greenpak4PatternGenerator::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
-	for(auto x : ncell->m_parameters)
+	for(auto& x : ncell->m_parameters)
 	{
-		if(x.first == "PATTERN_DATA")
+		const string& name = ncell->m_parameters.GetName(x.first);
+		if(name == "PATTERN_DATA")
 		{
 			//convert to bit array format
 			uint32_t truth_table = atoi(x.second.c_str());
@@ -83,7 +102,7 @@ bool Greenpak4PatternGenerator::CommitChanges()
 			}
 		}
 
-		else if(x.first == "PATTERN_LEN")
+		else if(name == "PATTERN_LEN")
 		{
 			m_patternLen = atoi(x.second.c_str());
 			if( (m_patternLen < 2) || (m_patternLen > 16) )
@@ -96,48 +115,49 @@ bool Greenpak4PatternGenerator::CommitChanges()
 		else
 		{
 			LogWarning("Cell \"%s\" has unrecognized parameter %s, ignoring\n",
-				ncell->m_name.c_str(), x.first.c_str());
+				ncell->m_name.c_str(), name.c_str());
 		}
 	}
 
 	return true;
 }
 
-vector<string> Greenpak4PatternGenerator::GetOutputPorts() const
-{
-	vector<string> ret;
-	ret.push_back("OUT");
-	return ret;
-}
-
-
-vector<string> Greenpak4PatternGenerator::GetInputPorts() const
-{
-	vector<string> ret;
-	ret.push_back("nRST");
-	ret.push_back("CLK");
-	return ret;
-}
 
-void Greenpak4PatternGenerator::SetInput(string port, Greenpak4EntityOutput src)
+void Greenpak4PatternGenerator::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	if(port == "CLK")
+	if(port == PORT_CLK)
 		m_clk = src;
 
-	else if(port == "nRST")
+	else if(port == PORT_NRST)
 		m_reset = src;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Serialization
 
-bool Greenpak4PatternGenerator::Load(bool* /*bitstream*/)
+bool Greenpak4PatternGenerator::Load(const Greenpak4Bitstream& bitstream)
 {
-	LogError("unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	//0/1 are unused in PGEN mode
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 2, m_clk))
+		return false;
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 3, m_reset))
+		return false;
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// CONFIGURATION
+
+	for(unsigned int i=0; i<16; i++)
+		m_truthtable[i] = bitstream[m_configBase + i];
+
+	m_patternLen = bitstream.GetField(m_configBase + 16, 4) + 1;
+
+	return true;
 }
 
-bool Greenpak4PatternGenerator::Save(bool* bitstream)
+bool Greenpak4PatternGenerator::Save(Greenpak4Bitstream& bitstream)
 {
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// INPUT BUS
@@ -163,10 +183,53 @@ bool Greenpak4PatternGenerator::Save(bool* bitstream)
 
 	//4-bit counter data
 	int len = m_patternLen - 1;
-	bitstream[m_configBase + 16] = (len & 1) ? true : false;
-	bitstream[m_configBase + 17] = (len & 2) ? true : false;
-	bitstream[m_configBase + 18] = (len & 4) ? true : false;
-	bitstream[m_configBase + 19] = (len & 8) ? true : false;
+	bitstream.SetField(m_configBase + 16, 4, len);
 
 	return true;
 }
+
+void Greenpak4PatternGenerator::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	//Words 0 and 1 are tied off in PGEN mode, they're the LUT's inputs
+	RegisterMatrixSelector(map, "CLK", m_inputBaseWord + 2);
+	RegisterMatrixSelector(map, "nRST", m_inputBaseWord + 3);
+
+	map.AddField(this, "PATTERN_DATA", m_configBase + 0, 16);
+	map.AddField(this, "PATTERN_LEN", m_configBase + 16, 4);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4PatternGenerator::GetInput(string port)
+{
+	if(port == "CLK")
+		return m_clk;
+	else if(port == "nRST")
+		return m_reset;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4PatternGenerator::GetPrimitiveName()
+{
+	return "GP_PGEN";
+}
+
+map<string, string> Greenpak4PatternGenerator::GetParameters()
+{
+	unsigned int pattern = 0;
+	for(unsigned int i=0; i<16; i++)
+	{
+		if(m_truthtable[i])
+			pattern |= (1 << i);
+	}
+
+	map<string, string> params;
+	char buf[32];
+	snprintf(buf, sizeof(buf), "16'h%04x", pattern);
+	params["PATTERN_DATA"] = buf;
+	snprintf(buf, sizeof(buf), "%d", m_patternLen);
+	params["PATTERN_LEN"] = buf;
+	return params;
+}
@@ -26,6 +26,14 @@ class Greenpak4PatternGenerator : public Greenpak4BitstreamEntity
 {
 public:
 
+	///IDs of our ports (indexes into our port table)
+	enum Port
+	{
+		PORT_NRST,
+		PORT_CLK,
+		PORT_OUT
+	};
+
 	//Construction / destruction
 	Greenpak4PatternGenerator(
 		Greenpak4Device* device,
@@ -36,18 +44,23 @@ public:
 	virtual ~Greenpak4PatternGenerator();
 
 	//Serialization
-	virtual bool Load(bool* bitstream);
-	virtual bool Save(bool* bitstream);
+	virtual bool Load(const Greenpak4Bitstream& bitstream);
+	virtual bool Save(Greenpak4Bitstream& bitstream);
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
 	virtual std::string GetDescription();
-	virtual unsigned int GetOutputNetNumber(std::string port);
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 protected:
 	Greenpak4EntityOutput m_clk;
@@ -30,7 +30,7 @@ Greenpak4PowerOnReset::Greenpak4PowerOnReset(
 	unsigned int ibase,
 	unsigned int oword,
 	unsigned int cbase)
-	: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+	: Greenpak4BitstreamEntity(KIND_POWER_ON_RESET, device, matrix, ibase, oword, cbase)
 	, m_resetDelay(500)
 {
 	m_dual = new Greenpak4DualEntity(this);
@@ -49,28 +49,30 @@ string Greenpak4PowerOnReset::GetDescription()
 	return "POR0";
 }
 
-vector<string> Greenpak4PowerOnReset::GetInputPorts() const
+static const Greenpak4EntityPort g_porPorts[] =
 {
-	vector<string> r;
-	//no inputs
-	return r;
+	{ "RST_DONE",  true },
+};
+static const Greenpak4PortTable g_porPortTable = PORT_TABLE(g_porPorts);
+
+const Greenpak4PortTable& Greenpak4PowerOnReset::GetPortTable() const
+{
+	return g_porPortTable;
 }
 
-void Greenpak4PowerOnReset::SetInput(string /*port*/, Greenpak4EntityOutput /*src*/)
+uint32_t Greenpak4PowerOnReset::GetFabricPortMask() const
 {
-	//no inputs
+	return (1 << PORT_RST_DONE);
 }
 
-vector<string> Greenpak4PowerOnReset::GetOutputPorts() const
+void Greenpak4PowerOnReset::SetInputByID(unsigned int /*port*/, Greenpak4EntityOutput /*src*/)
 {
-	vector<string> r;
-	r.push_back("RST_DONE");
-	return r;
+	//no inputs
 }
 
-unsigned int Greenpak4PowerOnReset::GetOutputNetNumber(string port)
+unsigned int Greenpak4PowerOnReset::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "RST_DONE")
+	if(port == PORT_RST_DONE)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -82,7 +84,7 @@ unsigned int Greenpak4PowerOnReset::GetOutputNetNumber(string port)
 bool Greenpak4PowerOnReset::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -106,13 +108,13 @@ bool Greenpak4PowerOnReset::CommitChanges()
 	return true;
 }
 
-bool Greenpak4PowerOnReset::Load(bool* /*bitstream*/)
+bool Greenpak4PowerOnReset::Load(const Greenpak4Bitstream& bitstream)
 {
-	LogError("Unimplemented\n");
-	return false;
+	m_resetDelay = bitstream[m_configBase] ? 500 : 4;
+	return true;
 }
 
-bool Greenpak4PowerOnReset::Save(bool* bitstream)
+bool Greenpak4PowerOnReset::Save(Greenpak4Bitstream& bitstream)
 {
 	if(m_resetDelay == 4)
 		bitstream[m_configBase] = false;
@@ -121,3 +123,29 @@ bool Greenpak4PowerOnReset::Save(bool* bitstream)
 
 	return true;
 }
+
+void Greenpak4PowerOnReset::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	map.AddField(this, "POR_TIME", m_configBase, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4PowerOnReset::GetInput(string /*port*/)
+{
+	//no inputs
+	return Greenpak4EntityOutput();
+}
+
+string Greenpak4PowerOnReset::GetPrimitiveName()
+{
+	return "GP_POR";
+}
+
+map<string, string> Greenpak4PowerOnReset::GetParameters()
+{
+	map<string, string> params;
+	params["POR_TIME"] = (m_resetDelay == 500) ? "500" : "4";
+	return params;
+}
@@ -27,7 +27,7 @@ Greenpak4PowerRail::Greenpak4PowerRail(
 	Greenpak4Device* device,
 	unsigned int matrix,
 	unsigned int oword)
-	: Greenpak4BitstreamEntity(device, matrix, 0, oword, 0)
+	: Greenpak4BitstreamEntity(KIND_POWER_RAIL, device, matrix, 0, oword, 0)
 	//Give garbage values to ibase and cbase since we have no inputs or configuration
 {
 	m_dual = new Greenpak4DualEntity(this);
@@ -47,42 +47,49 @@ bool Greenpak4PowerRail::CommitChanges()
 	return true;
 }
 
-bool Greenpak4PowerRail::Load(bool* /*bitstream*/)
+bool Greenpak4PowerRail::Load(const Greenpak4Bitstream& /*bitstream*/)
 {
 	//no error, we have no config to read
 	return true;
 }
 
-bool Greenpak4PowerRail::Save(bool* /*bitstream*/)
+bool Greenpak4PowerRail::Save(Greenpak4Bitstream& /*bitstream*/)
 {
 	return true;
 }
 
+void Greenpak4PowerRail::RegisterBitFields(Greenpak4BitFieldMap& /*map*/)
+{
+	//no configuration
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Accessors
 
-vector<string> Greenpak4PowerRail::GetInputPorts() const
+static const Greenpak4EntityPort g_railPorts[] =
 {
-	vector<string> r;
-	//no inputs
-	return r;
+	{ "OUT",  true },
+};
+static const Greenpak4PortTable g_railPortTable = PORT_TABLE(g_railPorts);
+
+const Greenpak4PortTable& Greenpak4PowerRail::GetPortTable() const
+{
+	return g_railPortTable;
 }
 
-void Greenpak4PowerRail::SetInput(string /*port*/, Greenpak4EntityOutput /*src*/)
+uint32_t Greenpak4PowerRail::GetFabricPortMask() const
 {
-	//no inputs
+	return (1 << PORT_OUT);
 }
 
-vector<string> Greenpak4PowerRail::GetOutputPorts() const
+void Greenpak4PowerRail::SetInputByID(unsigned int /*port*/, Greenpak4EntityOutput /*src*/)
 {
-	vector<string> r;
-	r.push_back("OUT");
-	return r;
+	//no inputs
 }
 
-unsigned int Greenpak4PowerRail::GetOutputNetNumber(std::string port)
+unsigned int Greenpak4PowerRail::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "OUT")
+	if(port == PORT_OUT)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -95,3 +102,25 @@ string Greenpak4PowerRail::GetDescription()
 	else
 		return "VSS0";
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4PowerRail::GetInput(string /*port*/)
+{
+	//no inputs
+	return Greenpak4EntityOutput();
+}
+
+string Greenpak4PowerRail::GetPrimitiveName()
+{
+	if(GetDigitalValue())
+		return "GP_VDD";
+	else
+		return "GP_VSS";
+}
+
+map<string, string> Greenpak4PowerRail::GetParameters()
+{
+	return map<string, string>();
+}
@@ -0,0 +1,207 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#include <Greenpak4.h>
+
+#include <string.h>
+
+using namespace std;
+
+#define IN		Greenpak4NetlistPort::DIR_INPUT
+#define OUT		Greenpak4NetlistPort::DIR_OUTPUT
+#define INOUT	Greenpak4NetlistPort::DIR_INOUT
+
+#define PRIMITIVE(type, name, ports) { type, name, ports, sizeof(ports) / sizeof(ports[0]) }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Port lists
+
+static const Greenpak4PrimitivePort g_2lutPorts[] =
+	{ {0, "IN0", IN, 1}, {1, "IN1", IN, 1}, {2, "OUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_3lutPorts[] =
+	{ {0, "IN0", IN, 1}, {1, "IN1", IN, 1}, {2, "IN2", IN, 1}, {3, "OUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_4lutPorts[] =
+	{ {0, "IN0", IN, 1}, {1, "IN1", IN, 1}, {2, "IN2", IN, 1}, {3, "IN3", IN, 1}, {4, "OUT", OUT, 1} };
+
+static const Greenpak4PrimitivePort g_abufPorts[] =
+	{ {0, "IN", IN, 1}, {1, "OUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_acmpPorts[] =
+	{ {0, "PWREN", IN, 1}, {1, "VIN", IN, 1}, {2, "VREF", IN, 1}, {3, "OUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_bandgapPorts[] =
+	{ {0, "OK", OUT, 1} };
+
+static const Greenpak4PrimitivePort g_countPorts[] =
+	{ {0, "CLK", IN, 1}, {1, "RST", IN, 1}, {2, "OUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_countAdvPorts[] =
+	{ {0, "CLK", IN, 1}, {1, "RST", IN, 1}, {2, "UP", IN, 1}, {3, "KEEP", IN, 1}, {4, "OUT", OUT, 1} };
+
+static const Greenpak4PrimitivePort g_dacPorts[] =
+	{ {0, "DIN", IN, 8}, {1, "VREF", IN, 1}, {2, "VOUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_delayPorts[] =
+	{ {0, "IN", IN, 1}, {1, "OUT", OUT, 1} };
+
+static const Greenpak4PrimitivePort g_dffPorts[] =
+	{ {0, "D", IN, 1}, {1, "CLK", IN, 1}, {2, "Q", OUT, 1} };
+static const Greenpak4PrimitivePort g_dffiPorts[] =
+	{ {0, "D", IN, 1}, {1, "CLK", IN, 1}, {2, "nQ", OUT, 1} };
+static const Greenpak4PrimitivePort g_dffrPorts[] =
+	{ {0, "D", IN, 1}, {1, "CLK", IN, 1}, {2, "nRST", IN, 1}, {3, "Q", OUT, 1} };
+static const Greenpak4PrimitivePort g_dffriPorts[] =
+	{ {0, "D", IN, 1}, {1, "CLK", IN, 1}, {2, "nRST", IN, 1}, {3, "nQ", OUT, 1} };
+static const Greenpak4PrimitivePort g_dffsPorts[] =
+	{ {0, "D", IN, 1}, {1, "CLK", IN, 1}, {2, "nSET", IN, 1}, {3, "Q", OUT, 1} };
+static const Greenpak4PrimitivePort g_dffsiPorts[] =
+	{ {0, "D", IN, 1}, {1, "CLK", IN, 1}, {2, "nSET", IN, 1}, {3, "nQ", OUT, 1} };
+static const Greenpak4PrimitivePort g_dffsrPorts[] =
+	{ {0, "D", IN, 1}, {1, "CLK", IN, 1}, {2, "nSR", IN, 1}, {3, "Q", OUT, 1} };
+static const Greenpak4PrimitivePort g_dffsriPorts[] =
+	{ {0, "D", IN, 1}, {1, "CLK", IN, 1}, {2, "nSR", IN, 1}, {3, "nQ", OUT, 1} };
+
+static const Greenpak4PrimitivePort g_edgedetPorts[] =
+	{ {0, "IN", IN, 1}, {1, "OUT", OUT, 1} };
+
+static const Greenpak4PrimitivePort g_ibufPorts[] =
+	{ {0, "IN", IN, 1}, {1, "OUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_iobufPorts[] =
+	{ {0, "IN", IN, 1}, {1, "OE", IN, 1}, {2, "OUT", OUT, 1}, {3, "IO", INOUT, 1} };
+static const Greenpak4PrimitivePort g_obufPorts[] =
+	{ {0, "IN", IN, 1}, {1, "OUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_obuftPorts[] =
+	{ {0, "IN", IN, 1}, {1, "OE", IN, 1}, {2, "OUT", OUT, 1} };
+
+static const Greenpak4PrimitivePort g_invPorts[] =
+	{ {0, "IN", IN, 1}, {1, "OUT", OUT, 1} };
+
+static const Greenpak4PrimitivePort g_lfoscPorts[] =
+	{ {0, "PWRDN", IN, 1}, {1, "CLKOUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_oscPorts[] =
+	{ {0, "PWRDN", IN, 1}, {1, "CLKOUT_HARDIP", OUT, 1}, {2, "CLKOUT_FABRIC", OUT, 1} };
+
+static const Greenpak4PrimitivePort g_pgaPorts[] =
+	{ {0, "VIN_P", IN, 1}, {1, "VIN_N", IN, 1}, {2, "VIN_SEL", IN, 1}, {3, "VOUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_pgenPorts[] =
+	{ {0, "nRST", IN, 1}, {1, "CLK", IN, 1}, {2, "OUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_porPorts[] =
+	{ {0, "RST_DONE", OUT, 1} };
+static const Greenpak4PrimitivePort g_pwrctlPorts[] =
+	{ {0, "PWRDET", OUT, 1} };
+static const Greenpak4PrimitivePort g_shregPorts[] =
+	{ {0, "nRST", IN, 1}, {1, "CLK", IN, 1}, {2, "IN", IN, 1}, {3, "OUTA", OUT, 1}, {4, "OUTB", OUT, 1} };
+static const Greenpak4PrimitivePort g_sysresetPorts[] =
+	{ {0, "RST", IN, 1} };
+static const Greenpak4PrimitivePort g_railPorts[] =
+	{ {0, "OUT", OUT, 1} };
+static const Greenpak4PrimitivePort g_vrefPorts[] =
+	{ {0, "VIN", IN, 1}, {1, "VOUT", OUT, 1} };
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The library itself
+
+//Must be kept sorted by name (strcmp order) for the binary search in Greenpak4LookupPrimitive(),
+//and in the same order as Greenpak4PrimitiveType
+static const Greenpak4Primitive g_primitives[] =
+{
+	PRIMITIVE(GP_PRIM_2LUT,			"GP_2LUT",			g_2lutPorts),
+	PRIMITIVE(GP_PRIM_3LUT,			"GP_3LUT",			g_3lutPorts),
+	PRIMITIVE(GP_PRIM_4LUT,			"GP_4LUT",			g_4lutPorts),
+	PRIMITIVE(GP_PRIM_ABUF,			"GP_ABUF",			g_abufPorts),
+	PRIMITIVE(GP_PRIM_ACMP,			"GP_ACMP",			g_acmpPorts),
+	PRIMITIVE(GP_PRIM_BANDGAP,		"GP_BANDGAP",		g_bandgapPorts),
+	PRIMITIVE(GP_PRIM_COUNT14,		"GP_COUNT14",		g_countPorts),
+	PRIMITIVE(GP_PRIM_COUNT14_ADV,	"GP_COUNT14_ADV",	g_countAdvPorts),
+	PRIMITIVE(GP_PRIM_COUNT8,		"GP_COUNT8",		g_countPorts),
+	PRIMITIVE(GP_PRIM_COUNT8_ADV,	"GP_COUNT8_ADV",	g_countAdvPorts),
+	PRIMITIVE(GP_PRIM_DAC,			"GP_DAC",			g_dacPorts),
+	PRIMITIVE(GP_PRIM_DELAY,		"GP_DELAY",			g_delayPorts),
+	PRIMITIVE(GP_PRIM_DFF,			"GP_DFF",			g_dffPorts),
+	PRIMITIVE(GP_PRIM_DFFI,			"GP_DFFI",			g_dffiPorts),
+	PRIMITIVE(GP_PRIM_DFFR,			"GP_DFFR",			g_dffrPorts),
+	PRIMITIVE(GP_PRIM_DFFRI,		"GP_DFFRI",			g_dffriPorts),
+	PRIMITIVE(GP_PRIM_DFFS,			"GP_DFFS",			g_dffsPorts),
+	PRIMITIVE(GP_PRIM_DFFSI,		"GP_DFFSI",			g_dffsiPorts),
+	PRIMITIVE(GP_PRIM_DFFSR,		"GP_DFFSR",			g_dffsrPorts),
+	PRIMITIVE(GP_PRIM_DFFSRI,		"GP_DFFSRI",		g_dffsriPorts),
+	PRIMITIVE(GP_PRIM_EDGEDET,		"GP_EDGEDET",		g_edgedetPorts),
+	PRIMITIVE(GP_PRIM_IBUF,			"GP_IBUF",			g_ibufPorts),
+	PRIMITIVE(GP_PRIM_INV,			"GP_INV",			g_invPorts),
+	PRIMITIVE(GP_PRIM_IOBUF,		"GP_IOBUF",			g_iobufPorts),
+	PRIMITIVE(GP_PRIM_LFOSC,		"GP_LFOSC",			g_lfoscPorts),
+	PRIMITIVE(GP_PRIM_OBUF,			"GP_OBUF",			g_obufPorts),
+	PRIMITIVE(GP_PRIM_OBUFT,		"GP_OBUFT",			g_obuftPorts),
+	PRIMITIVE(GP_PRIM_PGA,			"GP_PGA",			g_pgaPorts),
+	PRIMITIVE(GP_PRIM_PGEN,			"GP_PGEN",			g_pgenPorts),
+	PRIMITIVE(GP_PRIM_POR,			"GP_POR",			g_porPorts),
+	PRIMITIVE(GP_PRIM_PWRCTL,		"GP_PWRCTL",		g_pwrctlPorts),
+	PRIMITIVE(GP_PRIM_RCOSC,		"GP_RCOSC",			g_oscPorts),
+	PRIMITIVE(GP_PRIM_RINGOSC,		"GP_RINGOSC",		g_oscPorts),
+	PRIMITIVE(GP_PRIM_SHREG,		"GP_SHREG",			g_shregPorts),
+	PRIMITIVE(GP_PRIM_SYSRESET,		"GP_SYSRESET",		g_sysresetPorts),
+	PRIMITIVE(GP_PRIM_VDD,			"GP_VDD",			g_railPorts),
+	PRIMITIVE(GP_PRIM_VREF,			"GP_VREF",			g_vrefPorts),
+	PRIMITIVE(GP_PRIM_VSS,			"GP_VSS",			g_railPorts)
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lookup
+
+/**
+	@brief Finds a primitive cell by name, or returns NULL if it's not a GreenPAK primitive
+ */
+const Greenpak4Primitive* Greenpak4LookupPrimitive(const string& name)
+{
+	//Quick reject for user modules
+	if(name.compare(0, 3, "GP_") != 0)
+		return NULL;
+
+	int lo = 0;
+	int hi = sizeof(g_primitives) / sizeof(g_primitives[0]) - 1;
+	while(lo <= hi)
+	{
+		int mid = (lo + hi) / 2;
+		int cmp = strcmp(name.c_str(), g_primitives[mid].m_name);
+		if(cmp == 0)
+			return &g_primitives[mid];
+		else if(cmp < 0)
+			hi = mid - 1;
+		else
+			lo = mid + 1;
+	}
+
+	return NULL;
+}
+
+const Greenpak4Primitive* Greenpak4GetPrimitive(Greenpak4PrimitiveType type)
+{
+	if(type >= GP_PRIM_NUM_TYPES)
+		return NULL;
+	return &g_primitives[type];
+}
+
+/**
+	@brief Finds a port of this primitive by name, or returns NULL if there's no such port
+ */
+const Greenpak4PrimitivePort* Greenpak4Primitive::GetPort(const string& name) const
+{
+	//Cells have at most a handful of ports, linear search is fine
+	for(unsigned int i=0; i<m_portCount; i++)
+	{
+		if(name == m_ports[i].m_name)
+			return &m_ports[i];
+	}
+	return NULL;
+}
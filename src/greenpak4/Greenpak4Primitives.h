@@ -0,0 +1,106 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4Primitives_h
+#define Greenpak4Primitives_h
+
+#include <string>
+
+/**
+	@brief IDs of the GreenPAK primitive cells.
+
+	Order matches the table in Greenpak4Primitives.cpp (sorted by name).
+	Underlying type is fixed so netlist headers can forward declare it.
+ */
+enum Greenpak4PrimitiveType : unsigned int
+{
+	GP_PRIM_2LUT,
+	GP_PRIM_3LUT,
+	GP_PRIM_4LUT,
+	GP_PRIM_ABUF,
+	GP_PRIM_ACMP,
+	GP_PRIM_BANDGAP,
+	GP_PRIM_COUNT14,
+	GP_PRIM_COUNT14_ADV,
+	GP_PRIM_COUNT8,
+	GP_PRIM_COUNT8_ADV,
+	GP_PRIM_DAC,
+	GP_PRIM_DELAY,
+	GP_PRIM_DFF,
+	GP_PRIM_DFFI,
+	GP_PRIM_DFFR,
+	GP_PRIM_DFFRI,
+	GP_PRIM_DFFS,
+	GP_PRIM_DFFSI,
+	GP_PRIM_DFFSR,
+	GP_PRIM_DFFSRI,
+	GP_PRIM_EDGEDET,
+	GP_PRIM_IBUF,
+	GP_PRIM_INV,
+	GP_PRIM_IOBUF,
+	GP_PRIM_LFOSC,
+	GP_PRIM_OBUF,
+	GP_PRIM_OBUFT,
+	GP_PRIM_PGA,
+	GP_PRIM_PGEN,
+	GP_PRIM_POR,
+	GP_PRIM_PWRCTL,
+	GP_PRIM_RCOSC,
+	GP_PRIM_RINGOSC,
+	GP_PRIM_SHREG,
+	GP_PRIM_SYSRESET,
+	GP_PRIM_VDD,
+	GP_PRIM_VREF,
+	GP_PRIM_VSS,
+
+	GP_PRIM_NUM_TYPES
+};
+
+/**
+	@brief A single port of a GreenPAK primitive cell
+ */
+struct Greenpak4PrimitivePort
+{
+	///Index of this port within its primitive's port list
+	unsigned int m_index;
+
+	const char* m_name;
+	Greenpak4NetlistPort::Direction m_direction;
+	unsigned int m_width;
+};
+
+/**
+	@brief A GreenPAK primitive cell, as defined in the Yosys cell library (techlibs/greenpak4/cells_sim.v)
+
+	Yosys writes a blackbox module for every one of these into each netlist. We know what they look like already,
+	so they're skipped during parsing and their port directions come from this table instead.
+ */
+struct Greenpak4Primitive
+{
+	Greenpak4PrimitiveType m_type;
+	const char* m_name;
+	const Greenpak4PrimitivePort* m_ports;
+	unsigned int m_portCount;
+
+	const Greenpak4PrimitivePort* GetPort(const std::string& name) const;
+};
+
+const Greenpak4Primitive* Greenpak4LookupPrimitive(const std::string& name);
+const Greenpak4Primitive* Greenpak4GetPrimitive(Greenpak4PrimitiveType type);
+
+#endif
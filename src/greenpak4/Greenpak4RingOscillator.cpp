@@ -30,7 +30,7 @@ Greenpak4RingOscillator::Greenpak4RingOscillator(
 	unsigned int ibase,
 	unsigned int oword,
 	unsigned int cbase)
-	: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+	: Greenpak4BitstreamEntity(KIND_RINGOSC, device, matrix, ibase, oword, cbase)
 	, m_powerDown(device->GetGround())	//default to auto powerdown only
 	, m_powerDownEn(false)
 	, m_autoPowerDown(true)
@@ -53,31 +53,35 @@ bool Greenpak4RingOscillator::IsConstantPowerDown()
 	return m_powerDown.IsPowerRail();
 }
 
-vector<string> Greenpak4RingOscillator::GetInputPorts() const
+static const Greenpak4EntityPort g_ringoscPorts[] =
 {
-	vector<string> r;
-	r.push_back("PWRDN");
-	return r;
-}
+	{ "PWRDN",          false },
+	{ "CLKOUT_HARDIP",  true },
+	{ "CLKOUT_FABRIC",  true },
+};
+static const Greenpak4PortTable g_ringoscPortTable = PORT_TABLE(g_ringoscPorts);
 
-void Greenpak4RingOscillator::SetInput(string port, Greenpak4EntityOutput src)
+const Greenpak4PortTable& Greenpak4RingOscillator::GetPortTable() const
 {
-	if(port == "PWRDN")
-		m_powerDown = src;
+	return g_ringoscPortTable;
+}
 
-	//ignore anything else silently (should not be possible since synthesis would error out)
+uint32_t Greenpak4RingOscillator::GetFabricPortMask() const
+{
+	return (1 << PORT_PWRDN) | (1 << PORT_CLKOUT_FABRIC);
 }
 
-vector<string> Greenpak4RingOscillator::GetOutputPorts() const
+void Greenpak4RingOscillator::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	vector<string> r;
-	r.push_back("CLKOUT_FABRIC");
-	return r;
+	if(port == PORT_PWRDN)
+		m_powerDown = src;
+
+	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-unsigned int Greenpak4RingOscillator::GetOutputNetNumber(string port)
+unsigned int Greenpak4RingOscillator::GetOutputNetNumberByID(unsigned int port)
 {
-	if(port == "CLKOUT_FABRIC")
+	if(port == PORT_CLKOUT_FABRIC)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -94,7 +98,7 @@ string Greenpak4RingOscillator::GetDescription()
 bool Greenpak4RingOscillator::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -139,13 +143,46 @@ bool Greenpak4RingOscillator::CommitChanges()
 	return true;
 }
 
-bool Greenpak4RingOscillator::Load(bool* /*bitstream*/)
+bool Greenpak4RingOscillator::Load(const Greenpak4Bitstream& bitstream)
 {
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	//Output disabled means we were unused (constant power-down)
+	if(!bitstream[m_configBase + 7])
+	{
+		m_powerDownEn = true;
+		m_powerDown = m_device->GetGround();
+	}
+
+	//Power-down input is only written if enabled
+	else
+	{
+		m_powerDownEn = bitstream[m_configBase + 8];
+		if(m_powerDownEn)
+		{
+			if(!ReadMatrixSelector(bitstream, m_inputBaseWord, m_powerDown))
+				return false;
+		}
+		else
+			m_powerDown = m_device->GetGround();
+	}
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Configuration
+
+	m_autoPowerDown = !bitstream[m_configBase + 10];
+
+	static const int pre_divs[] = { 1, 4, 8, 16 };
+	m_preDiv = pre_divs[bitstream.GetField(m_configBase + 5, 2)];
+
+	static const int post_divs[] = { 1, 2, 4, 3, 8, 12, 24, 64 };
+	m_postDiv = post_divs[bitstream.GetField(m_configBase + 0, 3)];
+
+	return true;
 }
 
-bool Greenpak4RingOscillator::Save(bool* bitstream)
+bool Greenpak4RingOscillator::Save(Greenpak4Bitstream& bitstream)
 {
 	//Optimize PWRDN = 1'b0 and PWRDN_EN = 1 to PWRDN = dontcare and PWRDN_EN = 0.
 	//Detect constant power-down of 1 as "unused port"
@@ -267,3 +304,44 @@ bool Greenpak4RingOscillator::Save(bool* bitstream)
 
 	return true;
 }
+
+void Greenpak4RingOscillator::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	//All of the oscillators share one power-down input
+	RegisterMatrixSelector(map, "PWRDN", m_inputBaseWord, false, true);
+
+	map.AddField(this, "FABRIC_DIV", m_configBase + 0, 3);
+	map.AddField(this, "HARDIP_DIV", m_configBase + 5, 2);
+	map.AddField(this, "ENABLE", m_configBase + 7, 1);
+	map.AddField(this, "PWRDN_EN", m_configBase + 8, 1);
+	map.AddField(this, "AUTO_PWRDN", m_configBase + 10, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4RingOscillator::GetInput(string port)
+{
+	if(port == "PWRDN")
+		return m_powerDown;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4RingOscillator::GetPrimitiveName()
+{
+	return "GP_RINGOSC";
+}
+
+map<string, string> Greenpak4RingOscillator::GetParameters()
+{
+	map<string, string> params;
+	char buf[32];
+	params["PWRDN_EN"] = m_powerDownEn ? "1" : "0";
+	params["AUTO_PWRDN"] = m_autoPowerDown ? "1" : "0";
+	snprintf(buf, sizeof(buf), "%d", m_preDiv);
+	params["HARDIP_DIV"] = buf;
+	snprintf(buf, sizeof(buf), "%d", m_postDiv);
+	params["FABRIC_DIV"] = buf;
+	return params;
+}
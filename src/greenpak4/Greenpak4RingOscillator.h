@@ -28,6 +28,14 @@ class Greenpak4RingOscillator : public Greenpak4BitstreamEntity
 {
 public:
 
+	///IDs of our ports (indexes into our port table)
+	enum Port
+	{
+		PORT_PWRDN,
+		PORT_CLKOUT_HARDIP,
+		PORT_CLKOUT_FABRIC
+	};
+
 	//Construction / destruction
 	Greenpak4RingOscillator(
 		Greenpak4Device* device,
@@ -38,8 +46,9 @@ public:
 	virtual ~Greenpak4RingOscillator();
 
 	//Serialization
-	virtual bool Load(bool* bitstream);
-	virtual bool Save(bool* bitstream);
+	virtual bool Load(const Greenpak4Bitstream& bitstream);
+	virtual bool Save(Greenpak4Bitstream& bitstream);
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map);
 
 	virtual std::string GetDescription();
 
@@ -53,14 +62,25 @@ public:
 
 	bool IsConstantPowerDown();
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
-	virtual unsigned int GetOutputNetNumber(std::string port);
+	//Configuration accessors (used for timing analysis)
+	int GetPreDivider()
+	{ return m_preDiv; }
+
+	int GetPostDivider()
+	{ return m_postDiv; }
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
+
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
 protected:
 
 	///Power-down input (if implemented)
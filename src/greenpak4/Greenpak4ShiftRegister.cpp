@@ -30,7 +30,7 @@ Greenpak4ShiftRegister::Greenpak4ShiftRegister(
 		unsigned int ibase,
 		unsigned int oword,
 		unsigned int cbase)
-		: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+		: Greenpak4BitstreamEntity(KIND_SHIFT_REGISTER, device, matrix, ibase, oword, cbase)
 		, m_clock(device->GetGround())
 		, m_input(device->GetGround())
 		, m_reset(device->GetGround())	//default must be reset
@@ -55,40 +55,43 @@ string Greenpak4ShiftRegister::GetDescription()
 	return string(buf);
 }
 
-vector<string> Greenpak4ShiftRegister::GetInputPorts() const
+static const Greenpak4EntityPort g_shregPorts[] =
 {
-	vector<string> r;
-	r.push_back("IN");
-	r.push_back("nRST");
-	r.push_back("CLK");
-	return r;
+	{ "IN",    false },
+	{ "nRST",  false },
+	{ "CLK",   false },
+	{ "OUTA",  true },
+	{ "OUTB",  true },
+};
+static const Greenpak4PortTable g_shregPortTable = PORT_TABLE(g_shregPorts);
+
+const Greenpak4PortTable& Greenpak4ShiftRegister::GetPortTable() const
+{
+	return g_shregPortTable;
 }
 
-void Greenpak4ShiftRegister::SetInput(string port, Greenpak4EntityOutput src)
+uint32_t Greenpak4ShiftRegister::GetFabricPortMask() const
 {
-	if(port == "IN")
+	return (1 << PORT_IN) | (1 << PORT_NRST) | (1 << PORT_CLK) | (1 << PORT_OUTA) | (1 << PORT_OUTB);
+}
+
+void Greenpak4ShiftRegister::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
+{
+	if(port == PORT_IN)
 		m_input = src;
-	else if(port == "nRST")
+	else if(port == PORT_NRST)
 		m_reset = src;
-	else if(port == "CLK")
+	else if(port == PORT_CLK)
 		m_clock = src;
 
 	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-vector<string> Greenpak4ShiftRegister::GetOutputPorts() const
+unsigned int Greenpak4ShiftRegister::GetOutputNetNumberByID(unsigned int port)
 {
-	vector<string> r;
-	r.push_back("OUTA");
-	r.push_back("OUTB");
-	return r;
-}
-
-unsigned int Greenpak4ShiftRegister::GetOutputNetNumber(string port)
-{
-	if(port == "OUTA")
+	if(port == PORT_OUTA)
 		return m_outputBaseWord + 1;
-	else if(port == "OUTB")
+	else if(port == PORT_OUTB)
 		return m_outputBaseWord;
 	else
 		return -1;
@@ -100,7 +103,7 @@ unsigned int Greenpak4ShiftRegister::GetOutputNetNumber(string port)
 bool Greenpak4ShiftRegister::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -130,14 +133,30 @@ bool Greenpak4ShiftRegister::CommitChanges()
 	return true;
 }
 
-bool Greenpak4ShiftRegister::Load(bool* /*bitstream*/)
+bool Greenpak4ShiftRegister::Load(const Greenpak4Bitstream& bitstream)
 {
-	//TODO: Do our inputs
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 0, m_clock))
+		return false;
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 1, m_input))
+		return false;
+	if(!ReadMatrixSelector(bitstream, m_inputBaseWord + 2, m_reset))
+		return false;
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Configuration
+
+	//0-based tap positions, B first (see Save)
+	m_delayB = bitstream.GetField(m_configBase + 0, 4) + 1;
+	m_delayA = bitstream.GetField(m_configBase + 4, 4) + 1;
+	m_invertA = bitstream[m_configBase + 8];
+
+	return true;
 }
 
-bool Greenpak4ShiftRegister::Save(bool* bitstream)
+bool Greenpak4ShiftRegister::Save(Greenpak4Bitstream& bitstream)
 {
 	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// INPUT BUS
@@ -155,20 +174,57 @@ bool Greenpak4ShiftRegister::Save(bool* bitstream)
 	//Tap B comes first (considered output 0 in Silego docs but we flip so that A has the inverter)
 	//Note that we use 0-based tap positions, while the parameter to the shreg is 1-based delay in clocks
 	int delayB = m_delayB - 1;
-	bitstream[m_configBase + 0] = (delayB & 1) ? true : false;
-	bitstream[m_configBase + 1] = (delayB & 2) ? true : false;
-	bitstream[m_configBase + 2] = (delayB & 4) ? true : false;
-	bitstream[m_configBase + 3] = (delayB & 8) ? true : false;
+	bitstream.SetField(m_configBase + 0, 4, delayB);
 
 	//then tap A
 	int delayA = m_delayA - 1;
-	bitstream[m_configBase + 4] = (delayA & 1) ? true : false;
-	bitstream[m_configBase + 5] = (delayA & 2) ? true : false;
-	bitstream[m_configBase + 6] = (delayA & 4) ? true : false;
-	bitstream[m_configBase + 7] = (delayA & 8) ? true : false;
+	bitstream.SetField(m_configBase + 4, 4, delayA);
 
 	//then invert flag
 	bitstream[m_configBase + 8] = m_invertA;
 
 	return true;
 }
+
+void Greenpak4ShiftRegister::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	RegisterMatrixSelector(map, "CLK", m_inputBaseWord + 0);
+	RegisterMatrixSelector(map, "IN", m_inputBaseWord + 1);
+	RegisterMatrixSelector(map, "nRST", m_inputBaseWord + 2);
+
+	map.AddField(this, "OUTB_TAP", m_configBase + 0, 4);
+	map.AddField(this, "OUTA_TAP", m_configBase + 4, 4);
+	map.AddField(this, "OUTA_INVERT", m_configBase + 8, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4ShiftRegister::GetInput(string port)
+{
+	if(port == "CLK")
+		return m_clock;
+	else if(port == "IN")
+		return m_input;
+	else if(port == "nRST")
+		return m_reset;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4ShiftRegister::GetPrimitiveName()
+{
+	return "GP_SHREG";
+}
+
+map<string, string> Greenpak4ShiftRegister::GetParameters()
+{
+	map<string, string> params;
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%d", m_delayA);
+	params["OUTA_TAP"] = buf;
+	snprintf(buf, sizeof(buf), "%d", m_delayB);
+	params["OUTB_TAP"] = buf;
+	params["OUTA_INVERT"] = m_invertA ? "1" : "0";
+	return params;
+}
@@ -0,0 +1,1103 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include <log.h>
+#include <Greenpak4.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+typedef Greenpak4BitstreamEntity Entity;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+
+/**
+	@brief Gets a parameter, without the quotes if it's a string
+ */
+static string GetStringParameter(const map<string, string>& params, const char* name, const char* def)
+{
+	auto it = params.find(name);
+	if(it == params.end())
+		return def;
+
+	string s = it->second;
+	if( (s.length() >= 2) && (s[0] == '\"') && (s[s.length() - 1] == '\"') )
+		s = s.substr(1, s.length() - 2);
+	return s;
+}
+
+/**
+	@brief Gets a numeric parameter
+
+	Netlists give plain decimal values, the device gives Verilog literals like 4'h6; both are accepted.
+ */
+static uint32_t GetIntParameter(const map<string, string>& params, const char* name, uint32_t def)
+{
+	string s = GetStringParameter(params, name, "");
+	if(s.empty())
+		return def;
+
+	size_t tick = s.find('\'');
+	if( (tick == string::npos) || (tick + 2 > s.length()) )
+		return strtoul(s.c_str(), NULL, 10);
+
+	int base = 10;
+	switch(tolower(s[tick + 1]))
+	{
+		case 'h':
+			base = 16;
+			break;
+
+		case 'b':
+			base = 2;
+			break;
+
+		case 'o':
+			base = 8;
+			break;
+
+		default:
+			break;
+	}
+	return strtoul(s.c_str() + tick + 2, NULL, base);
+}
+
+/**
+	@brief Figures out which slot of a cell a primitive's pin goes in
+ */
+static unsigned int GetPinSlot(Greenpak4PrimitiveType type, const string& pin, bool output)
+{
+	if(output)
+		return ( (pin == "OUTB") || (pin == "CLKOUT_FABRIC") ) ? 1 : 0;
+
+	//LUT inputs go in order
+	if( (type == GP_PRIM_2LUT) || (type == GP_PRIM_3LUT) || (type == GP_PRIM_4LUT) )
+		return pin[2] - '0';
+
+	if( (pin == "CLK") || (pin == "OE") || (pin == "PWRDN") )
+		return 1;
+	if( (pin == "nSR") || (pin == "nSET") || (pin == "nRST") || (pin == "RST") || (pin == "IO") )
+		return 2;
+	if(pin == "KEEP")
+		return 3;
+	return 0;
+}
+
+static inline uint64_t Broadcast(bool bit)
+{
+	return bit ? ~0ULL : 0;
+}
+
+/**
+	@brief Looks up a truth table in every lane at once: a mux tree with one select word per input
+ */
+static inline uint64_t Lookup(uint32_t table, unsigned int order, const uint64_t* sel)
+{
+	uint64_t v[16];
+	unsigned int n = 1 << order;
+	for(unsigned int i=0; i<n; i++)
+		v[i] = Broadcast( (table >> i) & 1 );
+
+	for(unsigned int k=0; k<order; k++)
+	{
+		n >>= 1;
+		for(unsigned int j=0; j<n; j++)
+			v[j] = (v[2*j] & ~sel[k]) | (v[2*j + 1] & sel[k]);
+	}
+	return v[0];
+}
+
+//Bit-sliced counters: bit b of the count for a group of 64 lanes is bits[b*stride]
+
+static inline uint64_t IsZero(const uint64_t* bits, unsigned int stride, unsigned int width)
+{
+	uint64_t any = 0;
+	for(unsigned int b=0; b<width; b++)
+		any |= bits[b*stride];
+	return ~any;
+}
+
+static inline uint64_t IsEqual(const uint64_t* bits, unsigned int stride, unsigned int width, uint32_t value)
+{
+	uint64_t eq = ~0ULL;
+	for(unsigned int b=0; b<width; b++)
+		eq &= ~(bits[b*stride] ^ Broadcast( (value >> b) & 1 ));
+	return eq;
+}
+
+/**
+	@brief Decrements the lanes in dec, and loads a value into the lanes in load
+ */
+static inline void CountDown(
+	uint64_t* bits, unsigned int stride, unsigned int width, uint64_t dec, uint64_t load, uint32_t value)
+{
+	uint64_t borrow = dec;
+	for(unsigned int b=0; b<width; b++)
+	{
+		uint64_t& x = bits[b*stride];
+		uint64_t old = x;
+		x = (old ^ borrow);
+		borrow &= ~old;
+		x = (x & ~load) | (Broadcast( (value >> b) & 1 ) & load);
+	}
+}
+
+/**
+	@brief Increments the lanes in inc, and loads a value into the lanes in load
+ */
+static inline void CountUp(
+	uint64_t* bits, unsigned int stride, unsigned int width, uint64_t inc, uint64_t load, uint32_t value)
+{
+	uint64_t carry = inc;
+	for(unsigned int b=0; b<width; b++)
+	{
+		uint64_t& x = bits[b*stride];
+		uint64_t old = x;
+		x = (old ^ carry);
+		carry &= old;
+		x = (x & ~load) | (Broadcast( (value >> b) & 1 ) & load);
+	}
+}
+
+//State layout of each kind of cell, in bits (each m_words words long)
+static const unsigned int STATE_CLOCK = 0;			//Clock (or input, for edge detectors) at the last step
+
+static const unsigned int STATE_DFF_Q = 1;
+static const unsigned int STATE_DFF_SIZE = 2;
+
+static const unsigned int STATE_COUNT_RESET = 1;	//Reset input at the last step
+static const unsigned int STATE_COUNT_PRESCALER = 2;
+static const unsigned int PRESCALER_BITS = 8;
+static const unsigned int STATE_COUNT_VALUE = STATE_COUNT_PRESCALER + PRESCALER_BITS;
+
+static const unsigned int STATE_SHREG_BITS = 1;
+static const unsigned int SHREG_DEPTH = 16;
+
+static const unsigned int STATE_PGEN_INDEX = 1;
+static const unsigned int PGEN_BITS = 4;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+const unsigned int Greenpak4Simulator::NONE;
+const unsigned int Greenpak4Simulator::SIGNAL_VSS;
+const unsigned int Greenpak4Simulator::SIGNAL_VDD;
+
+/**
+	@brief Creates an empty model simulating the given number of lanes (rounded up to a multiple of 64)
+ */
+Greenpak4Simulator::Greenpak4Simulator(unsigned int lanes)
+	: m_words( max(1u, (lanes + 63) / 64) )
+	, m_cycle(0)
+	, m_stateBits(0)
+{
+	//The constants
+	AddSignal();
+	AddSignal();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Model construction
+
+unsigned int Greenpak4Simulator::AddSignal()
+{
+	unsigned int index = m_values.size() / m_words;
+	m_values.resize(m_values.size() + m_words, 0);
+	return index;
+}
+
+/**
+	@brief Adds an instance of a primitive
+
+	@param type		The primitive
+	@param name		Name of the instance, for messages
+	@param params	Parameters of the instance, as in the netlist or as reported by the device
+	@param pins		Signal connected to each pin. Missing inputs are tied off inactive (active-low pins high,
+					everything else low).
+ */
+bool Greenpak4Simulator::AddCell(
+	Greenpak4PrimitiveType type,
+	const string& name,
+	const map<string, string>& params,
+	const map<string, unsigned int>& pins)
+{
+	Cell cell;
+	cell.m_type = type;
+	cell.m_name = name;
+	cell.m_out[0] = NONE;
+	cell.m_out[1] = NONE;
+	cell.m_table = 0;
+	cell.m_bits = 0;
+	cell.m_countTo = 0;
+	cell.m_divide = 1;
+	cell.m_fabricDivide = 1;
+	cell.m_resetMode = RESET_BOTH;
+	cell.m_init = false;
+	cell.m_set = false;
+	cell.m_invert = false;
+	cell.m_resetToCountTo = false;
+	cell.m_rising = false;
+	cell.m_falling = false;
+	cell.m_powerDown = false;
+	cell.m_tapA = 1;
+	cell.m_tapB = 1;
+	cell.m_state = m_stateBits;
+	for(unsigned int i=0; i<SLOT_COUNT; i++)
+		cell.m_in[i] = SIGNAL_VSS;
+
+	//Hook up the pins
+	auto prim = Greenpak4GetPrimitive(type);
+	for(unsigned int i=0; i<prim->m_portCount; i++)
+	{
+		auto& port = prim->m_ports[i];
+		bool output = (port.m_direction == Greenpak4NetlistPort::DIR_OUTPUT);
+		unsigned int slot = GetPinSlot(type, port.m_name, output);
+		auto it = pins.find(port.m_name);
+
+		if(output)
+			cell.m_out[slot] = (it == pins.end()) ? AddSignal() : it->second;
+		else if(it != pins.end())
+			cell.m_in[slot] = it->second;
+		else
+			cell.m_in[slot] = (port.m_name[0] == 'n') ? SIGNAL_VDD : SIGNAL_VSS;
+	}
+
+	unsigned int index = m_cells.size();
+	unsigned int state = 0;
+	switch(type)
+	{
+		//Combinatorial logic
+		case GP_PRIM_2LUT:
+		case GP_PRIM_3LUT:
+		case GP_PRIM_4LUT:
+			cell.m_bits = 2 + (type - GP_PRIM_2LUT);
+			cell.m_table = GetIntParameter(params, "INIT", 0);
+			m_combinatorial.push_back(index);
+			break;
+
+		//Delays take no time at the resolution we simulate at
+		case GP_PRIM_DELAY:
+		case GP_PRIM_INV:
+		case GP_PRIM_IBUF:
+		case GP_PRIM_OBUF:
+		case GP_PRIM_OBUFT:
+		case GP_PRIM_IOBUF:
+		case GP_PRIM_VDD:
+		case GP_PRIM_VSS:
+		case GP_PRIM_BANDGAP:
+		case GP_PRIM_POR:
+		case GP_PRIM_PWRCTL:
+			m_combinatorial.push_back(index);
+			break;
+
+		case GP_PRIM_EDGEDET:
+			{
+				string dir = GetStringParameter(params, "EDGE_DIRECTION", "RISING");
+				cell.m_rising = (dir == "RISING") || (dir == "BOTH");
+				cell.m_falling = (dir == "FALLING") || (dir == "BOTH");
+				state = 1;
+				m_combinatorial.push_back(index);
+				m_sequential.push_back(index);
+			}
+			break;
+
+		//Registers
+		case GP_PRIM_DFF:
+		case GP_PRIM_DFFI:
+		case GP_PRIM_DFFR:
+		case GP_PRIM_DFFRI:
+		case GP_PRIM_DFFS:
+		case GP_PRIM_DFFSI:
+		case GP_PRIM_DFFSR:
+		case GP_PRIM_DFFSRI:
+			cell.m_init = GetIntParameter(params, "INIT", 0) != 0;
+			cell.m_invert =
+				(type == GP_PRIM_DFFI) || (type == GP_PRIM_DFFRI) ||
+				(type == GP_PRIM_DFFSI) || (type == GP_PRIM_DFFSRI);
+			if( (type == GP_PRIM_DFFS) || (type == GP_PRIM_DFFSI) )
+				cell.m_set = true;
+			else if( (type == GP_PRIM_DFFSR) || (type == GP_PRIM_DFFSRI) )
+				cell.m_set = GetIntParameter(params, "SRMODE", 0) != 0;
+			state = STATE_DFF_SIZE;
+			m_sequential.push_back(index);
+			break;
+
+		case GP_PRIM_COUNT8:
+		case GP_PRIM_COUNT8_ADV:
+		case GP_PRIM_COUNT14:
+		case GP_PRIM_COUNT14_ADV:
+			{
+				bool adv = (type == GP_PRIM_COUNT8_ADV) || (type == GP_PRIM_COUNT14_ADV);
+				cell.m_bits = ( (type == GP_PRIM_COUNT8) || (type == GP_PRIM_COUNT8_ADV) ) ? 8 : 14;
+				cell.m_countTo = GetIntParameter(params, "COUNT_TO", 0) & ( (1 << cell.m_bits) - 1 );
+				cell.m_divide = max(1u, min(GetIntParameter(params, "CLKIN_DIVIDE", 1), 1u << PRESCALER_BITS));
+
+				string mode = GetStringParameter(params, "RESET_MODE", "BOTH");
+				if(mode == "RISING")
+					cell.m_resetMode = RESET_RISING;
+				else if(mode == "FALLING")
+					cell.m_resetMode = RESET_FALLING;
+				else if(mode == "LEVEL")
+					cell.m_resetMode = RESET_LEVEL;
+
+				//Power-on value is COUNT_TO, but a reset clears the count unless an FSM counter is told otherwise
+				cell.m_resetToCountTo = adv && (GetStringParameter(params, "RESET_VALUE", "ZERO") == "COUNT_TO");
+
+				state = STATE_COUNT_VALUE + cell.m_bits;
+				m_sequential.push_back(index);
+			}
+			break;
+
+		case GP_PRIM_SHREG:
+			cell.m_tapA = max(1u, min(GetIntParameter(params, "OUTA_TAP", 1), SHREG_DEPTH));
+			cell.m_tapB = max(1u, min(GetIntParameter(params, "OUTB_TAP", 1), SHREG_DEPTH));
+			cell.m_invert = GetIntParameter(params, "OUTA_INVERT", 0) != 0;
+			state = STATE_SHREG_BITS + SHREG_DEPTH;
+			m_sequential.push_back(index);
+			break;
+
+		case GP_PRIM_PGEN:
+			cell.m_table = GetIntParameter(params, "PATTERN_DATA", 0);
+			cell.m_countTo = max(1u, min(GetIntParameter(params, "PATTERN_LEN", 2), 16u));
+			state = STATE_PGEN_INDEX + PGEN_BITS;
+			m_sequential.push_back(index);
+			break;
+
+		//Clocks
+		case GP_PRIM_LFOSC:
+			cell.m_divide = max(1u, GetIntParameter(params, "OUT_DIV", 1));
+			cell.m_powerDown = GetIntParameter(params, "PWRDN_EN", 0) != 0;
+			m_oscillators.push_back(index);
+			break;
+
+		case GP_PRIM_RINGOSC:
+		case GP_PRIM_RCOSC:
+			cell.m_divide = max(1u, GetIntParameter(params, "HARDIP_DIV", 1));
+			cell.m_fabricDivide = max(1u, GetIntParameter(params, "FABRIC_DIV", 1));
+			cell.m_powerDown = GetIntParameter(params, "PWRDN_EN", 0) != 0;
+			m_oscillators.push_back(index);
+			break;
+
+		//Comparator outputs can't be computed without the analog side, so they're stimulus like pins are
+		case GP_PRIM_ACMP:
+			AddInput(name + ".OUT", cell.m_out[0]);
+			return true;
+
+		//Purely analog, or no effect on logic
+		case GP_PRIM_ABUF:
+		case GP_PRIM_DAC:
+		case GP_PRIM_PGA:
+		case GP_PRIM_VREF:
+		case GP_PRIM_SYSRESET:
+			return true;
+
+		default:
+			LogError("Greenpak4Simulator: don't know how to simulate cell \"%s\" (%s)\n", name.c_str(), prim->m_name);
+			return false;
+	}
+
+	m_stateBits += state;
+	m_state.resize(m_stateBits * m_words, 0);
+	m_cells.push_back(cell);
+	return true;
+}
+
+/**
+	@brief Makes a signal a primary input, driven by SetInput()
+ */
+void Greenpak4Simulator::AddInput(const string& name, unsigned int signal)
+{
+	Port port;
+	port.m_name = name;
+	port.m_signal = signal;
+	port.m_enable = SIGNAL_VDD;
+	m_inputs.push_back(port);
+}
+
+/**
+	@brief Makes a signal a primary output, optionally with an output enable
+ */
+void Greenpak4Simulator::AddOutput(const string& name, unsigned int signal, unsigned int enable)
+{
+	Port port;
+	port.m_name = name;
+	port.m_signal = signal;
+	port.m_enable = enable;
+	m_outputs.push_back(port);
+}
+
+unsigned int Greenpak4Simulator::FindInput(const string& name)
+{
+	for(unsigned int i=0; i<m_inputs.size(); i++)
+	{
+		if(m_inputs[i].m_name == name)
+			return i;
+	}
+	return NONE;
+}
+
+unsigned int Greenpak4Simulator::FindOutput(const string& name)
+{
+	for(unsigned int i=0; i<m_outputs.size(); i++)
+	{
+		if(m_outputs[i].m_name == name)
+			return i;
+	}
+	return NONE;
+}
+
+/**
+	@brief Sorts the combinatorial cells so each one is evaluated after everything driving it
+
+	Must be called once all cells are added. Cells on combinatorial loops are evaluated last, in no particular order.
+	Cells that can't affect any output (unused blocks of a device, mostly) are dropped from evaluation entirely.
+ */
+void Greenpak4Simulator::Finalize()
+{
+	unsigned int nsignals = m_values.size() / m_words;
+
+	//Walk back from the outputs to find the cells that matter
+	vector<unsigned int> source(nsignals, NONE);
+	for(unsigned int i=0; i<m_cells.size(); i++)
+	{
+		for(auto out : m_cells[i].m_out)
+		{
+			if(out != NONE)
+				source[out] = i;
+		}
+	}
+	vector<bool> live(m_cells.size(), false);
+	vector<unsigned int> pending;
+	for(auto& port : m_outputs)
+	{
+		pending.push_back(port.m_signal);
+		pending.push_back(port.m_enable);
+	}
+	while(!pending.empty())
+	{
+		unsigned int c = source[pending.back()];
+		pending.pop_back();
+		if( (c == NONE) || live[c] )
+			continue;
+		live[c] = true;
+		for(auto in : m_cells[c].m_in)
+			pending.push_back(in);
+	}
+	for(auto list : {&m_combinatorial, &m_sequential, &m_oscillators})
+	{
+		vector<unsigned int> kept;
+		for(auto c : *list)
+		{
+			if(live[c])
+				kept.push_back(c);
+		}
+		*list = kept;
+	}
+
+	vector<unsigned int> driver(nsignals, NONE);
+	for(auto c : m_combinatorial)
+	{
+		for(auto out : m_cells[c].m_out)
+		{
+			if(out != NONE)
+				driver[out] = c;
+		}
+	}
+
+	//Kahn's algorithm, over cells
+	map<unsigned int, unsigned int> indegree;
+	map<unsigned int, vector<unsigned int>> fanout;
+	for(auto c : m_combinatorial)
+	{
+		indegree[c] = 0;
+		for(auto in : m_cells[c].m_in)
+		{
+			unsigned int d = driver[in];
+			if(d == NONE)
+				continue;
+			indegree[c] ++;
+			fanout[d].push_back(c);
+		}
+	}
+
+	vector<unsigned int> order;
+	for(auto c : m_combinatorial)
+	{
+		if(indegree[c] == 0)
+			order.push_back(c);
+	}
+	for(size_t i=0; i<order.size(); i++)
+	{
+		for(auto f : fanout[order[i]])
+		{
+			if(--indegree[f] == 0)
+				order.push_back(f);
+		}
+	}
+
+	if(order.size() != m_combinatorial.size())
+	{
+		LogWarning("Greenpak4Simulator: %zu cells are on combinatorial loops, results may not be accurate\n",
+			m_combinatorial.size() - order.size());
+		for(auto c : m_combinatorial)
+		{
+			if(indegree[c] != 0)
+				order.push_back(c);
+		}
+	}
+
+	m_combinatorial = order;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Device front end
+
+/**
+	@brief Name of the pin of an IO buffer primitive that is the pad, or NULL if it's not an IO buffer
+ */
+const char* Greenpak4Simulator::GetPadPin(Greenpak4PrimitiveType type)
+{
+	switch(type)
+	{
+		case GP_PRIM_IBUF:
+			return "IN";
+
+		case GP_PRIM_OBUF:
+		case GP_PRIM_OBUFT:
+			return "OUT";
+
+		case GP_PRIM_IOBUF:
+			return "IO";
+
+		default:
+			return NULL;
+	}
+}
+
+/**
+	@brief Name of the input or output for a pin of the device
+ */
+string Greenpak4Simulator::GetPadName(unsigned int pin)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "P%u", pin);
+	return buf;
+}
+
+/**
+	@brief Builds the model from the committed configuration of a device, then resets it
+
+	Every block is simulated as the primitive it reports. Pins are inputs and outputs named after their pin numbers
+	("P3"); cross connections are followed to the signal they carry.
+ */
+bool Greenpak4Simulator::LoadDevice(Greenpak4Device* device)
+{
+	for(unsigned int i=0; i<device->GetEntityCount(); i++)
+	{
+		auto entity = device->GetEntity(i);
+
+		//Cross connections are routing, they're followed from the other side.
+		//Power rails are followed to constants.
+		string primname = entity->GetPrimitiveName();
+		if( primname.empty() || (entity->GetKind() == Entity::KIND_POWER_RAIL) )
+			continue;
+
+		auto prim = Greenpak4LookupPrimitive(primname);
+		if(prim == NULL)
+		{
+			LogError("Greenpak4Simulator: %s reports unknown primitive %s\n",
+				entity->GetDescription().c_str(), primname.c_str());
+			return false;
+		}
+
+		//Name the pad after the pin
+		const char* padpin = GetPadPin(prim->m_type);
+		string pad;
+		if(padpin != NULL)
+			pad = GetPadName(static_cast<Greenpak4IOB*>(entity)->GetPinNumber());
+
+		map<string, unsigned int> pins;
+		for(unsigned int j=0; j<prim->m_portCount; j++)
+		{
+			auto& port = prim->m_ports[j];
+
+			//Multi-bit ports only go to analog blocks
+			if(port.m_width != 1)
+				continue;
+
+			if( (padpin != NULL) && (strcmp(port.m_name, padpin) == 0) )
+			{
+				unsigned int signal = AddSignal();
+				pins[port.m_name] = signal;
+				if( (prim->m_type == GP_PRIM_IBUF) || (prim->m_type == GP_PRIM_IOBUF) )
+					AddInput(pad, signal);
+			}
+			else if(port.m_direction == Greenpak4NetlistPort::DIR_OUTPUT)
+				pins[port.m_name] = GetDeviceSignal(Greenpak4EntityOutput(entity, port.m_name));
+			else
+				pins[port.m_name] = GetDeviceSignal(entity->GetInput(port.m_name));
+		}
+
+		if(!AddCell(prim->m_type, entity->GetDescription(), entity->GetParameters(), pins))
+			return false;
+
+		switch(prim->m_type)
+		{
+			case GP_PRIM_OBUF:
+				AddOutput(pad, pins["IN"]);
+				break;
+
+			case GP_PRIM_OBUFT:
+			case GP_PRIM_IOBUF:
+				AddOutput(pad, pins["IN"], pins["OE"]);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	m_deviceSignals.clear();
+	Finalize();
+	Reset();
+	return true;
+}
+
+/**
+	@brief Gets the signal for a net of the device being loaded, creating it if necessary
+ */
+unsigned int Greenpak4Simulator::GetDeviceSignal(Greenpak4EntityOutput net)
+{
+	//A signal can only cross between matrices once, but don't hang on a bogus bitstream
+	for(int i=0; i<4; i++)
+	{
+		if( (net.m_src == NULL) || (net.GetRealEntity()->GetKind() != Entity::KIND_CROSS_CONNECTION) )
+			break;
+		net = net.GetRealEntity()->GetInput("I");
+	}
+
+	if(net.m_src == NULL)
+		return SIGNAL_VSS;
+	if(net.IsPowerRail())
+		return net.GetPowerRailValue() ? SIGNAL_VDD : SIGNAL_VSS;
+
+	//Both matrix outputs of a dual are the same net
+	auto real = net.GetRealEntity();
+	unsigned int port = real->LookupPort(net.GetPort());
+
+	//So are outputs sharing a net number (a flipflop's Q and nQ are the same wire, inverted inside the block)
+	unsigned int netnum = real->GetOutputNetNumberByID(port);
+	if(netnum != static_cast<unsigned int>(-1))
+	{
+		auto& table = real->GetPortTable();
+		for(unsigned int i=0; i<table.m_count; i++)
+		{
+			if(table.m_ports[i].m_output && (real->GetOutputNetNumberByID(i) == netnum) )
+			{
+				port = i;
+				break;
+			}
+		}
+	}
+
+	uint64_t key = Greenpak4EntityOutput(real, real->GetPortName(port)).GetKey();
+	auto it = m_deviceSignals.find(key);
+	if(it != m_deviceSignals.end())
+		return it->second;
+
+	unsigned int signal = AddSignal();
+	m_deviceSignals[key] = signal;
+	return signal;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Simulation
+
+/**
+	@brief Puts every lane in the power-on state, with all inputs low
+ */
+void Greenpak4Simulator::Reset()
+{
+	m_cycle = 0;
+	fill(m_values.begin(), m_values.end(), 0);
+	fill(m_state.begin(), m_state.end(), 0);
+	for(unsigned int w=0; w<m_words; w++)
+		GetSignal(SIGNAL_VDD)[w] = ~0ULL;
+
+	for(auto c : m_sequential)
+	{
+		auto& cell = m_cells[c];
+		switch(cell.m_type)
+		{
+			case GP_PRIM_COUNT8:
+			case GP_PRIM_COUNT8_ADV:
+			case GP_PRIM_COUNT14:
+			case GP_PRIM_COUNT14_ADV:
+				for(unsigned int w=0; w<m_words; w++)
+				{
+					CountDown(GetState(cell, STATE_COUNT_PRESCALER) + w, m_words, PRESCALER_BITS,
+						0, ~0ULL, cell.m_divide - 1);
+					CountDown(GetState(cell, STATE_COUNT_VALUE) + w, m_words, cell.m_bits,
+						0, ~0ULL, cell.m_countTo);
+				}
+				break;
+
+			case GP_PRIM_EDGEDET:
+			case GP_PRIM_SHREG:
+			case GP_PRIM_PGEN:
+				break;
+
+			default:
+				{
+					auto q = GetState(cell, STATE_DFF_Q);
+					for(unsigned int w=0; w<m_words; w++)
+						q[w] = Broadcast(cell.m_init);
+				}
+				break;
+		}
+	}
+
+	for(auto c : m_oscillators)
+		UpdateOscillator(m_cells[c]);
+	for(auto c : m_sequential)
+		UpdateOutputs(m_cells[c]);
+	Settle();
+
+	//Nothing sees an edge on a signal that came out of reset high
+	for(auto c : m_sequential)
+	{
+		auto& cell = m_cells[c];
+		unsigned int clk = (cell.m_type == GP_PRIM_EDGEDET) ? cell.m_in[SLOT_DATA] : cell.m_in[SLOT_CLOCK];
+		memcpy(GetState(cell, STATE_CLOCK), GetSignal(clk), m_words * sizeof(uint64_t));
+		bool counter =
+			(cell.m_type == GP_PRIM_COUNT8) || (cell.m_type == GP_PRIM_COUNT8_ADV) ||
+			(cell.m_type == GP_PRIM_COUNT14) || (cell.m_type == GP_PRIM_COUNT14_ADV);
+		if(counter)
+			memcpy(GetState(cell, STATE_COUNT_RESET), GetSignal(cell.m_in[SLOT_RESET]), m_words * sizeof(uint64_t));
+	}
+	Settle();
+}
+
+/**
+	@brief Advances every lane by one oscillator tick
+ */
+void Greenpak4Simulator::Step()
+{
+	m_cycle ++;
+
+	for(auto c : m_oscillators)
+		UpdateOscillator(m_cells[c]);
+	Settle();
+
+	//Update all of the state before any register output changes, so registers fed directly by other registers
+	//see the old value
+	for(auto c : m_sequential)
+		EvaluateSequential(m_cells[c]);
+	for(auto c : m_sequential)
+		UpdateOutputs(m_cells[c]);
+	Settle();
+}
+
+void Greenpak4Simulator::Settle()
+{
+	for(auto c : m_combinatorial)
+		EvaluateCombinatorial(m_cells[c]);
+}
+
+void Greenpak4Simulator::UpdateOscillator(const Cell& cell)
+{
+	uint64_t hardip = Broadcast( (m_cycle / cell.m_divide) & 1 );
+	uint64_t fabric = Broadcast( (m_cycle / (cell.m_divide * cell.m_fabricDivide)) & 1 );
+	const uint64_t* pwrdn = GetSignal(cell.m_in[SLOT_CLOCK]);
+
+	for(unsigned int w=0; w<m_words; w++)
+	{
+		uint64_t run = cell.m_powerDown ? ~pwrdn[w] : ~0ULL;
+		GetSignal(cell.m_out[0])[w] = hardip & run;
+		if(cell.m_out[1] != NONE)
+			GetSignal(cell.m_out[1])[w] = fabric & run;
+	}
+}
+
+void Greenpak4Simulator::EvaluateCombinatorial(const Cell& cell)
+{
+	uint64_t* out = GetSignal(cell.m_out[0]);
+	const uint64_t* in = GetSignal(cell.m_in[SLOT_DATA]);
+
+	switch(cell.m_type)
+	{
+		case GP_PRIM_2LUT:
+		case GP_PRIM_3LUT:
+		case GP_PRIM_4LUT:
+			for(unsigned int w=0; w<m_words; w++)
+			{
+				uint64_t sel[4];
+				for(unsigned int k=0; k<cell.m_bits; k++)
+					sel[k] = GetSignal(cell.m_in[k])[w];
+				out[w] = Lookup(cell.m_table, cell.m_bits, sel);
+			}
+			break;
+
+		case GP_PRIM_INV:
+			for(unsigned int w=0; w<m_words; w++)
+				out[w] = ~in[w];
+			break;
+
+		case GP_PRIM_IOBUF:
+			{
+				const uint64_t* oe = GetSignal(cell.m_in[SLOT_CLOCK]);
+				const uint64_t* pad = GetSignal(cell.m_in[SLOT_RESET]);
+				for(unsigned int w=0; w<m_words; w++)
+					out[w] = (in[w] & oe[w]) | (pad[w] & ~oe[w]);
+			}
+			break;
+
+		case GP_PRIM_EDGEDET:
+			{
+				const uint64_t* prev = GetState(cell, STATE_CLOCK);
+				uint64_t rising = Broadcast(cell.m_rising);
+				uint64_t falling = Broadcast(cell.m_falling);
+				for(unsigned int w=0; w<m_words; w++)
+					out[w] = (in[w] & ~prev[w] & rising) | (~in[w] & prev[w] & falling);
+			}
+			break;
+
+		case GP_PRIM_VDD:
+		case GP_PRIM_BANDGAP:
+		case GP_PRIM_POR:
+			for(unsigned int w=0; w<m_words; w++)
+				out[w] = ~0ULL;
+			break;
+
+		case GP_PRIM_VSS:
+		case GP_PRIM_PWRCTL:
+			for(unsigned int w=0; w<m_words; w++)
+				out[w] = 0;
+			break;
+
+		//Buffers
+		default:
+			for(unsigned int w=0; w<m_words; w++)
+				out[w] = in[w];
+			break;
+	}
+}
+
+/**
+	@brief Clocks a register on the rising edges of its clock since the last step, then applies asynchronous controls
+ */
+void Greenpak4Simulator::EvaluateSequential(Cell& cell)
+{
+	const uint64_t* clk = GetSignal(cell.m_in[SLOT_CLOCK]);
+	const uint64_t* in = GetSignal(cell.m_in[SLOT_DATA]);
+	const uint64_t* rst = GetSignal(cell.m_in[SLOT_RESET]);
+	uint64_t* prev = GetState(cell, STATE_CLOCK);
+
+	switch(cell.m_type)
+	{
+		case GP_PRIM_EDGEDET:
+			memcpy(prev, in, m_words * sizeof(uint64_t));
+			break;
+
+		case GP_PRIM_COUNT8:
+		case GP_PRIM_COUNT8_ADV:
+		case GP_PRIM_COUNT14:
+		case GP_PRIM_COUNT14_ADV:
+			{
+				bool adv = (cell.m_type == GP_PRIM_COUNT8_ADV) || (cell.m_type == GP_PRIM_COUNT14_ADV);
+				const uint64_t* keep = GetSignal(cell.m_in[SLOT_AUX]);
+				uint64_t* prevReset = GetState(cell, STATE_COUNT_RESET);
+				uint32_t resetValue = cell.m_resetToCountTo ? cell.m_countTo : 0;
+
+				for(unsigned int w=0; w<m_words; w++)
+				{
+					uint64_t* pre = GetState(cell, STATE_COUNT_PRESCALER) + w;
+					uint64_t* count = GetState(cell, STATE_COUNT_VALUE) + w;
+
+					uint64_t edge = clk[w] & ~prev[w];
+					prev[w] = clk[w];
+					if(adv)
+						edge &= ~keep[w];
+
+					//Prescaler passes every Nth edge through
+					if(cell.m_divide > 1)
+					{
+						uint64_t pz = IsZero(pre, m_words, PRESCALER_BITS);
+						CountDown(pre, m_words, PRESCALER_BITS, edge & ~pz, edge & pz, cell.m_divide - 1);
+						edge &= pz;
+					}
+
+					//Count down to zero and reload, or (FSM counters with UP set) up to COUNT_TO and wrap
+					uint64_t up = adv ? in[w] : 0;
+					uint64_t zero = IsZero(count, m_words, cell.m_bits);
+					uint64_t top = IsEqual(count, m_words, cell.m_bits, cell.m_countTo);
+					uint64_t down = edge & ~up;
+					CountDown(count, m_words, cell.m_bits, down & ~zero, down & zero, cell.m_countTo);
+					CountUp(count, m_words, cell.m_bits, edge & up & ~top, edge & up & top, 0);
+
+					uint64_t reset = 0;
+					switch(cell.m_resetMode)
+					{
+						case RESET_BOTH:
+							reset = rst[w] ^ prevReset[w];
+							break;
+
+						case RESET_FALLING:
+							reset = ~rst[w] & prevReset[w];
+							break;
+
+						case RESET_RISING:
+							reset = rst[w] & ~prevReset[w];
+							break;
+
+						case RESET_LEVEL:
+							reset = rst[w];
+							break;
+					}
+					prevReset[w] = rst[w];
+					CountDown(count, m_words, cell.m_bits, 0, reset, resetValue);
+				}
+			}
+			break;
+
+		case GP_PRIM_SHREG:
+			for(unsigned int w=0; w<m_words; w++)
+			{
+				uint64_t* bits = GetState(cell, STATE_SHREG_BITS) + w;
+				uint64_t edge = clk[w] & ~prev[w];
+				prev[w] = clk[w];
+
+				for(unsigned int b=SHREG_DEPTH-1; b>0; b--)
+					bits[b*m_words] = (bits[b*m_words] & ~edge) | (bits[(b-1)*m_words] & edge);
+				bits[0] = (bits[0] & ~edge) | (in[w] & edge);
+
+				for(unsigned int b=0; b<SHREG_DEPTH; b++)
+					bits[b*m_words] &= rst[w];
+			}
+			break;
+
+		case GP_PRIM_PGEN:
+			for(unsigned int w=0; w<m_words; w++)
+			{
+				uint64_t* index = GetState(cell, STATE_PGEN_INDEX) + w;
+				uint64_t edge = clk[w] & ~prev[w];
+				prev[w] = clk[w];
+
+				uint64_t last = IsEqual(index, m_words, PGEN_BITS, cell.m_countTo - 1);
+				CountUp(index, m_words, PGEN_BITS, edge & ~last, edge & last, 0);
+				CountUp(index, m_words, PGEN_BITS, 0, ~rst[w], 0);
+			}
+			break;
+
+		//Flipflops
+		default:
+			{
+				bool async = (cell.m_type != GP_PRIM_DFF) && (cell.m_type != GP_PRIM_DFFI);
+				uint64_t* q = GetState(cell, STATE_DFF_Q);
+				for(unsigned int w=0; w<m_words; w++)
+				{
+					uint64_t edge = clk[w] & ~prev[w];
+					prev[w] = clk[w];
+					q[w] = (q[w] & ~edge) | (in[w] & edge);
+
+					if(async)
+					{
+						if(cell.m_set)
+							q[w] |= ~rst[w];
+						else
+							q[w] &= rst[w];
+					}
+				}
+			}
+			break;
+	}
+}
+
+/**
+	@brief Drives the outputs of a register from its state
+ */
+void Greenpak4Simulator::UpdateOutputs(const Cell& cell)
+{
+	uint64_t* out = GetSignal(cell.m_out[0]);
+
+	switch(cell.m_type)
+	{
+		case GP_PRIM_EDGEDET:
+			break;
+
+		case GP_PRIM_COUNT8:
+		case GP_PRIM_COUNT8_ADV:
+		case GP_PRIM_COUNT14:
+		case GP_PRIM_COUNT14_ADV:
+			{
+				bool adv = (cell.m_type == GP_PRIM_COUNT8_ADV) || (cell.m_type == GP_PRIM_COUNT14_ADV);
+				const uint64_t* up = GetSignal(cell.m_in[SLOT_DATA]);
+				for(unsigned int w=0; w<m_words; w++)
+				{
+					const uint64_t* count = GetState(cell, STATE_COUNT_VALUE) + w;
+					uint64_t zero = IsZero(count, m_words, cell.m_bits);
+					if(adv)
+					{
+						uint64_t top = IsEqual(count, m_words, cell.m_bits, cell.m_countTo);
+						out[w] = (zero & ~up[w]) | (top & up[w]);
+					}
+					else
+						out[w] = zero;
+				}
+			}
+			break;
+
+		case GP_PRIM_SHREG:
+			{
+				uint64_t* outb = GetSignal(cell.m_out[1]);
+				uint64_t invert = Broadcast(cell.m_invert);
+				const uint64_t* a = GetState(cell, STATE_SHREG_BITS + cell.m_tapA - 1);
+				const uint64_t* b = GetState(cell, STATE_SHREG_BITS + cell.m_tapB - 1);
+				for(unsigned int w=0; w<m_words; w++)
+				{
+					out[w] = a[w] ^ invert;
+					outb[w] = b[w];
+				}
+			}
+			break;
+
+		case GP_PRIM_PGEN:
+			for(unsigned int w=0; w<m_words; w++)
+			{
+				const uint64_t* index = GetState(cell, STATE_PGEN_INDEX) + w;
+				uint64_t sel[PGEN_BITS];
+				for(unsigned int k=0; k<PGEN_BITS; k++)
+					sel[k] = index[k*m_words];
+				out[w] = Lookup(cell.m_table, PGEN_BITS, sel);
+			}
+			break;
+
+		default:
+			{
+				const uint64_t* q = GetState(cell, STATE_DFF_Q);
+				uint64_t invert = Broadcast(cell.m_invert);
+				for(unsigned int w=0; w<m_words; w++)
+					out[w] = q[w] ^ invert;
+			}
+			break;
+	}
+}
@@ -0,0 +1,225 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4Simulator_h
+#define Greenpak4Simulator_h
+
+#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class Greenpak4Device;
+
+/**
+	@brief Cycle-based functional simulator for GreenPAK primitives
+
+	The model is a netlist of GP_* primitives connected by single-bit signals. It can be built from the committed
+	configuration of a device with LoadDevice(), or cell by cell with AddCell() by anything else that knows the
+	primitives (a synthesized netlist, for example).
+
+	Every signal holds one bit for each of 64 * N independent lanes, stored as N 64-bit words, so all the logic is
+	evaluated with bitwise operations on whole words and every lane runs its own stimulus. Counters, shift registers
+	and the pattern generator keep their state bit-sliced the same way.
+
+	Each Step() is one tick of the fastest oscillator: oscillator outputs toggle after their dividers, combinatorial
+	logic settles in topological order, registers capture on the rising edges of their clocks (and apply their
+	asynchronous controls), then the logic settles again. Delays are not modeled, so delay lines act as buffers and
+	edge detectors produce one-step pulses. Analog blocks are not simulated: comparator outputs are free inputs that
+	can be driven like pins, and the bandgap and power-on reset report ready.
+ */
+class Greenpak4Simulator
+{
+public:
+	Greenpak4Simulator(unsigned int lanes = 64);
+
+	static const unsigned int NONE = static_cast<unsigned int>(-1);
+
+	//Signals 0 and 1 are the constants
+	static const unsigned int SIGNAL_VSS = 0;
+	static const unsigned int SIGNAL_VDD = 1;
+
+	//Model construction
+	unsigned int AddSignal();
+	bool AddCell(
+		Greenpak4PrimitiveType type,
+		const std::string& name,
+		const std::map<std::string, std::string>& params,
+		const std::map<std::string, unsigned int>& pins);
+	void AddInput(const std::string& name, unsigned int signal);
+	void AddOutput(const std::string& name, unsigned int signal, unsigned int enable = SIGNAL_VDD);
+	void Finalize();
+
+	bool LoadDevice(Greenpak4Device* device);
+
+	static const char* GetPadPin(Greenpak4PrimitiveType type);
+	static std::string GetPadName(unsigned int pin);
+
+	//Simulation
+	void Reset();
+	void Step();
+	void Run(unsigned int cycles)
+	{
+		for(unsigned int i=0; i<cycles; i++)
+			Step();
+	}
+
+	unsigned int GetLaneCount()
+	{ return m_words * 64; }
+
+	unsigned int GetWordCount()
+	{ return m_words; }
+
+	uint64_t GetCycle()
+	{ return m_cycle; }
+
+	unsigned int GetInputCount()
+	{ return m_inputs.size(); }
+
+	unsigned int GetOutputCount()
+	{ return m_outputs.size(); }
+
+	const std::string& GetInputName(unsigned int input)
+	{ return m_inputs[input].m_name; }
+
+	const std::string& GetOutputName(unsigned int output)
+	{ return m_outputs[output].m_name; }
+
+	unsigned int FindInput(const std::string& name);
+	unsigned int FindOutput(const std::string& name);
+
+	///Sets 64 lanes of an input (lane 64*word + i is bit i)
+	void SetInput(unsigned int input, unsigned int word, uint64_t value)
+	{ m_values[m_inputs[input].m_signal * m_words + word] = value; }
+
+	///Gets 64 lanes of an output
+	uint64_t GetOutput(unsigned int output, unsigned int word)
+	{ return m_values[m_outputs[output].m_signal * m_words + word]; }
+
+	///Gets 64 lanes of an output's enable (set where the pin is driven)
+	uint64_t GetOutputEnable(unsigned int output, unsigned int word)
+	{ return m_values[m_outputs[output].m_enable * m_words + word]; }
+
+protected:
+
+	//Where each pin of a cell goes in Cell::m_in / Cell::m_out
+	enum PinSlot
+	{
+		SLOT_DATA	= 0,		//D, IN, UP
+		SLOT_CLOCK	= 1,		//CLK, OE, PWRDN
+		SLOT_RESET	= 2,		//nSR, nSET, nRST, RST, IO
+		SLOT_AUX	= 3,		//KEEP
+
+		SLOT_COUNT	= 4
+	};
+
+	enum ResetMode
+	{
+		RESET_BOTH,
+		RESET_FALLING,
+		RESET_RISING,
+		RESET_LEVEL
+	};
+
+	struct Cell
+	{
+		Greenpak4PrimitiveType m_type;
+		std::string m_name;
+
+		unsigned int m_in[SLOT_COUNT];
+		unsigned int m_out[2];
+
+		///LUT truth table, pattern generator data
+		uint32_t m_table;
+
+		///LUT order, counter / shift register / pattern generator state bits
+		unsigned int m_bits;
+
+		///Counter reload value, pattern length
+		unsigned int m_countTo;
+
+		///Counter and oscillator dividers
+		unsigned int m_divide;
+		unsigned int m_fabricDivide;
+
+		ResetMode m_resetMode;
+
+		//Flags
+		bool m_init;
+		bool m_set;
+		bool m_invert;
+		bool m_resetToCountTo;
+		bool m_rising;
+		bool m_falling;
+		bool m_powerDown;
+
+		///Shift register taps
+		unsigned int m_tapA;
+		unsigned int m_tapB;
+
+		///First word of this cell's state in m_state
+		unsigned int m_state;
+	};
+
+	struct Port
+	{
+		std::string m_name;
+		unsigned int m_signal;
+		unsigned int m_enable;
+	};
+
+	//Device front end
+	unsigned int GetDeviceSignal(Greenpak4EntityOutput net);
+
+	//Evaluation
+	void EvaluateCombinatorial(const Cell& cell);
+	void EvaluateSequential(Cell& cell);
+	void UpdateOutputs(const Cell& cell);
+	void UpdateOscillator(const Cell& cell);
+	void Settle();
+
+	uint64_t* GetSignal(unsigned int signal)
+	{ return &m_values[signal * m_words]; }
+
+	uint64_t* GetState(const Cell& cell, unsigned int index)
+	{ return &m_state[(cell.m_state + index) * m_words]; }
+
+	unsigned int m_words;
+	uint64_t m_cycle;
+
+	std::vector<Cell> m_cells;
+	std::vector<Port> m_inputs;
+	std::vector<Port> m_outputs;
+
+	///Values of all signals, signal-major (m_words words per signal)
+	std::vector<uint64_t> m_values;
+
+	///Register state, m_words words per bit
+	std::vector<uint64_t> m_state;
+	unsigned int m_stateBits;
+
+	//Cells by evaluation phase (indexes into m_cells)
+	std::vector<unsigned int> m_combinatorial;
+	std::vector<unsigned int> m_sequential;
+	std::vector<unsigned int> m_oscillators;
+
+	///Signal index for each net of the device being loaded
+	std::unordered_map<uint64_t, unsigned int> m_deviceSignals;
+};
+
+#endif
@@ -0,0 +1,128 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include <log.h>
+#include <Greenpak4.h>
+
+using namespace std;
+
+//Strings for the well-known symbols, must match the order of Greenpak4WellKnownSymbol
+static const char* g_wellKnownSymbols[GP_SYM_NUM_WELLKNOWN] =
+{
+	"",		//GP_SYM_NONE, never hashed
+	"LOC",
+	"top",
+	"src",
+	"__IGNORE__NOLOAD__"
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+Greenpak4StringTable::Greenpak4StringTable()
+{
+	Clear();
+}
+
+Greenpak4StringTable::~Greenpak4StringTable()
+{
+}
+
+void Greenpak4StringTable::Clear()
+{
+	m_strings.clear();
+	m_hashes.clear();
+	Rehash(64);
+
+	//Placeholder for GP_SYM_NONE, not in the hash table so it can never be returned by Intern() or Lookup()
+	m_strings.push_back(g_wellKnownSymbols[GP_SYM_NONE]);
+	m_hashes.push_back(0);
+
+	for(unsigned int i=GP_SYM_NONE+1; i<GP_SYM_NUM_WELLKNOWN; i++)
+		Intern(g_wellKnownSymbols[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lookup
+
+/**
+	@brief FNV-1a
+ */
+uint32_t Greenpak4StringTable::Hash(const string& str)
+{
+	uint32_t hash = 2166136261u;
+	for(size_t i=0; i<str.length(); i++)
+	{
+		hash ^= (uint8_t)str[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+Greenpak4Symbol Greenpak4StringTable::Lookup(const string& str) const
+{
+	uint32_t hash = Hash(str);
+	size_t mask = m_buckets.size() - 1;
+	for(size_t i = hash & mask; ; i = (i+1) & mask)
+	{
+		Greenpak4Symbol sym = m_buckets[i];
+		if(sym == GP_SYM_NONE)
+			return GP_SYM_NONE;
+		if( (m_hashes[sym] == hash) && (m_strings[sym] == str) )
+			return sym;
+	}
+}
+
+Greenpak4Symbol Greenpak4StringTable::Intern(const string& str)
+{
+	uint32_t hash = Hash(str);
+	size_t mask = m_buckets.size() - 1;
+	size_t i = hash & mask;
+	for(; m_buckets[i] != GP_SYM_NONE; i = (i+1) & mask)
+	{
+		Greenpak4Symbol sym = m_buckets[i];
+		if( (m_hashes[sym] == hash) && (m_strings[sym] == str) )
+			return sym;
+	}
+
+	//Not found, add it in the empty bucket we stopped at
+	Greenpak4Symbol sym = m_strings.size();
+	m_strings.push_back(str);
+	m_hashes.push_back(hash);
+	m_buckets[i] = sym;
+
+	//Keep the load factor under 1/2
+	if(m_strings.size() * 2 > m_buckets.size())
+		Rehash(m_buckets.size() * 2);
+
+	return sym;
+}
+
+void Greenpak4StringTable::Rehash(size_t nbuckets)
+{
+	m_buckets.assign(nbuckets, GP_SYM_NONE);
+	size_t mask = nbuckets - 1;
+	for(Greenpak4Symbol sym = GP_SYM_NONE+1; sym < m_strings.size(); sym++)
+	{
+		size_t i = m_hashes[sym] & mask;
+		while(m_buckets[i] != GP_SYM_NONE)
+			i = (i+1) & mask;
+		m_buckets[i] = sym;
+	}
+}
@@ -0,0 +1,89 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+#ifndef Greenpak4StringTable_h
+#define Greenpak4StringTable_h
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <stdint.h>
+
+///ID of an interned string. Only meaningful within the Greenpak4StringTable that issued it.
+typedef uint32_t Greenpak4Symbol;
+
+/**
+	@brief Symbols every string table is created with, in this order, so they can be checked without a lookup
+ */
+enum Greenpak4WellKnownSymbol
+{
+	///Never issued for a real string, returned by Lookup() on a miss
+	GP_SYM_NONE,
+
+	GP_SYM_LOC,
+	GP_SYM_TOP,
+	GP_SYM_SRC,
+	GP_SYM_IGNORE_NOLOAD,
+
+	GP_SYM_NUM_WELLKNOWN
+};
+
+/**
+	@brief Netlist-wide string interner
+
+	Every name that appears in the netlist (cell, net and port names, attribute and parameter keys) is stored here
+	exactly once and referred to by a small integer ID. Lookups go through an open-addressing hash table, and strings
+	never move once interned, so references returned by GetString() stay valid for the life of the table.
+ */
+class Greenpak4StringTable
+{
+public:
+	Greenpak4StringTable();
+	virtual ~Greenpak4StringTable();
+
+	//Forget everything but the well-known symbols
+	void Clear();
+
+	//Get the ID of a string, adding it if it's not already in the table
+	Greenpak4Symbol Intern(const std::string& str);
+
+	//Get the ID of a string, or GP_SYM_NONE if it's not in the table
+	Greenpak4Symbol Lookup(const std::string& str) const;
+
+	const std::string& GetString(Greenpak4Symbol sym) const
+	{ return m_strings[sym]; }
+
+	size_t size() const
+	{ return m_strings.size(); }
+
+protected:
+	static uint32_t Hash(const std::string& str);
+
+	void Rehash(size_t nbuckets);
+
+	///The strings, indexed by symbol (deque so references stay valid as we grow)
+	std::deque<std::string> m_strings;
+
+	///Cached hash of each string, indexed by symbol
+	std::vector<uint32_t> m_hashes;
+
+	///Open-addressing (linear probe) table of symbols, GP_SYM_NONE marks an empty bucket. Size is a power of two.
+	std::vector<Greenpak4Symbol> m_buckets;
+};
+
+#endif
@@ -0,0 +1,124 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#ifndef Greenpak4SymbolMap_h
+#define Greenpak4SymbolMap_h
+
+#include <algorithm>
+#include <utility>
+
+/**
+	@brief Small map from interned names to values, stored as a flat vector sorted by symbol ID
+
+	Used for cell parameters, attributes and connections (a handful of entries each) as well as the per-module cell,
+	net and port tables. Lookups by symbol are a binary search over integers. Lookups by string hash the name once in
+	the string table, and never insert anything into it unless the map itself is being written to.
+
+	Iteration order is symbol order, i.e. the order in which names were first seen in the netlist.
+ */
+template<class T>
+class Greenpak4SymbolMap
+{
+public:
+	typedef std::pair<Greenpak4Symbol, T> value_type;
+	typedef typename std::vector<value_type>::iterator iterator;
+
+	Greenpak4SymbolMap(Greenpak4StringTable* strings)
+	: m_strings(strings)
+	{}
+
+	iterator begin()
+	{ return m_entries.begin(); }
+
+	iterator end()
+	{ return m_entries.end(); }
+
+	size_t size() const
+	{ return m_entries.size(); }
+
+	bool empty() const
+	{ return m_entries.empty(); }
+
+	void clear()
+	{ m_entries.clear(); }
+
+	void erase(iterator it)
+	{ m_entries.erase(it); }
+
+	iterator find(Greenpak4Symbol sym)
+	{
+		auto it = LowerBound(sym);
+		if( (it != m_entries.end()) && (it->first == sym) )
+			return it;
+		return m_entries.end();
+	}
+
+	iterator find(const std::string& name)
+	{
+		Greenpak4Symbol sym = m_strings->Lookup(name);
+		if(sym == GP_SYM_NONE)
+			return m_entries.end();
+		return find(sym);
+	}
+
+	bool contains(Greenpak4Symbol sym)
+	{ return find(sym) != m_entries.end(); }
+
+	bool contains(const std::string& name)
+	{ return find(name) != m_entries.end(); }
+
+	//Get the value for a key, default-constructing it if not present (same semantics as std::map)
+	T& operator[](Greenpak4Symbol sym)
+	{
+		auto it = LowerBound(sym);
+		if( (it == m_entries.end()) || (it->first != sym) )
+			it = m_entries.insert(it, value_type(sym, T()));
+		return it->second;
+	}
+
+	T& operator[](const std::string& name)
+	{ return (*this)[m_strings->Intern(name)]; }
+
+	//Name of a key in this map
+	const std::string& GetName(Greenpak4Symbol sym) const
+	{ return m_strings->GetString(sym); }
+
+	Greenpak4StringTable* GetStringTable()
+	{ return m_strings; }
+
+protected:
+	iterator LowerBound(Greenpak4Symbol sym)
+	{
+		//Cheap check for the common case of appending a new highest symbol
+		if(m_entries.empty() || (m_entries.back().first < sym) )
+			return m_entries.end();
+
+		return std::lower_bound(
+			m_entries.begin(),
+			m_entries.end(),
+			sym,
+			[](const value_type& a, Greenpak4Symbol b) { return a.first < b; });
+	}
+
+	Greenpak4StringTable* m_strings;
+
+	std::vector<value_type> m_entries;
+};
+
+#endif
@@ -30,7 +30,7 @@ Greenpak4SystemReset::Greenpak4SystemReset(
 	unsigned int ibase,
 	unsigned int oword,
 	unsigned int cbase)
-	: Greenpak4BitstreamEntity(device, matrix, ibase, oword, cbase)
+	: Greenpak4BitstreamEntity(KIND_SYSTEM_RESET, device, matrix, ibase, oword, cbase)
 	, m_resetMode(RISING_EDGE)
 	, m_resetDelay(500)
 	, m_reset(device->GetGround())
@@ -51,29 +51,31 @@ string Greenpak4SystemReset::GetDescription()
 	return "SYSRST0";
 }
 
-vector<string> Greenpak4SystemReset::GetInputPorts() const
+static const Greenpak4EntityPort g_sysrstPorts[] =
 {
-	vector<string> r;
-	r.push_back("RST");
-	return r;
+	{ "RST",  false },
+};
+static const Greenpak4PortTable g_sysrstPortTable = PORT_TABLE(g_sysrstPorts);
+
+const Greenpak4PortTable& Greenpak4SystemReset::GetPortTable() const
+{
+	return g_sysrstPortTable;
 }
 
-vector<string> Greenpak4SystemReset::GetOutputPorts() const
+uint32_t Greenpak4SystemReset::GetFabricPortMask() const
 {
-	vector<string> r;
-	//no output ports
-	return r;
+	return (1 << PORT_RST);
 }
 
-unsigned int Greenpak4SystemReset::GetOutputNetNumber(string /*port*/)
+unsigned int Greenpak4SystemReset::GetOutputNetNumberByID(unsigned int /*port*/)
 {
 	//no output ports;
 	return -1;
 }
 
-void Greenpak4SystemReset::SetInput(string port, Greenpak4EntityOutput src)
+void Greenpak4SystemReset::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	if(port == "RST")
+	if(port == PORT_RST)
 		m_reset = src;
 
 	//ignore anything else silently (should not be possible since synthesis would error out)
@@ -85,7 +87,7 @@ void Greenpak4SystemReset::SetInput(string port, Greenpak4EntityOutput src)
 bool Greenpak4SystemReset::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -125,13 +127,27 @@ bool Greenpak4SystemReset::CommitChanges()
 	return true;
 }
 
-bool Greenpak4SystemReset::Load(bool* /*bitstream*/)
+bool Greenpak4SystemReset::Load(const Greenpak4Bitstream& bitstream)
 {
-	LogError("Unimplemented\n");
-	return false;
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// INPUT BUS
+
+	//Hard-wired to pin #2 if enabled
+	if(bitstream[m_configBase + 2])
+		m_reset = m_device->GetIOB(2)->GetOutput("OUT");
+	else
+		m_reset = m_device->GetGround();
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Configuration
+
+	m_resetMode = bitstream[m_configBase + 0] ? HIGH_LEVEL : RISING_EDGE;
+	m_resetDelay = bitstream[m_configBase + 1] ? 500 : 4;
+
+	return true;
 }
 
-bool Greenpak4SystemReset::Save(bool* bitstream)
+bool Greenpak4SystemReset::Save(Greenpak4Bitstream& bitstream)
 {
 	//No DRC needed - cannot route anything but pin 2 to us
 	//If somebody tries something stupid PAR will fail with an unroutable design
@@ -158,3 +174,34 @@ bool Greenpak4SystemReset::Save(bool* bitstream)
 
 	return true;
 }
+
+void Greenpak4SystemReset::RegisterBitFields(Greenpak4BitFieldMap& map)
+{
+	map.AddField(this, "RESET_MODE", m_configBase + 0, 1);
+	map.AddField(this, "EDGE_SPEED", m_configBase + 1, 1);
+	map.AddField(this, "RST_EN", m_configBase + 2, 1);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4SystemReset::GetInput(string port)
+{
+	if(port == "RST")
+		return m_reset;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4SystemReset::GetPrimitiveName()
+{
+	return "GP_SYSRESET";
+}
+
+map<string, string> Greenpak4SystemReset::GetParameters()
+{
+	map<string, string> params;
+	params["RESET_MODE"] = (m_resetMode == HIGH_LEVEL) ? "\"LEVEL\"" : "\"RISING\"";
+	params["EDGE_SPEED"] = (m_resetDelay == 500) ? "500" : "4";
+	return params;
+}
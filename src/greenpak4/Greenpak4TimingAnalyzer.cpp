@@ -0,0 +1,1028 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include <log.h>
+#include <Greenpak4.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+
+typedef Greenpak4BitstreamEntity Entity;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Delay model
+
+//Supply voltages the delay table is given at
+static const double g_vccPoints[3] = { 1.8, 3.3, 5.0 };
+
+//Supported operating range (1.8 V -5% to 5.0 V +10%)
+static const double g_vccLowest = 1.71;
+static const double g_vccHighest = 5.5;
+
+enum DelayID
+{
+	DELAY_NONE,
+	DELAY_ROUTE,
+	DELAY_DEDICATED,
+	DELAY_XCONN,
+	DELAY_LUT2,
+	DELAY_LUT3,
+	DELAY_LUT4,
+	DELAY_INV,
+	DELAY_LINE,
+	DELAY_LINE_TAP,
+	DELAY_GLITCH_FILTER,
+	DELAY_DFF_CLK_Q,
+	DELAY_DFF_SETUP,
+	DELAY_DFF_HOLD,
+	DELAY_DFF_RECOVERY,
+	DELAY_COUNT_CLK_OUT,
+	DELAY_COUNT_SETUP,
+	DELAY_COUNT_HOLD,
+	DELAY_SHREG_CLK_OUT,
+	DELAY_SHREG_SETUP,
+	DELAY_PGEN_CLK_OUT,
+	DELAY_IBUF,
+	DELAY_OBUF,
+	DELAY_OE,
+
+	NUM_DELAYS
+};
+
+/*
+	Typical delays in ns at each of g_vccPoints.
+
+	These are rounded, deliberately pessimistic estimates in line with the typical propagation delays in the
+	datasheet, not a characterization of any particular part. Replace them as bench measurements come in.
+ */
+static const double g_delays[NUM_DELAYS][3] =
+{
+	{   0.0,    0.0,    0.0 },		//DELAY_NONE
+	{   4.0,    2.0,    1.5 },		//DELAY_ROUTE: one hop through a routing matrix
+	{   1.0,    0.5,    0.4 },		//DELAY_DEDICATED: dedicated (non-matrix) routing
+	{   6.0,    3.0,    2.2 },		//DELAY_XCONN: cross connection between matrices
+	{  25.0,   11.0,    8.0 },		//DELAY_LUT2
+	{  27.0,   12.0,    9.0 },		//DELAY_LUT3
+	{  30.0,   13.0,   10.0 },		//DELAY_LUT4
+	{  20.0,    9.0,    7.0 },		//DELAY_INV
+	{  25.0,   12.0,    9.0 },		//DELAY_LINE: delay line, fixed part
+	{ 200.0,  165.0,  150.0 },		//DELAY_LINE_TAP: delay line, per tap
+	{  20.0,   10.0,    8.0 },		//DELAY_GLITCH_FILTER
+	{  30.0,   13.0,   10.0 },		//DELAY_DFF_CLK_Q
+	{  10.0,    5.0,    4.0 },		//DELAY_DFF_SETUP
+	{   2.0,    1.0,    1.0 },		//DELAY_DFF_HOLD
+	{  10.0,    5.0,    4.0 },		//DELAY_DFF_RECOVERY: set/reset deassertion to clock
+	{  40.0,   18.0,   13.0 },		//DELAY_COUNT_CLK_OUT
+	{  12.0,    6.0,    4.0 },		//DELAY_COUNT_SETUP
+	{   2.0,    1.0,    1.0 },		//DELAY_COUNT_HOLD
+	{  35.0,   16.0,   12.0 },		//DELAY_SHREG_CLK_OUT
+	{  12.0,    6.0,    4.0 },		//DELAY_SHREG_SETUP
+	{  35.0,   16.0,   12.0 },		//DELAY_PGEN_CLK_OUT
+	{  25.0,   12.0,    9.0 },		//DELAY_IBUF: pad to fabric
+	{  30.0,   14.0,   10.0 },		//DELAY_OBUF: fabric to pad
+	{  35.0,   16.0,   12.0 },		//DELAY_OE: output enable to pad
+};
+
+enum ArcType
+{
+	ARC_SOURCE,				//Output where arrival times start (m_from is NULL)
+	ARC_COMBINATORIAL,		//Input to output
+	ARC_CLOCK_TO_OUT,		//Register clock to output
+	ARC_CHECK,				//Register input with setup (m_delay) and hold (m_hold) times against CLK
+	ARC_PAD,				//Input driving an output pin
+	ARC_ASYNC				//Asynchronous control input, reported but not checked
+};
+
+/**
+	@brief One timing arc of one kind of block. Pins are named as in GetInput(), outputs as in the port table.
+ */
+struct Greenpak4TimingArc
+{
+	Entity::Kind m_kind;
+	ArcType m_type;
+	const char* m_from;
+	const char* m_to;		//NULL for every output of the block
+	DelayID m_delay;
+	DelayID m_hold;
+};
+
+static const Greenpak4TimingArc g_arcs[] =
+{
+	//Combinatorial logic (LUT delays depend on the order of the LUT, see GetCellDelay())
+	{ Entity::KIND_LUT,                ARC_COMBINATORIAL,  "IN0",   "OUT",            DELAY_LUT2,           DELAY_NONE },
+	{ Entity::KIND_LUT,                ARC_COMBINATORIAL,  "IN1",   "OUT",            DELAY_LUT2,           DELAY_NONE },
+	{ Entity::KIND_LUT,                ARC_COMBINATORIAL,  "IN2",   "OUT",            DELAY_LUT2,           DELAY_NONE },
+	{ Entity::KIND_LUT,                ARC_COMBINATORIAL,  "IN3",   "OUT",            DELAY_LUT2,           DELAY_NONE },
+	{ Entity::KIND_INVERTER,           ARC_COMBINATORIAL,  "IN",    "OUT",            DELAY_INV,            DELAY_NONE },
+	{ Entity::KIND_DELAY,              ARC_COMBINATORIAL,  "IN",    "OUT",            DELAY_LINE,           DELAY_NONE },
+	{ Entity::KIND_CROSS_CONNECTION,   ARC_COMBINATORIAL,  "I",     "O",              DELAY_XCONN,          DELAY_NONE },
+
+	//Registers
+	{ Entity::KIND_FLIPFLOP,           ARC_CLOCK_TO_OUT,   "CLK",   NULL,             DELAY_DFF_CLK_Q,      DELAY_NONE },
+	{ Entity::KIND_FLIPFLOP,           ARC_CHECK,          "D",     NULL,             DELAY_DFF_SETUP,      DELAY_DFF_HOLD },
+	{ Entity::KIND_FLIPFLOP,           ARC_CHECK,          "nSR",   NULL,             DELAY_DFF_RECOVERY,   DELAY_DFF_HOLD },
+	{ Entity::KIND_COUNTER,            ARC_CLOCK_TO_OUT,   "CLK",   "OUT",            DELAY_COUNT_CLK_OUT,  DELAY_NONE },
+	{ Entity::KIND_COUNTER,            ARC_CHECK,          "RST",   NULL,             DELAY_COUNT_SETUP,    DELAY_COUNT_HOLD },
+	{ Entity::KIND_COUNTER,            ARC_CHECK,          "UP",    NULL,             DELAY_COUNT_SETUP,    DELAY_COUNT_HOLD },
+	{ Entity::KIND_COUNTER,            ARC_CHECK,          "KEEP",  NULL,             DELAY_COUNT_SETUP,    DELAY_COUNT_HOLD },
+	{ Entity::KIND_SHIFT_REGISTER,     ARC_CLOCK_TO_OUT,   "CLK",   NULL,             DELAY_SHREG_CLK_OUT,  DELAY_NONE },
+	{ Entity::KIND_SHIFT_REGISTER,     ARC_CHECK,          "IN",    NULL,             DELAY_SHREG_SETUP,    DELAY_DFF_HOLD },
+	{ Entity::KIND_SHIFT_REGISTER,     ARC_CHECK,          "nRST",  NULL,             DELAY_SHREG_SETUP,    DELAY_DFF_HOLD },
+	{ Entity::KIND_PATTERN_GENERATOR,  ARC_CLOCK_TO_OUT,   "CLK",   "OUT",            DELAY_PGEN_CLK_OUT,   DELAY_NONE },
+	{ Entity::KIND_PATTERN_GENERATOR,  ARC_CHECK,          "nRST",  NULL,             DELAY_SHREG_SETUP,    DELAY_DFF_HOLD },
+
+	//I/O pins
+	{ Entity::KIND_IOB_TYPE_A,         ARC_SOURCE,         NULL,    "OUT",            DELAY_IBUF,           DELAY_NONE },
+	{ Entity::KIND_IOB_TYPE_A,         ARC_PAD,            "IN",    NULL,             DELAY_OBUF,           DELAY_NONE },
+	{ Entity::KIND_IOB_TYPE_A,         ARC_PAD,            "OE",    NULL,             DELAY_OE,             DELAY_NONE },
+	{ Entity::KIND_IOB_TYPE_B,         ARC_SOURCE,         NULL,    "OUT",            DELAY_IBUF,           DELAY_NONE },
+	{ Entity::KIND_IOB_TYPE_B,         ARC_PAD,            "IN",    NULL,             DELAY_OBUF,           DELAY_NONE },
+	{ Entity::KIND_IOB_TYPE_B,         ARC_PAD,            "OE",    NULL,             DELAY_OE,             DELAY_NONE },
+
+	//Clocks, and status outputs not related to any clock
+	{ Entity::KIND_LFOSC,              ARC_SOURCE,         NULL,    "CLKOUT",         DELAY_NONE,           DELAY_NONE },
+	{ Entity::KIND_RINGOSC,            ARC_SOURCE,         NULL,    "CLKOUT_HARDIP",  DELAY_NONE,           DELAY_NONE },
+	{ Entity::KIND_RINGOSC,            ARC_SOURCE,         NULL,    "CLKOUT_FABRIC",  DELAY_NONE,           DELAY_NONE },
+	{ Entity::KIND_RCOSC,              ARC_SOURCE,         NULL,    "CLKOUT_HARDIP",  DELAY_NONE,           DELAY_NONE },
+	{ Entity::KIND_RCOSC,              ARC_SOURCE,         NULL,    "CLKOUT_FABRIC",  DELAY_NONE,           DELAY_NONE },
+	{ Entity::KIND_COMPARATOR,         ARC_SOURCE,         NULL,    "OUT",            DELAY_NONE,           DELAY_NONE },
+	{ Entity::KIND_POWER_ON_RESET,     ARC_SOURCE,         NULL,    "RST_DONE",       DELAY_NONE,           DELAY_NONE },
+
+	//Asynchronous controls
+	{ Entity::KIND_LFOSC,              ARC_ASYNC,          "PWRDN", NULL,             DELAY_NONE,           DELAY_NONE },
+	{ Entity::KIND_RINGOSC,            ARC_ASYNC,          "PWRDN", NULL,             DELAY_NONE,           DELAY_NONE },
+	{ Entity::KIND_RCOSC,              ARC_ASYNC,          "PWRDN", NULL,             DELAY_NONE,           DELAY_NONE },
+	{ Entity::KIND_COMPARATOR,         ARC_ASYNC,          "PWREN", NULL,             DELAY_NONE,           DELAY_NONE },
+	{ Entity::KIND_SYSTEM_RESET,       ARC_ASYNC,          "RST",   NULL,             DELAY_NONE,           DELAY_NONE },
+};
+
+/**
+	@brief Evaluates a delay at the given supply voltage, interpolating linearly between characterization points
+ */
+static double EvaluateDelay(DelayID id, double vcc)
+{
+	const double* d = g_delays[id];
+	unsigned int i = (vcc < g_vccPoints[1]) ? 0 : 1;
+	double t = (vcc - g_vccPoints[i]) / (g_vccPoints[i+1] - g_vccPoints[i]);
+	return max(0.0, d[i] + t*(d[i+1] - d[i]));
+}
+
+/**
+	@brief Evaluates the delay of one arc of a block, taking its configuration into account
+ */
+static double GetCellDelay(Greenpak4BitstreamEntity* cell, DelayID id, double vcc)
+{
+	switch(cell->GetKind())
+	{
+		case Entity::KIND_LUT:
+			id = static_cast<DelayID>(DELAY_LUT2 + static_cast<Greenpak4LUT*>(cell)->GetOrder() - 2);
+			break;
+
+		case Entity::KIND_DELAY:
+			{
+				auto delay = static_cast<Greenpak4Delay*>(cell);
+				double d = EvaluateDelay(DELAY_LINE, vcc) + delay->GetDelayTap() * EvaluateDelay(DELAY_LINE_TAP, vcc);
+				if(delay->HasGlitchFilter())
+					d += EvaluateDelay(DELAY_GLITCH_FILTER, vcc);
+				return d;
+			}
+
+		default:
+			break;
+	}
+
+	return EvaluateDelay(id, vcc);
+}
+
+/**
+	@brief Gets the block that determines the timing of a site (paired sites act as whichever block is selected)
+ */
+static Greenpak4BitstreamEntity* GetTimingEntity(Greenpak4BitstreamEntity* entity)
+{
+	if(entity->GetKind() == Entity::KIND_PAIRED)
+		return static_cast<Greenpak4PairedEntity*>(entity)->GetActiveEntity();
+	return entity;
+}
+
+static string FormatFrequency(double period)
+{
+	if(period <= 0)
+		return "unknown frequency";
+
+	char buf[32];
+	double hz = 1e9 / period;
+	if(hz >= 1e6)
+		snprintf(buf, sizeof(buf), "%.3f MHz", hz / 1e6);
+	else if(hz >= 1e3)
+		snprintf(buf, sizeof(buf), "%.3f kHz", hz / 1e3);
+	else
+		snprintf(buf, sizeof(buf), "%.3f Hz", hz);
+	return buf;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction / destruction
+
+const unsigned int Greenpak4TimingAnalyzer::NONE;
+
+/**
+	@brief Sets up analysis of a device at both ends of a supply voltage range (slow corner first)
+ */
+Greenpak4TimingAnalyzer::Greenpak4TimingAnalyzer(Greenpak4Device* device, double vccMin, double vccMax)
+	: m_device(device)
+	, m_cornerCount(0)
+	, m_loopNodes(0)
+	, m_worstSetup(numeric_limits<double>::infinity())
+	, m_worstHold(numeric_limits<double>::infinity())
+{
+	m_vcc[m_cornerCount++] = vccMin;
+	if(vccMax != vccMin)
+		m_vcc[m_cornerCount++] = vccMax;
+}
+
+bool Greenpak4TimingAnalyzer::IsSupportedVoltage(double vcc)
+{
+	return (vcc >= g_vccLowest) && (vcc <= g_vccHighest);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Graph construction
+
+/**
+	@brief Gets the node for a net, creating it if necessary
+ */
+unsigned int Greenpak4TimingAnalyzer::GetNode(Greenpak4EntityOutput net)
+{
+	//Both matrix outputs of a dual are the same net
+	auto real = net.GetRealEntity();
+	if(real != net.m_src)
+		net = Greenpak4EntityOutput(real, net.GetPort(), real->GetMatrix());
+
+	auto it = m_nodeIndex.find(net.GetKey());
+	if(it != m_nodeIndex.end())
+		return it->second;
+
+	Node node;
+	node.m_net = net;
+	node.m_used = false;
+	unsigned int index = m_nodes.size();
+	m_nodes.push_back(node);
+	m_nodeIndex[net.GetKey()] = index;
+	return index;
+}
+
+/**
+	@brief Gets the node driving an input pin, or NONE if it's unconnected or tied to a constant
+ */
+unsigned int Greenpak4TimingAnalyzer::GetInputNode(Greenpak4BitstreamEntity* entity, const char* pin, bool create)
+{
+	auto src = entity->GetInput(pin);
+	if( (src.m_src == NULL) || src.IsPowerRail() )
+		return NONE;
+
+	if(create)
+		return GetNode(src);
+
+	auto real = src.GetRealEntity();
+	auto it = m_nodeIndex.find(Greenpak4EntityOutput(real, src.GetPort()).GetKey());
+	if(it == m_nodeIndex.end())
+		return NONE;
+	return it->second;
+}
+
+/**
+	@brief Gets the delay of the routing from a node to an input pin
+
+	Only connections between general fabric ports go through a routing matrix, anything else is a dedicated route.
+ */
+void Greenpak4TimingAnalyzer::GetRouteDelay(
+	Greenpak4BitstreamEntity* entity,
+	const char* pin,
+	unsigned int node,
+	double* delay)
+{
+	auto& net = m_nodes[node].m_net;
+	bool fabric = entity->IsGeneralFabricInput(pin) && ( (net.m_src->GetFabricPortMask() >> net.m_portID) & 1 );
+
+	for(unsigned int c=0; c<m_cornerCount; c++)
+		delay[c] = EvaluateDelay(fabric ? DELAY_ROUTE : DELAY_DEDICATED, m_vcc[c]);
+}
+
+/**
+	@brief Creates nodes, arcs, sources and endpoints for every block in the device
+ */
+void Greenpak4TimingAnalyzer::BuildGraph()
+{
+	for(unsigned int i=0; i<m_device->GetEntityCount(); i++)
+	{
+		auto entity = m_device->GetEntity(i);
+		auto cell = GetTimingEntity(entity);
+		auto kind = cell->GetKind();
+
+		for(auto& arc : g_arcs)
+		{
+			if(arc.m_kind != kind)
+				continue;
+
+			switch(arc.m_type)
+			{
+				case ARC_SOURCE:
+					{
+						Source source;
+						source.m_node = GetNode(entity->GetOutput(arc.m_to));
+						for(unsigned int c=0; c<m_cornerCount; c++)
+							source.m_delay[c] = GetCellDelay(cell, arc.m_delay, m_vcc[c]);
+						m_sources.push_back(source);
+					}
+					break;
+
+				case ARC_COMBINATORIAL:
+				case ARC_CLOCK_TO_OUT:
+					{
+						unsigned int from = GetInputNode(entity, arc.m_from);
+						if(from == NONE)
+							break;
+
+						double route[MAX_CORNERS];
+						GetRouteDelay(entity, arc.m_from, from, route);
+
+						auto& table = entity->GetPortTable();
+						for(unsigned int port=0; port<table.m_count; port++)
+						{
+							if(!table.m_ports[port].m_output)
+								continue;
+							if( (arc.m_to != NULL) && (0 != strcmp(arc.m_to, table.m_ports[port].m_name)) )
+								continue;
+
+							Edge edge;
+							edge.m_from = from;
+							edge.m_to = GetNode(entity->GetOutput(table.m_ports[port].m_name));
+							edge.m_entity = entity;
+							edge.m_pin = arc.m_from;
+							edge.m_clockToOut = (arc.m_type == ARC_CLOCK_TO_OUT);
+							for(unsigned int c=0; c<m_cornerCount; c++)
+								edge.m_delay[c] = route[c] + GetCellDelay(cell, arc.m_delay, m_vcc[c]);
+
+							m_nodes[from].m_fanout.push_back(m_edges.size());
+							m_nodes[from].m_used = true;
+							m_edges.push_back(edge);
+						}
+					}
+					break;
+
+				case ARC_CHECK:
+				case ARC_PAD:
+				case ARC_ASYNC:
+					{
+						Endpoint ep;
+						ep.m_entity = entity;
+						ep.m_pin = arc.m_from;
+						ep.m_node = GetInputNode(entity, arc.m_from);
+						if(ep.m_node == NONE)
+							break;
+						ep.m_clockNode = NONE;
+						GetRouteDelay(entity, arc.m_from, ep.m_node, ep.m_delay);
+						for(unsigned int c=0; c<m_cornerCount; c++)
+						{
+							ep.m_clockDelay[c] = 0;
+							ep.m_setup[c] = 0;
+							ep.m_hold[c] = 0;
+						}
+
+						if(arc.m_type == ARC_PAD)
+						{
+							ep.m_type = ENDPOINT_PAD;
+							for(unsigned int c=0; c<m_cornerCount; c++)
+								ep.m_delay[c] += GetCellDelay(cell, arc.m_delay, m_vcc[c]);
+						}
+						else if(arc.m_type == ARC_CHECK)
+						{
+							//A register with a constant clock never captures anything, so there's nothing to check
+							ep.m_type = ENDPOINT_REGISTER;
+							ep.m_clockNode = GetInputNode(entity, "CLK");
+							if(ep.m_clockNode == NONE)
+								ep.m_type = ENDPOINT_ASYNC;
+							else
+							{
+								GetRouteDelay(entity, "CLK", ep.m_clockNode, ep.m_clockDelay);
+								m_nodes[ep.m_clockNode].m_used = true;
+								for(unsigned int c=0; c<m_cornerCount; c++)
+								{
+									ep.m_setup[c] = GetCellDelay(cell, arc.m_delay, m_vcc[c]);
+									ep.m_hold[c] = GetCellDelay(cell, arc.m_hold, m_vcc[c]);
+								}
+							}
+						}
+						else
+							ep.m_type = ENDPOINT_ASYNC;
+
+						m_nodes[ep.m_node].m_used = true;
+						m_endpoints.push_back(ep);
+					}
+					break;
+			}
+		}
+	}
+
+	LogDebug("Timing graph: %zu nets, %zu arcs, %zu sources, %zu endpoints\n",
+		m_nodes.size(), m_edges.size(), m_sources.size(), m_endpoints.size());
+}
+
+/**
+	@brief Sorts the nodes in topological order. Nodes on (or fed by) combinatorial loops are left out.
+ */
+void Greenpak4TimingAnalyzer::SortGraph()
+{
+	vector<unsigned int> fanin(m_nodes.size(), 0);
+	for(auto& edge : m_edges)
+		fanin[edge.m_to] ++;
+
+	vector<unsigned int> ready;
+	for(unsigned int i=0; i<m_nodes.size(); i++)
+	{
+		if(fanin[i] == 0)
+			ready.push_back(i);
+	}
+
+	m_order.clear();
+	while(!ready.empty())
+	{
+		unsigned int node = ready.back();
+		ready.pop_back();
+		m_order.push_back(node);
+
+		for(auto e : m_nodes[node].m_fanout)
+		{
+			if(--fanin[m_edges[e].m_to] == 0)
+				ready.push_back(m_edges[e].m_to);
+		}
+	}
+
+	m_loopNodes = m_nodes.size() - m_order.size();
+	if(m_loopNodes != 0)
+	{
+		for(unsigned int i=0; i<m_nodes.size(); i++)
+		{
+			if(fanin[i] == 0)
+				continue;
+			LogWarning("%u nets are on or fed by combinatorial loops and will not be analyzed (including %s)\n",
+				m_loopNodes, GetNodeName(i).c_str());
+			break;
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Clocks
+
+/**
+	@brief Finds where a clock net comes from, following buffers, inverters and counters back to an oscillator.
+
+	Counters divide the clock by (COUNT_TO + 1) times their input divider. Clocks that don't lead back to an
+	oscillator (external clock pins, logic of several signals...) have no known period.
+ */
+const Greenpak4TimingAnalyzer::ClockInfo& Greenpak4TimingAnalyzer::GetClock(unsigned int node)
+{
+	if(m_clocks[node].m_valid)
+		return m_clocks[node];
+
+	double scale = 1;
+	double period = 0;
+	unsigned int n = node;
+	for(unsigned int depth=0; depth<32; depth++)
+	{
+		auto& net = m_nodes[n].m_net;
+		auto cell = GetTimingEntity(net.m_src);
+		string port = net.GetPort();
+
+		unsigned int next = NONE;
+		switch(cell->GetKind())
+		{
+			case Entity::KIND_LFOSC:
+				period = 1e9 / 1730 * static_cast<Greenpak4LFOscillator*>(cell)->GetOutputDivider();
+				break;
+
+			case Entity::KIND_RINGOSC:
+				{
+					auto osc = static_cast<Greenpak4RingOscillator*>(cell);
+					period = 1e9 / 27e6 * osc->GetPreDivider();
+					if(port == "CLKOUT_FABRIC")
+						period *= osc->GetPostDivider();
+				}
+				break;
+
+			case Entity::KIND_RCOSC:
+				{
+					auto osc = static_cast<Greenpak4RCOscillator*>(cell);
+					period = 1e9 / (osc->IsFastClock() ? 2e6 : 25e3) * osc->GetPreDivider();
+					if(port == "CLKOUT_FABRIC")
+						period *= osc->GetPostDivider();
+				}
+				break;
+
+			case Entity::KIND_COUNTER:
+				{
+					auto count = static_cast<Greenpak4Counter*>(cell);
+					scale *= (count->GetCountValue() + 1) * count->GetClockDivider();
+					next = GetInputNode(net.m_src, "CLK", false);
+				}
+				break;
+
+			case Entity::KIND_INVERTER:
+			case Entity::KIND_DELAY:
+				next = GetInputNode(net.m_src, "IN", false);
+				break;
+
+			case Entity::KIND_CROSS_CONNECTION:
+				next = GetInputNode(net.m_src, "I", false);
+				break;
+
+			//A LUT with only one live input is a buffer or an inverter
+			case Entity::KIND_LUT:
+				{
+					static const char* pins[] = { "IN0", "IN1", "IN2", "IN3" };
+					unsigned int live = 0;
+					for(auto pin : pins)
+					{
+						unsigned int in = GetInputNode(net.m_src, pin, false);
+						if( (in != NONE) && (in != next) )
+						{
+							next = in;
+							live ++;
+						}
+					}
+					if(live != 1)
+						next = NONE;
+				}
+				break;
+
+			default:
+				break;
+		}
+
+		if(next == NONE)
+			break;
+		n = next;
+	}
+
+	auto& info = m_clocks[node];
+	info.m_valid = true;
+	info.m_root = n;
+	info.m_period = period * scale;
+	return info;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Analysis
+
+/**
+	@brief Runs the analysis at every corner
+ */
+void Greenpak4TimingAnalyzer::Analyze()
+{
+	BuildGraph();
+	SortGraph();
+
+	ClockInfo unknown = { false, NONE, 0 };
+	m_clocks.assign(m_nodes.size(), unknown);
+	m_late.resize(m_nodes.size());
+	m_early.resize(m_nodes.size());
+	m_pred.resize(m_nodes.size());
+	m_earlyPred.resize(m_nodes.size());
+	m_reached.resize(m_nodes.size());
+
+	for(unsigned int c=0; c<m_cornerCount; c++)
+	{
+		for(auto& source : m_sources)
+		{
+			if(!m_nodes[source.m_node].m_used)
+				continue;
+
+			PropagateFrom(source, c);
+			CheckEndpoints(source, c);
+		}
+	}
+}
+
+/**
+	@brief Computes the latest and earliest arrival time at every node reachable from one source
+ */
+void Greenpak4TimingAnalyzer::PropagateFrom(const Source& source, unsigned int corner)
+{
+	fill(m_reached.begin(), m_reached.end(), false);
+	fill(m_pred.begin(), m_pred.end(), NONE);
+	fill(m_earlyPred.begin(), m_earlyPred.end(), NONE);
+
+	m_reached[source.m_node] = true;
+	m_late[source.m_node] = source.m_delay[corner];
+	m_early[source.m_node] = source.m_delay[corner];
+
+	for(auto node : m_order)
+	{
+		if(!m_reached[node])
+			continue;
+
+		for(auto e : m_nodes[node].m_fanout)
+		{
+			auto& edge = m_edges[e];
+			double late = m_late[node] + edge.m_delay[corner];
+			double early = m_early[node] + edge.m_delay[corner];
+
+			if(!m_reached[edge.m_to])
+			{
+				m_reached[edge.m_to] = true;
+				m_late[edge.m_to] = late;
+				m_early[edge.m_to] = early;
+				m_pred[edge.m_to] = e;
+				m_earlyPred[edge.m_to] = e;
+				continue;
+			}
+
+			if(late > m_late[edge.m_to])
+			{
+				m_late[edge.m_to] = late;
+				m_pred[edge.m_to] = e;
+			}
+			if(early < m_early[edge.m_to])
+			{
+				m_early[edge.m_to] = early;
+				m_earlyPred[edge.m_to] = e;
+			}
+		}
+	}
+}
+
+/**
+	@brief Checks every endpoint reached by the current pass
+ */
+void Greenpak4TimingAnalyzer::CheckEndpoints(const Source& source, unsigned int corner)
+{
+	for(unsigned int i=0; i<m_endpoints.size(); i++)
+	{
+		auto& ep = m_endpoints[i];
+		if(!m_reached[ep.m_node])
+			continue;
+
+		TimingPath path;
+		path.m_check = CHECK_NONE;
+		path.m_corner = corner;
+		path.m_endpoint = i;
+		path.m_root = source.m_node;
+		path.m_period = 0;
+		path.m_arrival = m_late[ep.m_node] + ep.m_delay[corner];
+		path.m_required = 0;
+		path.m_slack = 0;
+
+		if(ep.m_type == ENDPOINT_PAD)
+			path.m_note = "output pin";
+		else if(ep.m_type == ENDPOINT_ASYNC)
+			path.m_note = "asynchronous input";
+		else
+		{
+			auto& clock = GetClock(ep.m_clockNode);
+			if( (clock.m_root != source.m_node) || !m_reached[ep.m_clockNode] )
+				path.m_note = "not launched by the capture clock";
+			else if(clock.m_period <= 0)
+				path.m_note = "capture clock has no known period";
+			else
+			{
+				//If the launching register runs on a faster clock, its edges are the ones that matter
+				double period = clock.m_period;
+				for(unsigned int n = ep.m_node; m_pred[n] != NONE; n = m_edges[m_pred[n]].m_from)
+				{
+					auto& edge = m_edges[m_pred[n]];
+					if(!edge.m_clockToOut)
+						continue;
+					double launch = GetClock(edge.m_from).m_period;
+					if( (launch > 0) && (launch < period) )
+						period = launch;
+					break;
+				}
+				path.m_period = period;
+
+				double capture = m_late[ep.m_clockNode] + ep.m_clockDelay[corner];
+
+				path.m_check = CHECK_SETUP;
+				path.m_required = capture + period - ep.m_setup[corner];
+				path.m_slack = path.m_required - path.m_arrival;
+				m_worstSetup = min(m_worstSetup, path.m_slack);
+				RecordDomain(clock.m_root, clock.m_period, CHECK_SETUP, path.m_slack);
+				RecordPath(path, ep);
+
+				path.m_check = CHECK_HOLD;
+				path.m_arrival = m_early[ep.m_node] + ep.m_delay[corner];
+				path.m_required = capture + ep.m_hold[corner];
+				path.m_slack = path.m_arrival - path.m_required;
+				m_worstHold = min(m_worstHold, path.m_slack);
+				RecordDomain(clock.m_root, clock.m_period, CHECK_HOLD, path.m_slack);
+				RecordPath(path, ep);
+				continue;
+			}
+		}
+
+		RecordPath(path, ep);
+	}
+}
+
+/**
+	@brief Keeps a path if it's the worst one seen so far into its endpoint for its check and corner
+ */
+void Greenpak4TimingAnalyzer::RecordPath(TimingPath& path, const Endpoint& ep)
+{
+	uint64_t key = (static_cast<uint64_t>(path.m_endpoint) * CHECK_COUNT + path.m_check) * MAX_CORNERS + path.m_corner;
+	auto it = m_pathIndex.find(key);
+	if(it != m_pathIndex.end())
+	{
+		auto& old = m_paths[it->second];
+		if(path.m_check == CHECK_NONE)
+		{
+			if(path.m_arrival <= old.m_arrival)
+				return;
+		}
+		else if(path.m_slack >= old.m_slack)
+			return;
+	}
+
+	//Walk back to the source (hold checks follow the earliest arrivals, everything else the latest)
+	bool hold = (path.m_check == CHECK_HOLD);
+	auto& pred = hold ? m_earlyPred : m_pred;
+	auto& arrival = hold ? m_early : m_late;
+
+	vector<unsigned int> nodes;
+	for(unsigned int n = ep.m_node; ; n = m_edges[pred[n]].m_from)
+	{
+		nodes.push_back(n);
+		if(pred[n] == NONE)
+			break;
+	}
+	reverse(nodes.begin(), nodes.end());
+
+	path.m_hops.clear();
+	double last = 0;
+	for(auto n : nodes)
+	{
+		PathHop hop = { GetNodeName(n), arrival[n] - last, arrival[n] };
+		path.m_hops.push_back(hop);
+		last = arrival[n];
+	}
+	PathHop hop = { GetPinName(ep.m_entity, ep.m_pin), path.m_arrival - last, path.m_arrival };
+	path.m_hops.push_back(hop);
+
+	if(it != m_pathIndex.end())
+		m_paths[it->second] = path;
+	else
+	{
+		m_pathIndex[key] = m_paths.size();
+		m_paths.push_back(path);
+	}
+}
+
+void Greenpak4TimingAnalyzer::RecordDomain(unsigned int root, double period, CheckType check, double slack)
+{
+	ClockDomain* domain = NULL;
+	for(auto& d : m_domains)
+	{
+		if( (d.m_root == root) && (d.m_period == period) )
+			domain = &d;
+	}
+	if(domain == NULL)
+	{
+		ClockDomain d =
+		{
+			root,
+			period,
+			numeric_limits<double>::infinity(),
+			numeric_limits<double>::infinity(),
+			0
+		};
+		m_domains.push_back(d);
+		domain = &m_domains.back();
+	}
+
+	if(check == CHECK_SETUP)
+	{
+		domain->m_worstSetup = min(domain->m_worstSetup, slack);
+		domain->m_endpoints ++;
+	}
+	else
+		domain->m_worstHold = min(domain->m_worstHold, slack);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reporting
+
+string Greenpak4TimingAnalyzer::GetNodeName(unsigned int node)
+{
+	auto& net = m_nodes[node].m_net;
+	return GetPinName(net.m_src, net.GetPort().c_str());
+}
+
+string Greenpak4TimingAnalyzer::GetPinName(Greenpak4BitstreamEntity* entity, const char* pin)
+{
+	return entity->GetDescription() + "." + pin;
+}
+
+string Greenpak4TimingAnalyzer::GetClockName(unsigned int root, double period)
+{
+	return GetNodeName(root) + " at " + FormatFrequency(period);
+}
+
+string Greenpak4TimingAnalyzer::GetCornerName(unsigned int corner)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.2f V", m_vcc[corner]);
+	return buf;
+}
+
+/**
+	@brief Prints a short summary of the results to the log
+ */
+void Greenpak4TimingAnalyzer::PrintSummary()
+{
+	string corners;
+	for(unsigned int c=0; c<m_cornerCount; c++)
+	{
+		if(c)
+			corners += ", ";
+		corners += GetCornerName(c);
+	}
+	LogNotice("Corners:         %s\n", corners.c_str());
+
+	if(m_paths.empty())
+	{
+		LogNotice("No timing paths found\n");
+		return;
+	}
+
+	for(auto& d : m_domains)
+	{
+		unsigned int endpoints = d.m_endpoints / m_cornerCount;
+		LogNotice("Clock %s: %u endpoint%s, worst setup slack %.2f ns, worst hold slack %.2f ns\n",
+			GetClockName(d.m_root, d.m_period).c_str(),
+			endpoints,
+			(endpoints == 1) ? "" : "s",
+			d.m_worstSetup,
+			d.m_worstHold);
+	}
+
+	const TimingPath* setup = NULL;
+	const TimingPath* longest = NULL;
+	for(auto& p : m_paths)
+	{
+		if( (p.m_check == CHECK_SETUP) && ( (setup == NULL) || (p.m_slack < setup->m_slack) ) )
+			setup = &p;
+		if( (p.m_check == CHECK_NONE) && ( (longest == NULL) || (p.m_arrival > longest->m_arrival) ) )
+			longest = &p;
+	}
+
+	if(setup)
+	{
+		LogNotice("Critical path:   %.2f ns from %s to %s at %s, slack %.2f ns\n",
+			setup->m_arrival,
+			setup->m_hops[0].m_name.c_str(),
+			setup->m_hops.back().m_name.c_str(),
+			GetCornerName(setup->m_corner).c_str(),
+			setup->m_slack);
+	}
+	else
+		LogNotice("No paths constrained by a clock\n");
+
+	if(longest)
+	{
+		LogNotice("Longest unconstrained path: %.2f ns from %s to %s at %s (%s)\n",
+			longest->m_arrival,
+			longest->m_hops[0].m_name.c_str(),
+			longest->m_hops.back().m_name.c_str(),
+			GetCornerName(longest->m_corner).c_str(),
+			longest->m_note.c_str());
+	}
+
+	if( (m_worstSetup < 0) || (m_worstHold < 0) )
+	{
+		LogWarning("Timing constraints are not met (worst setup slack %.2f ns, worst hold slack %.2f ns)\n",
+			m_worstSetup, m_worstHold);
+	}
+}
+
+string Greenpak4TimingAnalyzer::FormatPath(const TimingPath& path)
+{
+	string buf;
+	auto& ep = m_endpoints[path.m_endpoint];
+
+	Greenpak4AppendFormat(buf, "Endpoint: %s\n", GetPinName(ep.m_entity, ep.m_pin).c_str());
+	if(path.m_check == CHECK_NONE)
+	{
+		Greenpak4AppendFormat(buf, "Source:   %s\n", GetNodeName(path.m_root).c_str());
+		Greenpak4AppendFormat(buf, "Type:     %s\n", path.m_note.c_str());
+	}
+	else
+		Greenpak4AppendFormat(buf, "Clock:    %s, %.2f ns\n",
+			GetClockName(path.m_root, path.m_period).c_str(), path.m_period);
+	Greenpak4AppendFormat(buf, "Corner:   %s\n", GetCornerName(path.m_corner).c_str());
+
+	Greenpak4AppendFormat(buf, "    %10s %10s  %s\n", "Incr", "Arrival", "Point");
+	for(auto& hop : path.m_hops)
+		Greenpak4AppendFormat(buf, "    %10.2f %10.2f  %s\n", hop.m_increment, hop.m_arrival, hop.m_name.c_str());
+
+	if(path.m_check != CHECK_NONE)
+	{
+		Greenpak4AppendFormat(buf, "    %21.2f  required (%s)\n",
+			path.m_required, (path.m_check == CHECK_SETUP) ? "setup" : "hold");
+		Greenpak4AppendFormat(buf, "    %21.2f  slack%s\n", path.m_slack, (path.m_slack < 0) ? " (VIOLATED)" : "");
+	}
+	buf += "\n";
+	return buf;
+}
+
+/**
+	@brief Writes the full report: clocks, then every endpoint's worst path for each check, worst first
+ */
+bool Greenpak4TimingAnalyzer::WriteReport(string fname)
+{
+	string buf;
+	Greenpak4AppendFormat(buf, "Static timing report\n\n");
+
+	Greenpak4AppendFormat(buf, "Corners:\n");
+	for(unsigned int c=0; c<m_cornerCount; c++)
+		Greenpak4AppendFormat(buf, "    VCC = %s\n", GetCornerName(c).c_str());
+	if(m_loopNodes)
+		Greenpak4AppendFormat(buf, "%u nets on or fed by combinatorial loops were not analyzed\n", m_loopNodes);
+
+	Greenpak4AppendFormat(buf, "\nClocks:\n");
+	if(m_domains.empty())
+		Greenpak4AppendFormat(buf, "    none\n");
+	for(auto& d : m_domains)
+	{
+		unsigned int endpoints = d.m_endpoints / m_cornerCount;
+		Greenpak4AppendFormat(buf,
+			"    %s (period %.2f ns): %u endpoint%s, worst setup slack %.2f ns, worst hold slack %.2f ns\n",
+			GetClockName(d.m_root, d.m_period).c_str(),
+			d.m_period,
+			endpoints,
+			(endpoints == 1) ? "" : "s",
+			d.m_worstSetup,
+			d.m_worstHold);
+	}
+
+	static const char* titles[CHECK_COUNT] =
+	{
+		"Setup checks (worst slack first)",
+		"Hold checks (worst slack first)",
+		"Unconstrained paths (longest first)"
+	};
+	for(unsigned int check=0; check<CHECK_COUNT; check++)
+	{
+		vector<const TimingPath*> paths;
+		for(auto& p : m_paths)
+		{
+			if(p.m_check == check)
+				paths.push_back(&p);
+		}
+		sort(paths.begin(), paths.end(), [](const TimingPath* a, const TimingPath* b)
+			{
+				if(a->m_check == CHECK_NONE)
+					return a->m_arrival > b->m_arrival;
+				return a->m_slack < b->m_slack;
+			});
+
+		Greenpak4AppendFormat(buf, "\n%s:\n\n", titles[check]);
+		if(paths.empty())
+			Greenpak4AppendFormat(buf, "None\n");
+		for(auto p : paths)
+			buf += FormatPath(*p);
+	}
+
+	FILE* fp = fopen(fname.c_str(), "w");
+	if(!fp)
+	{
+		LogError("Couldn't open %s for writing\n", fname.c_str());
+		return false;
+	}
+	if(buf.size() != fwrite(buf.c_str(), 1, buf.size(), fp))
+	{
+		LogError("Couldn't write timing report %s\n", fname.c_str());
+		fclose(fp);
+		return false;
+	}
+	fclose(fp);
+	return true;
+}
@@ -0,0 +1,232 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#ifndef Greenpak4TimingAnalyzer_h
+#define Greenpak4TimingAnalyzer_h
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+class Greenpak4Device;
+
+/**
+	@brief Static timing analysis of a configured device
+
+	Works on the committed configuration (after PAR, or after loading a bitstream) rather than on the netlist, so
+	what gets analyzed is what the chip will actually do. Every output of every block is a node of the timing
+	graph; cell delays come from a per-arc table characterized at a few supply voltages and are evaluated at both
+	ends of the requested VCC range.
+
+	The graph is sorted once, then for each corner arrival times are propagated in topological order from every
+	timing source (oscillators, input pins, analog and status outputs) in turn. Each of those passes is linear in
+	the size of the graph. Keeping the sources apart means every arrival at a register input is known to come
+	from a single launch clock, so setup and hold checks are only done where launch and capture share a clock.
+ */
+class Greenpak4TimingAnalyzer
+{
+public:
+	Greenpak4TimingAnalyzer(Greenpak4Device* device, double vccMin, double vccMax);
+
+	///Returns true if the delay model covers the given supply voltage
+	static bool IsSupportedVoltage(double vcc);
+
+	void Analyze();
+
+	void PrintSummary();
+	bool WriteReport(std::string fname);
+
+	///Worst setup slack over all constrained paths, in ns (positive if there are none)
+	double GetWorstSetupSlack()
+	{ return m_worstSetup; }
+
+	///Worst hold slack over all constrained paths, in ns (positive if there are none)
+	double GetWorstHoldSlack()
+	{ return m_worstHold; }
+
+protected:
+
+	static const unsigned int NONE = static_cast<unsigned int>(-1);
+	static const unsigned int MAX_CORNERS = 2;
+
+	///A net: one output of one block
+	struct Node
+	{
+		Greenpak4EntityOutput m_net;
+
+		///Indexes of the edges leaving this node
+		std::vector<unsigned int> m_fanout;
+
+		///True if anything (an edge or an endpoint) reads this net
+		bool m_used;
+	};
+
+	///A cell arc (input pin to output) plus the routing into that pin
+	struct Edge
+	{
+		unsigned int m_from;
+		unsigned int m_to;
+
+		///Sink block and the pin the arc starts at
+		Greenpak4BitstreamEntity* m_entity;
+		const char* m_pin;
+
+		///True for clock-to-output arcs of registers
+		bool m_clockToOut;
+
+		double m_delay[MAX_CORNERS];
+	};
+
+	///A block output where arrival times start
+	struct Source
+	{
+		unsigned int m_node;
+		double m_delay[MAX_CORNERS];
+	};
+
+	enum EndpointType
+	{
+		ENDPOINT_REGISTER,		//Register data or control input, checked against its clock
+		ENDPOINT_PAD,			//Output pin
+		ENDPOINT_ASYNC			//Asynchronous control input, reported only
+	};
+
+	///A block input where paths end
+	struct Endpoint
+	{
+		EndpointType m_type;
+		Greenpak4BitstreamEntity* m_entity;
+		const char* m_pin;
+
+		///Net driving the pin, and the register's clock net (NONE if not a register input)
+		unsigned int m_node;
+		unsigned int m_clockNode;
+
+		///Routing delay into the pin (plus the pad driver for outputs) and into the clock pin
+		double m_delay[MAX_CORNERS];
+		double m_clockDelay[MAX_CORNERS];
+		double m_setup[MAX_CORNERS];
+		double m_hold[MAX_CORNERS];
+	};
+
+	///Where a clock net comes from and how fast it runs
+	struct ClockInfo
+	{
+		bool m_valid;
+		unsigned int m_root;
+		double m_period;
+	};
+
+	struct PathHop
+	{
+		std::string m_name;
+		double m_increment;
+		double m_arrival;
+	};
+
+	enum CheckType
+	{
+		CHECK_SETUP,
+		CHECK_HOLD,
+		CHECK_NONE,
+
+		CHECK_COUNT
+	};
+
+	///The worst path found into one endpoint, for one check at one corner
+	struct TimingPath
+	{
+		CheckType m_check;
+		unsigned int m_corner;
+		unsigned int m_endpoint;
+		unsigned int m_root;
+		double m_period;
+		double m_arrival;
+		double m_required;
+		double m_slack;
+		std::string m_note;
+		std::vector<PathHop> m_hops;
+	};
+
+	struct ClockDomain
+	{
+		unsigned int m_root;
+		double m_period;
+		double m_worstSetup;
+		double m_worstHold;
+		unsigned int m_endpoints;
+	};
+
+	//Graph construction
+	void BuildGraph();
+	unsigned int GetNode(Greenpak4EntityOutput net);
+	unsigned int GetInputNode(Greenpak4BitstreamEntity* entity, const char* pin, bool create = true);
+	void GetRouteDelay(Greenpak4BitstreamEntity* entity, const char* pin, unsigned int node, double* delay);
+	void SortGraph();
+
+	//Clocks
+	const ClockInfo& GetClock(unsigned int node);
+
+	//Propagation
+	void PropagateFrom(const Source& source, unsigned int corner);
+	void CheckEndpoints(const Source& source, unsigned int corner);
+	void RecordPath(TimingPath& path, const Endpoint& ep);
+	void RecordDomain(unsigned int root, double period, CheckType check, double slack);
+
+	//Reporting
+	std::string GetNodeName(unsigned int node);
+	std::string GetPinName(Greenpak4BitstreamEntity* entity, const char* pin);
+	std::string GetClockName(unsigned int root, double period);
+	std::string GetCornerName(unsigned int corner);
+	std::string FormatPath(const TimingPath& path);
+
+	Greenpak4Device* m_device;
+
+	double m_vcc[MAX_CORNERS];
+	unsigned int m_cornerCount;
+
+	//The timing graph
+	std::vector<Node> m_nodes;
+	std::unordered_map<uint64_t, unsigned int> m_nodeIndex;
+	std::vector<Edge> m_edges;
+	std::vector<Source> m_sources;
+	std::vector<Endpoint> m_endpoints;
+
+	///Nodes in topological order (nodes on combinatorial loops are left out)
+	std::vector<unsigned int> m_order;
+
+	std::vector<ClockInfo> m_clocks;
+
+	//Per-pass state
+	std::vector<double> m_late;
+	std::vector<double> m_early;
+	std::vector<unsigned int> m_pred;
+	std::vector<unsigned int> m_earlyPred;
+	std::vector<bool> m_reached;
+
+	//Results
+	std::vector<TimingPath> m_paths;
+	std::unordered_map<uint64_t, unsigned int> m_pathIndex;
+	std::vector<ClockDomain> m_domains;
+	unsigned int m_loopNodes;
+	double m_worstSetup;
+	double m_worstHold;
+};
+
+#endif
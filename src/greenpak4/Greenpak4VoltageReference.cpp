@@ -28,7 +28,7 @@ Greenpak4VoltageReference::Greenpak4VoltageReference(
 		Greenpak4Device* device,
 		unsigned int refnum,
 		unsigned int vout_muxsel)
-		: Greenpak4BitstreamEntity(device, 0, -1, -1, -1)
+		: Greenpak4BitstreamEntity(KIND_VREF, device, 0, -1, -1, -1)
 		, m_vin(device->GetGround())
 		, m_refnum(refnum)
 		, m_vinDiv(1)
@@ -54,29 +54,32 @@ string Greenpak4VoltageReference::GetDescription()
 	return string(buf);
 }
 
-vector<string> Greenpak4VoltageReference::GetInputPorts() const
+static const Greenpak4EntityPort g_vrefPorts[] =
 {
-	vector<string> r;
-	r.push_back("VIN");
-	return r;
-}
+	{ "VIN",   false },
+	{ "VOUT",  true },
+};
+static const Greenpak4PortTable g_vrefPortTable = PORT_TABLE(g_vrefPorts);
 
-void Greenpak4VoltageReference::SetInput(string port, Greenpak4EntityOutput src)
+const Greenpak4PortTable& Greenpak4VoltageReference::GetPortTable() const
 {
-	if(port == "VIN")
-		m_vin = src;
+	return g_vrefPortTable;
+}
 
-	//ignore anything else silently (should not be possible since synthesis would error out)
+uint32_t Greenpak4VoltageReference::GetFabricPortMask() const
+{
+	return (1 << PORT_VIN);
 }
 
-vector<string> Greenpak4VoltageReference::GetOutputPorts() const
+void Greenpak4VoltageReference::SetInputByID(unsigned int port, Greenpak4EntityOutput src)
 {
-	vector<string> r;
-	//no general fabric outputs
-	return r;
+	if(port == PORT_VIN)
+		m_vin = src;
+
+	//ignore anything else silently (should not be possible since synthesis would error out)
 }
 
-unsigned int Greenpak4VoltageReference::GetOutputNetNumber(string /*port*/)
+unsigned int Greenpak4VoltageReference::GetOutputNetNumberByID(unsigned int /*port*/)
 {
 	//no general fabric outputs
 	return -1;
@@ -88,7 +91,7 @@ unsigned int Greenpak4VoltageReference::GetOutputNetNumber(string /*port*/)
 bool Greenpak4VoltageReference::CommitChanges()
 {
 	//Get our cell, or bail if we're unassigned
-	auto ncell = dynamic_cast<Greenpak4NetlistCell*>(GetNetlistEntity());
+	auto ncell = GetNetlistCell();
 	if(ncell == NULL)
 		return true;
 
@@ -101,19 +104,23 @@ bool Greenpak4VoltageReference::CommitChanges()
 	return true;
 }
 
-bool Greenpak4VoltageReference::Load(bool* /*bitstream*/)
+bool Greenpak4VoltageReference::Load(const Greenpak4Bitstream& /*bitstream*/)
 {
-	//TODO: how do we do this?
-	LogError("Unimplemented\n");
-	return false;
+	//no configuration, everything is in the downstream logic (see DecodeACMPMuxSel)
+	return true;
 }
 
-bool Greenpak4VoltageReference::Save(bool* /*bitstream*/)
+bool Greenpak4VoltageReference::Save(Greenpak4Bitstream& /*bitstream*/)
 {
 	//no configuration, everything is in the downstream logic
 	return true;
 }
 
+void Greenpak4VoltageReference::RegisterBitFields(Greenpak4BitFieldMap& /*map*/)
+{
+	//Our settings are stored in the comparator or IOB we feed, and registered by them
+}
+
 unsigned int Greenpak4VoltageReference::GetACMPMuxSel()
 {
 	unsigned int select = 0;
@@ -159,7 +166,7 @@ unsigned int Greenpak4VoltageReference::GetACMPMuxSel()
 	//See if it's a DAC
 	else if(m_vin.IsDAC())
 	{
-		auto num = dynamic_cast<Greenpak4DAC*>(m_vin.GetRealEntity())->GetDACNum();
+		auto num = static_cast<Greenpak4DAC*>(m_vin.GetRealEntity())->GetDACNum();
 
 		if(m_device->GetPart() == Greenpak4Device::GREENPAK4_SLG46140)
 			LogError("Greenpak4VoltageReference: not implemented for 46140 yet\n");
@@ -187,3 +194,62 @@ unsigned int Greenpak4VoltageReference::GetACMPMuxSel()
 
 	return select;
 }
+
+bool Greenpak4VoltageReference::DecodeACMPMuxSel(unsigned int sel)
+{
+	//DAC outputs (SLG46620V only for now, see GetACMPMuxSel)
+	if( (sel == 0x1F) || (sel == 0x1E) )
+	{
+		if(m_device->GetDACCount() < 2)
+		{
+			LogError("Greenpak4VoltageReference: DAC reference selector on a part without DACs\n");
+			return false;
+		}
+		m_vin = m_device->GetDAC( (sel == 0x1F) ? 0 : 1)->GetOutput("VOUT");
+		return true;
+	}
+
+	//TODO: external Vref, divided Vdd
+	if(sel > 0x17)
+	{
+		LogError("Greenpak4VoltageReference: comparator reference selector %u not implemented yet\n", sel);
+		return false;
+	}
+
+	SetConstantVoltage( (sel + 1) * 50);
+	return true;
+}
+
+void Greenpak4VoltageReference::SetConstantVoltage(unsigned int mv)
+{
+	m_vin = m_device->GetGround();
+	m_vinDiv = 1;
+	m_vref = mv;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly
+
+Greenpak4EntityOutput Greenpak4VoltageReference::GetInput(string port)
+{
+	if(port == "VIN")
+		return m_vin;
+	else
+		return Greenpak4EntityOutput();
+}
+
+string Greenpak4VoltageReference::GetPrimitiveName()
+{
+	return "GP_VREF";
+}
+
+map<string, string> Greenpak4VoltageReference::GetParameters()
+{
+	map<string, string> params;
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%u", m_vinDiv);
+	params["VIN_DIV"] = buf;
+	snprintf(buf, sizeof(buf), "%u", m_vref);
+	params["VREF"] = buf;
+	return params;
+}
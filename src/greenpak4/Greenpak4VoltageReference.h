@@ -25,6 +25,13 @@ class Greenpak4VoltageReference : public Greenpak4BitstreamEntity
 {
 public:
 
+	///IDs of our ports (indexes into our port table)
+	enum Port
+	{
+		PORT_VIN,
+		PORT_VOUT
+	};
+
 	//Construction / destruction
 	Greenpak4VoltageReference(
 		Greenpak4Device* device,
@@ -32,21 +39,26 @@ public:
 		unsigned int vout_muxsel = -1);
 
 	//Serialization
-	virtual bool Load(bool* bitstream);
-	virtual bool Save(bool* bitstream);
+	virtual bool Load(const Greenpak4Bitstream& bitstream);
+	virtual bool Save(Greenpak4Bitstream& bitstream);
+	virtual void RegisterBitFields(Greenpak4BitFieldMap& map);
 
 	virtual ~Greenpak4VoltageReference();
 
 	virtual std::string GetDescription();
 
-	virtual void SetInput(std::string port, Greenpak4EntityOutput src);
-	virtual unsigned int GetOutputNetNumber(std::string port);
+	virtual const Greenpak4PortTable& GetPortTable() const;
+	virtual uint32_t GetFabricPortMask() const;
 
-	virtual std::vector<std::string> GetInputPorts() const;
-	virtual std::vector<std::string> GetOutputPorts() const;
+	virtual void SetInputByID(unsigned int port, Greenpak4EntityOutput src);
+	virtual unsigned int GetOutputNetNumberByID(unsigned int port);
 
 	virtual bool CommitChanges();
 
+	virtual Greenpak4EntityOutput GetInput(std::string port);
+	virtual std::string GetPrimitiveName();
+	virtual std::map<std::string, std::string> GetParameters();
+
 	//mux selector for output pad drivers, need to come up with a clearer name!
 	unsigned int GetMuxSel()
 	{ return m_voutMuxsel; }
@@ -54,6 +66,12 @@ public:
 	//mux selector for ACMP voltage inputs
 	unsigned int GetACMPMuxSel();
 
+	//inverse of GetACMPMuxSel(), used when loading the owning comparator
+	bool DecodeACMPMuxSel(unsigned int sel);
+
+	//drive a constant voltage (divided from the bandgap)
+	void SetConstantVoltage(unsigned int mv);
+
 	//return true if we're reporting a constant voltage (divided from the bandgap)
 	bool IsConstantVoltage()
 	{ return (m_vin.IsPowerRail() && !m_vin.GetPowerRailValue()); }
@@ -29,6 +29,7 @@ PAREngine::PAREngine(PARGraph* netlist, PARGraph* device)
 	: m_netlist(netlist)
 	, m_device(device)
 	, m_temperature(0)
+	, m_rng(0)
 {
 
 }
@@ -50,9 +51,8 @@ bool PAREngine::PlaceAndRoute(map<uint32_t, string> label_names, uint32_t seed)
 	LogVerbose("\nXBPAR initializing...\n");
 	m_temperature = 100;
 
-	//TODO: glibc rand sucks, replace with something a bit more random
-	//(this may not make a difference for a device this tiny though)
-	srand(seed);
+	//Seed the RNG. The constant keeps the xorshift state nonzero whatever the seed is.
+	m_rng = 0x9e3779b97f4a7c15ULL ^ seed;
 
 	//Detect obviously impossible-to-route designs
 	if(!SanityCheck(label_names))
@@ -61,6 +61,9 @@ bool PAREngine::PlaceAndRoute(map<uint32_t, string> label_names, uint32_t seed)
 	//Do an initial valid, but not necessarily routable, placement
 	if(!InitialPlacement(label_names))
 		return false;
+	bool replicated;
+	if(!ReplicateNodes(replicated))
+		return false;
 
 	//Converge until we get a passing placement
 	LogNotice("\nOptimizing placement...\n");
@@ -106,6 +109,12 @@ bool PAREngine::PlaceAndRoute(map<uint32_t, string> label_names, uint32_t seed)
 		//Try to optimize the placement more
 		made_change = OptimizePlacement(badnodes, label_names);
 
+		//See if changing the netlist helps where moving things around can't
+		if(!ReplicateNodes(replicated))
+			return false;
+		if(replicated)
+			made_change = true;
+
 		//Cool the system down
 		//TODO: Decide on a good rate for this?
 		m_temperature --;
@@ -254,7 +263,7 @@ bool PAREngine::OptimizePlacement(
 	LogIndenter li;
 
 	//Pick one of the nodes at random as our pivot node
-	PARGraphNode* pivot = badnodes[rand() % badnodes.size()];
+	PARGraphNode* pivot = badnodes[Random() % badnodes.size()];
 
 	//Find a new site for the pivot node (but remember the old site)
 	//If nothing was found, bail out
@@ -294,7 +303,7 @@ bool PAREngine::OptimizePlacement(
 	//TODO: make probability depend on dCost?
 	if(new_cost < original_cost)
 		return true;
-	if( (rand() % 100) < (int)m_temperature )
+	if( (Random() % 100) < m_temperature )
 		return true;
 
 	//If we don't like the change, revert
@@ -302,6 +311,21 @@ bool PAREngine::OptimizePlacement(
 	return false;
 }
 
+/**
+	@brief Adds copies of netlist nodes to the current placement, if the technology can reduce the cost that way
+
+	Called once after the initial placement and then after every optimization step. The base class never replicates.
+
+	@param changed	Set to true if the netlist graph was changed
+
+	@return False if replication failed and placement can't continue
+ */
+bool PAREngine::ReplicateNodes(bool& changed)
+{
+	changed = false;
+	return true;
+}
+
 /**
 	@brief Checks if we can move a node from one location to another
  */
@@ -381,6 +405,17 @@ std::string PAREngine::GetNodeTypes(PARGraphNode* node, std::map<uint32_t, std::
 	return ret;
 }
 
+/**
+	@brief Next random number for placement decisions (xorshift64*, seeded by PlaceAndRoute())
+ */
+uint32_t PAREngine::Random()
+{
+	m_rng ^= m_rng >> 12;
+	m_rng ^= m_rng << 25;
+	m_rng ^= m_rng >> 27;
+	return (m_rng * 0x2545f4914f6cdd1dULL) >> 32;
+}
+
 /**
 	@brief Compute the cost of a given placement.
  */
@@ -39,11 +39,13 @@ protected:
 
 	virtual bool CanMoveNode(PARGraphNode* node, PARGraphNode* old_mate, PARGraphNode* new_mate);
 
-	void MoveNode(PARGraphNode* node, PARGraphNode* newpos, std::map<uint32_t, std::string>& label_names);
+	virtual void MoveNode(PARGraphNode* node, PARGraphNode* newpos, std::map<uint32_t, std::string>& label_names);
 
 	virtual PARGraphNode* GetNewPlacementForNode(PARGraphNode* pivot) =0;
 	virtual void FindSubOptimalPlacements(std::vector<PARGraphNode*>& bad_nodes) =0;
 
+	virtual bool ReplicateNodes(bool& changed);
+
 	virtual uint32_t ComputeAndPrintScore(std::vector<PARGraphEdge*>& unroutes, uint32_t iteration);
 
 	virtual void PrintUnroutes(std::vector<PARGraphEdge*>& unroutes);
@@ -63,10 +65,15 @@ protected:
 
 	std::string GetNodeTypes(PARGraphNode* node, std::map<uint32_t, std::string>& label_names);
 
+	uint32_t Random();
+
 	PARGraph* m_netlist;
 	PARGraph* m_device;
 
 	uint32_t m_temperature;
+
+	//Random number generator state. Per engine (rather than the C library's) so runs only depend on their own seed.
+	uint64_t m_rng;
 };
 
 #endif
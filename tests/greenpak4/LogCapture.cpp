@@ -0,0 +1,111 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <libgp4par.h>
+
+using namespace std;
+
+/**
+	@brief Log sink that just counts what it is given
+ */
+class CountingLogSink : public LogSink
+{
+public:
+	CountingLogSink(unsigned int& count)
+		: m_count(count)
+	{}
+
+	virtual void Log(Severity /*severity*/, const string& /*msg*/)
+	{ m_count ++; }
+
+	virtual void Log(Severity /*severity*/, const char* /*format*/, va_list /*va*/)
+	{ m_count ++; }
+
+protected:
+	unsigned int& m_count;
+};
+
+static bool Check(bool ok, const char* what)
+{
+	if(!ok)
+		fprintf(stderr, "FAIL: %s\n", what);
+	return ok;
+}
+
+/**
+	@brief Runs libgp4par with the application's log sinks changed between runs, and checks that runs only log to
+	their own results (unless forwarding) and that g_log_sinks is left as the application had it
+ */
+int main(int argc, char* argv[])
+{
+	//expect one arg: the netlist
+	if(argc != 2)
+	{
+		fprintf(stderr, "Usage: LogCapture netlist.json\n");
+		return 1;
+	}
+	ifstream in(argv[1], ios::binary);
+	stringstream ss;
+	ss << in.rdbuf();
+	string json = ss.str();
+
+	bool ok = true;
+	Greenpak4PAROptions options;
+
+	//Sink installed before the first run sees nothing of it
+	unsigned int first = 0;
+	LogSink* firstSink = new CountingLogSink(first);
+	g_log_sinks.emplace_back(firstSink);
+	Greenpak4PARResults results;
+	ok &= Check(Greenpak4PlaceAndRoute(json.data(), json.size(), options, results), "first run failed");
+	size_t loglen = results.m_log.size();
+	ok &= Check(loglen != 0, "first run logged nothing");
+	ok &= Check(first == 0, "first run leaked to the application's sink");
+	ok &= Check( (g_log_sinks.size() == 1) && (g_log_sinks[0].get() == firstSink), "sinks not put back after first run");
+
+	//Nor does one installed after it
+	unsigned int second = 0;
+	g_log_sinks.emplace_back(new CountingLogSink(second));
+	ok &= Check(Greenpak4PlaceAndRoute(json.data(), json.size(), options, results), "second run failed");
+	ok &= Check(results.m_log.size() == loglen, "second run logged something different");
+	ok &= Check( (first == 0) && (second == 0), "second run leaked to the application's sinks");
+	ok &= Check(g_log_sinks.size() == 2, "sinks not put back after second run");
+
+	//With no sinks at all, the run still logs to its results
+	g_log_sinks.clear();
+	ok &= Check(Greenpak4PlaceAndRoute(json.data(), json.size(), options, results), "third run failed");
+	ok &= Check(results.m_log.size() == loglen, "third run logged something different");
+	ok &= Check(g_log_sinks.empty(), "sinks left behind by third run");
+
+	//Forwarding runs do reach the application's sinks, and so does anything logged outside a run
+	unsigned int forwarded = 0;
+	g_log_sinks.emplace_back(new CountingLogSink(forwarded));
+	options.m_forwardLog = true;
+	ok &= Check(Greenpak4PlaceAndRoute(json.data(), json.size(), options, results), "forwarding run failed");
+	ok &= Check(results.m_log.size() == loglen, "forwarding run logged something different");
+	ok &= Check(forwarded != 0, "forwarding run didn't reach the application's sink");
+	unsigned int before = forwarded;
+	LogNotice("Logged outside a run\n");
+	ok &= Check(forwarded == before + 1, "message outside a run didn't reach the application's sink");
+
+	return ok ? 0 : 1;
+}
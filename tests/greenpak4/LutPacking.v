@@ -0,0 +1,88 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+`default_nettype none
+
+/**
+	Six 4-input LUTs, but the device only has two LUT4 sites. Two of the LUTs really use all four inputs, the other four
+	have inputs that make no difference (or the same signal on two inputs) and have to be shrunk to fit into LUT3 and LUT2
+	sites.
+
+	INPUTS:
+		Pins 2, 3, 4, 5
+
+	OUTPUTS:
+		Pins 12-17, each a function of the inputs
+ */
+module LutPacking(a, b, c, d, y0, y1, y2, y3, y4, y5);
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// I/O declarations
+
+	(* LOC = "P2" *)
+	input wire a;
+
+	(* LOC = "P3" *)
+	input wire b;
+
+	(* LOC = "P4" *)
+	input wire c;
+
+	(* LOC = "P5" *)
+	input wire d;
+
+	(* LOC = "P12" *)
+	output wire y0;
+
+	(* LOC = "P13" *)
+	output wire y1;
+
+	(* LOC = "P14" *)
+	output wire y2;
+
+	(* LOC = "P15" *)
+	output wire y3;
+
+	(* LOC = "P16" *)
+	output wire y4;
+
+	(* LOC = "P17" *)
+	output wire y5;
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// LUTs with redundant inputs. Explicitly instantiate to prevent Yosys from optimizing them
+
+	//a ^ b ^ c, IN3 is ignored
+	GP_4LUT #(.INIT(16'h9696)) lut0(.IN0(a), .IN1(b), .IN2(c), .IN3(d), .OUT(y0));
+
+	//a drives two inputs, so only three distinct signals
+	GP_4LUT #(.INIT(16'hb3ec)) lut1(.IN0(a), .IN1(b), .IN2(a), .IN3(c), .OUT(y1));
+
+	//~d & (a | c), IN1 is ignored
+	GP_4LUT #(.INIT(16'h00fa)) lut3(.IN0(a), .IN1(b), .IN2(c), .IN3(d), .OUT(y3));
+
+	//d ^ a, IN1 and IN2 are ignored
+	GP_4LUT #(.INIT(16'h55aa)) lut5(.IN0(d), .IN1(c), .IN2(b), .IN3(a), .OUT(y5));
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// LUTs that need all four inputs
+
+	GP_4LUT #(.INIT(16'h7778)) lut2(.IN0(a), .IN1(b), .IN2(c), .IN3(d), .OUT(y2));
+	GP_4LUT #(.INIT(16'h6aaa)) lut4(.IN0(a), .IN1(b), .IN2(c), .IN3(d), .OUT(y4));
+
+endmodule
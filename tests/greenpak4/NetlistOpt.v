@@ -0,0 +1,86 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+`default_nettype none
+
+/**
+	Something for each of the gp4par netlist optimization passes to do. gp4par --verify checks the optimized design
+	against this netlist as written.
+
+	INPUTS:
+		Pins 2, 3, 4
+
+	OUTPUTS:
+		Pins 12-16, each a function of the inputs
+ */
+module NetlistOpt(a, b, c, y0, y1, y2, y3, y4);
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// I/O declarations
+
+	(* LOC = "P2" *)
+	input wire a;
+
+	(* LOC = "P3" *)
+	input wire b;
+
+	(* LOC = "P4" *)
+	input wire c;
+
+	(* LOC = "P12" *)
+	output wire y0;
+
+	(* LOC = "P13" *)
+	output wire y1;
+
+	(* LOC = "P14" *)
+	output wire y2;
+
+	(* LOC = "P15" *)
+	output wire y3;
+
+	(* LOC = "P16" *)
+	output wire y4;
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Explicitly instantiate everything to prevent Yosys from optimizing it first
+
+	//absorb-inv: the inverter only feeds a LUT, so it gets folded into the truth table
+	wire a_n;
+	GP_INV inv_a(.IN(a), .OUT(a_n));
+	GP_2LUT #(.INIT(4'h8)) and_an_b(.IN0(a_n), .IN1(b), .OUT(y0));
+
+	//constprop: a constant LUT input is folded into the truth table
+	GP_3LUT #(.INIT(8'h80)) and_a_1_c(.IN0(a), .IN1(1'b1), .IN2(c), .OUT(y1));
+
+	//strash: the same function of the same signals twice, with the inputs swapped
+	GP_2LUT #(.INIT(4'h8)) and_a_b(.IN0(a), .IN1(b), .OUT(y2));
+	GP_2LUT #(.INIT(4'h8)) and_b_a(.IN0(b), .IN1(a), .OUT(y3));
+
+	//constprop, then sweep: the inverter output is constant, so the inverter goes away once nothing reads it
+	wire one;
+	GP_INV inv_0(.IN(1'b0), .OUT(one));
+	GP_2LUT #(.INIT(4'h8)) and_1_b(.IN0(one), .IN1(b), .OUT(y4));
+
+	//sweep: nothing reads the flipflop, so it and the LUT driving it are removed
+	wire parity;
+	wire parity_ff;
+	GP_3LUT #(.INIT(8'h96)) xor_abc(.IN0(a), .IN1(b), .IN2(c), .OUT(parity));
+	GP_DFF dead_ff(.D(parity), .CLK(a), .Q(parity_ff));
+
+endmodule
@@ -0,0 +1,106 @@
+/***********************************************************************************************************************
+ * Copyright (C) 2016 Andrew Zonenberg and contributors                                                                *
+ *                                                                                                                     *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General   *
+ * Public License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) *
+ * any later version.                                                                                                  *
+ *                                                                                                                     *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied  *
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for     *
+ * more details.                                                                                                       *
+ *                                                                                                                     *
+ * You should have received a copy of the GNU Lesser General Public License along with this program; if not, you may   *
+ * find one here:                                                                                                      *
+ * https://www.gnu.org/licenses/old-licenses/lgpl-2.1.txt                                                              *
+ * or you may search the http://www.gnu.org website for the version 2.1 license, or you may write to the Free Software *
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA                                      *
+ **********************************************************************************************************************/
+
+`default_nettype none
+
+/**
+	More signals need to cross between the two routing matrices than there are cross connections, unless gp4par
+	replicates some of the AND gates into the matrix their loads are in.
+
+	The AND gates are locked into matrix 0 and the XOR gates reading them into matrix 1. The extra XORs in matrix 0
+	keep the original AND gates alive, so the ANDs have loads on both sides.
+
+	INPUTS:
+		Pins 3-10
+
+	OUTPUTS:
+		Pins 12, 13, 15-20, each a function of the inputs
+ */
+module Replication(a, y);
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// I/O declarations
+
+	(* LOC = "P10 P9 P8 P7 P6 P5 P4 P3" *)
+	input wire[7:0] a;
+
+	(* LOC = "P20 P19 P18 P17 P16 P15 P13 P12" *)
+	output wire[7:0] y;
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// AND gates in matrix 0. Explicitly instantiate to prevent Yosys from optimizing them
+
+	wire[3:0] x;
+
+	(* LOC = "LUT2_0" *)
+	GP_2LUT #(.INIT(4'h8)) and0(.IN0(a[0]), .IN1(a[1]), .OUT(x[0]));
+
+	(* LOC = "LUT2_1" *)
+	GP_2LUT #(.INIT(4'h8)) and1(.IN0(a[2]), .IN1(a[3]), .OUT(x[1]));
+
+	(* LOC = "LUT2_2" *)
+	GP_2LUT #(.INIT(4'h8)) and2(.IN0(a[4]), .IN1(a[5]), .OUT(x[2]));
+
+	(* LOC = "LUT2_3" *)
+	GP_2LUT #(.INIT(4'h8)) and3(.IN0(a[6]), .IN1(a[7]), .OUT(x[3]));
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Loads of the AND gates in matrix 0
+
+	wire[3:0] k;
+
+	(* LOC = "LUT3_0", keep *)
+	GP_2LUT #(.INIT(4'h6)) xor0(.IN0(x[0]), .IN1(a[0]), .OUT(k[0]));
+
+	(* LOC = "LUT3_1", keep *)
+	GP_2LUT #(.INIT(4'h6)) xor1(.IN0(x[1]), .IN1(a[0]), .OUT(k[1]));
+
+	(* LOC = "LUT3_2", keep *)
+	GP_2LUT #(.INIT(4'h6)) xor2(.IN0(x[2]), .IN1(a[0]), .OUT(k[2]));
+
+	(* LOC = "LUT3_3", keep *)
+	GP_2LUT #(.INIT(4'h6)) xor3(.IN0(x[3]), .IN1(a[0]), .OUT(k[3]));
+
+	////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	// Loads of the AND gates in matrix 1
+
+	(* LOC = "LUT3_8" *)
+	GP_3LUT #(.INIT(8'h96)) out0(.IN0(a[0]), .IN1(x[0]), .IN2(a[3]), .OUT(y[0]));
+
+	(* LOC = "LUT3_9" *)
+	GP_3LUT #(.INIT(8'h96)) out1(.IN0(a[1]), .IN1(x[1]), .IN2(a[4]), .OUT(y[1]));
+
+	(* LOC = "LUT3_10" *)
+	GP_3LUT #(.INIT(8'h96)) out2(.IN0(a[2]), .IN1(x[2]), .IN2(a[5]), .OUT(y[2]));
+
+	(* LOC = "LUT3_11" *)
+	GP_3LUT #(.INIT(8'h96)) out3(.IN0(a[3]), .IN1(x[3]), .IN2(a[6]), .OUT(y[3]));
+
+	(* LOC = "LUT3_12" *)
+	GP_3LUT #(.INIT(8'h96)) out4(.IN0(a[4]), .IN1(x[0]), .IN2(a[7]), .OUT(y[4]));
+
+	(* LOC = "LUT3_13" *)
+	GP_3LUT #(.INIT(8'h96)) out5(.IN0(a[5]), .IN1(x[1]), .IN2(a[0]), .OUT(y[5]));
+
+	(* LOC = "LUT3_14" *)
+	GP_3LUT #(.INIT(8'h96)) out6(.IN0(a[6]), .IN1(x[2]), .IN2(a[1]), .OUT(y[6]));
+
+	(* LOC = "LUT3_15" *)
+	GP_3LUT #(.INIT(8'h96)) out7(.IN0(a[7]), .IN1(x[3]), .IN2(a[2]), .OUT(y[7]));
+
+endmodule